@@ -0,0 +1,428 @@
+#!/usr/bin/env python3
+# Copyright 2022 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+"""Tunes the tile sizes of all CPU dispatches in a model.
+
+Every dispatch of the model is extracted into a benchmark module with
+--iree-hal-dump-executable-benchmarks-combined. The benchmark module is compiled
+once with the default heuristics, recording the configuration chosen for each
+dispatch with --iree-codegen-llvmcpu-dump-tuning-records. Candidate
+configurations derived from the defaults are then swept in rounds: each round
+compiles the benchmark module with a tuning database assigning one candidate to
+every dispatch and times all dispatches with iree-benchmark-executables on the
+local CPU. The fastest configuration of each dispatch that beats the default is
+written to the output tuning database, which the compiler consumes with
+--iree-codegen-llvmcpu-tuning-database when compiling the model:
+
+  python3 tune_cpu_dispatches.py \\
+    --iree_compile=build/tools/iree-compile \\
+    --iree_benchmark_executables=build/tools/iree-benchmark-executables \\
+    --compile_flags="--iree-hal-target-backends=llvm-cpu \\
+                     --iree-llvm-target-cpu-features=host" \\
+    --input_type=mhlo \\
+    --output=/tmp/model_tuning.jsonl \\
+    model.mlir
+
+  build/tools/iree-compile \\
+    --iree-hal-target-backends=llvm-cpu \\
+    --iree-llvm-target-cpu-features=host \\
+    --iree-input-type=mhlo \\
+    --iree-codegen-llvmcpu-tuning-database=/tmp/model_tuning.jsonl \\
+    model.mlir -o model.vmfb
+
+Dispatches are keyed by a fingerprint of their contents and target so the
+database can be shared by models containing the same dispatches. Compile with
+the same target flags used for tuning or the fingerprints will not match.
+"""
+
+import argparse
+import copy
+import itertools
+import json
+import os
+import pathlib
+import re
+import shlex
+import subprocess
+import sys
+import tempfile
+
+from typing import Dict, List, Optional, Sequence
+
+# Multipliers applied to each workgroup tile size to derive candidates.
+TILE_SIZE_FACTORS = (1, 0.5, 2, 0.25, 4)
+
+TIME_UNIT_TO_NS = {"ns": 1, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def find_bracketed_list(text: str, start: int) -> int:
+  """Returns the index past the `]` closing the `[` at |start|."""
+  depth = 0
+  for index in range(start, len(text)):
+    if text[index] == "[":
+      depth += 1
+    elif text[index] == "]":
+      depth -= 1
+      if depth == 0:
+        return index + 1
+  raise ValueError(f"unbalanced brackets in '{text}'")
+
+
+def parse_tile_sizes(compilation_info: str) -> Optional[List[List[int]]]:
+  """Returns the tile sizes of a textual compilation info, if any."""
+  key = "tile_sizes = "
+  start = compilation_info.find(key)
+  if start < 0:
+    return None
+  start += len(key)
+  end = find_bracketed_list(compilation_info, start)
+  return json.loads(compilation_info[start:end])
+
+
+def replace_tile_sizes(compilation_info: str,
+                       tile_sizes: List[List[int]]) -> str:
+  """Returns |compilation_info| with its tile sizes replaced."""
+  key = "tile_sizes = "
+  start = compilation_info.find(key) + len(key)
+  end = find_bracketed_list(compilation_info, start)
+  return (compilation_info[:start] + json.dumps(tile_sizes) +
+          compilation_info[end:])
+
+
+def generate_candidates(compilation_info: str,
+                        max_candidates: int) -> List[str]:
+  """Derives candidate configurations from a default |compilation_info|.
+
+  Only the workgroup (first level) tile sizes are varied. Each nonzero tile
+  size is scaled by the factors in TILE_SIZE_FACTORS while remaining a multiple
+  of the next level tile size so that the pass pipeline verifiers accept it.
+  Candidates closest to the default come first and the default itself is not
+  included.
+  """
+  tile_sizes = parse_tile_sizes(compilation_info)
+  # Workload per workgroup must match the workgroup tile sizes; leave such
+  # configurations alone instead of keeping the two in sync.
+  if not tile_sizes or "workload_per_wg" in compilation_info:
+    return []
+  workgroup_tiles = tile_sizes[0]
+  inner_tiles = tile_sizes[1] if len(tile_sizes) > 1 else []
+
+  choices = []
+  for dim, size in enumerate(workgroup_tiles):
+    inner = inner_tiles[dim] if dim < len(inner_tiles) else 0
+    dim_choices = []
+    for factor in TILE_SIZE_FACTORS:
+      scaled = int(size * factor)
+      if size == 0 or scaled < 1 or scaled < inner:
+        continue
+      if inner and scaled % inner != 0:
+        continue
+      if scaled not in dim_choices:
+        dim_choices.append(scaled)
+    choices.append(dim_choices if dim_choices else [size])
+
+  def distance(sizes):
+    return sum(
+        choice.index(size) for choice, size in zip(choices, sizes))
+
+  candidates = sorted(
+      (sizes for sizes in itertools.product(*choices)
+       if list(sizes) != workgroup_tiles),
+      key=distance)
+  results = []
+  for sizes in candidates[:max_candidates]:
+    new_tile_sizes = copy.deepcopy(tile_sizes)
+    new_tile_sizes[0] = list(sizes)
+    results.append(replace_tile_sizes(compilation_info, new_tile_sizes))
+  return results
+
+
+def read_tuning_records(path: pathlib.Path) -> List[Dict]:
+  """Reads a JSON lines tuning database."""
+  records = []
+  with open(path) as f:
+    for line in f:
+      if line.strip():
+        records.append(json.loads(line))
+  return records
+
+
+def write_tuning_records(path: pathlib.Path, records: Sequence[Dict]):
+  """Writes a JSON lines tuning database."""
+  with open(path, "w") as f:
+    for record in records:
+      f.write(json.dumps(record, sort_keys=True) + "\n")
+
+
+def get_benchmark_prefix(record: Dict) -> str:
+  """Returns the benchmark function name prefix of a dispatch.
+
+  See appendDispatchBenchmark in DumpExecutableBenchmarks.cpp.
+  """
+  return f"{record['executable']}_{record['variant']}_{record['export']}"
+
+
+def parse_benchmark_times(benchmark_json: Dict) -> Dict[str, float]:
+  """Returns the real time in ns of each benchmark function."""
+  times = {}
+  for benchmark in benchmark_json.get("benchmarks", []):
+    if benchmark.get("run_type", "iteration") != "iteration":
+      continue
+    if benchmark.get("error_occurred"):
+      continue
+    name = benchmark["name"].split("/")[0]
+    if name.startswith("BM_"):
+      name = name[len("BM_"):]
+    unit = TIME_UNIT_TO_NS[benchmark.get("time_unit", "ns")]
+    times[name] = times.get(name, 0.0) + benchmark["real_time"] * unit
+  return times
+
+
+def get_dispatch_times(records: Sequence[Dict],
+                       benchmark_times: Dict[str, float]) -> Dict[str, float]:
+  """Sums the benchmark times of each dispatch fingerprint.
+
+  A dispatch may be benchmarked with several workloads and the same dispatch
+  may appear in multiple executables.
+  """
+  times = {}
+  for record in records:
+    # Benchmark names are suffixed with the workload, e.g. `_384x128`.
+    pattern = re.compile(re.escape(get_benchmark_prefix(record)) +
+                         r"(_[0-9]+(x[0-9]+)*)?")
+    for name, time in benchmark_times.items():
+      if pattern.fullmatch(name):
+        fingerprint = record["fingerprint"]
+        times[fingerprint] = times.get(fingerprint, 0.0) + time
+  return times
+
+
+class Tuner(object):
+  """Runs the compiler and benchmark tools in a working directory."""
+
+  def __init__(self, args: argparse.Namespace, work_dir: pathlib.Path):
+    self.args = args
+    self.work_dir = work_dir
+    self.compile_flags = shlex.split(args.compile_flags)
+
+  def run(self, cmd: List[str], check: bool = True) -> bool:
+    if self.args.verbose:
+      print(" ".join(shlex.quote(arg) for arg in cmd), file=sys.stderr)
+    result = subprocess.run(cmd,
+                            stdout=subprocess.DEVNULL,
+                            stderr=None if self.args.verbose else
+                            subprocess.PIPE,
+                            text=True)
+    if result.returncode != 0 and check:
+      raise RuntimeError(f"command failed: {' '.join(cmd)}\n{result.stderr}")
+    return result.returncode == 0
+
+  def dump_benchmark_module(self) -> pathlib.Path:
+    dump_dir = self.work_dir / "benchmarks"
+    cmd = [self.args.iree_compile, self.args.model, "-o", os.devnull]
+    cmd += self.compile_flags
+    if self.args.input_type:
+      cmd.append(f"--iree-input-type={self.args.input_type}")
+    cmd += [
+        f"--iree-hal-dump-executable-benchmarks-to={dump_dir}",
+        "--iree-hal-dump-executable-benchmarks-combined",
+    ]
+    self.run(cmd)
+    modules = list(dump_dir.glob("*_benchmarks.mlir"))
+    if len(modules) != 1:
+      raise RuntimeError(f"expected one benchmark module in {dump_dir}")
+    return modules[0]
+
+  def compile_benchmark_module(self,
+                               benchmark_module: pathlib.Path,
+                               output: pathlib.Path,
+                               extra_flags: List[str],
+                               check: bool = True) -> bool:
+    cmd = [self.args.iree_compile, str(benchmark_module), "-o", str(output)]
+    cmd += self.compile_flags + extra_flags
+    return self.run(cmd, check=check)
+
+  def benchmark(self, vmfb: pathlib.Path) -> Dict[str, float]:
+    results = self.work_dir / "benchmark_results.json"
+    cmd = [
+        self.args.iree_benchmark_executables,
+        f"--module_file={vmfb}",
+        f"--worker_counts={self.args.worker_count}",
+        f"--benchmark_out={results}",
+        "--benchmark_out_format=json",
+    ]
+    if self.args.benchmark_min_time:
+      cmd.append(f"--benchmark_min_time={self.args.benchmark_min_time}")
+    self.run(cmd)
+    with open(results) as f:
+      return parse_benchmark_times(json.load(f))
+
+  def tune(self) -> List[Dict]:
+    benchmark_module = self.dump_benchmark_module()
+
+    # Compile with the default heuristics to find the dispatches, their
+    # fingerprints and default configurations.
+    baseline_db = self.work_dir / "baseline.jsonl"
+    baseline_vmfb = self.work_dir / "baseline.vmfb"
+    self.compile_benchmark_module(
+        benchmark_module, baseline_vmfb,
+        [f"--iree-codegen-llvmcpu-dump-tuning-records={baseline_db}"])
+    records = read_tuning_records(baseline_db)
+    if not records:
+      print("no tunable dispatches found", file=sys.stderr)
+      return []
+    best_times = get_dispatch_times(records, self.benchmark(baseline_vmfb))
+    baseline_times = dict(best_times)
+
+    # One record per fingerprint describes the dispatch; duplicates are only
+    # needed to find all of its benchmarks.
+    dispatches = {}
+    for record in records:
+      dispatches.setdefault(record["fingerprint"], record)
+    candidates = {
+        fingerprint:
+        generate_candidates(record["compilation_info"],
+                            self.args.max_candidates)
+        for fingerprint, record in dispatches.items()
+    }
+    best_configs = {}
+
+    num_rounds = max((len(c) for c in candidates.values()), default=0)
+    for round_index in range(num_rounds):
+      round_configs = {
+          fingerprint: configs[round_index]
+          for fingerprint, configs in candidates.items()
+          if round_index < len(configs)
+      }
+      print(f"round {round_index + 1}/{num_rounds}: "
+            f"{len(round_configs)} dispatch(es)",
+            file=sys.stderr)
+      round_times = self.benchmark_configs(benchmark_module, records,
+                                           round_configs, round_index)
+      for fingerprint, time in round_times.items():
+        best_time = best_times.get(fingerprint)
+        if best_time is None or time < best_time:
+          best_times[fingerprint] = time
+          best_configs[fingerprint] = round_configs[fingerprint]
+
+    tuned_records = []
+    for fingerprint, config in best_configs.items():
+      baseline_time = baseline_times.get(fingerprint)
+      best_time = best_times[fingerprint]
+      if baseline_time and best_time > baseline_time * (
+          1.0 - self.args.min_improvement):
+        continue
+      record = dict(dispatches[fingerprint])
+      record["compilation_info"] = config
+      record["time_ns"] = best_time
+      if baseline_time:
+        record["baseline_time_ns"] = baseline_time
+        print(f"{get_benchmark_prefix(record)}: "
+              f"{baseline_time / best_time:.2f}x faster",
+              file=sys.stderr)
+      tuned_records.append(record)
+    return tuned_records
+
+  def benchmark_configs(self, benchmark_module: pathlib.Path,
+                        records: Sequence[Dict], configs: Dict[str, str],
+                        round_index: int) -> Dict[str, float]:
+    """Benchmarks all dispatches with the given configurations.
+
+    When a configuration fails to compile the dispatches are retried one at a
+    time so that one invalid candidate does not discard the whole round.
+    """
+    round_db = self.work_dir / f"round_{round_index}.jsonl"
+    round_vmfb = self.work_dir / f"round_{round_index}.vmfb"
+    write_tuning_records(round_db, [{
+        "fingerprint": fingerprint,
+        "compilation_info": config
+    } for fingerprint, config in configs.items()])
+    if self.compile_benchmark_module(
+        benchmark_module,
+        round_vmfb, [f"--iree-codegen-llvmcpu-tuning-database={round_db}"],
+        check=False):
+      times = get_dispatch_times(records, self.benchmark(round_vmfb))
+      return {f: t for f, t in times.items() if f in configs}
+
+    times = {}
+    for fingerprint, config in configs.items():
+      write_tuning_records(round_db, [{
+          "fingerprint": fingerprint,
+          "compilation_info": config
+      }])
+      if not self.compile_benchmark_module(
+          benchmark_module,
+          round_vmfb, [f"--iree-codegen-llvmcpu-tuning-database={round_db}"],
+          check=False):
+        continue
+      dispatch_times = get_dispatch_times(records, self.benchmark(round_vmfb))
+      if fingerprint in dispatch_times:
+        times[fingerprint] = dispatch_times[fingerprint]
+    return times
+
+
+def parse_arguments():
+  """Parses command-line options."""
+  parser = argparse.ArgumentParser(
+      description=__doc__, formatter_class=argparse.RawTextHelpFormatter)
+  parser.add_argument("model", help="Model source to tune")
+  parser.add_argument("--iree_compile",
+                      required=True,
+                      help="Path to the iree-compile tool")
+  parser.add_argument("--iree_benchmark_executables",
+                      required=True,
+                      help="Path to the iree-benchmark-executables tool")
+  parser.add_argument("--output",
+                      required=True,
+                      type=pathlib.Path,
+                      help="Tuning database to write")
+  parser.add_argument(
+      "--compile_flags",
+      default="--iree-hal-target-backends=llvm-cpu",
+      help="Target flags used to compile the model and the benchmarks")
+  parser.add_argument("--input_type",
+                      default="",
+                      help="Value of --iree-input-type for the model")
+  parser.add_argument("--max_candidates",
+                      type=int,
+                      default=8,
+                      help="Maximum number of candidates per dispatch")
+  parser.add_argument("--worker_count",
+                      type=int,
+                      default=1,
+                      help="Number of task system workers to benchmark with")
+  parser.add_argument("--benchmark_min_time",
+                      default="",
+                      help="Value of --benchmark_min_time for each run")
+  parser.add_argument(
+      "--min_improvement",
+      type=float,
+      default=0.02,
+      help="Minimum relative improvement over the default to keep a config")
+  parser.add_argument("--work_dir",
+                      type=pathlib.Path,
+                      default=None,
+                      help="Directory to keep intermediate files in")
+  parser.add_argument("--verbose",
+                      action="store_true",
+                      help="Print the commands being run")
+  return parser.parse_args()
+
+
+def main(args):
+  if args.work_dir:
+    args.work_dir.mkdir(parents=True, exist_ok=True)
+    records = Tuner(args, args.work_dir).tune()
+  else:
+    with tempfile.TemporaryDirectory() as work_dir:
+      records = Tuner(args, pathlib.Path(work_dir)).tune()
+  write_tuning_records(args.output, records)
+  print(f"wrote {len(records)} tuned dispatch(es) to {args.output}",
+        file=sys.stderr)
+
+
+if __name__ == "__main__":
+  main(parse_arguments())
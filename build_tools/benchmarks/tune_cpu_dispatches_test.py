@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+# Copyright 2022 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+import unittest
+
+from tune_cpu_dispatches import generate_candidates, get_dispatch_times, parse_benchmark_times, parse_tile_sizes
+
+COMPILATION_INFO = (
+    "#iree_codegen.compilation_info<lowering_config = <tile_sizes = "
+    "[[128, 64, 0], [8, 32, 0], [0, 0, 16]]>, "
+    "translation_info = <CPUDoubleTilingPadExpert>>")
+
+
+class TuneCpuDispatchesTest(unittest.TestCase):
+
+  def test_parse_tile_sizes(self):
+    self.assertEqual(parse_tile_sizes(COMPILATION_INFO),
+                     [[128, 64, 0], [8, 32, 0], [0, 0, 16]])
+
+  def test_parse_tile_sizes_missing(self):
+    self.assertIsNone(
+        parse_tile_sizes("#iree_codegen.translation_info<CPUDefault>"))
+
+  def test_generate_candidates(self):
+    candidates = generate_candidates(COMPILATION_INFO, max_candidates=4)
+
+    self.assertEqual(len(candidates), 4)
+    self.assertNotIn(COMPILATION_INFO, candidates)
+    for candidate in candidates:
+      tile_sizes = parse_tile_sizes(candidate)
+      # Inner levels are kept and workgroup tiles stay multiples of them.
+      self.assertEqual(tile_sizes[1:], [[8, 32, 0], [0, 0, 16]])
+      self.assertEqual(tile_sizes[0][0] % 8, 0)
+      self.assertEqual(tile_sizes[0][1] % 32, 0)
+      self.assertEqual(tile_sizes[0][2], 0)
+      self.assertTrue(candidate.endswith("<CPUDoubleTilingPadExpert>>"))
+    # The closest candidates vary one dimension at a time.
+    self.assertIn([64, 64, 0], [parse_tile_sizes(c)[0] for c in candidates])
+
+  def test_generate_candidates_with_workload_per_wg(self):
+    compilation_info = COMPILATION_INFO.replace(
+        "<CPUDoubleTilingPadExpert>",
+        "<CPUDoubleTilingPadExpert workload_per_wg = [64, 128]>")
+
+    self.assertEqual(generate_candidates(compilation_info, 4), [])
+
+  def test_get_dispatch_times(self):
+    benchmark_json = {
+        "benchmarks": [
+            {
+                "name": "BM_ex_0_cpu_dispatch_1_64x64/workers:1/real_time",
+                "run_type": "iteration",
+                "real_time": 2.0,
+                "time_unit": "us",
+            },
+            {
+                "name": "BM_ex_0_cpu_dispatch_1_32x32/workers:1/real_time",
+                "run_type": "iteration",
+                "real_time": 1.0,
+                "time_unit": "us",
+            },
+            {
+                "name": "BM_ex_0_cpu_dispatch_1_foo_16/workers:1/real_time",
+                "run_type": "iteration",
+                "real_time": 7.0,
+                "time_unit": "us",
+            },
+            {
+                "name": "BM_ex_0_cpu_dispatch_10/workers:1/real_time",
+                "run_type": "iteration",
+                "real_time": 5.0,
+                "time_unit": "ms",
+            },
+            {
+                "name": "BM_ex_0_cpu_dispatch_10/workers:1/real_time_mean",
+                "run_type": "aggregate",
+                "real_time": 5.0,
+                "time_unit": "ms",
+            },
+        ]
+    }
+    records = [
+        {
+            "fingerprint": "a",
+            "executable": "ex_0",
+            "variant": "cpu",
+            "export": "dispatch_1",
+        },
+        {
+            "fingerprint": "b",
+            "executable": "ex_0",
+            "variant": "cpu",
+            "export": "dispatch_10",
+        },
+    ]
+
+    times = get_dispatch_times(records, parse_benchmark_times(benchmark_json))
+
+    self.assertEqual(times, {"a": 3000.0, "b": 5e6})
+
+
+if __name__ == "__main__":
+  unittest.main()
@@ -0,0 +1,46 @@
+#!/bin/bash
+# Copyright 2022 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# Build the IREE runtime using CMake with VM execution profiling compiled in
+# and run the VM tests, which skip the profiling tests in default builds.
+# Designed for CI, but can be run manually. This uses previously cached build
+# results and does not clear build directories.
+
+set -e
+set -x
+
+ROOT_DIR=$(git rev-parse --show-toplevel)
+cd ${ROOT_DIR?}
+
+CMAKE_BIN=${CMAKE_BIN:-$(which cmake)}
+"${CMAKE_BIN?}" --version
+ninja --version
+
+if [ -d "build-runtime-profiling" ]
+then
+  echo "build-runtime-profiling directory already exists. Will use cached results there."
+else
+  echo "build-runtime-profiling directory does not already exist. Creating a new one."
+  mkdir build-runtime-profiling
+fi
+cd build-runtime-profiling
+
+# Op profiling implies function profiling; see iree/base/config.h.
+PROFILING_DEFINES="-DIREE_VM_EXECUTION_PROFILING_OPS_ENABLE=1"
+"${CMAKE_BIN?}" -G Ninja .. \
+  -DCMAKE_BUILD_TYPE=RelWithDebInfo \
+  -DCMAKE_C_FLAGS="${PROFILING_DEFINES?}" \
+  -DCMAKE_CXX_FLAGS="${PROFILING_DEFINES?}" \
+  -DIREE_BUILD_COMPILER=OFF
+"${CMAKE_BIN?}" --build . -- -k 0
+
+export CTEST_PARALLEL_LEVEL=${CTEST_PARALLEL_LEVEL:-$(nproc)}
+ctest \
+  --timeout 900 \
+  --output-on-failure \
+  --no-tests=error \
+  --tests-regex "^iree/vm/"
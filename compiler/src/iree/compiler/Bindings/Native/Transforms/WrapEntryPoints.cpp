@@ -197,22 +197,55 @@ static func::FuncOp createExportWrapperFunc(func::FuncOp exportOp,
   auto entryBuilder = OpBuilder::atBlockBegin(entryBlock);
 
   // Build a map of result value to the argument that has its backing storage.
+  // Storage is either a !hal.buffer provided by the caller only to hold the
+  // result or a tensor input that the caller donates to the result: the input
+  // contents must not be used by the caller after the call and the result may
+  // be computed in-place in the input storage.
   SmallVector<Value> resultStorages;
   resultStorages.resize(resultTypes.size());
   for (unsigned i = 0; i < inputTypes.size(); ++i) {
     auto outputAttr =
         exportOp.getArgAttrOfType<IntegerAttr>(i, "iree.abi.output");
     if (!outputAttr) continue;
-    // Today all outputs need to be a !hal.buffer - we could change this
-    // in the future to be something more generalized.
+    int64_t resultIndex = outputAttr.getInt();
+    if (resultIndex < 0 ||
+        resultIndex >= static_cast<int64_t>(resultTypes.size()) ||
+        resultStorages[resultIndex]) {
+      exportOp.emitError() << "storage argument " << i
+                           << " has an invalid or duplicate output index "
+                           << resultIndex;
+      return {};
+    }
     auto storageArg = entryBlock->getArgument(i);
+    auto oldType = oldExportType.getInput(i);
+    if (oldType.isa<TensorType>()) {
+      if (oldType != oldExportType.getResult(resultIndex)) {
+        exportOp.emitError() << "donated argument " << i << " type " << oldType
+                             << " does not match result " << resultIndex
+                             << " type "
+                             << oldExportType.getResult(resultIndex);
+        return {};
+      }
+      // The donated storage is only known to be large enough for the result
+      // when the input and result have the same static shape.
+      if (!oldType.cast<TensorType>().hasStaticShape()) {
+        exportOp.emitError() << "donated argument " << i << " type " << oldType
+                             << " must have a static shape";
+        return {};
+      }
+      resultStorages[resultIndex] =
+          entryBuilder.create<IREE::HAL::BufferViewBufferOp>(
+              storageArg.getLoc(),
+              entryBuilder.getType<IREE::HAL::BufferType>(), storageArg);
+      continue;
+    }
     if (!storageArg.getType().isa<IREE::HAL::BufferType>()) {
       exportOp.emitError() << "storage argument " << i
                            << " has an invalid type " << storageArg.getType()
-                           << "; must be a !hal.buffer";
+                           << "; must be a !hal.buffer or a donated tensor";
       return {};
     }
-    resultStorages[outputAttr.getInt()] = storageArg;
+    resultStorages[resultIndex] = storageArg;
   }
 
   // Marshal arguments.
@@ -57,6 +57,31 @@ func.func @outputStorage(%arg0: tensor<?x8x8x3xf32>, %ret1: !hal.buffer {iree.ab
 
 // -----
 
+// Tests that a tensor argument can be donated as the storage of a result.
+
+// CHECK-LABEL: func.func @donatedStorage(
+//  CHECK-SAME:   %[[ARG0:.+]]: !hal.buffer_view {iree.abi.output = 0 : index},
+//  CHECK-SAME:   %[[ARG1:.+]]: !hal.buffer_view
+//  CHECK-SAME: -> !hal.buffer_view
+//  CHECK-SAME: attributes {
+//  CHECK-SAME:   iree.abi.stub
+//  CHECK-SAME: } {
+//  CHECK-NEXT:   %[[ARG0_STORAGE:.+]] = hal.buffer_view.buffer<%[[ARG0]] : !hal.buffer_view> : !hal.buffer
+//  CHECK-NEXT:   %[[ARG0_TENSOR:.+]] = hal.tensor.import %[[ARG0]] : !hal.buffer_view -> tensor<4x8xf32>
+//  CHECK-NEXT:   %[[ARG1_TENSOR:.+]] = hal.tensor.import %[[ARG1]] : !hal.buffer_view -> tensor<1x8xf32>
+//  CHECK-NEXT:   %[[RET_TENSOR:.+]] = call @_donatedStorage(%[[ARG0_TENSOR]], %[[ARG1_TENSOR]])
+//  CHECK-NEXT:   %[[RET_VIEW:.+]] = hal.tensor.export %[[RET_TENSOR]] into %[[ARG0_STORAGE]] : tensor<4x8xf32> -> !hal.buffer_view
+//  CHECK-NEXT:   return %[[RET_VIEW]] : !hal.buffer_view
+//  CHECK-NEXT: }
+
+// CHECK-LABEL: func.func private @_donatedStorage(
+func.func @donatedStorage(%cache: tensor<4x8xf32> {iree.abi.output = 0 : index}, %update: tensor<1x8xf32>) -> tensor<4x8xf32> {
+  %0 = tensor.insert_slice %update into %cache[3, 0] [1, 8] [1, 1] : tensor<1x8xf32> into tensor<4x8xf32>
+  return %0 : tensor<4x8xf32>
+}
+
+// -----
+
 // CHECK-LABEL: func.func @wrappedAlready
 //  CHECK-SAME: (%arg0: !hal.buffer_view) -> !hal.buffer_view
 //  CHECK-SAME: attributes {iree.abi.stub}
@@ -0,0 +1,16 @@
+// RUN: iree-opt --iree-abi-wrap-entry-points --split-input-file --verify-diagnostics %s
+
+// expected-error @+1 {{donated argument 0 type tensor<?x8xf32> must have a static shape}}
+func.func @donatedDynamicStorage(%cache: tensor<?x8xf32> {iree.abi.output = 0 : index}, %update: tensor<1x8xf32>) -> tensor<?x8xf32> {
+  %c0 = arith.constant 0 : index
+  %0 = tensor.insert_slice %update into %cache[%c0, 0] [1, 8] [1, 1] : tensor<1x8xf32> into tensor<?x8xf32>
+  return %0 : tensor<?x8xf32>
+}
+
+// -----
+
+// expected-error @+1 {{donated argument 0 type tensor<4x8xf32> does not match result 0 type tensor<8x4xf32>}}
+func.func @donatedMismatchedStorage(%cache: tensor<4x8xf32> {iree.abi.output = 0 : index}) -> tensor<8x4xf32> {
+  %0 = linalg.init_tensor [8, 4] : tensor<8x4xf32>
+  return %0 : tensor<8x4xf32>
+}
@@ -900,6 +900,43 @@ static std::string getStringAttrFromTargetAttr(ModuleOp module,
   return "";
 }
 
+// Returns the non-zero status codes of microkernel calls within |funcOp| (an
+// entry point converted by ConvertHALEntryPointFuncOp) from the entry point so
+// that the runtime fails the dispatch. The microkernels are linked in from
+// runtime/src/iree/builtins/ukernel/ and return 0 on success.
+static void returnUKernelErrors(LLVM::LLVMFuncOp funcOp) {
+  SmallVector<LLVM::CallOp> callOps;
+  funcOp.walk([&](LLVM::CallOp callOp) {
+    auto callee = callOp.getCallee();
+    if (callee && callee->startswith("iree_ukernel_") &&
+        callOp.getNumResults() == 1) {
+      callOps.push_back(callOp);
+    }
+  });
+  if (callOps.empty()) return;
+
+  Location loc = funcOp.getLoc();
+  OpBuilder builder(funcOp.getContext());
+  Type statusType = builder.getI32Type();
+  Block *errorBlock = builder.createBlock(
+      &funcOp.getBody(), funcOp.getBody().end(), {statusType}, {loc});
+  builder.create<LLVM::ReturnOp>(loc, errorBlock->getArgument(0));
+  for (auto callOp : callOps) {
+    Block *continueBlock =
+        callOp->getBlock()->splitBlock(std::next(callOp->getIterator()));
+    builder.setInsertionPointAfter(callOp);
+    Value status = callOp.getResult(0);
+    Value zero = builder.create<LLVM::ConstantOp>(
+        callOp.getLoc(), statusType, builder.getI32IntegerAttr(0));
+    Value failed = builder.create<LLVM::ICmpOp>(
+        callOp.getLoc(), builder.getI1Type(), LLVM::ICmpPredicate::ne, status,
+        zero);
+    builder.create<LLVM::CondBrOp>(callOp.getLoc(), failed, errorBlock,
+                                   ValueRange{status}, continueBlock,
+                                   ValueRange{});
+  }
+}
+
 void ConvertToLLVMPass::runOnOperation() {
   auto module = getOperation();
   std::string dataLayoutStr = targetDataLayout.getValue();
@@ -997,6 +1034,13 @@ void ConvertToLLVMPass::runOnOperation() {
   >(&getContext(), converter);
   // clang-format on
 
+  // Public functions are the entry points converted by
+  // ConvertHALEntryPointFuncOp.
+  SmallVector<StringAttr> entryPointNames;
+  for (auto funcOp : module.getOps<func::FuncOp>()) {
+    if (funcOp.isPublic()) entryPointNames.push_back(funcOp.getNameAttr());
+  }
+
   LLVMConversionTarget target(getContext());
   target.addLegalOp<ModuleOp>();
   target.addIllegalDialect<func::FuncDialect, mlir::arith::ArithmeticDialect,
@@ -1009,6 +1053,12 @@ void ConvertToLLVMPass::runOnOperation() {
     return;
   }
 
+  for (auto entryPointName : entryPointNames) {
+    if (auto funcOp = module.lookupSymbol<LLVM::LLVMFuncOp>(entryPointName)) {
+      if (!funcOp.isExternal()) returnUKernelErrors(funcOp);
+    }
+  }
+
   // Post conversion patterns.
   {
     RewritePatternSet postPatterns(&getContext());
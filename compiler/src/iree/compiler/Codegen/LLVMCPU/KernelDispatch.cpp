@@ -11,11 +11,15 @@
 #include "iree-dialects/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Codegen/Common/LinalgOpInfo.h"
 #include "iree/compiler/Codegen/LLVMCPU/TargetMLTransformInfo.h"
+#include "iree/compiler/Codegen/LLVMCPU/TuningDatabase.h"
 #include "iree/compiler/Codegen/Transforms/Transforms.h"
 #include "iree/compiler/Codegen/Utils/Utils.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableFingerprint.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SHA1.h"
 #include "llvm/Support/TargetSelect.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
@@ -42,7 +46,8 @@ static llvm::cl::opt<int> clNativeVectorSizeInBytes(
 
 static llvm::cl::opt<int> clNumberOfRuntimeThreads(
     "iree-codegen-llvm-number-of-threads",
-    llvm::cl::desc("number of threads that are used at runtime"),
+    llvm::cl::desc("number of threads that are used at runtime if not "
+                   "specified by the `num_threads` target configuration"),
     llvm::cl::init(8));
 
 static llvm::cl::list<int> mmt4dWorkgroupTileSizes(
@@ -79,12 +84,32 @@ static llvm::cl::opt<bool> enableTripleTilingPipeline(
     llvm::cl::desc("enable triple tiling expert for matmul kernels"),
     llvm::cl::init(false));
 
+// Defined here as it changes the lowering configuration of linalg.mmt4d ops
+// and used in Passes.cpp to control the codegen pass pipeline.
+llvm::cl::opt<bool> clEnableLLVMCPUMicrokernels(
+    "iree-llvmcpu-enable-microkernels",
+    llvm::cl::desc("Lowers linalg.mmt4d ops to calls to the ukernel library "
+                   "linked in as bitcode (experimental)"),
+    llvm::cl::init(false));
+
 llvm::cl::opt<std::string> clCPUCodegenTransformDialectFileName(
     "iree-codegen-llvmcpu-use-transform-dialect",
     llvm::cl::desc(
         "MLIR file containing a transform dialect specification to apply"),
     llvm::cl::init(""));
 
+static llvm::cl::opt<std::string> clTuningDatabase(
+    "iree-codegen-llvmcpu-tuning-database",
+    llvm::cl::desc("Tuning database (see TuningDatabase.h) with the "
+                   "compilation info to use for dispatches by fingerprint"),
+    llvm::cl::init(""));
+
+static llvm::cl::opt<std::string> clDumpTuningRecords(
+    "iree-codegen-llvmcpu-dump-tuning-records",
+    llvm::cl::desc("Appends the fingerprint and the compilation info chosen "
+                   "for each dispatch to the given tuning database"),
+    llvm::cl::init(""));
+
 using IREE::Codegen::DispatchLoweringPassPipeline;
 
 // Encodes the pre-processing strategy to be applied on a Linalg operation
@@ -172,6 +197,18 @@ static int64_t getVectorSize(func::FuncOp entryPointFn, ShapedType shapedType) {
   return getVectorSize(entryPointFn, byteWidth);
 }
 
+/// Returns the number of threads that execute the workgroups of `op`
+/// concurrently.
+static int64_t getNumberOfThreads(Operation *op) {
+  auto variantOp = getExecutableVariantOp(op);
+  if (succeeded(variantOp)) {
+    auto targetMLTransInfo =
+        TargetMLTransformInfo::getTargetMLTransformInfo(*variantOp);
+    if (targetMLTransInfo.numThreads > 0) return targetMLTransInfo.numThreads;
+  }
+  return clNumberOfRuntimeThreads;
+}
+
 /// Returns minimum tiling sizes for each dimension. One dimension is possible
 /// to access at different element types. It determines the tiling sizes by
 /// looking into all the operands.
@@ -265,7 +302,7 @@ static unsigned getReferenceTypeLengthInBytes(func::FuncOp entryPointFn) {
 static SmallVector<int64_t> getDefaultDistributedLoopTileSizes(
     ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
     ArrayRef<int64_t> minTileSizes, ArrayRef<int64_t> maxTileSizes,
-    ArrayRef<int64_t> vectorSizeHints) {
+    ArrayRef<int64_t> vectorSizeHints, int64_t numThreads) {
   assert(lbs.size() == ubs.size() && lbs.size() == minTileSizes.size() &&
          lbs.size() == maxTileSizes.size() &&
          "expected all vectors to be of equal size");
@@ -312,7 +349,7 @@ static SmallVector<int64_t> getDefaultDistributedLoopTileSizes(
   // Reduce the number of workgroups in cases where we are dividing the work too
   // much. Over-provision the number of workgroups to twice the number of
   // threads.
-  int64_t numWorkgroupsLimit = 2 * clNumberOfRuntimeThreads;
+  int64_t numWorkgroupsLimit = 2 * numThreads;
   int64_t numWorkgroups =
       std::accumulate(numWorkgroupsPerDim.begin(), numWorkgroupsPerDim.end(),
                       1LL, std::multiplies<int64_t>{});
@@ -403,8 +440,8 @@ static int64_t getMaxTileSize(int64_t lb, int64_t ub, int64_t maxSize,
 static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
     ArrayRef<unsigned> partitionableLoops, ArrayRef<int64_t> lbs,
     ArrayRef<int64_t> ubs, ArrayRef<int64_t> minTileSizes,
-    ArrayRef<int64_t> maxTileSizes, bool allowIncompleteTile = false,
-    ArrayRef<int64_t> vectorSizeHints = {}) {
+    ArrayRef<int64_t> maxTileSizes, int64_t numThreads,
+    bool allowIncompleteTile = false, ArrayRef<int64_t> vectorSizeHints = {}) {
   int64_t numLoops = lbs.size();
   assert(numLoops == minTileSizes.size() && maxTileSizes.size() == numLoops &&
          "expected as many min/max tile sizes as number of loops");
@@ -428,7 +465,7 @@ static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
   SmallVector<int64_t> distributedTileSizes =
       getDefaultDistributedLoopTileSizes(lbs, ubs, adjustedMinTileSizes,
                                          adjustedMaxTileSizes,
-                                         adjustedVectorSizeHints);
+                                         adjustedVectorSizeHints, numThreads);
   // Final fix up of the tile sizes to make sure that they divide the problem
   // size to make it vectorizable.
   for (auto i : llvm::seq<unsigned>(0, distributedTileSizes.size())) {
@@ -449,9 +486,9 @@ static SmallVector<int64_t> getDefaultDistributedLevelTileSizes(
   SmallVector<int64_t> ubs = linalgOp.getStaticLoopRanges();
   auto loops = cast<PartitionableLoopsInterface>(linalgOp.getOperation())
                    .getPartitionableLoops(kNumMaxParallelDims);
-  return getDefaultDistributedLevelTileSizes(loops, lbs, ubs, minTileSizes,
-                                             maxTileSizes, allowIncompleteTile,
-                                             vectorSizeHints);
+  return getDefaultDistributedLevelTileSizes(
+      loops, lbs, ubs, minTileSizes, maxTileSizes, getNumberOfThreads(linalgOp),
+      allowIncompleteTile, vectorSizeHints);
 }
 
 /// Splits the tile sizes in `parallelSizes` into `reductionSizes` for the
@@ -562,7 +599,8 @@ static LogicalResult setDefaultRootConfig(
   }
 
   SmallVector<int64_t> flowTileSizes = getDefaultDistributedLevelTileSizes(
-      partitionableLoops, lbs, ubs, minTileSizes, maxTileSizes);
+      partitionableLoops, lbs, ubs, minTileSizes, maxTileSizes,
+      getNumberOfThreads(entryPointFn));
   TileSizesListType tileSizes;
   tileSizes.emplace_back(std::move(flowTileSizes));
   auto loweringConfig = IREE::Codegen::LoweringConfigAttr::get(
@@ -722,6 +760,71 @@ static LogicalResult setAArch64RootConfig(func::FuncOp entryPointFn,
       DispatchLoweringPassPipeline::CPUAArchDoubleTilingExpert);
 }
 
+/// Returns the byte width of the element type of `value`.
+static int64_t getElementByteWidth(Value value) {
+  return IREE::Util::getRoundedElementByteWidth(
+      getElementTypeOrSelf(value.getType()));
+}
+
+/// Caps the distributed tile sizes of the M and N dims of the matmul-like `op`
+/// with an analytical cache model, given the (vector level) `minTileSizes`:
+///  - The RHS panel (K x N tile) of a workgroup is reused for every row of its
+///    output tile, so the N tile is limited to keep it in half of the L2 cache
+///    with room left for the streamed LHS rows and the accumulators.
+///  - All concurrently running workgroups share the L3 cache and each reuses
+///    its LHS panel (M tile x K) for every column of its output tile, so the
+///    M tile is limited to keep the panels of all threads in the L3 cache.
+/// Tile sizes are only lowered, to a power of 2 that is at least the min tile
+/// size.
+static void limitMatmulTileSizesByCacheSizes(
+    linalg::LinalgOp op, const TargetMLTransformInfo &targetMLTransInfo,
+    ArrayRef<int64_t> minTileSizes, SmallVectorImpl<int64_t> &maxTileSizes) {
+  unsigned numLoops = op.getNumLoops();
+  if (numLoops < 3) return;
+  int64_t K = op.getStaticLoopRanges()[numLoops - 1];
+  if (ShapedType::isDynamic(K)) return;
+
+  auto limitTileSize = [&](unsigned dim, int64_t budgetInBytes,
+                           int64_t elementByteWidth) {
+    if (budgetInBytes <= 0) return;
+    int64_t size = llvm::PowerOf2Floor(budgetInBytes / (K * elementByteWidth));
+    size = std::max<int64_t>(size, minTileSizes[dim]);
+    maxTileSizes[dim] = std::min<int64_t>(maxTileSizes[dim], size);
+  };
+  limitTileSize(numLoops - 2, targetMLTransInfo.l2CacheSizeInBytes / 2,
+                getElementByteWidth(op.getInputOperand(1)->get()));
+  limitTileSize(numLoops - 3,
+                targetMLTransInfo.l3CacheSizeInBytes / getNumberOfThreads(op),
+                getElementByteWidth(op.getInputOperand(0)->get()));
+}
+
+/// Returns the tile size of the K dim of the cache level for the matmul-like
+/// `op`, given the vector level `workgroupTileSizes`. The LHS and RHS slivers
+/// used by one vector level tile are kept in half of the L1 cache. Returns 0 if
+/// the K dim is dynamic. Falls back to the experimentally derived default when
+/// the L1 size is unknown or the slivers have no static footprint.
+static int64_t getMatmulL1ReductionTileSize(
+    linalg::LinalgOp op, const TargetMLTransformInfo &targetMLTransInfo,
+    ArrayRef<int64_t> workgroupTileSizes) {
+  const int64_t kDefaultL1ReductionTileSize = 384;
+  if (targetMLTransInfo.l1CacheSizeInBytes <= 0) {
+    return kDefaultL1ReductionTileSize;
+  }
+  unsigned numLoops = op.getNumLoops();
+  int64_t K = op.getStaticLoopRanges()[numLoops - 1];
+  if (ShapedType::isDynamic(K)) return 0;
+  int64_t bytesPerK =
+      workgroupTileSizes[numLoops - 3] *
+          getElementByteWidth(op.getInputOperand(0)->get()) +
+      workgroupTileSizes[numLoops - 2] *
+          getElementByteWidth(op.getInputOperand(1)->get());
+  if (bytesPerK <= 0) return kDefaultL1ReductionTileSize;
+  int64_t vectorK = workgroupTileSizes[numLoops - 1];
+  int64_t maxSize = std::max<int64_t>(
+      targetMLTransInfo.l1CacheSizeInBytes / 2 / bytesPerK, vectorK);
+  return getMaxTileSize(0, K, maxSize, vectorK);
+}
+
 /// Returns default hard-coded workgroup sizes for a give target. No smartness
 /// should be introduced in this utility.
 static void getDefaultMatmulWorkgroupSizes(linalg::LinalgOp op,
@@ -818,6 +921,8 @@ static LogicalResult setRootConfig(
 
   auto variantOp = getExecutableVariantOp(entryPointFn);
   assert(succeeded(variantOp) && "ExecutableVariantOp not found");
+  auto targetMLTransInfo =
+      TargetMLTransformInfo::getTargetMLTransformInfo(*variantOp);
 
   // Use the default distribution for the matmul loops.
   int64_t defaultMaxSize = defaultWorkgroupTileSize;
@@ -845,10 +950,14 @@ static LogicalResult setRootConfig(
       maxTileSizes[0] = 192;
       maxTileSizes[1] = 128;
     }
+    limitMatmulTileSizesByCacheSizes(linalgOp, targetMLTransInfo,
+                                     workgroupTileSizes, maxTileSizes);
     flowTileSizes = getDefaultDistributedLevelTileSizes(
         linalgOp, workgroupTileSizes, maxTileSizes,
         /*allowIncompleteTile=*/true);
   } else {
+    limitMatmulTileSizesByCacheSizes(linalgOp, targetMLTransInfo,
+                                     workgroupTileSizes, maxTileSizes);
     flowTileSizes = getDefaultDistributedLevelTileSizes(
         linalgOp, workgroupTileSizes, maxTileSizes);
   }
@@ -866,10 +975,11 @@ static LogicalResult setRootConfig(
     return setMatmulPadRootConfig(entryPointFn, contractionOp, flowTileSizes,
                                   workgroupTileSizes, vectorSize);
   }
-  // TODO(hanchung): We should make the tile sizes be related to memory
-  // hierarchy. They are derived from experiments for now.
-  if (enableTripleTilingPipeline) {
-    SmallVector<int64_t> l1TileSizes = {0, 0, 384};
+  if (enableTripleTilingPipeline && numLoops == 3) {
+    SmallVector<int64_t> l1TileSizes = {
+        0, 0,
+        getMatmulL1ReductionTileSize(linalgOp, targetMLTransInfo,
+                                     workgroupTileSizes)};
     TileSizesListType tripleTileSizes = {flowTileSizes, l1TileSizes,
                                          workgroupTileSizes};
     if (isNoPadMultiTilingBeneficial(contractionOp, tripleTileSizes)) {
@@ -917,6 +1027,15 @@ static LogicalResult setRootConfig(func::FuncOp entryPointFn,
     return {1, 1, 1, M0, N0, K0};
   };
 
+  // Microkernels operate on whole workgroup tiles and the ops are only
+  // distributed before being lowered to calls (see LLVMCPULowerToUKernels).
+  if (clEnableLLVMCPUMicrokernels) {
+    TileSizesListType tileSizes = {getWorkgroupTileSizes()};
+    return setOpConfigAndEntryPointFnTranslation(
+        entryPointFn, mmt4dOp, tileSizes,
+        DispatchLoweringPassPipeline::CPUDefault);
+  }
+
   SmallVector<int64_t> parallelTileSizes = getL1TileSizes();
   SmallVector<int64_t> reductionTileSizes;
   splitParallelAndReductionTiles(mmt4dOp.getOperation(), parallelTileSizes,
@@ -1539,9 +1658,100 @@ static LogicalResult setTranslationInfoAndRootConfig(
   return setRootConfig(entryPointFn, computeOps);
 }
 
+/// Sets the compilation info recorded for |fingerprint| in the tuning database
+/// on the root operation of |computeOps|. Compilation info specified by the
+/// user takes precedence.
+static LogicalResult applyTuningRecord(func::FuncOp entryPointFn,
+                                       ArrayRef<Operation *> computeOps,
+                                       StringRef fingerprint) {
+  for (auto computeOp : computeOps) {
+    if (getCompilationInfo(computeOp)) return success();
+  }
+  FailureOr<IREE::Codegen::CompilationInfoAttr> compilationInfo =
+      lookupTuningRecord(clTuningDatabase, fingerprint, entryPointFn);
+  if (failed(compilationInfo)) return failure();
+  if (!compilationInfo.value()) return success();
+  FailureOr<Operation *> rootOp = getRootOperation(computeOps);
+  if (failed(rootOp) || !rootOp.value()) return success();
+  setCompilationInfo(rootOp.value(), compilationInfo.value());
+  return success();
+}
+
+/// Records the configuration chosen for the root operation of |computeOps| so
+/// that it can be used as the starting point for tuning.
+static LogicalResult dumpTuningRecord(IREE::HAL::ExecutableVariantOp variantOp,
+                                      IREE::HAL::ExecutableExportOp exportOp,
+                                      ArrayRef<Operation *> computeOps,
+                                      StringRef fingerprint) {
+  FailureOr<Operation *> rootOp = getRootOperation(computeOps);
+  if (failed(rootOp) || !rootOp.value()) return success();
+  IREE::Codegen::LoweringConfigAttr loweringConfig =
+      getLoweringConfig(rootOp.value());
+  IREE::Codegen::TranslationInfoAttr translationInfo =
+      getTranslationInfo(exportOp);
+  if (!loweringConfig || !translationInfo) return success();
+
+  TuningRecord record;
+  record.fingerprint = fingerprint.str();
+  record.executableName =
+      variantOp->getParentOfType<IREE::HAL::ExecutableOp>().getName().str();
+  record.variantName = variantOp.getName().str();
+  record.exportName = exportOp.getName().str();
+  record.compilationInfo = IREE::Codegen::CompilationInfoAttr::get(
+      exportOp.getContext(), loweringConfig, translationInfo,
+      getWorkgroupSize(exportOp));
+  return appendTuningRecord(clDumpTuningRecords, record, exportOp);
+}
+
+/// Prints |path| and a hash of its contents to |os|. Returns failure if the file
+/// cannot be read.
+static LogicalResult printFileForCacheKey(StringRef path, raw_ostream &os) {
+  auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (!buffer) return failure();
+  os << path << "@"
+     << llvm::toHex(llvm::SHA1::hash(
+            llvm::arrayRefFromStringRef((*buffer)->getBuffer())));
+  return success();
+}
+
+Optional<std::string> getCPULaunchConfigCacheKey() {
+  // Tuning records are appended as a side effect of choosing configurations.
+  if (!clDumpTuningRecords.empty()) return llvm::None;
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << "vector-size=" << clNativeVectorSizeInBytes
+     << " threads=" << clNumberOfRuntimeThreads << " mmt4d-workgroup-tiles=";
+  llvm::interleaveComma(mmt4dWorkgroupTileSizes, os);
+  os << " mmt4d-l1-tiles=";
+  llvm::interleaveComma(mmt4dL1TileSizes, os);
+  os << " mmt4d-vector-sizes=";
+  llvm::interleaveComma(mmt4dVectorSizes, os);
+  os << " generic-workgroup-tile=" << defaultWorkgroupTileSize
+     << " vector-padding=" << enableVectorPadding
+     << " vector-peeling=" << enableVectorPeeling
+     << " triple-tiling=" << enableTripleTilingPipeline
+     << " microkernels=" << clEnableLLVMCPUMicrokernels;
+  // Files are only read when the options are set and may change between
+  // compilations so their contents are part of the key.
+  if (!clCPUCodegenTransformDialectFileName.empty()) {
+    os << " transform-dialect=";
+    if (failed(printFileForCacheKey(clCPUCodegenTransformDialectFileName, os))) {
+      return llvm::None;
+    }
+  }
+  if (!clTuningDatabase.empty()) {
+    os << " tuning-database=";
+    if (failed(printFileForCacheKey(clTuningDatabase, os))) return llvm::None;
+  }
+  return os.str();
+}
+
 LogicalResult initCPULaunchConfig(ModuleOp moduleOp) {
   llvm::StringMap<IREE::HAL::ExecutableExportOp> exportOps =
       getAllEntryPoints(moduleOp);
+  auto variantOp = moduleOp->getParentOfType<IREE::HAL::ExecutableVariantOp>();
+  bool useTuningDatabase =
+      variantOp && (!clTuningDatabase.empty() || !clDumpTuningRecords.empty());
   for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
     auto exportOp = exportOps.lookup(funcOp.getName());
     if (!exportOp) continue;
@@ -1564,9 +1774,26 @@ LogicalResult initCPULaunchConfig(ModuleOp moduleOp) {
       return failure();
     }
 
+    // The fingerprint is taken before any configuration is attached.
+    std::string fingerprint;
+    if (useTuningDatabase) {
+      fingerprint =
+          IREE::HAL::getDispatchFingerprint(variantOp, exportOp, funcOp);
+    }
+    if (useTuningDatabase && !clTuningDatabase.empty() &&
+        failed(applyTuningRecord(funcOp, computeOps, fingerprint))) {
+      return failure();
+    }
+
     if (failed(setTranslationInfoAndRootConfig(funcOp, computeOps))) {
       return failure();
     }
+
+    if (useTuningDatabase && !clDumpTuningRecords.empty() &&
+        failed(dumpTuningRecord(variantOp, exportOp, computeOps,
+                                fingerprint))) {
+      return failure();
+    }
   }
 
   // The root confguration setting introduces `tensor.dim` operations. Resolve
@@ -53,6 +53,10 @@ enum class TripleTilingLevel : unsigned {
 
 LogicalResult initCPULaunchConfig(ModuleOp moduleOp);
 
+// Returns a string covering the options used by initCPULaunchConfig or None if
+// the launch configuration cannot be cached (see getLLVMCPUCodegenCacheKey).
+Optional<std::string> getCPULaunchConfigCacheKey();
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
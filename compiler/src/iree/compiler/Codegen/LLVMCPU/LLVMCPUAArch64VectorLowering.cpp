@@ -17,18 +17,18 @@
 
 #define DEBUG_TYPE "iree-llvmcpu-aarch64-vector-lowering"
 
+namespace mlir {
+namespace iree_compiler {
+
 // A flag to switch between inline asm and intrinsics while we develop these two
-// parallel paths.
-static llvm::cl::opt<bool> clMmt4dUseIntrinsics(
+// parallel paths. Also used in Passes.cpp for executable cache keys.
+llvm::cl::opt<bool> clMmt4dUseIntrinsics(
     "iree-codegen-mmt4d-use-intrinsics",
     llvm::cl::desc("Whether to use instrinsics when lowering vector contracts "
                    "generated from mmt4d matmuls (as opposed to inline asm). "
                    "Not for production use."),
     llvm::cl::init(false));
 
-namespace mlir {
-namespace iree_compiler {
-
 namespace {
 struct LLVMCPUAArch64VectorLoweringPass
     : public LLVMCPUAArch64VectorLoweringBase<
@@ -0,0 +1,158 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/ADT/DenseSet.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+namespace {
+
+// Hints are stored as a 64-bit mask indexed by binding ordinal.
+static constexpr int64_t kMaxHintedBindings = 64;
+
+// Returns a bitmask of the hal.interface.workgroup.id dimensions that |values|
+// are derived from. Loop induction variables are treated as derived from the
+// loop bounds and step so that the distributed loops created by
+// tile-and-distribute are followed back to the workgroup IDs.
+static unsigned getWorkgroupIDDims(ValueRange values) {
+  unsigned dims = 0;
+  SmallVector<Value> worklist(values.begin(), values.end());
+  llvm::DenseSet<Value> visited;
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    if (!visited.insert(value).second) continue;
+    if (auto blockArg = value.dyn_cast<BlockArgument>()) {
+      auto forOp = dyn_cast<scf::ForOp>(blockArg.getOwner()->getParentOp());
+      if (forOp && forOp.getInductionVar() == blockArg) {
+        worklist.push_back(forOp.getLowerBound());
+        worklist.push_back(forOp.getUpperBound());
+        worklist.push_back(forOp.getStep());
+      }
+      continue;
+    }
+    Operation *op = value.getDefiningOp();
+    if (auto idOp = dyn_cast<IREE::HAL::InterfaceWorkgroupIDOp>(op)) {
+      dims |= 1u << idOp.getDimension().getZExtValue();
+      continue;
+    }
+    worklist.append(op->operand_begin(), op->operand_end());
+  }
+  return dims;
+}
+
+// Binding access hints accumulated across all subspans of a function.
+struct BindingAccessHints {
+  uint64_t streamedBindings = 0;
+  uint64_t reusedBindings = 0;
+  // Bindings with any access that contradicts the hint bits above.
+  uint64_t notStreamedBindings = 0;
+  uint64_t notReusedBindings = 0;
+};
+
+// Classifies the accesses of |subspanOp| into |hints|. Bindings are streamed
+// if every access is offset by all workgroup ID dimensions used by the
+// function and reused if they are only read at offsets independent of the
+// workgroup ID.
+static void classifyBindingAccess(
+    IREE::HAL::InterfaceBindingSubspanOp subspanOp, unsigned usedDims,
+    BindingAccessHints &hints) {
+  int64_t binding = subspanOp.getBinding().getSExtValue();
+  if (binding >= kMaxHintedBindings) return;
+  uint64_t bindingBit = 1ull << binding;
+
+  bool isStreamed = usedDims != 0;
+  bool isReused = true;
+  bool hasAccesses = false;
+  for (Operation *user : subspanOp->getUsers()) {
+    unsigned dims = 0;
+    if (auto loadOp = dyn_cast<IREE::Flow::DispatchTensorLoadOp>(user)) {
+      dims = getWorkgroupIDDims(loadOp.getOffsets());
+    } else if (auto storeOp = dyn_cast<IREE::Flow::DispatchTensorStoreOp>(
+                   user)) {
+      dims = getWorkgroupIDDims(storeOp.getOffsets());
+      isReused = false;
+    } else {
+      // Unknown access (such as a memref subspan); leave as unknown.
+      isStreamed = false;
+      isReused = false;
+      break;
+    }
+    hasAccesses = true;
+    if (dims != usedDims) isStreamed = false;
+    if (dims != 0) isReused = false;
+  }
+  if (!hasAccesses) return;
+
+  if (isStreamed) {
+    hints.streamedBindings |= bindingBit;
+  } else {
+    hints.notStreamedBindings |= bindingBit;
+  }
+  if (isReused) {
+    hints.reusedBindings |= bindingBit;
+  } else {
+    hints.notReusedBindings |= bindingBit;
+  }
+}
+
+struct LLVMCPUAnnotateBindingAccessPass
+    : LLVMCPUAnnotateBindingAccessBase<LLVMCPUAnnotateBindingAccessPass> {
+  void runOnOperation() override {
+    IREE::HAL::ExecutableVariantOp variantOp = getOperation();
+    ModuleOp moduleOp = variantOp.getInnerModule();
+    llvm::StringMap<IREE::HAL::ExecutableExportOp> exportOps =
+        getAllEntryPoints(moduleOp);
+    Builder builder(&getContext());
+    for (auto funcOp : moduleOp.getOps<func::FuncOp>()) {
+      auto exportOp = exportOps.lookup(funcOp.getName());
+      if (!exportOp) continue;
+
+      unsigned usedDims = 0;
+      funcOp.walk([&](IREE::HAL::InterfaceWorkgroupIDOp idOp) {
+        usedDims |= 1u << idOp.getDimension().getZExtValue();
+      });
+
+      BindingAccessHints hints;
+      funcOp.walk([&](IREE::HAL::InterfaceBindingSubspanOp subspanOp) {
+        classifyBindingAccess(subspanOp, usedDims, hints);
+      });
+
+      // A binding accessed through multiple subspans only keeps a hint if all
+      // of its subspans agree.
+      uint64_t streamedBindings =
+          hints.streamedBindings & ~hints.notStreamedBindings;
+      uint64_t reusedBindings = hints.reusedBindings & ~hints.notReusedBindings;
+      if (streamedBindings) {
+        exportOp->setAttr("iree_codegen.streamed_bindings",
+                          builder.getI64IntegerAttr(streamedBindings));
+      }
+      if (reusedBindings) {
+        exportOp->setAttr("iree_codegen.reused_bindings",
+                          builder.getI64IntegerAttr(reusedBindings));
+      }
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
+createLLVMCPUAnnotateBindingAccessPass() {
+  return std::make_unique<LLVMCPUAnnotateBindingAccessPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
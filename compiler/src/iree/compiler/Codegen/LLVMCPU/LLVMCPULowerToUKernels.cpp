@@ -0,0 +1,151 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/flags.h"
+#include "iree/compiler/Codegen/PassDetail.h"
+#include "iree/compiler/Codegen/Passes.h"
+#include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/MemRef/IR/MemRef.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Returns the name of the runtime/src/iree/builtins/ukernel/ entry point
+// implementing |mmt4dOp| or an empty string if there is none for its element
+// types.
+static StringRef getMmt4dUKernelName(linalg::Mmt4DOp mmt4dOp) {
+  auto getElementType = [](Value value) {
+    return value.getType().cast<MemRefType>().getElementType();
+  };
+  Type lhsType = getElementType(mmt4dOp.getInputs()[0]);
+  Type rhsType = getElementType(mmt4dOp.getInputs()[1]);
+  Type outType = getElementType(mmt4dOp.getOutputs()[0]);
+  if (lhsType.isF32() && rhsType.isF32() && outType.isF32()) {
+    return "iree_ukernel_mmt4d_f32f32f32_memref";
+  }
+  if (lhsType.isSignlessInteger(8) && rhsType.isSignlessInteger(8) &&
+      outType.isSignlessInteger(32)) {
+    return "iree_ukernel_mmt4d_i8i8i32_memref";
+  }
+  return "";
+}
+
+// Returns true if the tiles in the inner two dimensions of |buffer| are static
+// and are laid out contiguously one after another along the second dimension
+// as the microkernels expect. The outer-most dimension may have any stride.
+static bool hasContiguousInnerTiles(Value buffer) {
+  auto type = buffer.getType().dyn_cast<MemRefType>();
+  if (!type || type.getRank() != 4) return false;
+  ArrayRef<int64_t> shape = type.getShape();
+  if (ShapedType::isDynamic(shape[2]) || ShapedType::isDynamic(shape[3])) {
+    return false;
+  }
+  SmallVector<int64_t> strides;
+  int64_t offset;
+  if (failed(getStridesAndOffset(type, strides, offset))) return false;
+  return strides[3] == 1 && strides[2] == shape[3] &&
+         strides[1] == shape[2] * shape[3];
+}
+
+// Returns the microkernel function |name| with |argTypes|, inserting a private
+// declaration into |moduleOp| if it does not yet exist. The microkernel
+// implementation is linked in from bitcode by the LLVMCPU target backend.
+static func::FuncOp getOrInsertUKernelDecl(ModuleOp moduleOp, StringRef name,
+                                           TypeRange argTypes, Location loc) {
+  if (auto funcOp = moduleOp.lookupSymbol<func::FuncOp>(name)) return funcOp;
+  auto builder = OpBuilder::atBlockBegin(moduleOp.getBody());
+  auto funcOp = builder.create<func::FuncOp>(
+      loc, name,
+      builder.getFunctionType(argTypes, {builder.getIntegerType(32)}));
+  funcOp.setPrivate();
+  return funcOp;
+}
+
+// Replaces |mmt4dOp| with a call to the matching microkernel. Buffers are
+// passed as their base allocation followed by the offset and outer-most stride
+// of the accessed view (see iree_ukernel_mmt4d_*_memref in
+// runtime/src/iree/builtins/ukernel/mmt4d.h).
+static LogicalResult lowerMmt4dToUKernel(ModuleOp moduleOp,
+                                         linalg::Mmt4DOp mmt4dOp) {
+  StringRef ukernelName = getMmt4dUKernelName(mmt4dOp);
+  if (ukernelName.empty()) return failure();
+  Value lhs = mmt4dOp.getInputs()[0];
+  Value rhs = mmt4dOp.getInputs()[1];
+  Value out = mmt4dOp.getOutputs()[0];
+  if (!hasContiguousInnerTiles(lhs) || !hasContiguousInnerTiles(rhs) ||
+      !hasContiguousInnerTiles(out)) {
+    return failure();
+  }
+
+  Location loc = mmt4dOp.getLoc();
+  OpBuilder builder(mmt4dOp);
+  SmallVector<Value> operands;
+  for (Value buffer : {lhs, rhs, out}) {
+    auto metadataOp =
+        builder.create<memref::ExtractStridedMetadataOp>(loc, buffer);
+    operands.push_back(metadataOp.getBaseBuffer());
+    operands.push_back(metadataOp.getOffset());
+    operands.push_back(metadataOp.getStrides()[0]);
+  }
+  // M, N, K.
+  operands.push_back(builder.create<memref::DimOp>(loc, lhs, 0));
+  operands.push_back(builder.create<memref::DimOp>(loc, rhs, 0));
+  operands.push_back(builder.create<memref::DimOp>(loc, lhs, 1));
+  // M0, N0, K0.
+  auto lhsShape = lhs.getType().cast<MemRefType>().getShape();
+  auto rhsShape = rhs.getType().cast<MemRefType>().getShape();
+  for (int64_t size : {lhsShape[2], rhsShape[2], lhsShape[3]}) {
+    operands.push_back(builder.create<arith::ConstantIntOp>(loc, size, 32));
+  }
+  // linalg.mmt4d always accumulates into its output.
+  operands.push_back(builder.create<arith::ConstantIntOp>(
+      loc, IREE_UKERNEL_FLAG_ACCUMULATE, 32));
+
+  auto funcOp = getOrInsertUKernelDecl(
+      moduleOp, ukernelName, ValueRange(operands).getTypes(), loc);
+  // Non-zero return codes are returned from the entry point after conversion
+  // to LLVM (see ConvertToLLVM.cpp) and fail the dispatch.
+  builder.create<func::CallOp>(loc, funcOp, operands);
+  mmt4dOp.erase();
+  return success();
+}
+
+namespace {
+
+struct LLVMCPULowerToUKernelsPass
+    : LLVMCPULowerToUKernelsBase<LLVMCPULowerToUKernelsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithmeticDialect, func::FuncDialect,
+                    memref::MemRefDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SmallVector<linalg::Mmt4DOp> mmt4dOps;
+    moduleOp.walk([&](linalg::Mmt4DOp op) {
+      if (op.hasBufferSemantics()) mmt4dOps.push_back(op);
+    });
+    // Ops that cannot be lowered fall back to the regular loop lowering.
+    for (auto mmt4dOp : mmt4dOps) {
+      (void)lowerMmt4dToUKernel(moduleOp, mmt4dOp);
+    }
+  }
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<ModuleOp>> createLLVMCPULowerToUKernelsPass() {
+  return std::make_unique<LLVMCPULowerToUKernelsPass>();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
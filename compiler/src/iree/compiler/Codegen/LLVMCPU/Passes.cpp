@@ -52,12 +52,22 @@ static llvm::cl::opt<bool> clEnableMicrokernels(
     llvm::cl::desc("Enables microkernel lowering for vmvx (experimental)"),
     llvm::cl::init(false));
 
+// Lowers linalg.mmt4d ops to calls to the ukernel library.
+// Defined externally in KernelDispatch.cpp as it changes the lowering
+// configuration of linalg.mmt4d ops.
+extern llvm::cl::opt<bool> clEnableLLVMCPUMicrokernels;
+
 // MLIR file containing a top-level module that specifies the transformations to
 // apply to form dispatch regions.
 // Defined externally in KernelDispatch.cpp to control the codegen pass
 // pipeline.
 extern llvm::cl::opt<std::string> clCPUCodegenTransformDialectFileName;
 
+// Whether to use intrinsics when lowering mmt4d vector contracts on aarch64.
+// Defined externally in LLVMCPUAArch64VectorLowering.cpp and only used here
+// for executable cache keys.
+extern llvm::cl::opt<bool> clMmt4dUseIntrinsics;
+
 //===---------------------------------------------------------------------===//
 // Default Linalg code generation options for CPU backend
 //===---------------------------------------------------------------------===//
@@ -112,6 +122,7 @@ static void addTileAndDistributePasses(OpPassManager &pm) {
       createFoldAffineMinInDistributedLoopsPass());
   nestedModulePM.addPass(createCanonicalizerPass());
   nestedModulePM.addPass(createCSEPass());
+  pm.addPass(createLLVMCPUAnnotateBindingAccessPass());
 }
 
 //===---------------------------------------------------------------------===//
@@ -595,6 +606,9 @@ static void addLowerToLLVMPasses(OpPassManager &passManager) {
     passManager.addNestedPass<func::FuncOp>(
         createLLVMCPUEmitVectorizationRemarksPass());
   }
+  if (clEnableLLVMCPUMicrokernels) {
+    passManager.addPass(createLLVMCPULowerToUKernelsPass());
+  }
   passManager.addNestedPass<func::FuncOp>(createConvertLinalgToLoopsPass());
   passManager.addNestedPass<func::FuncOp>(createCanonicalizerPass());
   passManager.addNestedPass<func::FuncOp>(createCSEPass());
@@ -651,5 +665,15 @@ void buildLLVMCPUCodegenPassPipeline(OpPassManager &passManager) {
   });
 }
 
+Optional<std::string> getLLVMCPUCodegenCacheKey() {
+  Optional<std::string> launchConfigKey = getCPULaunchConfigCacheKey();
+  if (!launchConfigKey) return llvm::None;
+  std::string key;
+  llvm::raw_string_ostream os(key);
+  os << *launchConfigKey << " hoist-padding=" << clEnableHoistPadding
+     << " mmt4d-intrinsics=" << clMmt4dUseIntrinsics;
+  return os.str();
+}
+
 }  // namespace iree_compiler
 }  // namespace mlir
@@ -20,18 +20,58 @@ struct RISCVTargetMLTransformInfo : TargetMLTransformInfo {
   }
 };
 
-}  // namespace
+struct X86TargetMLTransformInfo : TargetMLTransformInfo {
+  X86TargetMLTransformInfo() {
+    l1CacheSizeInBytes = 32 * 1024;
+    l2CacheSizeInBytes = 1024 * 1024;
+    l3CacheSizeInBytes = 8 * 1024 * 1024;
+  }
+};
 
-namespace mlir {
-namespace iree_compiler {
+struct AArch64TargetMLTransformInfo : TargetMLTransformInfo {
+  AArch64TargetMLTransformInfo() {
+    l1CacheSizeInBytes = 64 * 1024;
+    l2CacheSizeInBytes = 512 * 1024;
+  }
+};
 
-const TargetMLTransformInfo TargetMLTransformInfo::getTargetMLTransformInfo(
+/// Returns the info with the per-architecture defaults for |variantOp|.
+TargetMLTransformInfo getDefaultTargetMLTransformInfo(
     IREE::HAL::ExecutableVariantOp variantOp) {
   if (isRISCV(variantOp)) {
     return RISCVTargetMLTransformInfo();
   }
+  if (isX86(variantOp)) {
+    return X86TargetMLTransformInfo();
+  }
+  if (isAArch64(variantOp)) {
+    return AArch64TargetMLTransformInfo();
+  }
 
   return TargetMLTransformInfo();
+}
+
+}  // namespace
+
+namespace mlir {
+namespace iree_compiler {
+
+const TargetMLTransformInfo TargetMLTransformInfo::getTargetMLTransformInfo(
+    IREE::HAL::ExecutableVariantOp variantOp) {
+  TargetMLTransformInfo info = getDefaultTargetMLTransformInfo(variantOp);
+
+  // Allow tuning for a specific CPU through the target configuration.
+  IREE::HAL::ExecutableTargetAttr targetAttr = variantOp.getTarget();
+  DictionaryAttr config = targetAttr ? targetAttr.getConfiguration() : nullptr;
+  if (!config) return info;
+  auto overrideFromConfig = [&](StringRef name, int64_t &value) {
+    if (auto attr = config.getAs<IntegerAttr>(name)) value = attr.getInt();
+  };
+  overrideFromConfig("l1_cache_size", info.l1CacheSizeInBytes);
+  overrideFromConfig("l2_cache_size", info.l2CacheSizeInBytes);
+  overrideFromConfig("l3_cache_size", info.l3CacheSizeInBytes);
+  overrideFromConfig("num_threads", info.numThreads);
+  return info;
 };
 
 }  // namespace iree_compiler
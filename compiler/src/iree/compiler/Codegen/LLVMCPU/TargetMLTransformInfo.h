@@ -21,6 +21,19 @@ struct TargetMLTransformInfo {
   unsigned defaultMaxTransposeUnrollFactor =
       std::numeric_limits<unsigned>::max();
 
+  // Cache hierarchy used by the tile size cost model. L1 and L2 are per core
+  // and L3 is shared by all threads. Zero means the size is unknown and the
+  // corresponding constraint is skipped.
+  int64_t l1CacheSizeInBytes = 32 * 1024;
+  int64_t l2CacheSizeInBytes = 512 * 1024;
+  int64_t l3CacheSizeInBytes = 0;
+
+  // Number of threads that execute workgroups concurrently. Zero means unknown.
+  int64_t numThreads = 0;
+
+  // Returns the info for the target of |variantOp|. Per-architecture defaults
+  // can be overridden with the `l1_cache_size`, `l2_cache_size`,
+  // `l3_cache_size` (in bytes) and `num_threads` target configuration entries.
   static const TargetMLTransformInfo getTargetMLTransformInfo(
       IREE::HAL::ExecutableVariantOp variantOp);
 };
@@ -0,0 +1,129 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/LLVMCPU/TuningDatabase.h"
+
+#include <mutex>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/AsmParser/AsmParser.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+// Serializes access to the database files and the cache of parsed databases.
+// Executables may be translated concurrently.
+static std::mutex &getTuningDatabaseMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Maps fingerprints to the textual compilation info. Attributes are kept as
+// text as they are uniqued in the context they are parsed in and databases are
+// shared across contexts.
+using TuningDatabase = llvm::StringMap<std::string>;
+
+// Parses the JSON lines database in |buffer| into |database|.
+static LogicalResult parseTuningDatabase(StringRef buffer,
+                                         TuningDatabase &database,
+                                         std::string &error) {
+  SmallVector<StringRef> lines;
+  buffer.split(lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (auto it : llvm::enumerate(lines)) {
+    StringRef line = it.value().trim();
+    if (line.empty()) continue;
+    auto lineError = [&](const Twine &message) {
+      error = ("line " + Twine(it.index() + 1) + ": " + message).str();
+      return failure();
+    };
+    llvm::Expected<llvm::json::Value> value = llvm::json::parse(line);
+    if (!value) return lineError(llvm::toString(value.takeError()));
+    const llvm::json::Object *object = value->getAsObject();
+    if (!object) return lineError("expected a JSON object");
+    llvm::Optional<StringRef> fingerprint = object->getString("fingerprint");
+    llvm::Optional<StringRef> compilationInfo =
+        object->getString("compilation_info");
+    if (!fingerprint || !compilationInfo) {
+      return lineError("expected `fingerprint` and `compilation_info` strings");
+    }
+    database[*fingerprint] = compilationInfo->str();
+  }
+  return success();
+}
+
+FailureOr<IREE::Codegen::CompilationInfoAttr> lookupTuningRecord(
+    StringRef path, StringRef fingerprint, Operation *errorOp) {
+  std::string compilationInfoStr;
+  {
+    std::lock_guard<std::mutex> lock(getTuningDatabaseMutex());
+    static llvm::StringMap<TuningDatabase> databases;
+    auto databaseIt = databases.find(path);
+    if (databaseIt == databases.end()) {
+      auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+      if (!buffer) {
+        errorOp->emitError() << "failed to open tuning database " << path
+                             << ": " << buffer.getError().message();
+        return failure();
+      }
+      TuningDatabase database;
+      std::string error;
+      if (failed(parseTuningDatabase((*buffer)->getBuffer(), database,
+                                     error))) {
+        errorOp->emitError() << "failed to parse tuning database " << path
+                             << ": " << error;
+        return failure();
+      }
+      databaseIt = databases.try_emplace(path, std::move(database)).first;
+    }
+    auto recordIt = databaseIt->second.find(fingerprint);
+    if (recordIt == databaseIt->second.end()) {
+      return IREE::Codegen::CompilationInfoAttr{};
+    }
+    compilationInfoStr = recordIt->second;
+  }
+
+  auto compilationInfo =
+      parseAttribute(compilationInfoStr, errorOp->getContext())
+          .dyn_cast_or_null<IREE::Codegen::CompilationInfoAttr>();
+  if (!compilationInfo) {
+    errorOp->emitError() << "invalid compilation info for " << fingerprint
+                         << " in tuning database " << path << ": "
+                         << compilationInfoStr;
+    return failure();
+  }
+  return compilationInfo;
+}
+
+LogicalResult appendTuningRecord(StringRef path, const TuningRecord &record,
+                                 Operation *errorOp) {
+  std::string compilationInfoStr;
+  llvm::raw_string_ostream(compilationInfoStr) << record.compilationInfo;
+  llvm::json::Object object{
+      {"fingerprint", record.fingerprint},
+      {"compilation_info", compilationInfoStr},
+      {"executable", record.executableName},
+      {"variant", record.variantName},
+      {"export", record.exportName},
+  };
+
+  std::lock_guard<std::mutex> lock(getTuningDatabaseMutex());
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec, llvm::sys::fs::OF_Append);
+  if (ec) {
+    return errorOp->emitError()
+           << "failed to open tuning database " << path << ": "
+           << ec.message();
+  }
+  os << llvm::json::Value(std::move(object)) << "\n";
+  return success();
+}
+
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,55 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
+#define IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
+
+#include <string>
+
+#include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
+#include "mlir/IR/Operation.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace iree_compiler {
+
+/// A tuning database holds the compilation info to use for dispatches keyed by
+/// their fingerprint (see IREE::HAL::getDispatchFingerprint). Databases are
+/// JSON lines files with one object per line:
+///
+///   {"fingerprint": "<hex>",
+///    "compilation_info": "#iree_codegen.compilation_info<...>",
+///    "executable": "...", "variant": "...", "export": "...",
+///    "time_ns": 123.4}
+///
+/// Only `fingerprint` and `compilation_info` are used by the compiler; the
+/// remaining fields help humans and tools (such as
+/// build_tools/benchmarks/tune_cpu_dispatches.py) to map entries back to
+/// benchmarks. When a fingerprint appears multiple times the last line wins so
+/// records can be appended to an existing database.
+struct TuningRecord {
+  std::string fingerprint;
+  std::string executableName;
+  std::string variantName;
+  std::string exportName;
+  IREE::Codegen::CompilationInfoAttr compilationInfo;
+};
+
+/// Returns the compilation info recorded for |fingerprint| in the database at
+/// |path| or nullptr if the dispatch has not been tuned. Databases are only
+/// read once per process. Errors are reported on |errorOp|.
+FailureOr<IREE::Codegen::CompilationInfoAttr> lookupTuningRecord(
+    StringRef path, StringRef fingerprint, Operation *errorOp);
+
+/// Appends |record| to the database at |path|, creating it if needed. May be
+/// called from multiple threads. Errors are reported on |errorOp|.
+LogicalResult appendTuningRecord(StringRef path, const TuningRecord &record,
+                                 Operation *errorOp);
+
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_CODEGEN_LLVMCPU_TUNINGDATABASE_H_
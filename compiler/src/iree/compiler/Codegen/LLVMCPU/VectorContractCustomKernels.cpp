@@ -766,6 +766,7 @@ class MMTKernelGenerator {
     switch (kernel.arch) {
       case CustomKernelTargetArch::Aarch64:
         return "w";
+      case CustomKernelTargetArch::X86_64:
       case CustomKernelTargetArch::None:
         break;
     }
@@ -0,0 +1,91 @@
+// RUN: iree-opt --pass-pipeline='hal.executable(hal.executable.variant(iree-llvmcpu-annotate-binding-access))' --split-input-file %s | FileCheck %s
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+  native_vector_size = 16 : index,
+  target_triple = "x86_64-unknown-unknown-eabi-elf"}>
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>]
+  >]>
+#map = affine_map<()[s0] -> (s0 * 64)>
+hal.executable private @add_bias {
+  hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+    hal.executable.export public @add_bias ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @add_bias() {
+        %c1024 = arith.constant 1024 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:1024xf32>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:64xf32>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<writeonly:1024xf32>
+        %workgroup_id_x = hal.interface.workgroup.id[0] : index
+        %workgroup_count_x = hal.interface.workgroup.count[0] : index
+        %3 = affine.apply #map()[%workgroup_id_x]
+        %4 = affine.apply #map()[%workgroup_count_x]
+        %bias = flow.dispatch.tensor.load %1, offsets = [0], sizes = [64], strides = [1] : !flow.dispatch.tensor<readonly:64xf32> -> tensor<64xf32>
+        scf.for %arg0 = %3 to %c1024 step %4 {
+          %5 = flow.dispatch.tensor.load %0, offsets = [%arg0], sizes = [64], strides = [1] : !flow.dispatch.tensor<readonly:1024xf32> -> tensor<64xf32>
+          %6 = arith.addf %5, %bias : tensor<64xf32>
+          flow.dispatch.tensor.store %6, %2, offsets = [%arg0], sizes = [64], strides = [1] : tensor<64xf32> -> !flow.dispatch.tensor<writeonly:1024xf32>
+        }
+        return
+      }
+    }
+  }
+}
+// Bindings 0 and 2 are streamed and the bias in binding 1 is reused.
+//      CHECK: hal.executable.export public @add_bias
+// CHECK-SAME:   iree_codegen.reused_bindings = 2 : i64
+// CHECK-SAME:   iree_codegen.streamed_bindings = 5 : i64
+
+// -----
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128",
+  native_vector_size = 16 : index,
+  target_triple = "x86_64-unknown-unknown-eabi-elf"}>
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>]
+  >]>
+#map = affine_map<()[s0] -> (s0 * 64)>
+hal.executable private @matmul {
+  hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+    hal.executable.export public @matmul ordinal(0) layout(#pipeline_layout)
+    builtin.module {
+      func.func @matmul() {
+        %c512 = arith.constant 512 : index
+        %0 = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) : !flow.dispatch.tensor<readonly:512x256xf32>
+        %1 = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) : !flow.dispatch.tensor<readonly:256x512xf32>
+        %2 = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) : !flow.dispatch.tensor<readwrite:512x512xf32>
+        %workgroup_id_x = hal.interface.workgroup.id[0] : index
+        %workgroup_count_x = hal.interface.workgroup.count[0] : index
+        %workgroup_id_y = hal.interface.workgroup.id[1] : index
+        %workgroup_count_y = hal.interface.workgroup.count[1] : index
+        %3 = affine.apply #map()[%workgroup_id_y]
+        %4 = affine.apply #map()[%workgroup_count_y]
+        scf.for %arg0 = %3 to %c512 step %4 {
+          %5 = affine.apply #map()[%workgroup_id_x]
+          %6 = affine.apply #map()[%workgroup_count_x]
+          scf.for %arg1 = %5 to %c512 step %6 {
+            %7 = flow.dispatch.tensor.load %0, offsets = [%arg0, 0], sizes = [64, 256], strides = [1, 1] : !flow.dispatch.tensor<readonly:512x256xf32> -> tensor<64x256xf32>
+            %8 = flow.dispatch.tensor.load %1, offsets = [0, %arg1], sizes = [256, 64], strides = [1, 1] : !flow.dispatch.tensor<readonly:256x512xf32> -> tensor<256x64xf32>
+            %9 = flow.dispatch.tensor.load %2, offsets = [%arg0, %arg1], sizes = [64, 64], strides = [1, 1] : !flow.dispatch.tensor<readwrite:512x512xf32> -> tensor<64x64xf32>
+            %10 = linalg.matmul ins(%7, %8 : tensor<64x256xf32>, tensor<256x64xf32>) outs(%9 : tensor<64x64xf32>) -> tensor<64x64xf32>
+            flow.dispatch.tensor.store %10, %2, offsets = [%arg0, %arg1], sizes = [64, 64], strides = [1, 1] : tensor<64x64xf32> -> !flow.dispatch.tensor<readwrite:512x512xf32>
+          }
+        }
+        return
+      }
+    }
+  }
+}
+// Only the output tile is distinct per workgroup: each LHS row block and RHS
+// column block is shared by a row or column of workgroups.
+//      CHECK: hal.executable.export public @matmul
+//  CHECK-NOT:   iree_codegen.reused_bindings
+// CHECK-SAME:   iree_codegen.streamed_bindings = 4 : i64
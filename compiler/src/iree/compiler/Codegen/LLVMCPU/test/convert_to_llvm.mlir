@@ -1,4 +1,4 @@
-// RUN: iree-opt -iree-convert-to-llvm %s | FileCheck %s
+// RUN: iree-opt -iree-convert-to-llvm --split-input-file %s | FileCheck %s
 
 builtin.module {
   func.func private @extern_public()
@@ -13,3 +13,25 @@ builtin.module {
 // CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]:  !llvm.ptr<struct<"iree_hal_executable_workgroup_state_v0_t", opaque>> {llvm.align = 16 : i64, llvm.noalias}) -> i32
 //      CHECK:     llvm.return %{{.+}} : i32
 
+
+// -----
+
+// Non-zero microkernel return codes are returned from the entry point.
+
+builtin.module {
+  func.func private @iree_ukernel_mmt4d_f32f32f32(i32) -> i32
+  func.func @ukernel_entry_point() {
+    %flags = arith.constant 1 : i32
+    %0 = func.call @iree_ukernel_mmt4d_f32f32f32(%flags) : (i32) -> i32
+    return
+  }
+}
+//      CHECK: llvm.func internal @ukernel_entry_point(
+//      CHECK:   %[[STATUS:.+]] = llvm.call @iree_ukernel_mmt4d_f32f32f32(%{{.+}}) : (i32) -> i32
+//  CHECK-DAG:   %[[ZERO:.+]] = llvm.mlir.constant(0 : i32) : i32
+//      CHECK:   %[[FAILED:.+]] = llvm.icmp "ne" %[[STATUS]], %[[ZERO]] : i32
+//      CHECK:   llvm.cond_br %[[FAILED]], ^[[ERROR:.+]](%[[STATUS]] : i32), ^[[CONTINUE:[a-z0-9]+]]
+//      CHECK: ^[[CONTINUE]]:
+//      CHECK:   llvm.return %{{.+}} : i32
+//      CHECK: ^[[ERROR]](%[[ERROR_STATUS:.+]]: i32):
+//      CHECK:   llvm.return %[[ERROR_STATUS]] : i32
@@ -0,0 +1,58 @@
+// RUN: iree-opt --split-input-file --iree-llvmcpu-lower-to-ukernels --cse %s | FileCheck %s
+
+func.func @mmt4d_f32f32f32(%lhs: memref<?x?x4x1xf32, strided<[?, 4, 1, 1], offset: ?>>,
+                           %rhs: memref<?x?x4x1xf32, strided<[?, 4, 1, 1], offset: ?>>,
+                           %out: memref<?x?x4x4xf32, strided<[?, 16, 4, 1], offset: ?>>) {
+  linalg.mmt4d ins(%lhs, %rhs : memref<?x?x4x1xf32, strided<[?, 4, 1, 1], offset: ?>>, memref<?x?x4x1xf32, strided<[?, 4, 1, 1], offset: ?>>)
+               outs(%out : memref<?x?x4x4xf32, strided<[?, 16, 4, 1], offset: ?>>)
+  return
+}
+//      CHECK: func.func private @iree_ukernel_mmt4d_f32f32f32_memref(
+// CHECK-SAME:     memref<f32>, index, index, memref<f32>, index, index, memref<f32>, index, index,
+// CHECK-SAME:     index, index, index, i32, i32, i32, i32) -> i32
+//      CHECK: func.func @mmt4d_f32f32f32
+// CHECK-SAME:     %[[LHS:[a-zA-Z0-9]+]]
+// CHECK-SAME:     %[[RHS:[a-zA-Z0-9]+]]
+// CHECK-SAME:     %[[OUT:[a-zA-Z0-9]+]]
+//      CHECK:   %[[LHS_BASE:[a-zA-Z0-9_]+]], %[[LHS_OFFSET:[a-zA-Z0-9_]+]], %[[LHS_SIZES:[a-zA-Z0-9_]+]]:4, %[[LHS_STRIDES:[a-zA-Z0-9_]+]]:4 = memref.extract_strided_metadata %[[LHS]]
+//      CHECK:   %[[RHS_BASE:[a-zA-Z0-9_]+]], %[[RHS_OFFSET:[a-zA-Z0-9_]+]], %[[RHS_SIZES:[a-zA-Z0-9_]+]]:4, %[[RHS_STRIDES:[a-zA-Z0-9_]+]]:4 = memref.extract_strided_metadata %[[RHS]]
+//      CHECK:   %[[OUT_BASE:[a-zA-Z0-9_]+]], %[[OUT_OFFSET:[a-zA-Z0-9_]+]], %[[OUT_SIZES:[a-zA-Z0-9_]+]]:4, %[[OUT_STRIDES:[a-zA-Z0-9_]+]]:4 = memref.extract_strided_metadata %[[OUT]]
+//  CHECK-DAG:   %[[C0:.+]] = arith.constant 0 : index
+//  CHECK-DAG:   %[[C1:.+]] = arith.constant 1 : index
+//  CHECK-DAG:   %[[I1:.+]] = arith.constant 1 : i32
+//  CHECK-DAG:   %[[I4:.+]] = arith.constant 4 : i32
+//  CHECK-DAG:   %[[M:.+]] = memref.dim %[[LHS]], %[[C0]]
+//  CHECK-DAG:   %[[N:.+]] = memref.dim %[[RHS]], %[[C0]]
+//  CHECK-DAG:   %[[K:.+]] = memref.dim %[[LHS]], %[[C1]]
+//      CHECK:   call @iree_ukernel_mmt4d_f32f32f32_memref(
+// CHECK-SAME:       %[[LHS_BASE]], %[[LHS_OFFSET]], %[[LHS_STRIDES]]#0,
+// CHECK-SAME:       %[[RHS_BASE]], %[[RHS_OFFSET]], %[[RHS_STRIDES]]#0,
+// CHECK-SAME:       %[[OUT_BASE]], %[[OUT_OFFSET]], %[[OUT_STRIDES]]#0,
+// CHECK-SAME:       %[[M]], %[[N]], %[[K]], %[[I4]], %[[I4]], %[[I1]], %[[I1]])
+//  CHECK-NOT:   linalg.mmt4d
+
+// -----
+
+func.func @mmt4d_i8i8i32(%lhs: memref<8x16x8x4xi8>, %rhs: memref<4x16x8x4xi8>,
+                         %out: memref<8x4x8x8xi32>) {
+  linalg.mmt4d ins(%lhs, %rhs : memref<8x16x8x4xi8>, memref<4x16x8x4xi8>)
+               outs(%out : memref<8x4x8x8xi32>)
+  return
+}
+// CHECK-LABEL: func.func @mmt4d_i8i8i32
+//       CHECK:   call @iree_ukernel_mmt4d_i8i8i32_memref(
+//   CHECK-NOT:   linalg.mmt4d
+
+// -----
+
+// The tiles of the output are not contiguous and the microkernel cannot be
+// used.
+func.func @mmt4d_noncontiguous(%lhs: memref<?x?x4x1xf32>, %rhs: memref<?x?x4x1xf32>,
+                               %out: memref<?x?x4x4xf32, strided<[?, 32, 4, 1], offset: ?>>) {
+  linalg.mmt4d ins(%lhs, %rhs : memref<?x?x4x1xf32>, memref<?x?x4x1xf32>)
+               outs(%out : memref<?x?x4x4xf32, strided<[?, 32, 4, 1], offset: ?>>)
+  return
+}
+// CHECK-LABEL: func.func @mmt4d_noncontiguous
+//   CHECK-NOT:   call
+//       CHECK:   linalg.mmt4d
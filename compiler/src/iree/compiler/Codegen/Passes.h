@@ -8,6 +8,7 @@
 #define IREE_COMPILER_CODEGEN_PASSES_H_
 
 #include <memory>
+#include <string>
 
 #include "iree/compiler/Codegen/Dialect/LoweringConfig.h"
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
@@ -212,6 +213,13 @@ createVerifyLinalgTransformLegalityPass();
 /// Performs the final conversion to LLVM dialect.
 std::unique_ptr<OperationPass<ModuleOp>> createConvertToLLVMPass();
 
+/// Annotates each hal.executable.export with the bitmasks of the bindings
+/// streamed across workgroups (`iree_codegen.streamed_bindings`) and reused by
+/// all workgroups (`iree_codegen.reused_bindings`). Must run after the
+/// dispatch has been tiled and distributed to workgroups.
+std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
+createLLVMCPUAnnotateBindingAccessPass();
+
 std::unique_ptr<OperationPass<func::FuncOp>>
 createLLVMCPUEmitVectorizationRemarksPass();
 
@@ -225,6 +233,10 @@ createLLVMCPUCheckIRBeforeLLVMConversionPass();
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
 createLLVMCPULowerExecutableTargetPass();
 
+/// Lowers buffer-level linalg.mmt4d ops to calls to the microkernels in
+/// runtime/src/iree/builtins/ukernel/ that are linked in as bitcode.
+std::unique_ptr<OperationPass<ModuleOp>> createLLVMCPULowerToUKernelsPass();
+
 /// Synchronizes LLVM linkage with MLIR symbol visibility.
 std::unique_ptr<OperationPass<ModuleOp>>
 createLLVMCPUSynchronizeSymbolVisibilityPass();
@@ -315,6 +327,12 @@ void addCPUAArchDoubleTilingExpertPassPipeline(OpPassManager &passManager);
 /// module within the IREE::HAL::ExecutableOp.
 void buildLLVMCPUCodegenPassPipeline(OpPassManager &passManager);
 
+/// Returns a string covering the command line options that change the code
+/// produced by buildLLVMCPUCodegenPassPipeline (including the contents of the
+/// files they name) for use in executable cache keys, or None if the pipeline
+/// has side effects that would be skipped when reusing its results.
+Optional<std::string> getLLVMCPUCodegenCacheKey();
+
 //------------------------------------------------------------------------------
 // LLVMGPU
 //------------------------------------------------------------------------------
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include "iree/builtins/ukernel/flags.h"
 #include "iree/compiler/Codegen/PassDetail.h"
 #include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
@@ -21,9 +22,6 @@
 #include "mlir/Pass/PassRegistry.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
-// TODO: move these flags to a header file shared with runtime/.
-#define IREE_VMVX_MATMUL_FLAG_ACCUMULATE 1
-
 namespace mlir {
 namespace iree_compiler {
 
@@ -1003,7 +1001,7 @@ struct LinalgContractionConversion
     auto &rhsDesc = info.rhsAnal.getDesc(rewriter);
     auto &outDesc = info.outAnal.getDesc(rewriter);
 
-    int flags = IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+    int flags = IREE_UKERNEL_FLAG_ACCUMULATE;
 
     Value m = lhsDesc.sizes[0];
     Value k = rhsDesc.sizes[0];
@@ -1035,7 +1033,7 @@ struct LinalgContractionConversion
     auto &lhsDesc = info.lhsAnal.getDesc(rewriter);
     auto &rhsDesc = info.rhsAnal.getDesc(rewriter);
     auto &outDesc = info.outAnal.getDesc(rewriter);
-    int flags = IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+    int flags = IREE_UKERNEL_FLAG_ACCUMULATE;
     Value m = lhsDesc.sizes[0];
     Value n = rhsDesc.sizes[0];
     Value k = rhsDesc.sizes[1];
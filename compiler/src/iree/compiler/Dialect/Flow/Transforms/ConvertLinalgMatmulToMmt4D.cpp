@@ -9,6 +9,8 @@
 
 #include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
 #include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/HAL/Utils/InferCustomKernelsTargetInfoFromParent.h"
 #include "iree/compiler/Utils/CustomKernelsTargetInfo.h"
 #include "llvm/ADT/Optional.h"
 #include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
@@ -379,6 +381,21 @@ LinalgMatmulOpToLinalgMmt4DOpPattern::chooseTileParams(Value lhs, Value rhs,
                                   "f32*f32->f32, aarch64");
     }
   }
+  if (targetInfo.is(CustomKernelTargetArch::X86_64)) {
+    // M0 and N0 match the number of f32 lanes in a vector register so that
+    // the accumulator tile is held in M0 registers and each step of K is a
+    // broadcast LHS element times one RHS vector.
+    if (lhsElemType.isF32() && rhsElemType.isF32() && accElemType.isF32()) {
+      if (targetInfo.has(CustomKernelTargetFeature::X86_64Avx512f)) {
+        return chooseMatMulOrMatVec({16, 1, 16}, {16, 1, 1}, {16, 1, 2},
+                                    "f32*f32->f32, x86_64 +avx512f");
+      } else if (targetInfo.has(CustomKernelTargetFeature::X86_64Avx2) &&
+                 targetInfo.has(CustomKernelTargetFeature::X86_64Fma)) {
+        return chooseMatMulOrMatVec({8, 1, 8}, {8, 1, 1}, {8, 1, 2},
+                                    "f32*f32->f32, x86_64 +avx2 +fma");
+      }
+    }
+  }
   // enableGenericSlow is meant for tests only. It's just a way to get some
   // test coverage for Mmt4d where we do not currently have kernels.
   if (enableGenericSlow) {
@@ -433,6 +450,37 @@ struct FoldFillGenericOpPattern : public OpRewritePattern<linalg::GenericOp> {
   }
 };
 
+// Infers |targetInfo| from the executable targets that |op| is being compiled
+// for (the `hal.device.targets` of a parent op). The data layout is chosen once
+// for all targets so inference only succeeds when they are all CPU targets of
+// the same architecture. Features are taken from the baseline target that
+// multiversioned variants (those with `match_cpu_features`) fall back to.
+static LogicalResult inferTargetInfoFromExecutableTargets(
+    Operation *op, CustomKernelsTargetInfo &targetInfo) {
+  auto targetAttrs = IREE::HAL::DeviceTargetAttr::lookupExecutableTargets(op);
+  if (targetAttrs.empty()) return failure();
+  llvm::Optional<CustomKernelsTargetInfo> baselineInfo;
+  llvm::Optional<CustomKernelsTargetInfo> anyInfo;
+  for (auto targetAttr : targetAttrs) {
+    if (targetAttr.getBackend().getValue() != "llvm-cpu") return failure();
+    CustomKernelsTargetInfo info;
+    if (failed(InferCustomKernelsTargetInfoFromTargetAttr(targetAttr, info))) {
+      return failure();
+    }
+    for (auto arch :
+         {CustomKernelTargetArch::Aarch64, CustomKernelTargetArch::X86_64}) {
+      if (anyInfo && anyInfo->is(arch) != info.is(arch)) return failure();
+    }
+    if (!anyInfo) anyInfo = info;
+    auto config = targetAttr.getConfiguration();
+    if (!baselineInfo && !(config && config.get("match_cpu_features"))) {
+      baselineInfo = info;
+    }
+  }
+  targetInfo = baselineInfo ? *baselineInfo : *anyInfo;
+  return success();
+}
+
 class ConvertLinalgMatmulToMmt4DPass final
     : public ConvertLinalgMatmulToMmt4DBase<ConvertLinalgMatmulToMmt4DPass> {
  public:
@@ -450,11 +498,19 @@ class ConvertLinalgMatmulToMmt4DPass final
 
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    // Without an explicit target the tile shapes are derived from the CPU
+    // targets the program is being compiled for. Matmuls are left unchanged
+    // when no target is known.
+    CustomKernelsTargetInfo effectiveTargetInfo = targetInfo;
+    if (targetInfo.is(CustomKernelTargetArch::None)) {
+      (void)inferTargetInfoFromExecutableTargets(getOperation(),
+                                                 effectiveTargetInfo);
+    }
     // Main pattern.
     {
       RewritePatternSet patterns(&getContext());
-      patterns.insert<LinalgMatmulOpToLinalgMmt4DOpPattern>(context, targetInfo,
-                                                            enableGenericSlow);
+      patterns.insert<LinalgMatmulOpToLinalgMmt4DOpPattern>(
+          context, effectiveTargetInfo, enableGenericSlow);
       if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                               std::move(patterns)))) {
         return signalPassFailure();
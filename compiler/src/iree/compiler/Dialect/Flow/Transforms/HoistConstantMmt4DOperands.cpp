@@ -0,0 +1,165 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/Analysis/Constant/ConstExpr.h"
+#include "iree/compiler/Dialect/Util/Analysis/Constant/OpOracle.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-hoist-constant-mmt4d-operands"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+using ConstValueInfo = IREE::Util::ConstExprAnalysis::ConstValueInfo;
+
+// Packing may pad the operands up to a multiple of the tile sizes. Operands
+// that grow more than this over the values they are computed from are left in
+// place so that hoisting does not bloat the working set.
+static constexpr int64_t kMaxHoistedSizeGrowth = 2;
+
+// Returns the size in bytes of |value| or None if it is not statically shaped.
+static Optional<int64_t> getStaticByteSize(Value value) {
+  auto shapedType = value.getType().dyn_cast<ShapedType>();
+  if (!shapedType || !shapedType.hasStaticShape()) return llvm::None;
+  return shapedType.getNumElements() *
+         IREE::Util::getRoundedElementByteWidth(shapedType.getElementType());
+}
+
+// Returns true if the value of |info| is no larger than
+// kMaxHoistedSizeGrowth times the constants and globals it is computed from.
+static bool isHoistableSize(const ConstValueInfo *info) {
+  auto byteSize = getStaticByteSize(info->constValue);
+  if (!byteSize) return false;
+  int64_t rootByteSize = 0;
+  for (Value root : info->roots) {
+    auto size = getStaticByteSize(root);
+    if (!size) return false;
+    rootByteSize += *size;
+  }
+  return *byteSize <= kMaxHoistedSizeGrowth * rootByteSize;
+}
+
+// Clones the ops producing |info| and all of its (transitive) producers into
+// |builder| in def-use order, recording the clones in |mapping|.
+static void cloneProducerTree(OpBuilder &builder, const ConstValueInfo *info,
+                              BlockAndValueMapping &mapping) {
+  if (mapping.contains(info->constValue)) return;
+  for (auto *producerInfo : info->producers) {
+    cloneProducerTree(builder, producerInfo, mapping);
+  }
+  builder.clone(*info->getOperation(), mapping);
+}
+
+namespace {
+
+// Moves the computation of mmt4d operands derived only from constants and
+// immutable globals (such as packed weights produced by
+// iree-flow-convert-linalg-matmul-to-mmt4d) into initializers. Const-eval then
+// materializes the packed layout at compile time and otherwise the packing
+// runs once at load time instead of on every invocation.
+//
+// This is a targeted subset of iree-util-hoist-into-globals, which is not
+// enabled by default as hoisting all const-exprs may grow the working set.
+// The same hoisting policy applies: constants and global loads are already
+// globals and ineligible leaves (broadcasts, init_tensors, sub-byte values)
+// stay with their consumers. Operands must also be statically shaped and not
+// much larger than the originals, which become dead once the packed values
+// are hoisted.
+class HoistConstantMmt4DOperandsPass
+    : public HoistConstantMmt4DOperandsBase<HoistConstantMmt4DOperandsPass> {
+ public:
+  HoistConstantMmt4DOperandsPass() = default;
+  HoistConstantMmt4DOperandsPass(const HoistConstantMmt4DOperandsPass &pass) {}
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    IREE::Util::registerConstExprDependentDialects(registry);
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable moduleSymbols(moduleOp);
+    const auto &constExprs = getAnalysis<IREE::Util::ConstExprAnalysis>();
+    IREE::Util::ConstExprHoistingPolicy policy(constExprs);
+    policy.initialize();
+
+    // Gather all operands up-front as the analysis is invalidated by the
+    // rewrites below. Ops in initializers already run once.
+    llvm::SetVector<Value> constOperands;
+    for (auto funcOp : moduleOp.getOps<mlir::func::FuncOp>()) {
+      funcOp.walk([&](linalg::Mmt4DOp mmt4dOp) {
+        for (Value input : mmt4dOp.getInputs()) {
+          const auto *info = constExprs.lookup(input);
+          if (!info || policy.getDecision(info)->getOutcome() !=
+                           IREE::Util::ConstExprHoistingPolicy::ENABLE_HOIST) {
+            continue;
+          }
+          if (!isHoistableSize(info)) continue;
+          constOperands.insert(input);
+        }
+      });
+    }
+
+    for (Value value : constOperands) {
+      LLVM_DEBUG(llvm::dbgs() << "HOIST MMT4D OPERAND: " << value << "\n");
+      Location loc = value.getLoc();
+
+      auto initializerBuilder = OpBuilder::atBlockEnd(moduleOp.getBody());
+      auto initializerOp =
+          initializerBuilder.create<IREE::Util::InitializerOp>(loc);
+      auto builder = OpBuilder::atBlockBegin(initializerOp.addEntryBlock());
+      BlockAndValueMapping mapping;
+      cloneProducerTree(builder, constExprs.lookup(value), mapping);
+
+      auto globalBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+      auto globalOp = globalBuilder.create<IREE::Util::GlobalOp>(
+          loc, "packed", /*isMutable=*/false, value.getType());
+      StringAttr globalSymbol = moduleSymbols.insert(globalOp);
+      SymbolTable::setSymbolVisibility(globalOp,
+                                       SymbolTable::Visibility::Private);
+      builder.create<IREE::Util::GlobalStoreOp>(loc, mapping.lookup(value),
+                                                globalSymbol);
+      builder.create<IREE::Util::InitializerReturnOp>(loc);
+
+      // The original producers are left for canonicalization to remove.
+      OpBuilder loadBuilder(&getContext());
+      loadBuilder.setInsertionPointAfterValue(value);
+      auto loadOp = loadBuilder.create<IREE::Util::GlobalLoadOp>(loc, globalOp);
+      value.replaceAllUsesWith(loadOp.getResult());
+
+      ++hoistedOperands;
+    }
+  }
+
+ private:
+  Statistic hoistedOperands{
+      this, "hoisted mmt4d operand(s)",
+      "Number of constant linalg.mmt4d operands moved into initializers"};
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createHoistConstantMmt4DOperandsPass() {
+  return std::make_unique<HoistConstantMmt4DOperandsPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,247 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===--- HorizontalFusion.cpp - Pass to merge independent linalg ops ------===//
+//
+// Merges independent linalg.generic ops with the same iteration space into a
+// single multi-result linalg.generic. Dispatch region formation then produces
+// one dispatch (sharing one workgroup grid) instead of one dispatch per op.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-horizontal-fusion"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+// Returns true if |op| would be placed into a dispatch on its own by dispatch
+// region formation and has a static iteration space no larger than
+// |maxElements|. This mirrors the producer/consumer heuristics in
+// DispatchLinalgOnTensors: ops fused with a producer root or a consumer are
+// better left alone.
+static bool isHorizontalFusionCandidate(linalg::GenericOp genericOp,
+                                        int64_t maxElements) {
+  if (!genericOp.hasTensorSemantics() || genericOp.hasDynamicShape()) {
+    return false;
+  }
+  // Leave user-specified configurations alone.
+  if (genericOp->hasAttr("compilation_info") ||
+      genericOp->hasAttr("lowering_config")) {
+    return false;
+  }
+
+  int64_t numElements = 1;
+  for (int64_t loopRange : genericOp.getStaticLoopRanges()) {
+    numElements *= loopRange;
+  }
+  if (numElements > maxElements) return false;
+
+  // Single-use ops with a linalg user are fused into that user.
+  if (genericOp->hasOneUse() &&
+      isa<linalg::LinalgOp>(*genericOp->getUsers().begin())) {
+    return false;
+  }
+
+  // Inputs produced by single-use linalg ops (other than fills) make this op
+  // a fused consumer of that producer.
+  for (Value input : genericOp.getInputs()) {
+    auto producerOp = input.getDefiningOp<linalg::LinalgOp>();
+    if (producerOp && !isa<linalg::FillOp>(producerOp) &&
+        producerOp->hasOneUse()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if |lhs| and |rhs| have the same loops and can be merged.
+static bool haveSameIterationSpace(linalg::GenericOp lhs,
+                                   linalg::GenericOp rhs) {
+  return lhs.iterator_types() == rhs.iterator_types() &&
+         lhs.getStaticLoopRanges() == rhs.getStaticLoopRanges();
+}
+
+// Returns true if all uses of the results of |op| are after |insertionOp|.
+// As the merged op is created at |insertionOp| this also guarantees that no op
+// in the group depends on another.
+static bool areAllUsesAfter(Operation *op, Operation *insertionOp) {
+  Block *block = insertionOp->getBlock();
+  for (Operation *user : op->getUsers()) {
+    Operation *ancestor = block->findAncestorOpInBlock(*user);
+    if (!ancestor || ancestor == insertionOp ||
+        ancestor->isBeforeInBlock(insertionOp)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Merges |genericOps| into a single linalg.generic created before the last op
+// in the group and replaces all of their results.
+static void mergeGenericOps(ArrayRef<linalg::GenericOp> genericOps) {
+  linalg::GenericOp lastOp = genericOps.back();
+  OpBuilder builder(lastOp);
+
+  // Inputs read with the same indexing map are shared (such as multiple
+  // reductions over the same input).
+  SmallVector<Value> inputs;
+  SmallVector<AffineMap> inputMaps;
+  DenseMap<std::pair<Value, AffineMap>, unsigned> inputIndices;
+  SmallVector<SmallVector<unsigned>> inputArgIndices;
+  SmallVector<Value> outputs;
+  SmallVector<AffineMap> outputMaps;
+  SmallVector<Type> resultTypes;
+  SmallVector<Location> locs;
+  for (auto genericOp : genericOps) {
+    auto &argIndices = inputArgIndices.emplace_back();
+    for (OpOperand *operand : genericOp.getInputOperands()) {
+      AffineMap map = genericOp.getTiedIndexingMap(operand);
+      auto it = inputIndices.try_emplace({operand->get(), map}, inputs.size());
+      if (it.second) {
+        inputs.push_back(operand->get());
+        inputMaps.push_back(map);
+      }
+      argIndices.push_back(it.first->second);
+    }
+    for (OpOperand *operand : genericOp.getOutputOperands()) {
+      outputs.push_back(operand->get());
+      outputMaps.push_back(genericOp.getTiedIndexingMap(operand));
+    }
+    llvm::append_range(resultTypes, genericOp->getResultTypes());
+    locs.push_back(genericOp.getLoc());
+  }
+  SmallVector<AffineMap> indexingMaps = inputMaps;
+  llvm::append_range(indexingMaps, outputMaps);
+  auto iteratorTypes = llvm::to_vector(
+      lastOp.iterator_types().getAsValueRange<StringAttr>());
+
+  auto fusedOp = builder.create<linalg::GenericOp>(
+      builder.getFusedLoc(locs), resultTypes, inputs, outputs, indexingMaps,
+      iteratorTypes,
+      [&](OpBuilder &nestedBuilder, Location nestedLoc, ValueRange args) {
+        SmallVector<Value> yieldedValues;
+        unsigned outputArgIndex = inputs.size();
+        for (auto it : llvm::enumerate(genericOps)) {
+          linalg::GenericOp genericOp = it.value();
+          Block *body = genericOp.getBody();
+          BlockAndValueMapping mapping;
+          unsigned numInputs = genericOp.getNumInputs();
+          for (unsigned i = 0; i < numInputs; ++i) {
+            mapping.map(body->getArgument(i),
+                        args[inputArgIndices[it.index()][i]]);
+          }
+          for (unsigned i = numInputs; i < body->getNumArguments(); ++i) {
+            mapping.map(body->getArgument(i), args[outputArgIndex++]);
+          }
+          for (Operation &op : body->without_terminator()) {
+            nestedBuilder.clone(op, mapping);
+          }
+          for (Value value : body->getTerminator()->getOperands()) {
+            yieldedValues.push_back(mapping.lookupOrDefault(value));
+          }
+        }
+        nestedBuilder.create<linalg::YieldOp>(nestedLoc, yieldedValues);
+      });
+
+  unsigned resultIndex = 0;
+  for (auto genericOp : genericOps) {
+    for (Value result : genericOp->getResults()) {
+      result.replaceAllUsesWith(fusedOp->getResult(resultIndex++));
+    }
+    genericOp.erase();
+  }
+}
+
+namespace {
+
+struct HorizontalFusionPass
+    : public HorizontalFusionBase<HorizontalFusionPass> {
+  HorizontalFusionPass() = default;
+  HorizontalFusionPass(const HorizontalFusionPass &pass) {}
+  HorizontalFusionPass(int64_t maxElements, int64_t maxOps) {
+    this->maxElements = maxElements;
+    this->maxOps = maxOps;
+  }
+
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<linalg::LinalgDialect>();
+  }
+
+  void runOnOperation() override {
+    // Blocks are visited after their nested ops and merging only touches ops
+    // directly within the visited block.
+    getOperation()->walk([&](Block *block) {
+      if (isa<linalg::LinalgOp>(block->getParentOp())) return;
+      for (auto &group : findGroups(*block)) {
+        LLVM_DEBUG({
+          llvm::dbgs() << "HORIZONTAL FUSION GROUP:\n";
+          for (auto genericOp : group) llvm::dbgs() << "  " << genericOp << "\n";
+        });
+        mergeGenericOps(group);
+        ++fusedGroups;
+        fusedOps += group.size();
+      }
+    });
+  }
+
+ private:
+  // Greedily groups candidates in |block| in program order. Each op joins the
+  // first open group with the same iteration space whose results are only
+  // used after it.
+  SmallVector<SmallVector<linalg::GenericOp>> findGroups(Block &block) {
+    SmallVector<SmallVector<linalg::GenericOp>> groups;
+    for (auto genericOp : block.getOps<linalg::GenericOp>()) {
+      if (!isHorizontalFusionCandidate(genericOp, maxElements)) continue;
+      auto it = llvm::find_if(groups, [&](auto &group) {
+        return static_cast<int64_t>(group.size()) < maxOps &&
+               haveSameIterationSpace(group.front(), genericOp) &&
+               llvm::all_of(group, [&](linalg::GenericOp memberOp) {
+                 return areAllUsesAfter(memberOp, genericOp);
+               });
+      });
+      if (it != groups.end()) {
+        it->push_back(genericOp);
+      } else {
+        groups.push_back({genericOp});
+      }
+    }
+    llvm::erase_if(groups, [](auto &group) { return group.size() < 2; });
+    return groups;
+  }
+
+  Statistic fusedGroups{this, "fused group(s)",
+                        "Number of multi-result ops created"};
+  Statistic fusedOps{this, "fused op(s)",
+                     "Number of ops merged into multi-result ops"};
+};
+
+}  // namespace
+
+std::unique_ptr<Pass> createHorizontalFusionPass() {
+  return std::make_unique<HorizontalFusionPass>();
+}
+
+std::unique_ptr<Pass> createHorizontalFusionPass(int64_t maxElements,
+                                                 int64_t maxOps) {
+  return std::make_unique<HorizontalFusionPass>(maxElements, maxOps);
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
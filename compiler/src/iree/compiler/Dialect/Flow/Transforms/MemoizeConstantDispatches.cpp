@@ -0,0 +1,211 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/PassDetail.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/IR/BlockAndValueMapping.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-memoize-constant-dispatches"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace Flow {
+
+// Returns an attribute uniquely identifying the value of |value| if it is
+// constant for the lifetime of the program: either an inline constant or a load
+// of an immutable global. Returns nullptr if the value may change.
+static Attribute getConstantIdentity(Value value, SymbolTable &moduleSymbols) {
+  Attribute constantAttr;
+  if (matchPattern(value, m_Constant(&constantAttr))) return constantAttr;
+  auto loadOp = value.getDefiningOp<IREE::Util::GlobalLoadOp>();
+  if (!loadOp) return {};
+  auto globalOp =
+      moduleSymbols.lookup<IREE::Util::GlobalOp>(loadOp.getGlobalName());
+  if (!globalOp || globalOp.isGlobalMutable()) return {};
+  return loadOp.getGlobalAttr();
+}
+
+// Returns a key identifying the results of |dispatchOp| if it only consumes
+// values that are constant for the lifetime of the program. Two dispatches
+// with the same key produce the same results. Returns nullptr if the dispatch
+// cannot be memoized.
+static ArrayAttr getMemoizationKey(DispatchOp dispatchOp,
+                                   SymbolTable &moduleSymbols) {
+  // Tied results are updated in-place and would modify the global.
+  auto tiedOp = cast<IREE::Util::TiedOpInterface>(dispatchOp.getOperation());
+  for (unsigned i = 0; i < dispatchOp.getNumResults(); ++i) {
+    if (tiedOp.getTiedResultOperandIndex(i)) return {};
+  }
+
+  // Globals must have static shapes.
+  SmallVector<Attribute> keyAttrs;
+  keyAttrs.push_back(dispatchOp.getEntryPoint());
+  for (Type resultType : dispatchOp.getResultTypes()) {
+    auto tensorType = resultType.dyn_cast<RankedTensorType>();
+    if (!tensorType || !tensorType.hasStaticShape()) return {};
+    keyAttrs.push_back(TypeAttr::get(resultType));
+  }
+
+  // The workload, arguments, and dynamic dimensions must all be constant.
+  for (Value operand : dispatchOp->getOperands()) {
+    Attribute identityAttr = getConstantIdentity(operand, moduleSymbols);
+    if (!identityAttr) return {};
+    keyAttrs.push_back(identityAttr);
+  }
+
+  return ArrayAttr::get(dispatchOp.getContext(), keyAttrs);
+}
+
+// Returns the last op in |moduleOp| that must be ordered before an initializer
+// computing |dispatchOp|: the globals it loads and any initializers storing to
+// them. Returns nullptr if the dispatch has no such dependencies.
+static Operation *findLastDependency(
+    DispatchOp dispatchOp, SymbolTable &moduleSymbols,
+    DenseMap<StringRef, Operation *> &lastGlobalInitializers) {
+  Operation *lastOp = nullptr;
+  auto orderAfter = [&](Operation *op) {
+    if (op && (!lastOp || lastOp->isBeforeInBlock(op))) lastOp = op;
+  };
+  for (Value operand : dispatchOp->getOperands()) {
+    auto loadOp = operand.getDefiningOp<IREE::Util::GlobalLoadOp>();
+    if (!loadOp) continue;
+    orderAfter(moduleSymbols.lookup(loadOp.getGlobalName()));
+    orderAfter(lastGlobalInitializers.lookup(loadOp.getGlobalName()));
+  }
+  return lastOp;
+}
+
+namespace {
+
+class MemoizeConstantDispatchesPass
+    : public MemoizeConstantDispatchesBase<MemoizeConstantDispatchesPass> {
+ public:
+  MemoizeConstantDispatchesPass() = default;
+  MemoizeConstantDispatchesPass(const MemoizeConstantDispatchesPass &pass) {}
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable moduleSymbols(moduleOp);
+
+    // Gather all memoizable dispatches grouped by the key that identifies
+    // their results. Dispatches within initializers already run once.
+    llvm::MapVector<ArrayAttr, SmallVector<DispatchOp>> dispatchGroups;
+    for (auto funcOp : moduleOp.getOps<mlir::func::FuncOp>()) {
+      funcOp.walk([&](DispatchOp dispatchOp) {
+        if (auto keyAttr = getMemoizationKey(dispatchOp, moduleSymbols)) {
+          dispatchGroups[keyAttr].push_back(dispatchOp);
+        }
+      });
+    }
+
+    // Initializers run in module order so the initializers of memoized
+    // results must follow those of the globals they load.
+    DenseMap<StringRef, Operation *> lastGlobalInitializers;
+    for (auto initializerOp : moduleOp.getOps<IREE::Util::InitializerOp>()) {
+      initializerOp.walk([&](IREE::Util::GlobalStoreOp storeOp) {
+        lastGlobalInitializers[storeOp.getGlobal()] = initializerOp;
+      });
+    }
+
+    // Move each unique dispatch into an initializer that stores its results
+    // into globals and replace all equivalent dispatches with loads. The
+    // dispatch then runs once per context instead of once per invocation.
+    for (auto &group : dispatchGroups) {
+      auto &dispatchOps = group.second;
+      auto sourceOp = dispatchOps.front();
+      LLVM_DEBUG(llvm::dbgs() << "MEMOIZE (" << dispatchOps.size()
+                              << " uses): " << sourceOp << "\n");
+      Location loc = sourceOp.getLoc();
+
+      // The globals and their initializer are placed as early as possible:
+      // right after the last global or initializer the dispatch depends on.
+      auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp.getBody());
+      if (auto *lastOp = findLastDependency(sourceOp, moduleSymbols,
+                                            lastGlobalInitializers)) {
+        moduleBuilder.setInsertionPointAfter(lastOp);
+      }
+
+      std::string globalName =
+          ("memoized_" + sourceOp.getEntryPoint().getLeafReference().getValue())
+              .str();
+      SmallVector<IREE::Util::GlobalOp> globalOps;
+      for (auto resultType : sourceOp.getResultTypes()) {
+        auto globalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+            loc, globalName, /*isMutable=*/false, resultType);
+        moduleSymbols.insert(globalOp);
+        SymbolTable::setSymbolVisibility(globalOp,
+                                         SymbolTable::Visibility::Private);
+        globalOps.push_back(globalOp);
+        auto tensorType = resultType.cast<RankedTensorType>();
+        memoizedBytes += tensorType.getNumElements() *
+                         IREE::Util::getRoundedElementByteWidth(
+                             tensorType.getElementType());
+      }
+
+      auto initializerOp = moduleBuilder.create<IREE::Util::InitializerOp>(loc);
+      auto builder = OpBuilder::atBlockBegin(initializerOp.addEntryBlock());
+      BlockAndValueMapping mapping;
+      for (Value operand : sourceOp->getOperands()) {
+        if (mapping.contains(operand)) continue;
+        builder.clone(*operand.getDefiningOp(), mapping);
+      }
+      auto clonedOp = cast<DispatchOp>(builder.clone(*sourceOp, mapping));
+      for (auto it : llvm::zip(clonedOp.getResults(), globalOps)) {
+        builder.create<IREE::Util::GlobalStoreOp>(loc, std::get<0>(it),
+                                                  std::get<1>(it));
+      }
+      builder.create<IREE::Util::InitializerReturnOp>(loc);
+
+      for (auto dispatchOp : dispatchOps) {
+        OpBuilder loadBuilder(dispatchOp);
+        for (auto it : llvm::zip(dispatchOp.getResults(), globalOps)) {
+          auto loadOp = loadBuilder.create<IREE::Util::GlobalLoadOp>(
+              dispatchOp.getLoc(), std::get<1>(it));
+          std::get<0>(it).replaceAllUsesWith(loadOp.getResult());
+        }
+        dispatchOp.erase();
+      }
+
+      ++memoizedDispatches;
+      memoizedDispatchSites += dispatchOps.size();
+    }
+  }
+
+ private:
+  Statistic memoizedDispatches{
+      this, "memoized dispatch(es)",
+      "Number of unique dispatches moved into initializers"};
+  Statistic memoizedDispatchSites{
+      this, "memoized dispatch site(s)",
+      "Number of flow.dispatch ops replaced with loads of memoized results"};
+  Statistic memoizedBytes{
+      this, "memoized byte(s)",
+      "Total size in bytes of all globals holding memoized results"};
+};
+
+}  // namespace
+
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createMemoizeConstantDispatchesPass() {
+  return std::make_unique<MemoizeConstantDispatchesPass>();
+}
+
+}  // namespace Flow
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
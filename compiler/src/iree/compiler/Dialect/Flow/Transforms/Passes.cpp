@@ -95,6 +95,30 @@ static llvm::cl::opt<bool> clNormalizeInputIndexingMap(
     llvm::cl::desc("Enable normalizing input indexing map to identity"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clMemoizeConstantDispatches(
+    "iree-flow-memoize-constant-dispatches",
+    llvm::cl::desc("Runs dispatches that only consume immutable globals and "
+                   "constants once per context and reuses their results."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clEnableHorizontalFusion(
+    "iree-flow-enable-horizontal-fusion",
+    llvm::cl::desc("Merges independent small linalg ops with the same "
+                   "iteration space such that they form a single dispatch."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<int64_t> clHorizontalFusionMaxElements(
+    "iree-flow-horizontal-fusion-max-elements",
+    llvm::cl::desc("Maximum number of iterations of ops merged by horizontal "
+                   "fusion. Larger ops amortize their dispatch overhead."),
+    llvm::cl::init(65536));
+
+static llvm::cl::opt<int64_t> clHorizontalFusionMaxOps(
+    "iree-flow-horizontal-fusion-max-ops",
+    llvm::cl::desc("Maximum number of ops merged into a single op by "
+                   "horizontal fusion."),
+    llvm::cl::init(8));
+
 static llvm::cl::opt<bool> clDumpDispatchGraph(
     "iree-flow-dump-dispatch-graph",
     llvm::cl::desc("Dump a dot graph for dispatches"), llvm::cl::init(false));
@@ -210,12 +234,22 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
             return IREE::Flow::createConvertLinalgMatmulToMmt4DPass(
                 clMmt4dTargetOptions);
           })
+      .addPredicatedPass(
+          clMmt4dTargetOptions.empty() && transformOptions.dataTiling,
+          []() { return IREE::Flow::createConvertLinalgMatmulToMmt4DPass(); })
       // Pad linalg ops
       .addPredicatedPass(clEnablePaddingLinalgOps, []() {
         return IREE::Flow::createPadLinalgOpsToIntegerMultiplePass(
             clLinalgOpsPaddingSize);
       });
 
+  // Move the packing of constant mmt4d operands (weights) into initializers
+  // ahead of global optimization so that const-eval can materialize the packed
+  // layouts at compile time.
+  if (!clMmt4dTargetOptions.empty() || transformOptions.dataTiling) {
+    passManager.addPass(IREE::Flow::createHoistConstantMmt4DOperandsPass());
+  }
+
   passManager.addPass(mlir::createLinalgNamedOpConversionPass());
 
   // Expand tensor shapes into SSA values and optimize the whole program.
@@ -246,6 +280,13 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
       .addPass(mlir::createCanonicalizerPass)
       .addPass(mlir::createCSEPass)
 
+      // Horizontal fusion of independent ops that would otherwise each form
+      // a small dispatch.
+      .addPredicatedPass(clEnableHorizontalFusion, []() {
+        return createHorizontalFusionPass(clHorizontalFusionMaxElements,
+                                          clHorizontalFusionMaxOps);
+      })
+
       // Split reduction operations into parallel and reduction.
       .addPass(createSplitReductionPass)
       // SplitReductionPass may create reduction dimension that are not the last
@@ -303,6 +344,14 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   // an argument if two executables differ only in that one dimension).
   passManager.addPass(IREE::Flow::createDeduplicateExecutablesPass());
 
+  // Hoist dispatches whose inputs are constant for the lifetime of the program
+  // (such as weight transforms) into initializers. This runs after
+  // deduplication so that dispatches of equivalent executables on the same
+  // globals share a single memoized result.
+  if (clMemoizeConstantDispatches) {
+    passManager.addPass(IREE::Flow::createMemoizeConstantDispatchesPass());
+  }
+
   // Create one function per exported program entry point that can be used with
   // iree-benchmark-module to benchmark each function individually. Whether
   // a model supports execution like this (handles zero/null args, has state
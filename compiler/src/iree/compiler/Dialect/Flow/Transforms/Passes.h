@@ -34,6 +34,14 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
   // Enables passes to perform numeric precision reduction.
   bool numericPrecisionReduction = false;
 
+  // Converts linalg.matmul ops to linalg.mmt4d ops with tile shapes derived
+  // from the CPU features of the executable targets. Requires the targets to
+  // have been assigned to the module (hal.device.targets) beforehand.
+  // TODO: enable by default once i8 tile shapes exist for x86_64 and the
+  // packing of weights is hoisted to compile time without opting into
+  // const-eval.
+  bool dataTiling = false;
+
   // Hook to populate a constant evaluation pass pipeline. If nullptr, then
   // no passes are added for constant evaluation. This must be injected in
   // because constant-evaluators can depend on the whole compiler, of which
@@ -93,12 +101,24 @@ std::unique_ptr<Pass> createConvertLinalgMatmulToMmt4DPass(
     CustomKernelsTargetInfo targetInfo);
 std::unique_ptr<Pass> createConvertLinalgMatmulToMmt4DPass(StringRef options);
 
+// Moves the computation of linalg.mmt4d operands that only depend on constants
+// and immutable globals (such as packed weights) into initializers.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createHoistConstantMmt4DOperandsPass();
+
 // Create a pass to detach elementwise ops from named Linalg ops.
 std::unique_ptr<Pass> createDetachElementwiseFromNamedOpsPass();
 
 // Creates a pass to fuse Linalg operations on tensors.
 std::unique_ptr<Pass> createFusionOfTensorOpsPass();
 
+// Creates a pass to merge independent linalg.generic ops with the same
+// iteration space (and at most |maxElements| iterations) into multi-result ops
+// that form a single dispatch. At most |maxOps| ops are merged together.
+std::unique_ptr<Pass> createHorizontalFusionPass();
+std::unique_ptr<Pass> createHorizontalFusionPass(int64_t maxElements,
+                                                 int64_t maxOps);
+
 // Infers and inserts util.numeric.optional_narrow ops at points that may be
 // beneficial.
 std::unique_ptr<Pass> createInferNumericNarrowingPass();
@@ -190,6 +210,12 @@ createOutlineLargeConstantsPass();
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createDeduplicateExecutablesPass();
 
+// Moves dispatches that only consume immutable globals and constants into
+// initializers so that they run once per context, sharing results between
+// equivalent dispatches.
+std::unique_ptr<OperationPass<mlir::ModuleOp>>
+createMemoizeConstantDispatchesPass();
+
 // Create a pass to split reduction dimension.
 std::unique_ptr<Pass> createSplitReductionPass();
 
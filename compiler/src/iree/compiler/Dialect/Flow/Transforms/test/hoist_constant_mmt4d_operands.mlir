@@ -0,0 +1,92 @@
+// RUN: iree-opt --split-input-file --iree-flow-hoist-constant-mmt4d-operands %s | FileCheck %s
+
+#map0 = affine_map<(d0, d1, d2, d3) -> (d1, d3, d0, d2)>
+#map1 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+
+// CHECK: util.global private @[[PACKED:.+]] : tensor<2x4x8x1xf32>
+// CHECK: util.global private @weights
+util.global private @weights = dense<1.0> : tensor<4x16xf32>
+
+// CHECK-LABEL: func.func @hoist_packed_weights
+//  CHECK-SAME: (%[[LHS:.+]]: tensor<1x4x8x1xf32>, %[[ACC:.+]]: tensor<1x2x8x8xf32>)
+func.func @hoist_packed_weights(%lhs: tensor<1x4x8x1xf32>, %acc: tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32> {
+  %weights = util.global.load @weights : tensor<4x16xf32>
+  %expanded = tensor.expand_shape %weights [[0, 1], [2, 3]] : tensor<4x16xf32> into tensor<4x1x2x8xf32>
+  %init = linalg.init_tensor [2, 4, 8, 1] : tensor<2x4x8x1xf32>
+  %packed = linalg.generic {
+      indexing_maps = [#map0, #map1],
+      iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%expanded : tensor<4x1x2x8xf32>) outs(%init : tensor<2x4x8x1xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<2x4x8x1xf32>
+  // CHECK: %[[RHS:.+]] = util.global.load @[[PACKED]] : tensor<2x4x8x1xf32>
+  // CHECK: linalg.mmt4d
+  // CHECK-SAME: ins(%[[LHS]], %[[RHS]] : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>)
+  // CHECK-SAME: outs(%[[ACC]] : tensor<1x2x8x8xf32>)
+  %0 = linalg.mmt4d ins(%lhs, %packed : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>) outs(%acc : tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  return %0 : tensor<1x2x8x8xf32>
+}
+
+// CHECK: util.initializer {
+// CHECK-DAG:   %[[WEIGHTS:.+]] = util.global.load @weights : tensor<4x16xf32>
+// CHECK-DAG:   %[[EXPANDED:.+]] = tensor.expand_shape %[[WEIGHTS]]
+// CHECK-DAG:   %[[INIT:.+]] = linalg.init_tensor [2, 4, 8, 1]
+// CHECK:   %[[RESULT:.+]] = linalg.generic
+// CHECK-SAME: ins(%[[EXPANDED]] : tensor<4x1x2x8xf32>) outs(%[[INIT]] : tensor<2x4x8x1xf32>)
+// CHECK:   util.global.store %[[RESULT]], @[[PACKED]] : tensor<2x4x8x1xf32>
+// CHECK:   util.initializer.return
+
+// -----
+
+// Operands that depend on function arguments are left in place.
+
+// CHECK-LABEL: func.func @no_hoist_dynamic_operands
+func.func @no_hoist_dynamic_operands(%lhs: tensor<1x4x8x1xf32>, %rhs: tensor<2x4x8x1xf32>, %acc: tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32> {
+  // CHECK-NOT: util.global.load
+  // CHECK: linalg.mmt4d
+  %0 = linalg.mmt4d ins(%lhs, %rhs : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>) outs(%acc : tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  return %0 : tensor<1x2x8x8xf32>
+}
+// CHECK-NOT: util.initializer
+
+// -----
+
+// Constants are already globals and are not hoisted on their own.
+
+// CHECK-LABEL: func.func @no_hoist_constant_operands
+func.func @no_hoist_constant_operands(%lhs: tensor<1x4x8x1xf32>, %acc: tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32> {
+  // CHECK: %[[RHS:.+]] = arith.constant dense<1.000000e+00> : tensor<2x4x8x1xf32>
+  %rhs = arith.constant dense<1.0> : tensor<2x4x8x1xf32>
+  // CHECK: linalg.mmt4d
+  // CHECK-SAME: ins(%{{.+}}, %[[RHS]] : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>)
+  %0 = linalg.mmt4d ins(%lhs, %rhs : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>) outs(%acc : tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  return %0 : tensor<1x2x8x8xf32>
+}
+// CHECK-NOT: util.initializer
+
+// -----
+
+// Broadcasts are cheaper to recompute than to store and are not hoisted.
+
+#map0 = affine_map<(d0, d1, d2, d3) -> (d3)>
+#map1 = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+
+// CHECK-LABEL: func.func @no_hoist_broadcast_operands
+func.func @no_hoist_broadcast_operands(%lhs: tensor<1x4x8x1xf32>, %acc: tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32> {
+  %bias = arith.constant dense<1.0> : tensor<1xf32>
+  %init = linalg.init_tensor [2, 4, 8, 1] : tensor<2x4x8x1xf32>
+  // CHECK: %[[RHS:.+]] = linalg.generic
+  %rhs = linalg.generic {
+      indexing_maps = [#map0, #map1],
+      iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%bias : tensor<1xf32>) outs(%init : tensor<2x4x8x1xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    linalg.yield %in : f32
+  } -> tensor<2x4x8x1xf32>
+  // CHECK: linalg.mmt4d
+  // CHECK-SAME: ins(%{{.+}}, %[[RHS]] : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>)
+  %0 = linalg.mmt4d ins(%lhs, %rhs : tensor<1x4x8x1xf32>, tensor<2x4x8x1xf32>) outs(%acc : tensor<1x2x8x8xf32>) -> tensor<1x2x8x8xf32>
+  return %0 : tensor<1x2x8x8xf32>
+}
+// CHECK-NOT: util.initializer
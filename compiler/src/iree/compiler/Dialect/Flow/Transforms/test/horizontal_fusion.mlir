@@ -0,0 +1,128 @@
+// RUN: iree-opt --split-input-file --iree-flow-horizontal-fusion %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-flow-horizontal-fusion="max-elements=16" %s | FileCheck %s --check-prefix=THRESHOLD
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @elementwise_siblings(%arg0: tensor<4x8xf32>, %arg1: tensor<4x8xf32>, %arg2: tensor<4x8xf32>) -> (tensor<4x8xf32>, tensor<4x8xf32>) {
+  %0 = linalg.init_tensor [4, 8] : tensor<4x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0, %arg1 : tensor<4x8xf32>, tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+  ^bb0(%in0: f32, %in1: f32, %out: f32):
+    %3 = arith.addf %in0, %in1 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x8xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]}
+      ins(%arg0, %arg2 : tensor<4x8xf32>, tensor<4x8xf32>) outs(%0 : tensor<4x8xf32>) {
+  ^bb0(%in0: f32, %in1: f32, %out: f32):
+    %3 = arith.mulf %in0, %in1 : f32
+    linalg.yield %3 : f32
+  } -> tensor<4x8xf32>
+  return %1, %2 : tensor<4x8xf32>, tensor<4x8xf32>
+}
+// CHECK-LABEL: func.func @elementwise_siblings
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//  CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//  CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//       CHECK:   %[[INIT:.+]] = linalg.init_tensor
+//       CHECK:   %[[FUSED:.+]]:2 = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]], %[[ARG2]] :
+//  CHECK-SAME:       outs(%[[INIT]], %[[INIT]] :
+//  CHECK-NEXT:   ^bb0(%[[IN0:[a-zA-Z0-9_]+]]: f32, %[[IN1:[a-zA-Z0-9_]+]]: f32, %[[IN2:[a-zA-Z0-9_]+]]: f32, %{{[a-zA-Z0-9_]+}}: f32, %{{[a-zA-Z0-9_]+}}: f32):
+//       CHECK:     %[[ADD:.+]] = arith.addf %[[IN0]], %[[IN1]]
+//       CHECK:     %[[MUL:.+]] = arith.mulf %[[IN0]], %[[IN2]]
+//       CHECK:     linalg.yield %[[ADD]], %[[MUL]]
+//   CHECK-NOT:   linalg.generic
+//       CHECK:   return %[[FUSED]]#0, %[[FUSED]]#1
+
+// The ops are larger than the threshold and are left alone.
+// THRESHOLD-LABEL: func.func @elementwise_siblings
+//       THRESHOLD:   linalg.generic
+//       THRESHOLD:   linalg.generic
+
+// -----
+
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+func.func @reduction_siblings(%arg0: tensor<4x8xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %cst_0 = arith.constant 0xFF800000 : f32
+  %0 = linalg.init_tensor [4] : tensor<4xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<4xf32>) -> tensor<4xf32>
+  %2 = linalg.fill ins(%cst_0 : f32) outs(%0 : tensor<4xf32>) -> tensor<4xf32>
+  %3 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<4x8xf32>) outs(%1 : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %5 = arith.addf %in, %out : f32
+    linalg.yield %5 : f32
+  } -> tensor<4xf32>
+  %4 = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%arg0 : tensor<4x8xf32>) outs(%2 : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %5 = arith.maxf %in, %out : f32
+    linalg.yield %5 : f32
+  } -> tensor<4xf32>
+  return %3, %4 : tensor<4xf32>, tensor<4xf32>
+}
+// CHECK-LABEL: func.func @reduction_siblings
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<4x8xf32>
+//       CHECK:   %[[SUM_INIT:.+]] = linalg.fill
+//       CHECK:   %[[MAX_INIT:.+]] = linalg.fill
+//       CHECK:   %[[FUSED:.+]]:2 = linalg.generic
+//  CHECK-SAME:       iterator_types = ["parallel", "reduction"]
+//  CHECK-SAME:       ins(%[[ARG0]] : tensor<4x8xf32>)
+//  CHECK-SAME:       outs(%[[SUM_INIT]], %[[MAX_INIT]] :
+//  CHECK-NEXT:   ^bb0(%[[IN:[a-zA-Z0-9_]+]]: f32, %[[OUT0:[a-zA-Z0-9_]+]]: f32, %[[OUT1:[a-zA-Z0-9_]+]]: f32):
+//       CHECK:     %[[SUM:.+]] = arith.addf %[[IN]], %[[OUT0]]
+//       CHECK:     %[[MAX:.+]] = arith.maxf %[[IN]], %[[OUT1]]
+//       CHECK:     linalg.yield %[[SUM]], %[[MAX]]
+//       CHECK:   return %[[FUSED]]#0, %[[FUSED]]#1
+
+// -----
+
+#map = affine_map<(d0) -> (d0)>
+func.func @different_shapes(%arg0: tensor<4xf32>, %arg1: tensor<8xf32>) -> (tensor<4xf32>, tensor<8xf32>) {
+  %0 = linalg.init_tensor [4] : tensor<4xf32>
+  %1 = linalg.init_tensor [8] : tensor<8xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%arg0 : tensor<4xf32>) outs(%0 : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %4 = math.exp %in : f32
+    linalg.yield %4 : f32
+  } -> tensor<4xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%arg1 : tensor<8xf32>) outs(%1 : tensor<8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %4 = math.exp %in : f32
+    linalg.yield %4 : f32
+  } -> tensor<8xf32>
+  return %2, %3 : tensor<4xf32>, tensor<8xf32>
+}
+// CHECK-LABEL: func.func @different_shapes
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<4xf32>)
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<8xf32>)
+
+// -----
+
+#map = affine_map<(d0) -> (d0)>
+func.func @dependent_ops(%arg0: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %0 = linalg.init_tensor [4] : tensor<4xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%arg0 : tensor<4xf32>) outs(%0 : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = math.exp %in : f32
+    linalg.yield %3 : f32
+  } -> tensor<4xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel"]}
+      ins(%1 : tensor<4xf32>) outs(%0 : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %3 = math.log %in : f32
+    linalg.yield %3 : f32
+  } -> tensor<4xf32>
+  return %1, %2 : tensor<4xf32>, tensor<4xf32>
+}
+// CHECK-LABEL: func.func @dependent_ops
+//       CHECK:   %[[EXP:.+]] = linalg.generic
+//       CHECK:   %[[LOG:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[EXP]] : tensor<4xf32>)
+//       CHECK:   return %[[EXP]], %[[LOG]]
@@ -0,0 +1,102 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="func.func(iree-flow-convert-linalg-matmul-to-mmt4d)" %s | FileCheck %s
+
+// Tests that the mmt4d tile shapes are derived from the CPU features of the
+// executable targets when no explicit target is passed to the pass.
+
+#target_avx512 = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  cpu_features = "+avx,+avx2,+fma,+avx512f",
+  target_triple = "x86_64-unknown-unknown-eabi-elf"
+}>
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu", {
+  executable_targets = [#target_avx512]
+}>]} {
+func.func @infer_x86_64_avx512f(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xf32>, %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf32>, tensor<?x?xf32>) outs(%arg2 : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+}
+}
+// CHECK-LABEL: @infer_x86_64_avx512f(
+//       CHECK:   linalg.mmt4d
+//  CHECK-SAME:     {comment = "f32*f32->f32, x86_64 +avx512f"}
+//  CHECK-SAME:     ins({{.*}} : tensor<?x?x16x1xf32>, tensor<?x?x16x1xf32>) outs({{.*}} : tensor<?x?x16x16xf32>) -> tensor<?x?x16x16xf32>
+
+// -----
+
+// Multiversioned variants share the data layout chosen for the baseline
+// target.
+
+#target_avx2 = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  cpu_features = "+avx,+avx2,+fma",
+  target_triple = "x86_64-unknown-unknown-eabi-elf"
+}>
+#target_avx512 = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  cpu_features = "+avx,+avx2,+fma,+avx512f",
+  match_cpu_features = ["avx512f"],
+  target_triple = "x86_64-unknown-unknown-eabi-elf"
+}>
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu", {
+  executable_targets = [#target_avx512, #target_avx2]
+}>]} {
+func.func @infer_x86_64_baseline_avx2(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xf32>, %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf32>, tensor<?x?xf32>) outs(%arg2 : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+}
+}
+// CHECK-LABEL: @infer_x86_64_baseline_avx2(
+//       CHECK:   linalg.mmt4d
+//  CHECK-SAME:     {comment = "f32*f32->f32, x86_64 +avx2 +fma"}
+//  CHECK-SAME:     ins({{.*}} : tensor<?x?x8x1xf32>, tensor<?x?x8x1xf32>) outs({{.*}} : tensor<?x?x8x8xf32>) -> tensor<?x?x8x8xf32>
+
+// -----
+
+#target_aarch64 = #hal.executable.target<"llvm-cpu", "embedded-elf-arm_64", {
+  cpu_features = "+neon,+dotprod",
+  target_triple = "aarch64-unknown-unknown-eabi-elf"
+}>
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu", {
+  executable_targets = [#target_aarch64]
+}>]} {
+func.func @infer_aarch64_dotprod(%arg0: tensor<?x?xi8>, %arg1: tensor<?x?xi8>, %arg2: tensor<?x?xi32>) -> tensor<?x?xi32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xi8>, tensor<?x?xi8>) outs(%arg2 : tensor<?x?xi32>) -> tensor<?x?xi32>
+    return %0 : tensor<?x?xi32>
+}
+}
+// CHECK-LABEL: @infer_aarch64_dotprod(
+//       CHECK:   linalg.mmt4d
+//  CHECK-SAME:     {comment = "i8*i8->i32, aarch64 +dotprod"}
+
+// -----
+
+// Without a CPU feature that has known tile shapes matmuls are left as-is.
+
+#target_x86_64 = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {
+  cpu_features = "",
+  target_triple = "x86_64-unknown-unknown-eabi-elf"
+}>
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu", {
+  executable_targets = [#target_x86_64]
+}>]} {
+func.func @infer_x86_64_no_features(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xf32>, %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf32>, tensor<?x?xf32>) outs(%arg2 : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+}
+}
+// CHECK-LABEL: @infer_x86_64_no_features(
+//   CHECK-NOT:   linalg.mmt4d
+//       CHECK:   linalg.matmul
+
+// -----
+
+// Non-CPU targets keep the original layout.
+
+module attributes {hal.device.targets = [#hal.device.target<"vmvx", {
+  executable_targets = [#hal.executable.target<"vmvx", "vmvx-bytecode-fb">]
+}>]} {
+func.func @infer_non_cpu_target(%arg0: tensor<?x?xf32>, %arg1: tensor<?x?xf32>, %arg2: tensor<?x?xf32>) -> tensor<?x?xf32> {
+    %0 = linalg.matmul ins(%arg0, %arg1 : tensor<?x?xf32>, tensor<?x?xf32>) outs(%arg2 : tensor<?x?xf32>) -> tensor<?x?xf32>
+    return %0 : tensor<?x?xf32>
+}
+}
+// CHECK-LABEL: @infer_non_cpu_target(
+//   CHECK-NOT:   linalg.mmt4d
+//       CHECK:   linalg.matmul
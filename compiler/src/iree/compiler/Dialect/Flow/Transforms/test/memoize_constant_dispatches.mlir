@@ -0,0 +1,141 @@
+// RUN: iree-opt --split-input-file --iree-flow-memoize-constant-dispatches %s | FileCheck %s
+
+flow.executable @ex {
+  flow.executable.export @entry
+  builtin.module {
+    func.func @entry(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+
+// The memoized global and its initializer directly follow the global loaded.
+//      CHECK: util.global private @weights
+util.global private @weights = dense<1.0> : tensor<4xf32>
+//      CHECK: util.global private @[[MEMOIZED:.+]] : tensor<4xf32>
+// CHECK-NEXT: util.initializer {
+//  CHECK-DAG:   %[[C4:.+]] = arith.constant 4 : index
+//  CHECK-DAG:   %[[WEIGHTS:.+]] = util.global.load @weights : tensor<4xf32>
+//      CHECK:   %[[RESULT:.+]] = flow.dispatch @ex::@entry[%[[C4]]](%[[WEIGHTS]])
+//      CHECK:   util.global.store %[[RESULT]], @[[MEMOIZED]] : tensor<4xf32>
+//      CHECK:   util.initializer.return
+
+// CHECK-LABEL: func.func @memoize_shared
+func.func @memoize_shared() -> (tensor<4xf32>, tensor<4xf32>) {
+  %c4 = arith.constant 4 : index
+  %weights = util.global.load @weights : tensor<4xf32>
+  // CHECK-NOT: flow.dispatch
+  // CHECK: %[[A:.+]] = util.global.load @[[MEMOIZED]] : tensor<4xf32>
+  %0 = flow.dispatch @ex::@entry[%c4](%weights) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: %[[B:.+]] = util.global.load @[[MEMOIZED]] : tensor<4xf32>
+  %1 = flow.dispatch @ex::@entry[%c4](%weights) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: return %[[A]], %[[B]]
+  return %0, %1 : tensor<4xf32>, tensor<4xf32>
+}
+// CHECK-NOT: util.initializer
+
+// -----
+
+flow.executable @ex {
+  flow.executable.export @entry
+  builtin.module {
+    func.func @entry(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+
+// Initializers run in module order: the memoized initializer must follow the
+// initializer of the global it loads and precedes any later initializers.
+
+//      CHECK: util.global private @weights : tensor<4xf32>
+util.global private @weights : tensor<4xf32>
+//      CHECK: util.initializer {
+// CHECK-NEXT:   %[[CST:.+]] = arith.constant dense<2.000000e+00>
+// CHECK-NEXT:   util.global.store %[[CST]], @weights
+util.initializer {
+  %cst = arith.constant dense<2.0> : tensor<4xf32>
+  util.global.store %cst, @weights : tensor<4xf32>
+  util.initializer.return
+}
+//      CHECK: util.global private @[[MEMOIZED:.+]] : tensor<4xf32>
+// CHECK-NEXT: util.initializer {
+//      CHECK:   %[[WEIGHTS:.+]] = util.global.load @weights : tensor<4xf32>
+//      CHECK:   %[[RESULT:.+]] = flow.dispatch @ex::@entry[%{{.+}}](%[[WEIGHTS]])
+//      CHECK:   util.global.store %[[RESULT]], @[[MEMOIZED]] : tensor<4xf32>
+//      CHECK: util.global private mutable @other
+util.global private mutable @other : index
+//      CHECK: util.initializer {
+// CHECK-NEXT:   %[[C0:.+]] = arith.constant 0 : index
+// CHECK-NEXT:   util.global.store %[[C0]], @other
+util.initializer {
+  %c0 = arith.constant 0 : index
+  util.global.store %c0, @other : index
+  util.initializer.return
+}
+
+// CHECK-LABEL: func.func @memoize_after_initializer
+func.func @memoize_after_initializer() -> tensor<4xf32> {
+  %c4 = arith.constant 4 : index
+  %weights = util.global.load @weights : tensor<4xf32>
+  // CHECK: util.global.load @[[MEMOIZED]] : tensor<4xf32>
+  %0 = flow.dispatch @ex::@entry[%c4](%weights) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+// CHECK-NOT: util.initializer
+
+// -----
+
+flow.executable @ex {
+  flow.executable.export @entry
+  builtin.module {
+    func.func @entry(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+
+util.global private mutable @state = dense<1.0> : tensor<4xf32>
+
+// CHECK-LABEL: func.func @dont_memoize_mutable
+func.func @dont_memoize_mutable(%arg0: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[STATE:.+]] = util.global.load @state
+  %state = util.global.load @state : tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry[%c4](%[[STATE]])
+  %0 = flow.dispatch @ex::@entry[%c4](%state) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry[%c4](%arg0)
+  %1 = flow.dispatch @ex::@entry[%c4](%arg0) : (tensor<4xf32>) -> tensor<4xf32>
+  return %0, %1 : tensor<4xf32>, tensor<4xf32>
+}
+
+// CHECK-NOT: util.initializer
+
+// -----
+
+flow.executable @ex {
+  flow.executable.export @entry
+  builtin.module {
+    func.func @entry(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+
+util.global private @weights = dense<1.0> : tensor<4xf32>
+
+// CHECK-LABEL: func.func @dont_memoize_tied
+func.func @dont_memoize_tied() -> tensor<4xf32> {
+  %c4 = arith.constant 4 : index
+  // CHECK: %[[WEIGHTS:.+]] = util.global.load @weights
+  %weights = util.global.load @weights : tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@entry[%c4](%[[WEIGHTS]]) : (tensor<4xf32>) -> %[[WEIGHTS]]
+  %0 = flow.dispatch @ex::@entry[%c4](%weights) : (tensor<4xf32>) -> %weights
+  return %0 : tensor<4xf32>
+}
+
+// CHECK-NOT: util.initializer
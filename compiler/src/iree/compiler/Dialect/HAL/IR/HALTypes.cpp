@@ -313,7 +313,21 @@ std::string ExecutableTargetAttr::getSymbolNameFragment() {
 }
 
 Attribute ExecutableTargetAttr::getMatchExpression() {
-  return DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+  auto formatAttr =
+      DeviceMatchExecutableFormatAttr::get(getContext(), getFormat());
+
+  // Targets compiled for specific CPU features must only be selected when the
+  // processor supports all of them.
+  auto config = getConfiguration();
+  auto featuresAttr =
+      config ? config.getAs<ArrayAttr>("match_cpu_features") : ArrayAttr{};
+  if (!featuresAttr || featuresAttr.empty()) return formatAttr;
+  SmallVector<Attribute> conditionAttrs;
+  conditionAttrs.push_back(formatAttr);
+  for (auto featureAttr : featuresAttr.getAsRange<StringAttr>()) {
+    conditionAttrs.push_back(DeviceMatchCPUFeatureAttr::get(featureAttr));
+  }
+  return MatchAllAttr::get(getContext(), conditionAttrs);
 }
 
 //===----------------------------------------------------------------------===//
@@ -495,6 +509,33 @@ Value DeviceMatchArchitectureAttr::buildConditionExpression(
       .getValue();
 }
 
+// static
+Attribute DeviceMatchCPUFeatureAttr::parse(AsmParser &p, Type type) {
+  StringAttr featureAttr;
+  if (failed(p.parseLess()) || failed(p.parseAttribute(featureAttr)) ||
+      failed(p.parseGreater())) {
+    return {};
+  }
+  return get(p.getContext(), featureAttr);
+}
+
+void DeviceMatchCPUFeatureAttr::print(AsmPrinter &p) const {
+  auto &os = p.getStream();
+  os << "<";
+  p.printAttribute(getFeature());
+  os << ">";
+}
+
+Value DeviceMatchCPUFeatureAttr::buildConditionExpression(
+    Location loc, Value device, OpBuilder builder) const {
+  auto i1Type = builder.getI1Type();
+  return builder
+      .create<IREE::HAL::DeviceQueryOp>(
+          loc, i1Type, i1Type, device, builder.getStringAttr("hal.cpu"),
+          getFeature(), builder.getZeroAttr(i1Type))
+      .getValue();
+}
+
 // static
 Attribute DeviceMatchExecutableFormatAttr::parse(AsmParser &p, Type type) {
   StringAttr patternAttr;
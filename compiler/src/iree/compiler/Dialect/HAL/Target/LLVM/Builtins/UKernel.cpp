@@ -0,0 +1,63 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Target/LLVM/Builtins/UKernel.h"
+
+#include "iree/builtins/ukernel/bin/libukernel.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Support/MemoryBufferRef.h"
+#include "mlir/Support/LLVM.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+static const iree_file_toc_t *lookupUKernelFile(StringRef filename) {
+  for (size_t i = 0; i < iree_builtins_libukernel_size(); ++i) {
+    const auto &file_toc = iree_builtins_libukernel_create()[i];
+    if (filename == file_toc.name) return &file_toc;
+  }
+  return nullptr;
+}
+
+static const iree_file_toc_t *lookupUKernelFile(
+    llvm::TargetMachine *targetMachine) {
+  const auto &triple = targetMachine->getTargetTriple();
+
+  // NOTE: other arch-specific checks go here once the arch-specific
+  // implementations (such as mmt4d_arm_64.c) are built as bitcode.
+
+  // Fallback path using the generic wasm variants as they are largely
+  // machine-agnostic.
+  if (triple.isArch32Bit()) {
+    return lookupUKernelFile("libukernel_wasm32_generic.bc");
+  } else if (triple.isArch64Bit()) {
+    return lookupUKernelFile("libukernel_wasm64_generic.bc");
+  } else {
+    return nullptr;
+  }
+}
+
+llvm::Expected<std::unique_ptr<llvm::Module>> loadUKernelBitcode(
+    llvm::TargetMachine *targetMachine, llvm::LLVMContext &context) {
+  // Find a bitcode file for the current architecture.
+  const auto *file = lookupUKernelFile(targetMachine);
+  if (!file) {
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "no matching architecture bitcode file");
+  }
+
+  // Load the generic bitcode file contents.
+  llvm::MemoryBufferRef bitcodeBufferRef(
+      llvm::StringRef(file->data, file->size), file->name);
+  return llvm::parseBitcodeFile(bitcodeBufferRef, context);
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -14,24 +14,30 @@
 #include "iree/compiler/Codegen/Passes.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/Builtins/Device.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/Builtins/Musl.h"
+#include "iree/compiler/Dialect/HAL/Target/LLVM/Builtins/UKernel.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LibraryBuilder.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LinkerTool.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/StaticLibraryGenerator.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "llvm/ADT/StringSwitch.h"
 #include "llvm/Analysis/TargetTransformInfo.h"
 #include "llvm/Bitcode/BitcodeReader.h"
 #include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Linker/Linker.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/ThreadPool.h"
 #include "mlir/Dialect/ArmNeon/ArmNeonDialect.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/PDL/IR/PDL.h"
 #include "mlir/Dialect/PDLInterp/IR/PDLInterp.h"
 #include "mlir/Dialect/Transform/IR/TransformDialect.h"
+#include "mlir/IR/MLIRContext.h"
 #include "mlir/Target/LLVMIR/Dialect/LLVMIR/LLVMToLLVMIRTranslation.h"
 #include "mlir/Target/LLVMIR/Export.h"
 
@@ -45,6 +51,10 @@ namespace HAL {
 static constexpr char kQueryFunctionName[] =
     "iree_hal_executable_library_query";
 
+// Maximum number of partitions large executables are split into for parallel
+// code generation. Each partition produces an object file.
+static constexpr unsigned kMaxCodegenPartitions = 64;
+
 static llvm::Optional<FileLineColLoc> findFirstFileLoc(Location baseLoc) {
   if (auto loc = baseLoc.dyn_cast<FusedLoc>()) {
     for (auto &childLoc : loc.getLocations()) {
@@ -136,6 +146,102 @@ static LogicalResult linkBuiltinLibrary(
   return success();
 }
 
+// Returns the runtime CPU data keys (see iree/schemas/cpu_data.h) that can be
+// queried on |targetTriple|. The keys match the LLVM target feature names.
+static ArrayRef<const char *> getRuntimeCPUFeatureKeys(
+    const llvm::Triple &targetTriple) {
+  static const char *kX86_64Features[] = {
+      "sse3",    "ssse3",    "sse4.1",   "sse4.2",   "popcnt",   "cx16",
+      "sahf",    "avx",      "avx2",     "fma",      "f16c",     "bmi",
+      "bmi2",    "lzcnt",    "movbe",    "xsave",    "avx512f",  "avx512cd",
+      "avx512vl", "avx512dq", "avx512bw", "avx512vnni",
+  };
+  static const char *kAArch64Features[] = {
+      "dotprod",
+      "i8mm",
+  };
+  if (targetTriple.getArch() == llvm::Triple::ArchType::x86_64) {
+    return kX86_64Features;
+  } else if (targetTriple.isAArch64()) {
+    return kAArch64Features;
+  }
+  return {};
+}
+
+// Returns true if |cpu| only implies features the runtime can query on
+// |targetTriple|. Named CPUs imply features the runtime cannot detect (and
+// microarchitectural tuning) so only the generic feature levels are allowed.
+static bool isRuntimeSelectableCPU(const llvm::Triple &targetTriple,
+                                   StringRef cpu) {
+  if (targetTriple.getArch() == llvm::Triple::ArchType::x86_64) {
+    return llvm::StringSwitch<bool>(cpu)
+        .Cases("generic", "x86-64", "x86-64-v2", "x86-64-v3", "x86-64-v4",
+               true)
+        .Default(false);
+  } else if (targetTriple.isAArch64()) {
+    return cpu == "generic";
+  }
+  return false;
+}
+
+// Returns the runtime CPU data keys (see iree/schemas/cpu_data.h) of the
+// features enabled by |targetOptions|. Only features the runtime knows how to
+// query are returned.
+static SmallVector<StringRef> getRuntimeCPUFeatures(
+    const LLVMTargetOptions &targetOptions) {
+  SmallVector<StringRef> features;
+  auto knownFeatures =
+      getRuntimeCPUFeatureKeys(llvm::Triple(targetOptions.targetTriple));
+  if (knownFeatures.empty()) return features;
+  auto targetMachine = createTargetMachine(targetOptions);
+  if (!targetMachine) return features;
+  const auto *subtargetInfo = targetMachine->getMCSubtargetInfo();
+  for (const char *feature : knownFeatures) {
+    if (subtargetInfo->checkFeatures(std::string("+") + feature)) {
+      features.push_back(feature);
+    }
+  }
+  return features;
+}
+
+// Verifies that |variant| only differs from the baseline |targetOptions| in
+// ways the runtime can check before selecting it. Any other difference would
+// let the variant be selected on processors that cannot execute it.
+static LogicalResult verifyRuntimeSelectableVariant(
+    Location loc, const LLVMTargetOptions &targetOptions,
+    const LLVMTargetOptions::CPUVariant &variant) {
+  llvm::Triple targetTriple(targetOptions.targetTriple);
+  auto knownFeatures = getRuntimeCPUFeatureKeys(targetTriple);
+  if (knownFeatures.empty()) {
+    return mlir::emitError(loc)
+           << "CPU variants are not supported for target triple '"
+           << targetOptions.targetTriple
+           << "' as the runtime cannot query its processor features";
+  }
+  if (variant.cpu != targetOptions.targetCPU &&
+      !isRuntimeSelectableCPU(targetTriple, variant.cpu)) {
+    return mlir::emitError(loc)
+           << "CPU variant '" << variant.cpu
+           << "' cannot be selected at runtime; use a generic CPU level and "
+              "list the required features explicitly";
+  }
+  auto baselineFeatures =
+      llvm::SubtargetFeatures(targetOptions.targetCPUFeatures).getFeatures();
+  for (auto &feature :
+       llvm::SubtargetFeatures(variant.cpuFeatures).getFeatures()) {
+    if (!llvm::SubtargetFeatures::isEnabled(feature)) continue;
+    if (llvm::is_contained(baselineFeatures, feature)) continue;
+    auto name = llvm::SubtargetFeatures::StripFlag(feature);
+    if (!llvm::is_contained(knownFeatures, name)) {
+      return mlir::emitError(loc)
+             << "CPU variant feature '" << feature
+             << "' cannot be queried at runtime (see iree/schemas/cpu_data.h) "
+                "and the variant could be selected on processors without it";
+    }
+  }
+  return success();
+}
+
 class LLVMCPUTargetBackend final : public TargetBackend {
  public:
   explicit LLVMCPUTargetBackend(LLVMTargetOptions options)
@@ -168,8 +274,10 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     // synchronous mode.
     configItems.emplace_back(b.getStringAttr("legacy_sync"), b.getUnitAttr());
 
+    auto executableTargetsAttr = getExecutableTargets(context);
+    if (!executableTargetsAttr) return {};
     configItems.emplace_back(b.getStringAttr("executable_targets"),
-                             getExecutableTargets(context));
+                             executableTargetsAttr);
 
     auto configAttr = b.getDictionaryAttr(configItems);
     return IREE::HAL::DeviceTargetAttr::get(
@@ -180,6 +288,41 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     buildLLVMCPUCodegenPassPipeline(passManager);
   }
 
+  Optional<std::string> getExecutableCacheKey() const override {
+    // Static libraries and kept linker artifacts are written to disk as a side
+    // effect of serialization and would be missing on cache hits.
+    if (!options_.staticLibraryOutput.empty() || options_.keepLinkerArtifacts) {
+      return llvm::None;
+    }
+    // Codegen options that are not plumbed through the target options (such
+    // as tuning databases) are global command line options.
+    Optional<std::string> codegenKey = getLLVMCPUCodegenCacheKey();
+    if (!codegenKey) return llvm::None;
+    // The target triple, CPU and features are part of the executable target
+    // attributes.
+    std::string key;
+    llvm::raw_string_ostream os(key);
+    os << *codegenKey << " ";
+    const auto &tuning = options_.pipelineTuningOptions;
+    os << "loop-interleaving=" << tuning.LoopInterleaving
+       << " loop-vectorization=" << tuning.LoopVectorization
+       << " loop-unrolling=" << tuning.LoopUnrolling
+       << " slp-vectorization=" << tuning.SLPVectorization
+       << " opt-speed=" << options_.optimizerOptLevel.getSpeedupLevel()
+       << " opt-size=" << options_.optimizerOptLevel.getSizeLevel()
+       << " codegen-opt=" << static_cast<int>(options_.codeGenOptLevel)
+       << " float-abi=" << static_cast<int>(options_.options.FloatABIType)
+       << " abi=" << options_.options.MCOptions.ABIName
+       << " debug-symbols=" << options_.debugSymbols
+       << " sanitizer=" << static_cast<int>(options_.sanitizerKind)
+       << " link-embedded=" << options_.linkEmbedded
+       << " link-static=" << options_.linkStatic
+       << " system-linker=" << options_.systemLinkerPath
+       << " embedded-linker=" << options_.embeddedLinkerPath
+       << " wasm-linker=" << options_.wasmLinkerPath;
+    return os.str();
+  }
+
   LogicalResult linkExecutables(mlir::ModuleOp moduleOp) override {
     OpBuilder builder = OpBuilder::atBlockBegin(moduleOp.getBody());
 
@@ -187,8 +330,20 @@ class LLVMCPUTargetBackend final : public TargetBackend {
         llvm::to_vector<8>(moduleOp.getOps<IREE::HAL::ExecutableOp>());
     if (sourceExecutableOps.size() <= 1) return success();
 
-    // TODO(benvanik): rework linking to support multiple formats.
-    auto sharedTargetAttr = getExecutableTarget(builder.getContext());
+    // Gather the distinct targets of our variants in the order they were
+    // declared. When multiversioning there will be one per CPU configuration
+    // and each must be linked independently to preserve the selection order.
+    SmallVector<IREE::HAL::ExecutableTargetAttr> sourceTargetAttrs;
+    for (auto executableOp : sourceExecutableOps) {
+      for (auto variantOp :
+           executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+        auto targetAttr = variantOp.getTarget();
+        if (targetAttr.getBackend().getValue() != name()) continue;
+        if (!llvm::is_contained(sourceTargetAttrs, targetAttr)) {
+          sourceTargetAttrs.push_back(targetAttr);
+        }
+      }
+    }
 
     // Guess a module name, if needed, to make the output files readable.
     auto moduleName = guessModuleName(moduleOp);
@@ -201,18 +356,42 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     linkedExecutableOp.setVisibility(
         sourceExecutableOps.front().getVisibility());
 
-    // Add our hal.executable.variant with an empty module.
-    builder.setInsertionPointToStart(&linkedExecutableOp.getBlock());
-    auto linkedTargetOp = builder.create<IREE::HAL::ExecutableVariantOp>(
-        moduleOp.getLoc(), sharedTargetAttr.getSymbolNameFragment(),
-        sharedTargetAttr);
-    builder.setInsertionPoint(&linkedTargetOp.getBlock().back());
-    builder.create<ModuleOp>(moduleOp.getLoc());
-
-    // Try linking together all executables in moduleOp.
-    return linkExecutablesInto(
-        moduleOp, sourceExecutableOps, linkedExecutableOp, linkedTargetOp,
-        [](mlir::ModuleOp moduleOp) { return moduleOp; }, builder);
+    if (sourceTargetAttrs.size() <= 1) {
+      // TODO(benvanik): rework linking to support multiple formats.
+      auto sharedTargetAttr = getExecutableTarget(builder.getContext());
+
+      // Add our hal.executable.variant with an empty module.
+      builder.setInsertionPointToStart(&linkedExecutableOp.getBlock());
+      auto linkedTargetOp = builder.create<IREE::HAL::ExecutableVariantOp>(
+          moduleOp.getLoc(), sharedTargetAttr.getSymbolNameFragment(),
+          sharedTargetAttr);
+      builder.setInsertionPoint(&linkedTargetOp.getBlock().back());
+      builder.create<ModuleOp>(moduleOp.getLoc());
+
+      // Try linking together all executables in moduleOp.
+      return linkExecutablesInto(
+          moduleOp, sourceExecutableOps, linkedExecutableOp, linkedTargetOp,
+          [](mlir::ModuleOp moduleOp) { return moduleOp; }, builder);
+    }
+
+    // Add one hal.executable.variant with an empty module per target and link
+    // all source variants with that target into it.
+    SymbolTable linkedSymbolTable(linkedExecutableOp);
+    for (auto targetAttr : sourceTargetAttrs) {
+      builder.setInsertionPoint(&linkedExecutableOp.getBlock().back());
+      auto linkedTargetOp = builder.create<IREE::HAL::ExecutableVariantOp>(
+          moduleOp.getLoc(), targetAttr.getSymbolNameFragment(), targetAttr);
+      linkedSymbolTable.insert(linkedTargetOp);
+      builder.setInsertionPoint(&linkedTargetOp.getBlock().back());
+      builder.create<ModuleOp>(moduleOp.getLoc());
+      if (failed(linkExecutablesInto(
+              moduleOp, sourceExecutableOps, linkedExecutableOp,
+              linkedTargetOp, [](mlir::ModuleOp moduleOp) { return moduleOp; },
+              builder, /*matchLinkedTarget=*/true))) {
+        return failure();
+      }
+    }
+    return success();
   }
 
   LogicalResult serializeExecutable(const SerializationOptions &options,
@@ -320,9 +499,21 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       // Optionally entry points may specify that they require workgroup local
       // memory. We fetch that value here and plumb it through so the runtime
       // knows how much memory to reserve and pass in.
-      int64_t localMemorySize = exportOp.getWorkgroupLocalMemory()
-                                    .value_or(APInt(64, 0))
-                                    .getSExtValue();
+      LibraryBuilder::DispatchAttrs dispatchAttrs;
+      dispatchAttrs.localMemorySize = exportOp.getWorkgroupLocalMemory()
+                                          .value_or(APInt(64, 0))
+                                          .getSExtValue();
+
+      // Binding access hints are computed during codegen and let the runtime
+      // prefetch the bindings the next workgroup will access.
+      if (auto streamedBindingsAttr = exportOp->getAttrOfType<IntegerAttr>(
+              "iree_codegen.streamed_bindings")) {
+        dispatchAttrs.streamedBindings = streamedBindingsAttr.getInt();
+      }
+      if (auto reusedBindingsAttr = exportOp->getAttrOfType<IntegerAttr>(
+              "iree_codegen.reused_bindings")) {
+        dispatchAttrs.reusedBindings = reusedBindingsAttr.getInt();
+      }
 
       std::string sourceFile = "";
       int sourceLine = 0;
@@ -335,7 +526,7 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       }
       libraryBuilder.addExport(
           exportOp.getName(), sourceFile, sourceLine, /*tag=*/"",
-          LibraryBuilder::DispatchAttrs{localMemorySize}, llvmFunc);
+          dispatchAttrs, llvmFunc);
     }
 
     auto queryFunctionName = std::string(kQueryFunctionName);
@@ -374,8 +565,10 @@ class LLVMCPUTargetBackend final : public TargetBackend {
       }
     }
 
-    // Specialize the module to our target machine.
-    auto targetMachine = createTargetMachine(options_);
+    // Specialize the module to our target machine. Multiversioned variants
+    // carry their own CPU configuration that overrides the baseline.
+    auto targetMachine =
+        createTargetMachine(getVariantTargetOptions(variantOp.getTarget()));
     if (!targetMachine) {
       return mlir::emitError(variantOp.getLoc())
              << "failed to create target machine for target triple '"
@@ -407,6 +600,21 @@ class LLVMCPUTargetBackend final : public TargetBackend {
              << options_.targetTriple << "'";
     }
 
+    // Microkernels are only linked in when codegen emitted calls to them (see
+    // LLVMCPULowerToUKernels) to avoid the cost of linking and optimizing them
+    // for every executable.
+    bool hasUKernelCalls = llvm::any_of(*llvmModule, [](llvm::Function &func) {
+      return func.isDeclaration() && func.getName().startswith("iree_ukernel_");
+    });
+    if (hasUKernelCalls &&
+        failed(linkBuiltinLibrary(
+            variantOp.getLoc(), moduleLinker, linkerFlag, targetMachine.get(),
+            "libukernel", loadUKernelBitcode(targetMachine.get(), context)))) {
+      return mlir::emitError(variantOp.getLoc())
+             << "failed linking in builtin library for target triple '"
+             << options_.targetTriple << "'";
+    }
+
     // Strip any compiler identifiers that may have snuck in. We let the linker
     // tag the module.
     auto *llvmIdent = llvmModule->getNamedMetadata("llvm.ident");
@@ -445,26 +653,60 @@ class LLVMCPUTargetBackend final : public TargetBackend {
 
     SmallVector<Artifact> objectFiles;
 
-    // Emit the base object file containing the bulk of our code.
-    // This must come first such that we have the proper library linking order.
+    // Emit the base object files containing the bulk of our code.
+    // These must come first such that we have the proper library linking order.
     {
-      // NOTE: today we just use a single object file, however if we wanted to
-      // scale code generation and linking we'd want to generate one per
-      // function (or something like that). A single object file is also
-      // instrumental to static library generation (which only supports one
-      // object file per library).
-      std::string objectData;
-      if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
-                                      llvm::CGFT_ObjectFile, &objectData))) {
-        return variantOp.emitError()
-               << "failed to compile LLVM-IR module to an object file";
+      // Large executables (such as those produced by linking all of the
+      // dispatches in a program together) are split into partitions that are
+      // code generated in parallel and linked together. Static libraries only
+      // support a single object file and we keep a single object file when
+      // preserving linker artifacts so that the listings match the binary.
+      // The partition count only depends on the executable such that the
+      // output does not depend on the host.
+      unsigned partitionCount = 1;
+      if (!options_.linkStatic && !options_.keepLinkerArtifacts) {
+        auto exportOps = variantOp.getBlock().getOps<ExecutableExportOp>();
+        partitionCount = std::min<unsigned>(
+            kMaxCodegenPartitions,
+            std::distance(exportOps.begin(), exportOps.end()));
+      }
+      SmallVector<std::string> objectDatas;
+      if (partitionCount <= 1) {
+        std::string objectData;
+        if (failed(runEmitObjFilePasses(targetMachine.get(), llvmModule.get(),
+                                        llvm::CGFT_ObjectFile, &objectData))) {
+          return variantOp.emitError()
+                 << "failed to compile LLVM-IR module to an object file";
+        }
+        objectDatas.push_back(std::move(objectData));
+      } else {
+        // This serialization holds one executable thread slot; partitions
+        // only fan out to the slots that are free such that all executables
+        // serialized together stay within --iree-hal-executable-parallelism.
+        // --mlir-disable-threading keeps code generation on this thread.
+        MLIRContext *mlirContext = variantOp.getContext();
+        auto helperSlots = ExecutableThreadSlots::tryAcquire(
+            options.executableParallelism,
+            mlirContext->isMultithreadingEnabled() ? partitionCount - 1 : 0);
+        auto variantTargetOptions =
+            getVariantTargetOptions(variantOp.getTarget());
+        if (failed(runSplitEmitObjFilePasses(
+                [&]() { return createTargetMachine(variantTargetOptions); },
+                llvmModule.get(), partitionCount,
+                /*threadCount=*/1 + helperSlots.getCount(), objectDatas))) {
+          return variantOp.emitError()
+                 << "failed to compile LLVM-IR module partitions to object "
+                    "files";
+        }
+      }
+      for (auto &objectData : objectDatas) {
+        auto objectFile = Artifact::createTemporary(libraryName, "o");
+        auto &os = objectFile.outputFile->os();
+        os << objectData;
+        os.flush();
+        os.close();
+        objectFiles.push_back(std::move(objectFile));
       }
-      auto objectFile = Artifact::createTemporary(libraryName, "o");
-      auto &os = objectFile.outputFile->os();
-      os << objectData;
-      os.flush();
-      os.close();
-      objectFiles.push_back(std::move(objectFile));
     }
 
     // If we are keeping artifacts then let's also add the bitcode and
@@ -645,15 +887,67 @@ class LLVMCPUTargetBackend final : public TargetBackend {
   }
 
  private:
+  // Additional target information besides that is contained in
+  // LLVMTargetOptions options_.
+  struct AdditionalConfigurationValues {
+    std::string dataLayoutStr;
+    int64_t vectorSize;
+  };
+
+  // Returns the executable targets in order of preference or nullptr if any
+  // CPU variant is invalid. Errors are emitted on an unknown location as the
+  // targets come from command line flags.
   ArrayAttr getExecutableTargets(MLIRContext *context) const {
     SmallVector<Attribute> targetAttrs;
-    // This is where we would multiversion.
+
+    // Multiversioned variants are listed first in order of preference so that
+    // the runtime selects the first one the processor supports. Each requires
+    // the runtime-queryable features it enables beyond the baseline. Static
+    // libraries have a single query function per executable and cannot carry
+    // multiple variants.
+    if (!options_.linkStatic) {
+      auto baselineFeatures = getRuntimeCPUFeatures(options_);
+      for (auto &variant : options_.targetCPUVariants) {
+        if (failed(verifyRuntimeSelectableVariant(UnknownLoc::get(context),
+                                                  options_, variant))) {
+          return {};
+        }
+        auto variantOptions = options_;
+        variantOptions.targetCPU = variant.cpu;
+        variantOptions.targetCPUFeatures = variant.cpuFeatures;
+        SmallVector<StringRef> matchFeatures;
+        for (auto feature : getRuntimeCPUFeatures(variantOptions)) {
+          if (!llvm::is_contained(baselineFeatures, feature)) {
+            matchFeatures.push_back(feature);
+          }
+        }
+        // Variants that add nothing queryable would always be selected and
+        // shadow the baseline so we drop them.
+        if (matchFeatures.empty()) continue;
+        targetAttrs.push_back(getExecutableTarget(
+            context, variantOptions, computeConfiguration(variantOptions),
+            matchFeatures));
+      }
+    }
+
+    // The baseline is always supported and acts as the fallback.
     targetAttrs.push_back(getExecutableTarget(context));
     return ArrayAttr::get(context, targetAttrs);
   }
 
   IREE::HAL::ExecutableTargetAttr getExecutableTarget(
       MLIRContext *context) const {
+    return getExecutableTarget(context, options_, config_,
+                               /*matchCPUFeatures=*/{});
+  }
+
+  // Returns an executable target for the given CPU configuration. If
+  // |matchCPUFeatures| is not empty the target is a multiversioned variant
+  // that is only selected at runtime when the features are all available.
+  IREE::HAL::ExecutableTargetAttr getExecutableTarget(
+      MLIRContext *context, const LLVMTargetOptions &targetOptions,
+      const AdditionalConfigurationValues &targetConfig,
+      ArrayRef<StringRef> matchCPUFeatures) const {
     std::string format;
     if (options_.linkStatic) {
       // Static libraries are just string references when serialized so we don't
@@ -727,28 +1021,60 @@ class LLVMCPUTargetBackend final : public TargetBackend {
     addConfig("target_triple", StringAttr::get(context, options_.targetTriple));
 
     // Set data layout
-    addConfig("data_layout", StringAttr::get(context, config_.dataLayoutStr));
+    addConfig("data_layout",
+              StringAttr::get(context, targetConfig.dataLayoutStr));
 
     // Set the native vector size. This creates a dummy llvm module just to
     // build the TTI the right way.
-    addConfig("native_vector_size",
-              IntegerAttr::get(IndexType::get(context), config_.vectorSize));
+    addConfig("native_vector_size", IntegerAttr::get(IndexType::get(context),
+                                                     targetConfig.vectorSize));
 
     // Set target CPU features.
     addConfig("cpu_features",
-              StringAttr::get(context, options_.targetCPUFeatures));
+              StringAttr::get(context, targetOptions.targetCPUFeatures));
+
+    // Multiversioned variants record their CPU so that serialization can
+    // configure the target machine and the features the runtime must check.
+    if (!matchCPUFeatures.empty()) {
+      addConfig("cpu", StringAttr::get(context, targetOptions.targetCPU));
+      SmallVector<Attribute> matchAttrs;
+      for (auto feature : matchCPUFeatures) {
+        matchAttrs.push_back(StringAttr::get(context, feature));
+      }
+      addConfig("match_cpu_features", ArrayAttr::get(context, matchAttrs));
+    }
 
     return IREE::HAL::ExecutableTargetAttr::get(
         context, StringAttr::get(context, "llvm-cpu"),
         StringAttr::get(context, format), DictionaryAttr::get(context, config));
   }
 
-  void initConfiguration() {
-    auto targetMachine = createTargetMachine(options_);
+  // Returns the baseline options overridden by any CPU configuration stored on
+  // |targetAttr| by multiversioning.
+  LLVMTargetOptions getVariantTargetOptions(
+      IREE::HAL::ExecutableTargetAttr targetAttr) const {
+    auto targetOptions = options_;
+    if (auto config = targetAttr.getConfiguration()) {
+      if (auto cpuAttr = config.getAs<StringAttr>("cpu")) {
+        targetOptions.targetCPU = cpuAttr.getValue().str();
+      }
+      if (auto cpuFeaturesAttr = config.getAs<StringAttr>("cpu_features")) {
+        targetOptions.targetCPUFeatures = cpuFeaturesAttr.getValue().str();
+      }
+    }
+    return targetOptions;
+  }
+
+  void initConfiguration() { config_ = computeConfiguration(options_); }
+
+  static AdditionalConfigurationValues computeConfiguration(
+      const LLVMTargetOptions &targetOptions) {
+    AdditionalConfigurationValues config;
+    auto targetMachine = createTargetMachine(targetOptions);
 
     // Data layout
     llvm::DataLayout DL = targetMachine->createDataLayout();
-    config_.dataLayoutStr = DL.getStringRepresentation();
+    config.dataLayoutStr = DL.getStringRepresentation();
 
     // Set the native vector size. This creates a dummy llvm module just to
     // build the TTI the right way.
@@ -763,28 +1089,23 @@ class LLVMCPUTargetBackend final : public TargetBackend {
         llvm::GlobalValue::ExternalLinkage, "dummy_func", *llvmModule);
     llvm::TargetTransformInfo tti =
         targetMachine->getTargetTransformInfo(*dummyFunc);
-    config_.vectorSize = tti.getRegisterBitWidth(
-                             llvm::TargetTransformInfo::RGK_FixedWidthVector) /
-                         8;
+    config.vectorSize = tti.getRegisterBitWidth(
+                            llvm::TargetTransformInfo::RGK_FixedWidthVector) /
+                        8;
     LLVM_DEBUG({
       llvm::dbgs() << "CPU : " << targetMachine->getTargetCPU() << "\n";
       llvm::dbgs() << "Target Triple : "
                    << targetMachine->getTargetTriple().normalize() << "\n";
       llvm::dbgs() << "Target Feature string : "
                    << targetMachine->getTargetFeatureString() << "\n";
-      llvm::dbgs() << "Data Layout : " << config_.dataLayoutStr << "\n";
-      llvm::dbgs() << "Vector Width : " << config_.vectorSize << "\n";
+      llvm::dbgs() << "Data Layout : " << config.dataLayoutStr << "\n";
+      llvm::dbgs() << "Vector Width : " << config.vectorSize << "\n";
     });
+    return config;
   }
 
   LLVMTargetOptions options_;
-
-  // Additional target information besides that is contained in
-  // LLVMTargetOptions options_.
-  struct AdditionalConfigurationValues {
-    std::string dataLayoutStr;
-    int64_t vectorSize;
-  } config_;
+  AdditionalConfigurationValues config_;
 };
 
 void registerLLVMCPUTargetBackends(
@@ -6,8 +6,14 @@
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
 
+#include <atomic>
+
+#include "llvm/ADT/SmallString.h"
 #include "llvm/Analysis/AliasAnalysis.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/PassManager.h"
@@ -18,9 +24,12 @@
 #include "llvm/Support/CodeGen.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Instrumentation/AddressSanitizer.h"
 #include "llvm/Transforms/Instrumentation/ThreadSanitizer.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -128,6 +137,55 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
   return success();
 }
 
+LogicalResult runSplitEmitObjFilePasses(
+    const std::function<std::unique_ptr<llvm::TargetMachine>()> &createMachine,
+    llvm::Module *module, unsigned partitionCount, unsigned threadCount,
+    llvm::SmallVectorImpl<std::string> &objData) {
+  // LLVM contexts cannot be shared across threads so the partitions are
+  // written to bitcode here and each worker reads its partition into its own
+  // context. This is what llvm::splitCodeGen does but that ties the number of
+  // partitions (and thus the output) to the number of threads.
+  llvm::SmallVector<llvm::SmallString<0>> partitions;
+  llvm::SplitModule(
+      *module, partitionCount,
+      [&](std::unique_ptr<llvm::Module> partition) {
+        llvm::raw_svector_ostream os(partitions.emplace_back());
+        llvm::WriteBitcodeToFile(*partition, os);
+      },
+      /*PreserveLocals=*/false);
+
+  objData.clear();
+  objData.resize(partitions.size());
+  std::atomic<bool> anyFailed(false);
+  auto emitPartition = [&](size_t i) {
+    llvm::LLVMContext context;
+    context.setOpaquePointers(false);
+    auto partitionOr = llvm::parseBitcodeFile(
+        llvm::MemoryBufferRef(partitions[i].str(), "<split-module>"), context);
+    if (!partitionOr) {
+      llvm::consumeError(partitionOr.takeError());
+      anyFailed = true;
+      return;
+    }
+    auto machine = createMachine();
+    if (!machine ||
+        failed(runEmitObjFilePasses(machine.get(), partitionOr->get(),
+                                    llvm::CGFT_ObjectFile, &objData[i]))) {
+      anyFailed = true;
+    }
+  };
+  if (threadCount <= 1) {
+    for (size_t i = 0; i < partitions.size(); ++i) emitPartition(i);
+    return failure(anyFailed);
+  }
+  llvm::ThreadPool threadPool(llvm::hardware_concurrency(threadCount));
+  for (size_t i = 0; i < partitions.size(); ++i) {
+    threadPool.async([&, i]() { emitPartition(i); });
+  }
+  threadPool.wait();
+  return failure(anyFailed);
+}
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
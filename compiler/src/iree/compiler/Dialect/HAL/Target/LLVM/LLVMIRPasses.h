@@ -7,9 +7,12 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMIRPASSES_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMIRPASSES_H_
 
+#include <functional>
 #include <memory>
+#include <string>
 
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMTargetOptions.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Target/TargetMachine.h"
 #include "mlir/Support/LogicalResult.h"
@@ -34,6 +37,19 @@ LogicalResult runEmitObjFilePasses(llvm::TargetMachine *machine,
                                    llvm::CodeGenFileType fileType,
                                    std::string *objData);
 
+// Splits |module| into |partitionCount| partitions and emits an object file
+// for each using up to |threadCount| threads. Partitions are emitted on the
+// calling thread when |threadCount| is 1. Each thread creates its own
+// target machine with |createMachine|. The partitioning only depends on the
+// module contents and |partitionCount| such that |objData| is deterministic.
+//
+// Local symbols in |module| are externalized with hidden visibility so that
+// they can be referenced across partitions.
+LogicalResult runSplitEmitObjFilePasses(
+    const std::function<std::unique_ptr<llvm::TargetMachine>()> &createMachine,
+    llvm::Module *module, unsigned partitionCount, unsigned threadCount,
+    llvm::SmallVectorImpl<std::string> &objData);
+
 }  // namespace HAL
 }  // namespace IREE
 }  // namespace iree_compiler
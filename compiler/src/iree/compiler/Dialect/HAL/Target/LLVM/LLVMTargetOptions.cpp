@@ -9,6 +9,7 @@
 #include <mutex>
 
 #include "llvm/ADT/APFloat.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/MC/TargetRegistry.h"
@@ -78,6 +79,16 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
                      "host native CPU"),
       llvm::cl::init(""));
 
+  static llvm::cl::list<std::string> clTargetCPUVariants(
+      "iree-llvm-target-cpu-variant",
+      llvm::cl::desc(
+          "Additional LLVM target machine CPU and features to compile "
+          "executables for and select at runtime based on the processor; "
+          "specified as `cpu[,+feature...]` or `+feature[,+feature...]` and "
+          "may be repeated in order of preference (e.g. `x86-64-v4`, "
+          "`x86-64-v3`, or `+dotprod,+i8mm`)"),
+      llvm::cl::ZeroOrMore);
+
   static llvm::cl::opt<bool> llvmLoopInterleaving(
       "iree-llvm-loop-interleaving", llvm::cl::init(false),
       llvm::cl::desc("Enable LLVM loop interleaving opt"));
@@ -99,6 +110,25 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
   if (clTargetCPUFeatures != "host") {
     targetOptions.targetCPUFeatures = clTargetCPUFeatures;
   }
+  targetOptions.targetCPUVariants.clear();
+  for (llvm::StringRef variantStr : clTargetCPUVariants) {
+    // The CPU name is optional and when omitted the baseline CPU is used.
+    // Variant features are added to the baseline features.
+    LLVMTargetOptions::CPUVariant variant;
+    variant.cpu = targetOptions.targetCPU;
+    if (!variantStr.startswith("+") && !variantStr.startswith("-")) {
+      auto cpuFeatures = variantStr.split(',');
+      variant.cpu = cpuFeatures.first.str();
+      variantStr = cpuFeatures.second;
+    }
+    llvm::SubtargetFeatures features(targetOptions.targetCPUFeatures);
+    llvm::SmallVector<llvm::StringRef> variantFeatures;
+    variantStr.split(variantFeatures, ',', /*MaxSplit=*/-1,
+                     /*KeepEmpty=*/false);
+    for (auto feature : variantFeatures) features.AddFeature(feature);
+    variant.cpuFeatures = features.getString();
+    targetOptions.targetCPUVariants.push_back(std::move(variant));
+  }
 
   // LLVM opt options.
   targetOptions.pipelineTuningOptions.LoopInterleaving = llvmLoopInterleaving;
@@ -7,6 +7,9 @@
 #ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 #define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LLVMTARGETOPTIONS_H_
 
+#include <string>
+#include <vector>
+
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Target/TargetOptions.h"
 
@@ -29,6 +32,16 @@ struct LLVMTargetOptions {
   std::string targetCPU;
   std::string targetCPUFeatures;
 
+  // Additional CPU configurations that executables are compiled for. At runtime
+  // the first variant whose features are all supported by the processor is
+  // used and otherwise the baseline targetCPU/targetCPUFeatures is used.
+  // Variants should be listed in order of preference (most capable first).
+  struct CPUVariant {
+    std::string cpu;
+    std::string cpuFeatures;
+  };
+  std::vector<CPUVariant> targetCPUVariants;
+
   llvm::PipelineTuningOptions pipelineTuningOptions;
   // Optimization level to be used by the LLVM optimizer (middle-end).
   llvm::OptimizationLevel optimizerOptLevel;
@@ -124,6 +124,27 @@ static llvm::StructType *makeDispatchAttrsType(llvm::LLVMContext &context) {
   return type;
 }
 
+// %struct.iree_hal_executable_dispatch_hints_v0_t = type {
+//   i64,
+//   i64
+// }
+static llvm::StructType *makeDispatchHintsType(llvm::LLVMContext &context) {
+  if (auto *existingType = llvm::StructType::getTypeByName(
+          context, "iree_hal_executable_dispatch_hints_v0_t")) {
+    return existingType;
+  }
+  auto *i64Type = llvm::IntegerType::getInt64Ty(context);
+  auto *type =
+      llvm::StructType::create(context,
+                               {
+                                   i64Type,
+                                   i64Type,
+                               },
+                               "iree_hal_executable_dispatch_hints_v0_t",
+                               /*isPacked=*/false);
+  return type;
+}
+
 // %struct.iree_hal_executable_src_loc_v0_t = type {
 //   i32,
 //   i32,
@@ -228,6 +249,8 @@ static llvm::StructType *makeLibraryHeaderType(llvm::LLVMContext &context) {
 //   %struct.iree_hal_executable_library_header_t*,
 //   %struct.iree_hal_executable_import_table_v0_t,
 //   %struct.iree_hal_executable_export_table_v0_t,
+//   %struct.iree_hal_executable_constant_table_v0_t,
+//   %struct.iree_hal_executable_dispatch_hints_v0_t*,
 // }
 static llvm::StructType *makeLibraryType(llvm::StructType *libraryHeaderType) {
   auto &context = libraryHeaderType->getContext();
@@ -238,12 +261,14 @@ static llvm::StructType *makeLibraryType(llvm::StructType *libraryHeaderType) {
   auto *importTableType = makeImportTableType(context);
   auto *exportTableType = makeExportTableType(context);
   auto *constantTableType = makeConstantTableType(context);
+  auto *dispatchHintsType = makeDispatchHintsType(context);
   auto *type = llvm::StructType::create(context,
                                         {
                                             libraryHeaderType->getPointerTo(),
                                             importTableType,
                                             exportTableType,
                                             constantTableType,
+                                            dispatchHintsType->getPointerTo(),
                                         },
                                         "iree_hal_executable_library_v0_t",
                                         /*isPacked=*/false);
@@ -389,7 +414,7 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
       llvm::find_if(exports, [](const Dispatch &dispatch) {
         return !dispatch.attrs.isDefault();
       }) != exports.end();
-  if (!hasNonDefaultAttrs) {
+  if (hasNonDefaultAttrs) {
     SmallVector<llvm::Constant *, 4> exportAttrValues;
     for (auto dispatch : exports) {
       exportAttrValues.push_back(llvm::ConstantStruct::get(
@@ -400,7 +425,7 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ExportTable(
                   i16Type, RoundUpToAlignment(dispatch.attrs.localMemorySize,
                                               kWorkgroupLocalMemoryPageSize) /
                                kWorkgroupLocalMemoryPageSize),
-              // reserved=
+              // worker_scratch_pages= (only used by hand-authored libraries)
               llvm::ConstantInt::get(i16Type, 0),
           }));
     }
@@ -515,12 +540,57 @@ llvm::Constant *LibraryBuilder::buildLibraryV0ConstantTable(
                          });
 }
 
+llvm::Constant *LibraryBuilder::buildLibraryV0ExportHints(
+    std::string libraryName) {
+  auto &context = module->getContext();
+  auto *dispatchHintsType = makeDispatchHintsType(context);
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  auto *i64Type = llvm::IntegerType::getInt64Ty(context);
+  llvm::Constant *zero = llvm::ConstantInt::get(i32Type, 0);
+
+  // Omit the table entirely if no exports have hints; the feature bit will not
+  // be set and the runtime will not read the field.
+  bool hasHints = llvm::find_if(exports, [](const Dispatch &dispatch) {
+                    return dispatch.attrs.hasHints();
+                  }) != exports.end();
+  if (!hasHints) {
+    return llvm::Constant::getNullValue(dispatchHintsType->getPointerTo());
+  }
+
+  SmallVector<llvm::Constant *, 4> exportHintValues;
+  for (auto dispatch : exports) {
+    exportHintValues.push_back(llvm::ConstantStruct::get(
+        dispatchHintsType,
+        {
+            // streamed_bindings=
+            llvm::ConstantInt::get(i64Type, dispatch.attrs.streamedBindings),
+            // reused_bindings=
+            llvm::ConstantInt::get(i64Type, dispatch.attrs.reusedBindings),
+        }));
+  }
+  auto *exportHintsType =
+      llvm::ArrayType::get(dispatchHintsType, exportHintValues.size());
+  auto *global = new llvm::GlobalVariable(
+      *module, exportHintsType, /*isConstant=*/true,
+      llvm::GlobalVariable::PrivateLinkage,
+      llvm::ConstantArray::get(exportHintsType, exportHintValues),
+      /*Name=*/libraryName + "_hints");
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(
+      exportHintsType, global, ArrayRef<llvm::Constant *>{zero, zero});
+}
+
 llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
   auto &context = module->getContext();
   auto *libraryHeaderType = makeLibraryHeaderType(context);
   auto *libraryType = makeLibraryType(libraryHeaderType);
   auto *i32Type = llvm::IntegerType::getInt32Ty(context);
 
+  // Hints are an optional trailing field that must be declared in the header.
+  auto *exportHints = buildLibraryV0ExportHints(libraryName);
+  if (!exportHints->isNullValue()) {
+    addRequiredFeature(Features::DISPATCH_HINTS);
+  }
+
   // ----- Header -----
 
   auto *libraryHeader = new llvm::GlobalVariable(
@@ -558,6 +628,8 @@ llvm::Constant *LibraryBuilder::buildLibraryV0(std::string libraryName) {
                                     buildLibraryV0ExportTable(libraryName),
                                     // constants=
                                     buildLibraryV0ConstantTable(libraryName),
+                                    // export_hints=
+                                    exportHints,
                                 }),
       /*Name=*/libraryName);
   // TODO(benvanik): force alignment (8? natural pointer width?)
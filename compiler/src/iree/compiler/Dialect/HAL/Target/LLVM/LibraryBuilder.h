@@ -59,6 +59,8 @@ class LibraryBuilder {
   enum class Features : uint32_t {
     // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE
     NONE = 0u,
+    // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_DISPATCH_HINTS
+    DISPATCH_HINTS = 1u << 0,
   };
 
   // iree_hal_executable_library_sanitizer_kind_t
@@ -78,13 +80,25 @@ class LibraryBuilder {
   // IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
   static const int64_t kWorkgroupLocalMemoryPageSize = 4096;
 
-  // iree_hal_executable_dispatch_attrs_v0_t
+  // iree_hal_executable_dispatch_attrs_v0_t and
+  // iree_hal_executable_dispatch_hints_v0_t
   struct DispatchAttrs {
     // Required workgroup local memory size, in bytes.
     int64_t localMemorySize = 0;
 
+    // Bitmask of binding ordinals streamed across workgroups.
+    uint64_t streamedBindings = 0;
+    // Bitmask of binding ordinals reused by all workgroups.
+    uint64_t reusedBindings = 0;
+
     // True if all values are default and the attributes may be omitted.
-    constexpr bool isDefault() const { return localMemorySize == 0; }
+    constexpr bool isDefault() const {
+      return localMemorySize == 0;
+    }
+    // True if any binding access hints are specified.
+    constexpr bool hasHints() const {
+      return streamedBindings != 0 || reusedBindings != 0;
+    }
   };
 
   LibraryBuilder(llvm::Module *module, Mode mode,
@@ -136,6 +150,7 @@ class LibraryBuilder {
   llvm::Constant *buildLibraryV0ImportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ExportTable(std::string libraryName);
   llvm::Constant *buildLibraryV0ConstantTable(std::string libraryName);
+  llvm::Constant *buildLibraryV0ExportHints(std::string libraryName);
 
   llvm::Module *module = nullptr;
   Mode mode = Mode::INCLUDE_REFLECTION_ATTRS;
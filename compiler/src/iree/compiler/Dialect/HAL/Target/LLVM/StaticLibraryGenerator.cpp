@@ -30,6 +30,7 @@ static void generatePrefix(llvm::raw_ostream &os,
      << "//  - At runtime: retrieve library name from host binary \n"
      << "//  - Query library from " << query_function_name << "()<< \n"
      << "//  - Feed library into static_library_loader \n"
+     << "//    (or add the registry entry to a lazily queried registry) \n"
      << "//\n"
      << "// === Automatically generated file. DO NOT EDIT! === \n\n";
 
@@ -58,6 +59,18 @@ static void generateQueryFunction(llvm::raw_ostream &os,
         "iree_hal_executable_environment_v0_t* environment);\n";
 }
 
+static void generateRegistryEntry(llvm::raw_ostream &os,
+                                  const std::string &library_name,
+                                  const std::string &query_function_name) {
+  // Initializer for an iree_hal_static_library_registry_entry_t allowing
+  // the library to be lazily loaded by name from a registry.
+  llvm::StringRef ref(library_name);
+  os << "\n// Registry entry for "
+        "iree_hal_static_library_loader_create_from_registry.\n"
+     << "#define IREE_STATIC_LIBRARY_" << ref.upper() << "_REGISTRY_ENTRY \\\n"
+     << "  {\"" << library_name << "\", " << query_function_name << "}\n";
+}
+
 static void generateSuffix(llvm::raw_ostream &os,
                            const std::string &library_name,
                            const std::string &query_function_name) {
@@ -80,6 +93,7 @@ static bool generateExecutableLibraryHeader(
 
   generatePrefix(os, library_name, query_function_name);
   generateQueryFunction(os, library_name, query_function_name);
+  generateRegistryEntry(os, library_name, query_function_name);
   generateSuffix(os, library_name, query_function_name);
 
   os.close();
@@ -0,0 +1,46 @@
+// RUN: iree-opt --pass-pipeline='iree-hal-assign-target-devices{targets=llvm-cpu}' \
+// RUN:     --iree-llvm-target-triple=x86_64-unknown-linux-gnu \
+// RUN:     --iree-llvm-target-cpu-variant=x86-64-v3 \
+// RUN:     --iree-llvm-target-cpu-variant=+avx2,+fma %s | \
+// RUN: FileCheck %s --check-prefix=X86
+// RUN: iree-opt --pass-pipeline='iree-hal-assign-target-devices{targets=llvm-cpu}' \
+// RUN:     --iree-llvm-target-triple=aarch64-unknown-linux-gnu \
+// RUN:     --iree-llvm-target-cpu-variant=+dotprod,+i8mm %s | \
+// RUN: FileCheck %s --check-prefix=ARM64
+// RUN: not iree-opt --pass-pipeline='iree-hal-assign-target-devices{targets=llvm-cpu}' \
+// RUN:     --iree-llvm-target-triple=x86_64-unknown-linux-gnu \
+// RUN:     --iree-llvm-target-cpu-variant=+avx2,+avx512vbmi %s 2>&1 | \
+// RUN: FileCheck %s --check-prefix=X86-UNQUERYABLE-FEATURE
+// RUN: not iree-opt --pass-pipeline='iree-hal-assign-target-devices{targets=llvm-cpu}' \
+// RUN:     --iree-llvm-target-triple=x86_64-unknown-linux-gnu \
+// RUN:     --iree-llvm-target-cpu-variant=skylake-avx512 %s 2>&1 | \
+// RUN: FileCheck %s --check-prefix=X86-UNQUERYABLE-CPU
+// RUN: not iree-opt --pass-pipeline='iree-hal-assign-target-devices{targets=llvm-cpu}' \
+// RUN:     --iree-llvm-target-triple=aarch64-unknown-linux-gnu \
+// RUN:     --iree-llvm-target-cpu-variant=+sve %s 2>&1 | \
+// RUN: FileCheck %s --check-prefix=ARM64-UNQUERYABLE-FEATURE
+
+// Each variant becomes an executable target ahead of the baseline that records
+// the runtime-queryable features it requires beyond the baseline.
+
+//  X86-DAG: #[[V3:[a-z0-9_]+]] = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {cpu = "x86-64-v3", cpu_features = "", {{.+}}, match_cpu_features = ["sse3", "ssse3", "sse4.1", "sse4.2", "popcnt", "cx16", "sahf", "avx", "avx2", "fma", "f16c", "bmi", "bmi2", "lzcnt", "movbe", "xsave"], native_vector_size = 32 : index
+//  X86-DAG: #[[AVX2:[a-z0-9_]+]] = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {cpu = "generic", cpu_features = "+avx2,+fma", {{.+}}, match_cpu_features = ["sse3", "ssse3", "sse4.1", "sse4.2", "avx", "avx2", "fma"], native_vector_size = 32 : index
+//  X86-DAG: #[[BASELINE:[a-z0-9_]+]] = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {cpu_features = "", data_layout = {{.+}}, native_vector_size = 16 : index
+//      X86: executable_targets = [#[[V3]], #[[AVX2]], #[[BASELINE]]]
+
+//  ARM64-DAG: #[[DOTPROD:[a-z0-9_]+]] = #hal.executable.target<"llvm-cpu", "embedded-elf-arm_64", {cpu = "generic", cpu_features = "+dotprod,+i8mm", {{.+}}, match_cpu_features = ["dotprod", "i8mm"]
+//  ARM64-DAG: #[[BASELINE:[a-z0-9_]+]] = #hal.executable.target<"llvm-cpu", "embedded-elf-arm_64", {cpu_features = "", data_layout
+//      ARM64: executable_targets = [#[[DOTPROD]], #[[BASELINE]]]
+
+// Variants enabling anything the runtime cannot query would be selected on
+// processors that lack it and are rejected.
+
+// X86-UNQUERYABLE-FEATURE: error: CPU variant feature '+avx512vbmi' cannot be queried at runtime
+// X86-UNQUERYABLE-CPU: error: CPU variant 'skylake-avx512' cannot be selected at runtime
+// ARM64-UNQUERYABLE-FEATURE: error: CPU variant feature '+sve' cannot be queried at runtime
+
+module {
+  func.func @fn() {
+    return
+  }
+}
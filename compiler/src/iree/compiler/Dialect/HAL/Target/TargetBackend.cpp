@@ -7,11 +7,14 @@
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
 
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "mlir/IR/Dialect.h"
 #include "mlir/Support/FileUtilities.h"
@@ -51,6 +54,14 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
                      "(- for stdout)."),
       llvm::cl::cat(halTargetOptionsCategory));
 
+  binder.opt<bool>(
+      "iree-hal-dump-executable-benchmarks-combined",
+      executableBenchmarksCombined,
+      llvm::cl::desc("Writes all executable benchmarks into a single module "
+                     "that can be compiled and run with "
+                     "iree-benchmark-executables."),
+      llvm::cl::cat(halTargetOptionsCategory));
+
   binder.opt<std::string>("iree-hal-dump-executable-intermediates-to",
                           executableIntermediatesPath,
                           llvm::cl::desc("Path to write translated executable "
@@ -62,6 +73,69 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-dir", executableCachePath,
+      llvm::cl::desc("Directory of a persistent cache of translated and "
+                     "serialized executables that is reused across "
+                     "compilations and models."),
+      llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<int>(
+      "iree-hal-executable-parallelism", executableParallelism,
+      llvm::cl::desc("Maximum number of threads used to translate and "
+                     "serialize executables, including threads generating "
+                     "code within an executable (0 for all hardware "
+                     "threads)."),
+      llvm::cl::cat(halTargetOptionsCategory));
+}
+
+namespace {
+struct ExecutableThreadBudget {
+  std::mutex mutex;
+  std::condition_variable released;
+  int heldSlots = 0;
+};
+}  // namespace
+
+static ExecutableThreadBudget &getExecutableThreadBudget() {
+  static ExecutableThreadBudget budget;
+  return budget;
+}
+
+static int resolveExecutableThreadLimit(int limit) {
+  if (limit > 0) return limit;
+  return std::max(1u, llvm::hardware_concurrency().compute_thread_count());
+}
+
+// static
+ExecutableThreadSlots ExecutableThreadSlots::acquire(int limit) {
+  limit = resolveExecutableThreadLimit(limit);
+  auto &budget = getExecutableThreadBudget();
+  std::unique_lock<std::mutex> lock(budget.mutex);
+  budget.released.wait(lock, [&]() { return budget.heldSlots < limit; });
+  ++budget.heldSlots;
+  return ExecutableThreadSlots(1);
+}
+
+// static
+ExecutableThreadSlots ExecutableThreadSlots::tryAcquire(int limit, int count) {
+  limit = resolveExecutableThreadLimit(limit);
+  auto &budget = getExecutableThreadBudget();
+  std::lock_guard<std::mutex> lock(budget.mutex);
+  int acquired = std::max(0, std::min(count, limit - budget.heldSlots));
+  budget.heldSlots += acquired;
+  return ExecutableThreadSlots(acquired);
+}
+
+ExecutableThreadSlots::~ExecutableThreadSlots() {
+  if (!count) return;
+  auto &budget = getExecutableThreadBudget();
+  {
+    std::lock_guard<std::mutex> lock(budget.mutex);
+    budget.heldSlots -= count;
+  }
+  budget.released.notify_all();
 }
 
 // Renames |op| within |moduleOp| with a new name that is unique within both
@@ -225,7 +299,7 @@ LogicalResult TargetBackend::linkExecutablesInto(
     IREE::HAL::ExecutableOp linkedExecutableOp,
     IREE::HAL::ExecutableVariantOp linkedTargetOp,
     std::function<Operation *(mlir::ModuleOp moduleOp)> getInnerModuleFn,
-    OpBuilder &builder) {
+    OpBuilder &builder, bool matchLinkedTarget) {
   int nextEntryPointOrdinal = 0;
   DenseMap<StringRef, Operation *> targetSymbolMap;
   SymbolReplacements symbolReplacements;
@@ -245,6 +319,10 @@ LogicalResult TargetBackend::linkExecutablesInto(
     for (auto variantOp : variantOps) {
       // Only process targets matching our pattern.
       if (variantOp.getTarget().getBackend().getValue() != name()) continue;
+      if (matchLinkedTarget &&
+          variantOp.getTarget() != linkedTargetOp.getTarget()) {
+        continue;
+      }
 
       // Remap variant refs.
       auto oldVariantRefAttr =
@@ -298,7 +376,9 @@ LogicalResult TargetBackend::linkExecutablesInto(
   // Remove if we didn't add anything.
   if (linkedTargetOp.getOps<IREE::HAL::ExecutableExportOp>().empty()) {
     linkedTargetOp.erase();
-    linkedExecutableOp.erase();
+    if (linkedExecutableOp.getOps<IREE::HAL::ExecutableVariantOp>().empty()) {
+      linkedExecutableOp.erase();
+    }
   }
 
   return success();
@@ -15,6 +15,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Utils/DeviceSwitchBuilder.h"
 #include "iree/compiler/Utils/OptionUtils.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "mlir/IR/Dialect.h"
@@ -45,6 +46,8 @@ struct TargetOptions {
 
   // A path to write standalone executable benchmarks into.
   std::string executableBenchmarksPath;
+  // Whether to write all executable benchmarks into a single module.
+  bool executableBenchmarksCombined = false;
 
   // A path to write executable intermediates into.
   std::string executableIntermediatesPath;
@@ -52,10 +55,53 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A path to a persistent cache of translated and serialized executables
+  // shared across compilations. Disabled if empty.
+  std::string executableCachePath;
+
+  // Maximum number of threads used to translate and serialize executables,
+  // including threads used within a single executable. 0 uses all hardware
+  // threads. See ExecutableThreadSlots.
+  int executableParallelism = 0;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
 
+// Slots of the process-wide budget of threads translating and serializing
+// executables. The budget is independent of the MLIRContext thread pool such
+// that TargetOptions::executableParallelism holds no matter who created the
+// context (such as when compiling through the API).
+//
+// Each executable translation or serialization holds one slot while it runs.
+// Backends may borrow more slots for work within a single executable but only
+// those immediately available: nested work never exceeds the budget and never
+// waits on slots held by other executables.
+class ExecutableThreadSlots {
+ public:
+  // Blocks until fewer than |limit| slots are held and acquires one.
+  // A |limit| of 0 uses the number of hardware threads.
+  static ExecutableThreadSlots acquire(int limit);
+
+  // Acquires up to |count| slots that are available without blocking.
+  static ExecutableThreadSlots tryAcquire(int limit, int count);
+
+  ExecutableThreadSlots(ExecutableThreadSlots &&other) : count(other.count) {
+    other.count = 0;
+  }
+  ExecutableThreadSlots(const ExecutableThreadSlots &) = delete;
+  ExecutableThreadSlots &operator=(const ExecutableThreadSlots &) = delete;
+  ~ExecutableThreadSlots();
+
+  // Number of slots held.
+  int getCount() const { return count; }
+
+ private:
+  explicit ExecutableThreadSlots(int count) : count(count) {}
+
+  int count = 0;
+};
+
 // HAL executable target backend interface.
 // Multiple backends can be registered and targeted during a single compilation.
 // The flow->hal conversion process will use registered TargetBackend interfaces
@@ -132,6 +178,7 @@ class TargetBackend {
   virtual void getDependentDialects(DialectRegistry &registry) const {}
 
   // Returns the default device this backend targets.
+  // Returns nullptr after emitting an error if the backend is misconfigured.
   virtual IREE::HAL::DeviceTargetAttr getDefaultDeviceTarget(
       MLIRContext *context) const = 0;
 
@@ -168,6 +215,15 @@ class TargetBackend {
   //   }
   virtual void buildTranslationPassPipeline(OpPassManager &passManager) = 0;
 
+  // Returns a string covering all backend configuration that influences the
+  // translation and serialization of executables (such as optimization levels
+  // and linker options not captured by the executable target attributes) or
+  // None if the results cannot be reused by other compilations. Only backends
+  // returning a key participate in --iree-hal-executable-cache-dir.
+  virtual Optional<std::string> getExecutableCacheKey() const {
+    return llvm::None;
+  }
+
   // Links compatible executables within the provided |moduleOp| together into
   // zero or more new linked executables. Implementations should move
   // executable contents (including interfaces, entry points, and functions)
@@ -221,6 +277,8 @@ class TargetBackend {
     std::string dumpIntermediatesPath;
     // Optional path to write serialized binary results into.
     std::string dumpBinariesPath;
+    // Limit of ExecutableThreadSlots used when borrowing threads.
+    int executableParallelism = 0;
   };
 
   // Serializes the given |variantOp| executable produced by this backend to one
@@ -240,13 +298,16 @@ class TargetBackend {
  protected:
   // Links all executables for the current target found in |moduleOp| into
   // |linkedExecutableOp|. Functions will be cloned into |linkedModuleOp|.
+  // If |matchLinkedTarget| is true only source variants with the same target
+  // as |linkedTargetOp| are linked; this allows backends producing multiple
+  // variants of the same format to link each independently.
   LogicalResult linkExecutablesInto(
       mlir::ModuleOp moduleOp,
       ArrayRef<IREE::HAL::ExecutableOp> sourceExecutableOps,
       IREE::HAL::ExecutableOp linkedExecutableOp,
       IREE::HAL::ExecutableVariantOp linkedTargetOp,
       std::function<Operation *(mlir::ModuleOp moduleOp)> getInnerModuleFn,
-      OpBuilder &builder);
+      OpBuilder &builder, bool matchLinkedTarget = false);
 };
 
 // Dumps binary data to a file formed by joining the given path components:
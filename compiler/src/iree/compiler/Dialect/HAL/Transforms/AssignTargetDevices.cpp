@@ -83,6 +83,11 @@ class AssignTargetDevicesPass
       // Ask the target backend for its default device specification attribute.
       auto targetAttr =
           targetBackend->getDefaultDeviceTarget(moduleOp.getContext());
+      if (!targetAttr) {
+        // The backend will have emitted an error describing why.
+        signalPassFailure();
+        return;
+      }
       targetAttrs.push_back(targetAttr);
     }
 
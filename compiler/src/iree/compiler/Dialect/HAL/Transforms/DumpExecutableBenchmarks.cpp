@@ -15,6 +15,7 @@
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
@@ -119,6 +120,40 @@ static DispatchParamsMap gatherDispatchParams(mlir::ModuleOp moduleOp) {
   return map;
 }
 
+// Estimates the number of arithmetic operations performed by one dispatch of
+// |exportOp| by summing the iteration space of each linalg op in the export
+// function multiplied by the number of scalar ops in its body. This is
+// intentionally coarse (a matmul counts as 2*M*N*K) and only used to report
+// throughput in benchmark tools. Returns None if any op has a dynamic shape or
+// the export contains no linalg ops.
+static Optional<int64_t> estimateExportFlops(
+    IREE::HAL::ExecutableVariantOp variantOp,
+    IREE::HAL::ExecutableExportOp exportOp) {
+  auto innerModuleOp = variantOp.getInnerModule();
+  if (!innerModuleOp) return None;
+  auto funcOp = innerModuleOp.lookupSymbol<FunctionOpInterface>(
+      exportOp.getName());
+  if (!funcOp) return None;
+  int64_t totalFlops = 0;
+  bool hasAnyOps = false;
+  auto walkResult = funcOp->walk([&](linalg::LinalgOp linalgOp) {
+    if (linalgOp.hasDynamicShape()) return WalkResult::interrupt();
+    int64_t iterations = 1;
+    for (auto loopRange : linalgOp.getStaticLoopRanges()) {
+      iterations *= loopRange;
+    }
+    int64_t opsPerIteration = 0;
+    for (auto &op : linalgOp->getRegion(0).getOps()) {
+      if (!isa<linalg::YieldOp>(op)) ++opsPerIteration;
+    }
+    totalFlops += iterations * opsPerIteration;
+    hasAnyOps = true;
+    return WalkResult::advance();
+  });
+  if (walkResult.wasInterrupted() || !hasAnyOps) return None;
+  return totalFlops;
+}
+
 // Appends a global hal.buffer initialized to the size required for all
 // of the bindings in |dispatchParams| (plus alignment).
 static IREE::Util::GlobalOp appendGlobalBuffer(
@@ -158,6 +193,37 @@ static IREE::Util::GlobalOp appendGlobalBuffer(
 
   initBuilder.create<IREE::Util::GlobalStoreOp>(loc, allocateOp.getResult(),
                                                 globalOp.getNameAttr());
+
+  // Zero the buffer so that dispatches don't run on whatever garbage the
+  // allocator returned: NaNs and denormals can drastically change timings.
+  auto commandBuffer =
+      initBuilder
+          .create<IREE::HAL::CommandBufferCreateOp>(
+              loc, initBuilder.getType<IREE::HAL::CommandBufferType>(), device,
+              IREE::HAL::CommandBufferModeBitfield::OneShot |
+                  IREE::HAL::CommandBufferModeBitfield::AllowInlineExecution,
+              IREE::HAL::CommandCategoryBitfield::Transfer,
+              /*binding_capacity=*/Value{})
+          .getResult();
+  initBuilder.create<IREE::HAL::CommandBufferFillBufferOp>(
+      loc, commandBuffer, allocateOp.getResult(), indexSet.get(0),
+      indexSet.get(totalLength),
+      initBuilder.create<arith::ConstantIntOp>(loc, 0, 32));
+  initBuilder.create<IREE::HAL::CommandBufferFinalizeOp>(loc, commandBuffer);
+  Value waitFence = initBuilder.create<IREE::Util::NullOp>(
+      loc, initBuilder.getType<IREE::HAL::FenceType>());
+  Value signalFence = initBuilder.create<IREE::HAL::FenceCreateOp>(
+      loc, initBuilder.getType<IREE::HAL::FenceType>(), device,
+      IREE::HAL::FenceFlagBitfield::None);
+  initBuilder.create<IREE::HAL::DeviceQueueExecuteOp>(
+      loc, device, initBuilder.create<arith::ConstantIntOp>(loc, -1, 64),
+      waitFence, signalFence, ValueRange{commandBuffer});
+  auto fenceOp = initBuilder.create<IREE::HAL::FenceAwaitOp>(
+      loc, initBuilder.getI32Type(),
+      initBuilder.create<arith::ConstantIntOp>(loc, -1, 32), signalFence);
+  initBuilder.create<IREE::Util::StatusCheckOkOp>(
+      loc, fenceOp.getStatus(), "failed to initialize benchmark buffer");
+
   initBuilder.create<IREE::Util::InitializerReturnOp>(loc);
 
   return globalOp;
@@ -175,15 +241,17 @@ static void appendDispatchBenchmark(IREE::HAL::ExecutableOp executableOp,
                                     OpBuilder &moduleBuilder) {
   auto loc = FusedLoc::get(executableOp.getContext(), dispatchParams.locs);
 
-  std::string baseName = (executableOp.getName() + "_" + variantOp.getName() +
-                          "_" + exportOp.getName())
-                             .str();
+  std::string workloadStr;
   if (!dispatchParams.workload.empty()) {
-    baseName += "_" + std::to_string(dispatchParams.workload[0]);
+    workloadStr = std::to_string(dispatchParams.workload[0]);
     for (size_t i = 1; i < dispatchParams.workload.size(); ++i) {
-      baseName += "x" + std::to_string(dispatchParams.workload[i]);
+      workloadStr += "x" + std::to_string(dispatchParams.workload[i]);
     }
   }
+  std::string baseName = (executableOp.getName() + "_" + variantOp.getName() +
+                          "_" + exportOp.getName())
+                             .str();
+  if (!workloadStr.empty()) baseName += "_" + workloadStr;
 
   // Add a global variable holding an initialized buffer for the dispatch IO.
   auto bufferGlobalOp =
@@ -197,13 +265,36 @@ static void appendDispatchBenchmark(IREE::HAL::ExecutableOp executableOp,
 
   // Mark the function as being a dispatch benchmark.
   // This tells iree-benchmark-module to pass in the arguments we need.
+  // The additional entries describe the dispatch so that tools such as
+  // iree-benchmark-executables can report throughput; values are strings as
+  // that is all the VM reflection data supports.
+  int64_t totalBindingBytes = 0;
+  for (auto binding : dispatchParams.bindings) {
+    totalBindingBytes += binding.size;
+  }
+  SmallVector<NamedAttribute> reflectionAttrs = {
+      moduleBuilder.getNamedAttr("iree.benchmark",
+                                 moduleBuilder.getStringAttr("dispatch")),
+      moduleBuilder.getNamedAttr(
+          "iree.benchmark.export",
+          moduleBuilder.getStringAttr(
+              (executableOp.getName() + "::" + variantOp.getName() +
+               "::" + exportOp.getName())
+                  .str())),
+      moduleBuilder.getNamedAttr("iree.benchmark.workload",
+                                 moduleBuilder.getStringAttr(workloadStr)),
+      moduleBuilder.getNamedAttr(
+          "iree.benchmark.bytes",
+          moduleBuilder.getStringAttr(std::to_string(totalBindingBytes))),
+  };
+  if (auto flops = estimateExportFlops(variantOp, exportOp)) {
+    reflectionAttrs.push_back(moduleBuilder.getNamedAttr(
+        "iree.benchmark.flops",
+        moduleBuilder.getStringAttr(std::to_string(*flops))));
+  }
   funcOp->setAttr("iree.abi.stub", moduleBuilder.getUnitAttr());
-  funcOp->setAttr(
-      "iree.reflection",
-      moduleBuilder.getDictionaryAttr({
-          moduleBuilder.getNamedAttr("iree.benchmark",
-                                     moduleBuilder.getStringAttr("dispatch")),
-      }));
+  funcOp->setAttr("iree.reflection",
+                  moduleBuilder.getDictionaryAttr(reflectionAttrs));
 
   // Build the function that runs the dispatches.
   auto *entryBlock = funcOp.addEntryBlock();
@@ -343,31 +434,46 @@ static void appendDispatchBenchmark(IREE::HAL::ExecutableOp executableOp,
   funcBuilder.create<mlir::func::ReturnOp>(loc);
 }
 
-// Builds a module exporting one function for each dispatch configuration
-// targeting |sourceExecutableOp|.
-static mlir::OwningOpRef<mlir::ModuleOp> buildBenchmarkModule(
-    IREE::HAL::ExecutableOp sourceExecutableOp,
-    IREE::HAL::ExecutableVariantOp sourceVariantOp,
-    const DispatchParamsMap &dispatchParamsMap) {
+// Creates an empty benchmark module using the device targets of
+// |sourceModuleOp|.
+static mlir::OwningOpRef<mlir::ModuleOp> createBenchmarkModule(
+    mlir::ModuleOp sourceModuleOp) {
   // Empty module with default name.
   // We could use the original module name here to make tracking nicer.
   mlir::OwningOpRef<mlir::ModuleOp> moduleOp =
-      mlir::ModuleOp::create(sourceExecutableOp.getLoc());
-  auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp->getBody());
+      mlir::ModuleOp::create(sourceModuleOp.getLoc());
 
   // Copy over the device targets from the original module.
   // TODO(benvanik): filter this by the target of the variant.
   moduleOp->getOperation()->setAttr(
-      "hal.device.targets",
-      sourceExecutableOp->getParentOfType<mlir::ModuleOp>()->getAttr(
-          "hal.device.targets"));
+      "hal.device.targets", sourceModuleOp->getAttr("hal.device.targets"));
+
+  return moduleOp;
+}
+
+// Appends |sourceVariantOp| of |sourceExecutableOp| to |moduleOp| along with
+// one exported function for each dispatch configuration targeting it.
+// Multiple variants of the same executable share a single hal.executable.
+// Returns false and leaves |moduleOp| unmodified if no benchmarks could be
+// generated.
+static bool appendExecutableBenchmarks(
+    mlir::ModuleOp moduleOp, IREE::HAL::ExecutableOp sourceExecutableOp,
+    IREE::HAL::ExecutableVariantOp sourceVariantOp,
+    const DispatchParamsMap &dispatchParamsMap) {
+  auto moduleBuilder = OpBuilder::atBlockEnd(moduleOp.getBody());
 
   // Clone the executable variant into the new module.
-  auto executableOp = moduleBuilder.create<IREE::HAL::ExecutableOp>(
-      sourceExecutableOp.getLoc(), sourceExecutableOp.getName());
-  executableOp.setVisibility(sourceExecutableOp.getVisibility());
+  auto executableOp = moduleOp.lookupSymbol<IREE::HAL::ExecutableOp>(
+      sourceExecutableOp.getName());
+  bool createdExecutable = false;
+  if (!executableOp) {
+    executableOp = moduleBuilder.create<IREE::HAL::ExecutableOp>(
+        sourceExecutableOp.getLoc(), sourceExecutableOp.getName());
+    executableOp.setVisibility(sourceExecutableOp.getVisibility());
+    createdExecutable = true;
+  }
   auto variantOp = cast<IREE::HAL::ExecutableVariantOp>(
-      OpBuilder::atBlockBegin(&executableOp.getBlock())
+      OpBuilder::atBlockTerminator(&executableOp.getBlock())
           .clone(*sourceVariantOp.getOperation()));
 
   // Add functions to test each entry point with its various dispatch
@@ -387,18 +493,64 @@ static mlir::OwningOpRef<mlir::ModuleOp> buildBenchmarkModule(
     }
   }
 
-  // Skip the file when we could not generate any benchmarks.
-  if (!hasAnyBenchmarks) return {};
+  // Drop the variant when we could not generate any benchmarks.
+  if (!hasAnyBenchmarks) {
+    variantOp.erase();
+    if (createdExecutable) executableOp.erase();
+  }
+  return hasAnyBenchmarks;
+}
 
-  // Run CSE and the canonicalizer to pretty up the output.
+// Runs CSE and the canonicalizer to pretty up the output.
+static LogicalResult cleanupBenchmarkModule(mlir::ModuleOp moduleOp) {
   PassManager passManager(moduleOp->getContext());
   passManager.addPass(mlir::createCanonicalizerPass());
   passManager.addPass(mlir::createCSEPass());
-  if (failed(passManager.run(*moduleOp))) {
+  if (failed(passManager.run(moduleOp))) {
     moduleOp->emitError("failed to run canonicalizer; malformed output");
+    return failure();
+  }
+  return success();
+}
+
+// Builds a module exporting one function for each dispatch configuration
+// targeting |sourceExecutableOp|.
+static mlir::OwningOpRef<mlir::ModuleOp> buildBenchmarkModule(
+    IREE::HAL::ExecutableOp sourceExecutableOp,
+    IREE::HAL::ExecutableVariantOp sourceVariantOp,
+    const DispatchParamsMap &dispatchParamsMap) {
+  auto moduleOp = createBenchmarkModule(
+      sourceExecutableOp->getParentOfType<mlir::ModuleOp>());
+
+  // Skip the file when we could not generate any benchmarks.
+  if (!appendExecutableBenchmarks(*moduleOp, sourceExecutableOp,
+                                  sourceVariantOp, dispatchParamsMap)) {
     return {};
   }
 
+  if (failed(cleanupBenchmarkModule(*moduleOp))) return {};
+  return moduleOp;
+}
+
+// Builds a single module exporting one function for each dispatch
+// configuration of every executable variant in |sourceModuleOp|. This can be
+// compiled into one .vmfb and run with iree-benchmark-executables to measure
+// all dispatches of a program at once.
+static mlir::OwningOpRef<mlir::ModuleOp> buildCombinedBenchmarkModule(
+    mlir::ModuleOp sourceModuleOp, const DispatchParamsMap &dispatchParamsMap) {
+  auto moduleOp = createBenchmarkModule(sourceModuleOp);
+
+  bool hasAnyBenchmarks = false;
+  for (auto executableOp : sourceModuleOp.getOps<IREE::HAL::ExecutableOp>()) {
+    for (auto variantOp :
+         executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+      hasAnyBenchmarks |= appendExecutableBenchmarks(
+          *moduleOp, executableOp, variantOp, dispatchParamsMap);
+    }
+  }
+  if (!hasAnyBenchmarks) return {};
+
+  if (failed(cleanupBenchmarkModule(*moduleOp))) return {};
   return moduleOp;
 }
 
@@ -416,7 +568,10 @@ class DumpExecutableBenchmarksPass
  public:
   DumpExecutableBenchmarksPass() = default;
   DumpExecutableBenchmarksPass(const DumpExecutableBenchmarksPass &pass) {}
-  DumpExecutableBenchmarksPass(StringRef path) { this->path = path.str(); }
+  DumpExecutableBenchmarksPass(StringRef path, bool combined) {
+    this->path = path.str();
+    this->combined = combined;
+  }
 
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<IREE::HAL::HALDialect>();
@@ -448,6 +603,19 @@ class DumpExecutableBenchmarksPass
       llvm::sys::fs::create_directories(path);
     }
 
+    // Produce a single file containing all executables when requested.
+    if (combined) {
+      auto benchmarkModuleOp =
+          buildCombinedBenchmarkModule(moduleOp, dispatchParamsMap);
+      if (!benchmarkModuleOp) return;
+      auto fileName = (moduleName + "_benchmarks.mlir").str();
+      if (failed(
+              writeBenchmarkModule(*benchmarkModuleOp, fileName, moduleOp))) {
+        return signalPassFailure();
+      }
+      return;
+    }
+
     // Produce one file per executable containing all exported entry points.
     for (auto executableOp : moduleOp.getOps<IREE::HAL::ExecutableOp>()) {
       for (auto variantOp :
@@ -458,34 +626,48 @@ class DumpExecutableBenchmarksPass
         auto fileName = (moduleName + "_" + executableOp.getName() + "_" +
                          variantOp.getName() + ".mlir")
                             .str();
-        if (path.empty() || path == "-") {
-          dumpModuleToStream(*benchmarkModuleOp, fileName, llvm::outs());
-        } else {
-          auto filePath =
-              (path + llvm::sys::path::get_separator() + fileName).str();
-          std::string error;
-          auto file = mlir::openOutputFile(filePath, &error);
-          if (!file) {
-            executableOp.emitError()
-                << "while dumping to " << path << ": " << error;
-            return signalPassFailure();
-          }
-          dumpModuleToStream(*benchmarkModuleOp, fileName, file->os());
-          file->keep();
+        if (failed(writeBenchmarkModule(*benchmarkModuleOp, fileName,
+                                        executableOp))) {
+          return signalPassFailure();
         }
       }
     }
   }
 
  private:
+  // Writes |benchmarkModuleOp| to |fileName| under the dump path or stdout.
+  // Errors are reported on |errorOp|.
+  LogicalResult writeBenchmarkModule(mlir::ModuleOp benchmarkModuleOp,
+                                     StringRef fileName, Operation *errorOp) {
+    if (path.empty() || path == "-") {
+      dumpModuleToStream(benchmarkModuleOp, fileName, llvm::outs());
+      return success();
+    }
+    auto filePath = (path + llvm::sys::path::get_separator() + fileName).str();
+    std::string error;
+    auto file = mlir::openOutputFile(filePath, &error);
+    if (!file) {
+      return errorOp->emitError()
+             << "while dumping to " << path << ": " << error;
+    }
+    dumpModuleToStream(benchmarkModuleOp, fileName, file->os());
+    file->keep();
+    return success();
+  }
+
   Option<std::string> path{
       *this, "path",
       llvm::cl::desc("Path to write hal.executable benchmarks into.")};
+  Option<bool> combined{
+      *this, "combined",
+      llvm::cl::desc("Writes all benchmarks into a single module instead of "
+                     "one module per executable variant."),
+      llvm::cl::init(false)};
 };
 
 std::unique_ptr<OperationPass<ModuleOp>> createDumpExecutableBenchmarksPass(
-    StringRef path) {
-  return std::make_unique<DumpExecutableBenchmarksPass>(path);
+    StringRef path, bool combined) {
+  return std::make_unique<DumpExecutableBenchmarksPass>(path, combined);
 }
 
 static PassRegistration<DumpExecutableBenchmarksPass> pass([] {
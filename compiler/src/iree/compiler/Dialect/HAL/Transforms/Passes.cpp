@@ -112,7 +112,8 @@ void buildHALConfigurationPassPipeline(OpPassManager &passManager,
   // and is only useful for basic microbenchmarking.
   if (!targetOptions.executableBenchmarksPath.empty()) {
     passManager.addPass(createDumpExecutableBenchmarksPass(
-        targetOptions.executableBenchmarksPath));
+        targetOptions.executableBenchmarksPath,
+        targetOptions.executableBenchmarksCombined));
   }
 }
 
@@ -140,7 +141,8 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
   // After this point the executables are opaque blobs and we cannot change
   // their interfaces.
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-      createTranslateExecutablesPass());
+      createTranslateExecutablesPass(targetOptions.executableCachePath,
+                                     targetOptions.executableParallelism));
 
   //----------------------------------------------------------------------------
   // Host program conversion
@@ -224,7 +226,9 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
     passManager.addNestedPass<IREE::HAL::ExecutableOp>(
         createSerializeExecutablesPass(
             targetOptions.debugLevel, targetOptions.executableIntermediatesPath,
-            targetOptions.executableBinariesPath));
+            targetOptions.executableBinariesPath,
+            targetOptions.executableCachePath,
+            targetOptions.executableParallelism));
 
     // NOTE: symbol DCE will destroy executable target contents, so only run it
     // if we serialized things.
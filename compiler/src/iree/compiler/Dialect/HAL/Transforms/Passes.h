@@ -94,16 +94,23 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>> createDumpExecutableSourcesPass(
     StringRef path);
 
 // Dumps standalone hal.executable benchmarks to |path|.
+// If |combined| is set all benchmarks are written into a single module.
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
-createDumpExecutableBenchmarksPass(StringRef path);
+createDumpExecutableBenchmarksPass(StringRef path, bool combined = false);
 
 // Translates hal.executable.variant ops via a nested translation pipeline.
+// Translations are reused from and added to the persistent cache in
+// |executableCachePath| if not empty. At most |executableParallelism|
+// executables are translated at once (0 for all hardware threads).
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass();
+createTranslateExecutablesPass(std::string executableCachePath = "",
+                               int executableParallelism = 0);
 
 // Translates hal.executable.variant ops for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target);
+createTranslateTargetExecutableVariantsPass(
+    StringRef target, std::string executableCachePath = "",
+    int executableParallelism = 0);
 
 // Calls into each target backend to have it link multiple hal.executables
 // together (if that makes sense). For example, the LLVM AOT backend may combine
@@ -120,16 +127,23 @@ std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createResolveExportOrdinalsPass();
 
 // Converts hal.executable.variants to one or more hal.executable.binary ops.
+// Binaries are reused from and added to the persistent cache in
+// |executableCachePath| if not empty. At most |executableParallelism| threads
+// serialize executables at once (0 for all hardware threads).
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(int debugLevel = 2,
                                std::string dumpIntermediatesPath = "",
-                               std::string dumpBinariesPath = "");
+                               std::string dumpBinariesPath = "",
+                               std::string executableCachePath = "",
+                               int executableParallelism = 0);
 
 // Serializes executables for the specified |target| backend.
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(StringRef target, int debugLevel = 2,
                                      std::string dumpIntermediatesPath = "",
-                                     std::string dumpBinariesPath = "");
+                                     std::string dumpBinariesPath = "",
+                                     std::string executableCachePath = "",
+                                     int executableParallelism = 0);
 
 //===----------------------------------------------------------------------===//
 // Resource initialization, caching, and optimization
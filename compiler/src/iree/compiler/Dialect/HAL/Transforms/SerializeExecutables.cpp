@@ -11,14 +11,20 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/OperationSupport.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 
+#define DEBUG_TYPE "iree-hal-serialize-executables"
+
 namespace mlir {
 namespace iree_compiler {
 namespace IREE {
@@ -32,11 +38,15 @@ class SerializeTargetExecutablesPass
   SerializeTargetExecutablesPass(const SerializeTargetExecutablesPass &pass) {}
   SerializeTargetExecutablesPass(StringRef target, int debugLevel,
                                  std::string dumpIntermediatesPath,
-                                 std::string dumpBinariesPath) {
+                                 std::string dumpBinariesPath,
+                                 std::string executableCachePath,
+                                 int executableParallelism) {
     this->target = target.str();
     this->debugLevel = debugLevel;
     this->dumpIntermediatesPath = dumpIntermediatesPath;
     this->dumpBinariesPath = dumpBinariesPath;
+    this->executableCachePath = executableCachePath;
+    this->executableParallelism = executableParallelism;
   }
 
   StringRef getArgument() const override {
@@ -76,6 +86,7 @@ class SerializeTargetExecutablesPass
     serializationOptions.debugLevel = debugLevel;
     serializationOptions.dumpIntermediatesPath = dumpIntermediatesPath;
     serializationOptions.dumpBinariesPath = dumpBinariesPath;
+    serializationOptions.executableParallelism = executableParallelism;
     if (!dumpIntermediatesPath.empty()) {
       llvm::sys::fs::create_directories(dumpIntermediatesPath);
     }
@@ -83,25 +94,100 @@ class SerializeTargetExecutablesPass
       llvm::sys::fs::create_directories(dumpBinariesPath);
     }
 
+    // Binaries are only cached when no artifacts are requested as those are
+    // produced as a side effect of serialization.
+    Optional<ExecutableCache> cache;
+    Optional<std::string> backendKey = targetBackend->getExecutableCacheKey();
+    StringRef compilerIdentity = ExecutableCache::getCompilerIdentity();
+    if (!executableCachePath.empty() && dumpIntermediatesPath.empty() &&
+        dumpBinariesPath.empty() && backendKey && !compilerIdentity.empty()) {
+      cache.emplace(executableCachePath);
+    }
+
     auto variantOps = llvm::to_vector<4>(
         executableOp.getBlock().getOps<IREE::HAL::ExecutableVariantOp>());
     for (auto variantOp : variantOps) {
       if (variantOp.getTarget().getBackend().getValue() != target) continue;
       OpBuilder executableBuilder(variantOp);
+
+      // The executable name is used to name the produced libraries and
+      // locations end up in debug information.
+      std::string cacheKey;
+      if (cache) {
+        llvm::raw_string_ostream os(cacheKey);
+        os << compilerIdentity << "\n"
+           << *backendKey << "\n"
+           << "debug-level=" << debugLevel << "\n"
+           << executableOp.getName() << "\n";
+        OpPrintingFlags flags;
+        flags.useLocalScope();
+        if (debugLevel > 0) flags.enableDebugInfo();
+        variantOp->print(os, flags);
+        os.flush();
+        if (auto data = cache->lookup("binary", cacheKey)) {
+          if (succeeded(restoreFromCache(*data, executableBuilder))) {
+            LLVM_DEBUG(llvm::dbgs() << "BINARY CACHE HIT: "
+                                    << executableOp.getName() << "\n");
+            ++cacheHits;
+            variantOp.erase();
+            continue;
+          }
+        }
+        ++cacheMisses;
+      }
+
+      llvm::SmallPtrSet<Operation *, 8> existingOps;
+      for (auto &op : executableOp.getBlock()) existingOps.insert(&op);
+
       // Ask the target backend to serialize the executable. Note that it
       // may create one or more hal.executable.binary ops in the case of
       // multi-architecture binaries.
-      if (failed(targetBackend->serializeExecutable(
-              serializationOptions, variantOp, executableBuilder))) {
+      LogicalResult serialized = failure();
+      {
+        auto slot = ExecutableThreadSlots::acquire(executableParallelism);
+        serialized = targetBackend->serializeExecutable(
+            serializationOptions, variantOp, executableBuilder);
+      }
+      if (failed(serialized)) {
         variantOp.emitError()
             << "failed to serialize executable for target backend " << target;
         return signalPassFailure();
       }
+
+      if (cache) {
+        SmallVector<Operation *> binaryOps;
+        for (auto &op : executableOp.getBlock()) {
+          if (!existingOps.contains(&op)) binaryOps.push_back(&op);
+        }
+        // Failing to populate the cache only affects future compilations.
+        if (!binaryOps.empty() &&
+            failed(cache->insert(
+                "binary", cacheKey,
+                ExecutableCache::printExecutableOps(binaryOps)))) {
+          LLVM_DEBUG(llvm::dbgs() << "failed to write binary cache entry\n");
+        }
+      }
+
       variantOp.erase();
     }
   }
 
  private:
+  // Clones the ops in the cache entry |data| at the insertion point of
+  // |executableBuilder|. Returns failure if the entry could not be parsed.
+  LogicalResult restoreFromCache(StringRef data, OpBuilder &executableBuilder) {
+    auto cachedModuleOp =
+        ExecutableCache::parseExecutableOps(data, &getContext());
+    if (!cachedModuleOp) return failure();
+    auto cachedExecutableOp =
+        *cachedModuleOp->getOps<IREE::HAL::ExecutableOp>().begin();
+    for (auto &op : cachedExecutableOp.getBlock()) {
+      if (op.hasTrait<OpTrait::IsTerminator>()) continue;
+      executableBuilder.clone(op);
+    }
+    return success();
+  }
+
   Option<std::string> target{
       *this, "target",
       llvm::cl::desc(
@@ -119,14 +205,32 @@ class SerializeTargetExecutablesPass
       *this, "dump-binaries-path",
       llvm::cl::desc("Path to write translated and serialized executable "
                      "binaries into for debugging.")};
+  Option<std::string> executableCachePath{
+      *this, "executable-cache-path",
+      llvm::cl::desc("Directory of a persistent cache of serialized "
+                     "executables.")};
+  Option<int> executableParallelism{
+      *this, "executable-parallelism",
+      llvm::cl::desc("Maximum number of threads serializing executables at "
+                     "once (0 for all hardware threads)."),
+      llvm::cl::init(0)};
+
+  Statistic cacheHits{this, "cache hit(s)",
+                      "Number of binaries restored from the executable cache"};
+  Statistic cacheMisses{
+      this, "cache miss(es)",
+      "Number of binaries serialized and added to the executable cache"};
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeTargetExecutablesPass(StringRef target, int debugLevel,
                                      std::string dumpIntermediatesPath,
-                                     std::string dumpBinariesPath) {
+                                     std::string dumpBinariesPath,
+                                     std::string executableCachePath,
+                                     int executableParallelism) {
   return std::make_unique<SerializeTargetExecutablesPass>(
-      target, debugLevel, dumpIntermediatesPath, dumpBinariesPath);
+      target, debugLevel, dumpIntermediatesPath, dumpBinariesPath,
+      executableCachePath, executableParallelism);
 }
 
 static PassRegistration<SerializeTargetExecutablesPass> linkTargetPass([] {
@@ -139,10 +243,14 @@ class SerializeExecutablesPass
  public:
   SerializeExecutablesPass() = default;
   SerializeExecutablesPass(int debugLevel, std::string dumpIntermediatesPath,
-                           std::string dumpBinariesPath)
+                           std::string dumpBinariesPath,
+                           std::string executableCachePath,
+                           int executableParallelism)
       : debugLevel(debugLevel),
         dumpIntermediatesPath(dumpIntermediatesPath),
-        dumpBinariesPath(dumpBinariesPath) {}
+        dumpBinariesPath(dumpBinariesPath),
+        executableCachePath(executableCachePath),
+        executableParallelism(executableParallelism) {}
 
   StringRef getArgument() const override {
     return "iree-hal-serialize-executables";
@@ -157,7 +265,8 @@ class SerializeExecutablesPass
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addPass(createSerializeTargetExecutablesPass(
-          targetName, debugLevel, dumpIntermediatesPath, dumpBinariesPath));
+          targetName, debugLevel, dumpIntermediatesPath, dumpBinariesPath,
+          executableCachePath, executableParallelism));
     }
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
@@ -169,14 +278,19 @@ class SerializeExecutablesPass
   int debugLevel;
   std::string dumpIntermediatesPath;
   std::string dumpBinariesPath;
+  std::string executableCachePath;
+  int executableParallelism = 0;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
 createSerializeExecutablesPass(int debugLevel,
                                std::string dumpIntermediatesPath,
-                               std::string dumpBinariesPath) {
+                               std::string dumpBinariesPath,
+                               std::string executableCachePath,
+                               int executableParallelism) {
   return std::make_unique<SerializeExecutablesPass>(
-      debugLevel, dumpIntermediatesPath, dumpBinariesPath);
+      debugLevel, dumpIntermediatesPath, dumpBinariesPath, executableCachePath,
+      executableParallelism);
 }
 
 static PassRegistration<SerializeExecutablesPass> linkPass([] {
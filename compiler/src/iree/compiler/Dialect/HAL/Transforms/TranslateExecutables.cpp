@@ -11,19 +11,107 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetBackend.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
 #include "llvm/ADT/StringSet.h"
+#include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Bufferization/IR/Bufferization.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Pass/PassManager.h"
 
+#define DEBUG_TYPE "iree-hal-translate-executables"
+
 namespace mlir {
 namespace iree_compiler {
 namespace IREE {
 namespace HAL {
 
+// Renames the exports of |variantOp| along with the functions implementing
+// them in its inner modules from |fromNames| to |toNames|.
+static void renameExports(IREE::HAL::ExecutableVariantOp variantOp,
+                          ArrayRef<std::string> fromNames,
+                          ArrayRef<std::string> toNames) {
+  SmallVector<mlir::ModuleOp> innerModuleOps =
+      llvm::to_vector(variantOp.getBlock().getOps<mlir::ModuleOp>());
+  for (auto it : llvm::zip(fromNames, toNames)) {
+    StringRef fromName = std::get<0>(it);
+    auto toName = StringAttr::get(variantOp.getContext(), std::get<1>(it));
+    for (auto exportOp : variantOp.getOps<IREE::HAL::ExecutableExportOp>()) {
+      if (exportOp.getName() == fromName) {
+        SymbolTable::setSymbolName(exportOp, toName);
+      }
+    }
+    for (auto innerModuleOp : innerModuleOps) {
+      Operation *funcOp = SymbolTable::lookupSymbolIn(innerModuleOp, fromName);
+      if (!funcOp) continue;
+      (void)SymbolTable::replaceAllSymbolUses(funcOp, toName, innerModuleOp);
+      SymbolTable::setSymbolName(funcOp, toName);
+    }
+  }
+}
+
+// Returns the export names of |variantOp| and the position independent names
+// they are replaced with in cache entries so that the same dispatch outlined
+// from different models shares an entry.
+static void getCacheExportNames(IREE::HAL::ExecutableVariantOp variantOp,
+                                SmallVectorImpl<std::string> &exportNames,
+                                SmallVectorImpl<std::string> &cacheNames) {
+  for (auto exportOp : variantOp.getOps<IREE::HAL::ExecutableExportOp>()) {
+    exportNames.push_back(exportOp.getName().str());
+    cacheNames.push_back("__cached_export_" +
+                         std::to_string(cacheNames.size()));
+  }
+}
+
+// Prints |variantOp| with its exports renamed to |cacheNames|.
+static std::string printForCache(IREE::HAL::ExecutableVariantOp variantOp,
+                                 ArrayRef<std::string> exportNames,
+                                 ArrayRef<std::string> cacheNames,
+                                 bool forKey) {
+  auto clonedOp = cast<IREE::HAL::ExecutableVariantOp>(variantOp->clone());
+  renameExports(clonedOp, exportNames, cacheNames);
+  std::string str;
+  if (forKey) {
+    // Locations only affect debug information and are excluded from the key.
+    llvm::raw_string_ostream os(str);
+    clonedOp->print(os, OpPrintingFlags().useLocalScope());
+    os.flush();
+  } else {
+    str = ExecutableCache::printExecutableOps({clonedOp});
+  }
+  clonedOp->destroy();
+  return str;
+}
+
+// Replaces the contents of |variantOp| with the translated variant in the
+// cache entry |data|. Returns failure if the entry could not be parsed.
+static LogicalResult restoreFromCache(IREE::HAL::ExecutableVariantOp variantOp,
+                                      StringRef data,
+                                      ArrayRef<std::string> exportNames,
+                                      ArrayRef<std::string> cacheNames) {
+  auto cachedModuleOp =
+      ExecutableCache::parseExecutableOps(data, variantOp.getContext());
+  if (!cachedModuleOp) return failure();
+  auto cachedExecutableOp =
+      *cachedModuleOp->getOps<IREE::HAL::ExecutableOp>().begin();
+  auto cachedVariantOps =
+      cachedExecutableOp.getOps<IREE::HAL::ExecutableVariantOp>();
+  if (cachedVariantOps.empty()) return failure();
+  auto cachedVariantOp = *cachedVariantOps.begin();
+  renameExports(cachedVariantOp, cacheNames, exportNames);
+
+  variantOp->setAttrs(cachedVariantOp->getAttrDictionary());
+  Block &block = variantOp.getBlock();
+  while (!block.empty()) block.back().erase();
+  block.getOperations().splice(block.end(),
+                               cachedVariantOp.getBlock().getOperations());
+  return success();
+}
+
 class TranslateTargetExecutableVariantsPass
     : public PassWrapper<TranslateTargetExecutableVariantsPass,
                          OperationPass<IREE::HAL::ExecutableVariantOp>> {
@@ -31,8 +119,12 @@ class TranslateTargetExecutableVariantsPass
   TranslateTargetExecutableVariantsPass() = default;
   TranslateTargetExecutableVariantsPass(
       const TranslateTargetExecutableVariantsPass &pass) {}
-  TranslateTargetExecutableVariantsPass(StringRef target) {
+  TranslateTargetExecutableVariantsPass(StringRef target,
+                                        std::string executableCachePath,
+                                        int executableParallelism) {
     this->target = target.str();
+    this->executableCachePath = executableCachePath;
+    this->executableParallelism = executableParallelism;
   }
 
   StringRef getArgument() const override {
@@ -64,12 +156,57 @@ class TranslateTargetExecutableVariantsPass
 
     OpPassManager passManager(variantOp.getOperationName());
     targetBackend->buildTranslationPassPipeline(passManager);
-    if (failed(runPipeline(passManager, variantOp))) {
+
+    // Reuse the translation of an identical variant from the cache if
+    // possible. Translation only depends on the variant contents, the
+    // pipeline and the backend configuration.
+    Optional<ExecutableCache> cache;
+    std::string cacheKey;
+    SmallVector<std::string> exportNames;
+    SmallVector<std::string> cacheNames;
+    Optional<std::string> backendKey = targetBackend->getExecutableCacheKey();
+    StringRef compilerIdentity = ExecutableCache::getCompilerIdentity();
+    if (!executableCachePath.empty() && backendKey &&
+        !compilerIdentity.empty()) {
+      cache.emplace(executableCachePath);
+      getCacheExportNames(variantOp, exportNames, cacheNames);
+      llvm::raw_string_ostream os(cacheKey);
+      os << compilerIdentity << "\n" << *backendKey << "\n";
+      passManager.printAsTextualPipeline(os);
+      os << "\n"
+         << printForCache(variantOp, exportNames, cacheNames, /*forKey=*/true);
+      os.flush();
+      if (auto data = cache->lookup("translation", cacheKey)) {
+        if (succeeded(restoreFromCache(variantOp, *data, exportNames,
+                                       cacheNames))) {
+          LLVM_DEBUG(llvm::dbgs() << "TRANSLATION CACHE HIT: "
+                                  << variantOp.getName() << "\n");
+          ++cacheHits;
+          return;
+        }
+      }
+      ++cacheMisses;
+    }
+
+    LogicalResult translated = failure();
+    {
+      auto slot = ExecutableThreadSlots::acquire(executableParallelism);
+      translated = runPipeline(passManager, variantOp);
+    }
+    if (failed(translated)) {
       variantOp.emitError() << "failed to run translation of source "
                                "executable to target executable for backend "
                             << variantOp.getTarget();
       return signalPassFailure();
     }
+
+    // Failing to populate the cache only affects future compilations.
+    if (cache && failed(cache->insert("translation", cacheKey,
+                                      printForCache(variantOp, exportNames,
+                                                    cacheNames,
+                                                    /*forKey=*/false)))) {
+      LLVM_DEBUG(llvm::dbgs() << "failed to write translation cache entry\n");
+    }
   }
 
  private:
@@ -78,11 +215,29 @@ class TranslateTargetExecutableVariantsPass
       llvm::cl::desc(
           "Target backend name whose executables will be translated by "
           "this pass.")};
+  Option<std::string> executableCachePath{
+      *this, "executable-cache-path",
+      llvm::cl::desc("Directory of a persistent cache of translated "
+                     "executables.")};
+  Option<int> executableParallelism{
+      *this, "executable-parallelism",
+      llvm::cl::desc("Maximum number of threads translating executables at "
+                     "once (0 for all hardware threads)."),
+      llvm::cl::init(0)};
+
+  Statistic cacheHits{this, "cache hit(s)",
+                      "Number of variants restored from the executable cache"};
+  Statistic cacheMisses{
+      this, "cache miss(es)",
+      "Number of variants translated and added to the executable cache"};
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableVariantOp>>
-createTranslateTargetExecutableVariantsPass(StringRef target) {
-  return std::make_unique<TranslateTargetExecutableVariantsPass>(target);
+createTranslateTargetExecutableVariantsPass(StringRef target,
+                                            std::string executableCachePath,
+                                            int executableParallelism) {
+  return std::make_unique<TranslateTargetExecutableVariantsPass>(
+      target, executableCachePath, executableParallelism);
 }
 
 static PassRegistration<TranslateTargetExecutableVariantsPass> linkTargetPass(
@@ -93,6 +248,10 @@ class TranslateExecutablesPass
                          OperationPass<IREE::HAL::ExecutableOp>> {
  public:
   TranslateExecutablesPass() = default;
+  TranslateExecutablesPass(std::string executableCachePath,
+                           int executableParallelism)
+      : executableCachePath(executableCachePath),
+        executableParallelism(executableParallelism) {}
 
   StringRef getArgument() const override {
     return "iree-hal-translate-executables";
@@ -116,18 +275,25 @@ class TranslateExecutablesPass
     OpPassManager passManager(executableOp.getOperationName());
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addNestedPass<IREE::HAL::ExecutableVariantOp>(
-          createTranslateTargetExecutableVariantsPass(targetName));
+          createTranslateTargetExecutableVariantsPass(
+              targetName, executableCachePath, executableParallelism));
     }
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
       return signalPassFailure();
     }
   }
+
+ private:
+  std::string executableCachePath;
+  int executableParallelism = 0;
 };
 
 std::unique_ptr<OperationPass<IREE::HAL::ExecutableOp>>
-createTranslateExecutablesPass() {
-  return std::make_unique<TranslateExecutablesPass>();
+createTranslateExecutablesPass(std::string executableCachePath,
+                               int executableParallelism) {
+  return std::make_unique<TranslateExecutablesPass>(executableCachePath,
+                                                    executableParallelism);
 }
 
 static PassRegistration<TranslateExecutablesPass> translatePass([] {
@@ -1,4 +1,5 @@
 // RUN: iree-opt --split-input-file --iree-hal-dump-executable-benchmarks %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline='iree-hal-dump-executable-benchmarks{combined=true}' %s | FileCheck %s --check-prefix=COMBINED
 
 // Tests dumping executable benchmarks to stdout - it's more common to use files
 // but this is much easier to test with lit.
@@ -65,9 +66,11 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
   // CHECK-NEXT: util.initializer {
   // CHECK: %[[BUFFER:.+]] = hal.allocator.allocate<%{{.+}} : !hal.allocator> type("DeviceVisible|DeviceLocal") usage("{{.+}}Dispatch{{.+}}") : !hal.buffer{%c768}
   // CHECK-NEXT: util.global.store %[[BUFFER]], @ex0_embedded_elf_x86_64_dispatch0_512_buffer : !hal.buffer
+  // CHECK: hal.command_buffer.fill_buffer<%{{.+}} : !hal.command_buffer> target(%[[BUFFER]] : !hal.buffer)[%{{.+}}, %c768] pattern(%{{.+}} : i32)
+  // CHECK: hal.fence.await
 
   // CHECK: func.func @ex0_embedded_elf_x86_64_dispatch0_512(%arg0: i32)
-  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch"}} {
+  // CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch", iree.benchmark.bytes = "96", iree.benchmark.export = "ex0::embedded_elf_x86_64::dispatch0", iree.benchmark.workload = "512"}} {
   // CHECK: %[[BATCH_SIZE:.+]] = arith.index_cast %arg0 : i32 to index
 
   // Create command buffer:
@@ -161,3 +164,101 @@ module attributes {hal.device.targets = [#device_target_cpu]}  {
     return %39 : !stream.timepoint
   }
 }
+
+// -----
+
+// Tests that static linalg ops have their arithmetic estimated for throughput
+// reporting and that all executables can be combined into a single module.
+
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#device_target_cpu = #hal.device.target<"llvm-cpu", {
+  executable_targets = [#executable_target_embedded_elf_x86_64_]
+}>
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>,
+    #hal.descriptor_set.binding<1, storage_buffer>,
+    #hal.descriptor_set.binding<2, storage_buffer>
+  ]>
+]>
+
+module attributes {hal.device.targets = [#device_target_cpu]}  {
+
+  // COMBINED: hal.executable private @ex_matmul
+  // COMBINED: func.func @ex_matmul_embedded_elf_x86_64_matmul_8x4
+  // COMBINED-NOT: {{^}}module
+  // COMBINED: hal.executable private @ex_fill
+  // COMBINED: func.func @ex_fill_embedded_elf_x86_64_fill_32
+
+  hal.executable private @ex_matmul {
+    hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+      hal.executable.export public @matmul ordinal(0) layout(#pipeline_layout) {
+      ^bb0(%device: !hal.device, %arg0: index, %arg1: index):
+        %c1 = arith.constant 1 : index
+        hal.return %arg0, %arg1, %c1 : index, index, index
+      }
+      builtin.module {
+        func.func @matmul() {
+          %c0 = arith.constant 0 : index
+          %lhs = hal.interface.binding.subspan set(0) binding(0) type(storage_buffer) offset(%c0) alignment(64) : memref<4x16xf32>
+          %rhs = hal.interface.binding.subspan set(0) binding(1) type(storage_buffer) offset(%c0) alignment(64) : memref<16x8xf32>
+          %dst = hal.interface.binding.subspan set(0) binding(2) type(storage_buffer) offset(%c0) alignment(64) : memref<4x8xf32>
+          linalg.matmul ins(%lhs, %rhs : memref<4x16xf32>, memref<16x8xf32>) outs(%dst : memref<4x8xf32>)
+          func.return
+        }
+      }
+    }
+  }
+
+  // CHECK: func.func @ex_matmul_embedded_elf_x86_64_matmul_8x4(%arg0: i32)
+  // CHECK-SAME: iree.reflection = {iree.benchmark = "dispatch", iree.benchmark.bytes = "896", iree.benchmark.export = "ex_matmul::embedded_elf_x86_64::matmul", iree.benchmark.flops = "1024", iree.benchmark.workload = "8x4"}
+
+  hal.executable private @ex_fill {
+    hal.executable.variant public @embedded_elf_x86_64, target = #executable_target_embedded_elf_x86_64_ {
+      hal.executable.export public @fill ordinal(0) layout(#pipeline_layout) {
+      ^bb0(%device: !hal.device, %arg0: index):
+        %c1 = arith.constant 1 : index
+        hal.return %arg0, %c1, %c1 : index, index, index
+      }
+      builtin.module {
+        func.func @fill() {
+          func.return
+        }
+      }
+    }
+  }
+
+  // CHECK: func.func @ex_fill_embedded_elf_x86_64_fill_32(%arg0: i32)
+  // CHECK-SAME: iree.reflection = {iree.benchmark = "dispatch", iree.benchmark.bytes = "128", iree.benchmark.export = "ex_fill::embedded_elf_x86_64::fill", iree.benchmark.workload = "32"}
+
+  func.func private @main() -> !stream.timepoint {
+    %c0 = arith.constant 0 : index
+    %c4 = arith.constant 4 : index
+    %c8 = arith.constant 8 : index
+    %c32 = arith.constant 32 : index
+    %c128 = arith.constant 128 : index
+    %c256 = arith.constant 256 : index
+    %c512 = arith.constant 512 : index
+    %c768 = arith.constant 768 : index
+    %c1024 = arith.constant 1024 : index
+    %result, %result_timepoint = stream.resource.alloca uninitialized : !stream.resource<transient>{%c1024} => !stream.timepoint
+    %0 = stream.cmd.execute await(%result_timepoint) => with(%result as %arg0: !stream.resource<transient>{%c1024}) {
+      stream.cmd.dispatch @ex_matmul::@matmul[%c8, %c4] {
+        ro %arg0[%c0 for %c256] : !stream.resource<transient>{%c1024},
+        ro %arg0[%c256 for %c512] : !stream.resource<transient>{%c1024},
+        wo %arg0[%c768 for %c128] : !stream.resource<transient>{%c1024}
+      } attributes {hal.interface.bindings = [
+        #hal.interface.binding<0, 0>,
+        #hal.interface.binding<0, 1>,
+        #hal.interface.binding<0, 2>
+      ]}
+      stream.cmd.dispatch @ex_fill::@fill[%c32] {
+        wo %arg0[%c0 for %c128] : !stream.resource<transient>{%c1024}
+      } attributes {hal.interface.bindings = [
+        #hal.interface.binding<0, 0>
+      ]}
+    } => !stream.timepoint
+    %1 = stream.resource.dealloca await(%0) => %result : !stream.resource<transient>{%c1024} => !stream.timepoint
+    return %1 : !stream.timepoint
+  }
+}
@@ -82,3 +82,47 @@ func.func @no_results(%device : !hal.device) {
   // CHECK-NEXT:  return
   return
 }
+
+// -----
+
+// Variants compiled for specific CPU features are only selected when the device
+// reports every feature through the hal.cpu query category.
+
+// CHECK-LABEL: @cpu_features
+// CHECK-SAME: %[[DEVICE:.+]]: !hal.device
+func.func @cpu_features(%device : !hal.device) {
+  hal.device.switch<%device : !hal.device>
+    // CHECK-NEXT:  %{{.+}}, %[[IS_FORMAT0:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.executable.format" :: "embedded-elf-x86_64") : i1, i1 = false
+    // CHECK-NEXT:  %{{.+}}, %[[HAS_AVX2:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.cpu" :: "avx2") : i1, i1 = false
+    // CHECK-NEXT:  %[[IS_AVX2:.+]] = arith.andi %[[IS_FORMAT0]], %[[HAS_AVX2]] : i1
+    // CHECK-NEXT:  %{{.+}}, %[[HAS_FMA:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.cpu" :: "fma") : i1, i1 = false
+    // CHECK-NEXT:  %[[IS0:.+]] = arith.andi %[[IS_AVX2]], %[[HAS_FMA]] : i1
+    // CHECK-NEXT:  cf.cond_br %[[IS0]], ^bb1, ^bb2
+    // CHECK-NEXT: ^bb1:
+    // CHECK-NEXT:  "some.op_a"()
+    // CHECK-NEXT:  cf.br ^bb5
+    #hal.match.all<[#hal.device.match.executable.format<"embedded-elf-x86_64">, #hal.device.match.cpu.feature<"avx2">, #hal.device.match.cpu.feature<"fma">]> {
+      "some.op_a"() : () -> ()
+      hal.return
+    },
+    // CHECK-NEXT: ^bb2:
+    // CHECK-NEXT:  %{{.+}}, %[[IS1:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.executable.format" :: "embedded-elf-x86_64") : i1, i1 = false
+    // CHECK-NEXT:  cf.cond_br %[[IS1]], ^bb3, ^bb4
+    // CHECK-NEXT: ^bb3:
+    // CHECK-NEXT:  "some.op_b"()
+    // CHECK-NEXT:  cf.br ^bb5
+    #hal.device.match.executable.format<"embedded-elf-x86_64"> {
+      "some.op_b"() : () -> ()
+      hal.return
+    },
+    // CHECK-NEXT: ^bb4:
+    // CHECK-NEXT:  "some.op_c"()
+    // CHECK-NEXT:  cf.br ^bb5
+    #hal.match.always {
+      "some.op_c"() : () -> ()
+      hal.return
+    }
+  // CHECK-NEXT: ^bb5:
+  // CHECK-NEXT:  return
+  return
+}
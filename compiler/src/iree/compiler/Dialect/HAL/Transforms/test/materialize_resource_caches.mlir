@@ -170,3 +170,43 @@ func.func @exeLookup(%device : !hal.device) -> !hal.executable {
 }
 
 }
+
+// -----
+
+// Tests that variants of the same format compiled for specific CPU features are
+// only selected if the processor supports them, in order of preference.
+
+#pipeline_layout = #hal.pipeline.layout<push_constants = 0, sets = [
+  #hal.descriptor_set.layout<0, bindings = [
+    #hal.descriptor_set.binding<0, storage_buffer>
+  ]>
+]>
+
+module attributes {hal.device.targets = [#hal.device.target<"llvm-cpu">]} {
+
+hal.executable @exe {
+  hal.executable.variant @x86_64_v3, target = <"llvm-cpu", "embedded-elf-x86_64", {
+    match_cpu_features = ["avx2", "fma"]
+  }> {
+    hal.executable.export @entry ordinal(0) layout(#pipeline_layout)
+  }
+  hal.executable.variant @x86_64, target = <"llvm-cpu", "embedded-elf-x86_64"> {
+    hal.executable.export @entry ordinal(0) layout(#pipeline_layout)
+  }
+}
+
+// CHECK: util.global private @_executable_exe : !hal.executable
+// CHECK-NEXT: util.initializer {
+// CHECK:   %[[DEV:.+]] = hal.ex.shared_device : !hal.device
+// CHECK:   hal.device.switch<%[[DEV]] : !hal.device> -> !hal.executable
+// CHECK:   #hal.match.all<[#hal.device.match.executable.format<"embedded-elf-x86_64">, #hal.device.match.cpu.feature<"avx2">, #hal.device.match.cpu.feature<"fma">]> {
+// CHECK:     hal.executable.create
+// CHECK-SAME:  target(@exe::@x86_64_v3)
+// CHECK:   },
+// CHECK:   #hal.device.match.executable.format<"embedded-elf-x86_64"> {
+// CHECK:     hal.executable.create
+// CHECK-SAME:  target(@exe::@x86_64)
+// CHECK:   },
+// CHECK:   #hal.match.always {
+
+}
@@ -0,0 +1,157 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableCache.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/Parser/Parser.h"
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif  // _WIN32
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Returns the path of the binary (shared library or executable) containing the
+// compiler code or an empty string if it cannot be determined.
+static std::string getCompilerBinaryPath() {
+  static int anchor = 0;
+#if defined(_WIN32)
+  HMODULE module = nullptr;
+  if (!GetModuleHandleExA(GET_MODULE_HANDLE_EX_FLAG_FROM_ADDRESS |
+                              GET_MODULE_HANDLE_EX_FLAG_UNCHANGED_REFCOUNT,
+                          reinterpret_cast<LPCSTR>(&anchor), &module)) {
+    return "";
+  }
+  char path[MAX_PATH];
+  DWORD length = GetModuleFileNameA(module, path, MAX_PATH);
+  if (length == 0 || length == MAX_PATH) return "";
+  return std::string(path, length);
+#else
+  Dl_info info;
+  if (!dladdr(&anchor, &info) || !info.dli_fname) return "";
+  // The main executable is reported as it was invoked (argv[0]), which may be
+  // relative to a different working directory or not a path at all.
+  if (!llvm::sys::path::is_absolute(info.dli_fname)) {
+    return llvm::sys::fs::getMainExecutable(nullptr, &anchor);
+  }
+  return info.dli_fname;
+#endif  // _WIN32
+}
+
+StringRef ExecutableCache::getCompilerIdentity() {
+  static const std::string identity = []() -> std::string {
+    std::string binaryPath = getCompilerBinaryPath();
+    llvm::sys::fs::file_status status;
+    if (binaryPath.empty() || llvm::sys::fs::status(binaryPath, status)) {
+      return "";
+    }
+    return llvm::formatv(
+        "{0}:{1}:{2}", binaryPath, status.getSize(),
+        status.getLastModificationTime().time_since_epoch().count());
+  }();
+  return identity;
+}
+
+std::string ExecutableCache::getEntryPath(StringRef kind, StringRef key) const {
+  auto hash = llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(key)),
+                          /*LowerCase=*/true);
+  SmallString<256> entryPath(path);
+  llvm::sys::path::append(entryPath, kind, hash);
+  return entryPath.str().str();
+}
+
+Optional<std::string> ExecutableCache::lookup(StringRef kind,
+                                              StringRef key) const {
+  auto buffer = llvm::MemoryBuffer::getFile(getEntryPath(kind, key));
+  if (!buffer) return llvm::None;
+  return (*buffer)->getBuffer().str();
+}
+
+LogicalResult ExecutableCache::insert(StringRef kind, StringRef key,
+                                      StringRef data) const {
+  std::string entryPath = getEntryPath(kind, key);
+  if (llvm::sys::fs::create_directories(
+          llvm::sys::path::parent_path(entryPath))) {
+    return failure();
+  }
+
+  // Write to a unique temporary file and move it into place so that readers
+  // never observe partially written entries.
+  int fd = 0;
+  SmallString<256> tempPath;
+  if (llvm::sys::fs::createUniqueFile(entryPath + ".tmp-%%%%%%%%", fd,
+                                      tempPath)) {
+    return failure();
+  }
+  {
+    llvm::raw_fd_ostream os(fd, /*shouldClose=*/true);
+    os << data;
+    os.close();
+    if (os.has_error()) {
+      os.clear_error();
+      llvm::sys::fs::remove(tempPath);
+      return failure();
+    }
+  }
+  if (llvm::sys::fs::rename(tempPath, entryPath)) {
+    llvm::sys::fs::remove(tempPath);
+    return failure();
+  }
+  return success();
+}
+
+std::string ExecutableCache::printExecutableOps(ArrayRef<Operation *> ops) {
+  assert(!ops.empty() && "expected ops to print");
+  MLIRContext *context = ops.front()->getContext();
+  auto loc = UnknownLoc::get(context);
+  OwningOpRef<mlir::ModuleOp> moduleOp = mlir::ModuleOp::create(loc);
+  auto moduleBuilder = OpBuilder::atBlockBegin(moduleOp->getBody());
+  auto executableOp =
+      moduleBuilder.create<IREE::HAL::ExecutableOp>(loc, "cached");
+  auto executableBuilder =
+      OpBuilder::atBlockTerminator(&executableOp.getBlock());
+  for (auto *op : ops) executableBuilder.clone(*op);
+
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  moduleOp->print(os, OpPrintingFlags().enableDebugInfo().printGenericOpForm());
+  os.flush();
+  return str;
+}
+
+OwningOpRef<mlir::ModuleOp> ExecutableCache::parseExecutableOps(
+    StringRef data, MLIRContext *context) {
+  auto moduleOp = parseSourceString<mlir::ModuleOp>(data, context);
+  if (!moduleOp) return {};
+  auto executableOps = moduleOp->getOps<IREE::HAL::ExecutableOp>();
+  if (executableOps.empty()) return {};
+  return moduleOp;
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
@@ -0,0 +1,72 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+#define IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
+
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringRef.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/OwningOpRef.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// A persistent on-disk cache of executable compilation results that is shared
+// across compiler invocations and models. Entries are files under
+// `<path>/<kind>/` named by the SHA1 of their key. They are written atomically
+// so that concurrent compilers can share one cache directory.
+//
+// Keys must cover everything that influences the cached result: callers
+// include the executable contents and the target backend configuration (see
+// TargetBackend::getExecutableCacheKey) and getCompilerIdentity() covers the
+// compiler itself. Stale entries are never removed; delete the directory to
+// reclaim space.
+class ExecutableCache {
+ public:
+  explicit ExecutableCache(StringRef path) : path(path.str()) {}
+
+  // Returns a string identifying the running compiler binary or an empty
+  // string if it cannot be determined, in which case nothing should be cached.
+  // This is the path, size and modification time of the binary containing the
+  // compiler code: the shared library when the compiler is embedded in another
+  // program (such as the Python bindings) and the tool itself when statically
+  // linked.
+  static StringRef getCompilerIdentity();
+
+  // Returns the cached data for |key| in |kind| if present.
+  Optional<std::string> lookup(StringRef kind, StringRef key) const;
+
+  // Stores |data| for |key| in |kind|, replacing any existing entry.
+  LogicalResult insert(StringRef kind, StringRef key, StringRef data) const;
+
+  // Prints |ops| nested in a hal.executable so that they can be stored in the
+  // cache and restored with parseExecutableOps. Locations are preserved.
+  static std::string printExecutableOps(ArrayRef<Operation *> ops);
+
+  // Parses the ops printed by printExecutableOps. The returned module contains
+  // a single hal.executable holding the ops.
+  static OwningOpRef<mlir::ModuleOp> parseExecutableOps(StringRef data,
+                                                        MLIRContext *context);
+
+ private:
+  std::string getEntryPath(StringRef kind, StringRef key) const;
+
+  std::string path;
+};
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLECACHE_H_
@@ -0,0 +1,43 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/Utils/ExecutableFingerprint.h"
+
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/OperationSupport.h"
+#include "mlir/IR/SymbolTable.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+std::string getDispatchFingerprint(ExecutableVariantOp variantOp,
+                                   ExecutableExportOp exportOp,
+                                   Operation *funcOp) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << variantOp.getTarget() << "\n";
+  os << exportOp.getLayout() << "\n";
+
+  // Print a clone with a fixed name so that dispatches that only differ by
+  // their symbol name hash the same. Locations are not printed by default.
+  Operation *clonedOp = funcOp->clone();
+  SymbolTable::setSymbolName(clonedOp, "dispatch");
+  clonedOp->print(os, OpPrintingFlags().useLocalScope());
+  clonedOp->destroy();
+  os.flush();
+
+  return llvm::toHex(llvm::SHA1::hash(llvm::arrayRefFromStringRef(str)),
+                     /*LowerCase=*/true);
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
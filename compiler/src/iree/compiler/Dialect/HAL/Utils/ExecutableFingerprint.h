@@ -0,0 +1,34 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLEFINGERPRINT_H_
+#define IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLEFINGERPRINT_H_
+
+#include <string>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "mlir/IR/Operation.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Returns a hex string identifying the dispatch implemented by |funcOp| for
+// |exportOp| within |variantOp|. The fingerprint covers the target, the
+// pipeline layout of the export and the contents of the function; symbol names
+// and locations are excluded so that the same dispatch produced by different
+// models (or different runs on the same model) has the same fingerprint.
+std::string getDispatchFingerprint(ExecutableVariantOp variantOp,
+                                   ExecutableExportOp exportOp,
+                                   Operation *funcOp);
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_HAL_UTILS_EXECUTABLEFINGERPRINT_H_
@@ -13,20 +13,9 @@
 namespace mlir {
 namespace iree_compiler {
 
-LogicalResult InferCustomKernelsTargetInfoFromParent(
-    func::FuncOp entryPointFn, CustomKernelsTargetInfo &targetInfo) {
-  // Set the out-value to defaults early so that early returns produce
-  // consistent results and so that we can write simpler code below
-  // (for loop OR-ing booleans, assuming initial 'false' value).
-  targetInfo = CustomKernelsTargetInfo();
-
-  // Try to find the parent ExecutableVariantOp and its relevant attributes.
-  auto variantOp =
-      entryPointFn->getParentOfType<IREE::HAL::ExecutableVariantOp>();
-  if (!variantOp) {
-    return failure();
-  }
-  IREE::HAL::ExecutableTargetAttr targetAttr = variantOp.getTarget();
+static LogicalResult inferCustomKernelsTargetInfo(
+    IREE::HAL::ExecutableTargetAttr targetAttr,
+    CustomKernelsTargetInfo &targetInfo, bool ignoreUnknownFeatures) {
   if (!targetAttr) {
     return failure();
   }
@@ -47,7 +36,33 @@ LogicalResult InferCustomKernelsTargetInfoFromParent(
   // parsing work of constructing a llvm::Triple from a string.
   llvm::StringRef archName(tripleAttr.getValue().split('-').first);
   llvm::StringRef featuresStr(cpuFeaturesAttr.getValue());
-  return ParseCustomKernelsTargetInfo(archName, featuresStr, targetInfo);
+  return ParseCustomKernelsTargetInfo(archName, featuresStr, targetInfo,
+                                      ignoreUnknownFeatures);
+}
+
+LogicalResult InferCustomKernelsTargetInfoFromParent(
+    func::FuncOp entryPointFn, CustomKernelsTargetInfo &targetInfo) {
+  // Set the out-value to defaults early so that early returns produce
+  // consistent results and so that we can write simpler code below
+  // (for loop OR-ing booleans, assuming initial 'false' value).
+  targetInfo = CustomKernelsTargetInfo();
+
+  // Try to find the parent ExecutableVariantOp and its relevant attributes.
+  auto variantOp =
+      entryPointFn->getParentOfType<IREE::HAL::ExecutableVariantOp>();
+  if (!variantOp) {
+    return failure();
+  }
+  return inferCustomKernelsTargetInfo(variantOp.getTarget(), targetInfo,
+                                      /*ignoreUnknownFeatures=*/false);
+}
+
+LogicalResult InferCustomKernelsTargetInfoFromTargetAttr(
+    IREE::HAL::ExecutableTargetAttr targetAttr,
+    CustomKernelsTargetInfo &targetInfo) {
+  targetInfo = CustomKernelsTargetInfo();
+  return inferCustomKernelsTargetInfo(targetAttr, targetInfo,
+                                      /*ignoreUnknownFeatures=*/true);
 }
 
 }  // namespace iree_compiler
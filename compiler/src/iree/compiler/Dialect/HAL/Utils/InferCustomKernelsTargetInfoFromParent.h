@@ -11,6 +11,7 @@
 
 #include <cassert>
 
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "iree/compiler/Utils/CustomKernelsTargetInfo.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -22,6 +23,12 @@ namespace iree_compiler {
 LogicalResult InferCustomKernelsTargetInfoFromParent(
     func::FuncOp entryPointFn, CustomKernelsTargetInfo &targetInfo);
 
+// Infers the target info from the `target_triple` and `cpu_features` of
+// |targetAttr|. CPU features not used by custom kernels are ignored.
+LogicalResult InferCustomKernelsTargetInfoFromTargetAttr(
+    IREE::HAL::ExecutableTargetAttr targetAttr,
+    CustomKernelsTargetInfo &targetInfo);
+
 }  // namespace iree_compiler
 }  // namespace mlir
 
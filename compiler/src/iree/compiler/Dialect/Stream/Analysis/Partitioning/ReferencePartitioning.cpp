@@ -5,10 +5,13 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/Debug.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 
 #define DEBUG_TYPE "iree-stream-partitioning"
@@ -219,8 +222,77 @@ PartitionSet partitionStreamableOpsReference(
   return partitionSet;
 }
 
+// Workload elements (as passed to stream.async.dispatch) that are assumed to
+// keep a single execution unit busy. Roughly one 64x64 workgroup tile.
+static constexpr int64_t kWorkloadPerExecutionUnit = 64 * 64;
+
+// Bytes moved by transfer ops that are assumed to keep a single execution unit
+// busy.
+static constexpr int64_t kBytesPerExecutionUnit = 64 * 1024;
+
+// Returns the total constant byte size of all resources read and written by
+// |op| or None if any of them are dynamically sized.
+static Optional<int64_t> estimateResourceBytes(Operation *op) {
+  auto sizeAwareOp = dyn_cast<IREE::Util::SizeAwareOpInterface>(op);
+  if (!sizeAwareOp) return llvm::None;
+  int64_t totalBytes = 0;
+  auto addSize = [&](Value size) {
+    APInt value;
+    if (!size || !matchPattern(size, m_ConstantInt(&value))) return false;
+    totalBytes += value.getSExtValue();
+    return true;
+  };
+  for (auto operand : llvm::enumerate(op->getOperands())) {
+    if (!operand.value().getType().isa<IREE::Stream::ResourceType>()) continue;
+    if (!addSize(sizeAwareOp.getOperandSize(operand.index()))) {
+      return llvm::None;
+    }
+  }
+  for (auto result : llvm::enumerate(op->getResults())) {
+    if (!result.value().getType().isa<IREE::Stream::ResourceType>()) continue;
+    if (!addSize(sizeAwareOp.getResultSize(result.index()))) {
+      return llvm::None;
+    }
+  }
+  return totalBytes;
+}
+
+// Estimates how many of |concurrency| execution units |op| will occupy while
+// it runs. Dispatches are estimated from their workload and fall back to the
+// size of their operands and results; transfers are estimated from their
+// sizes. Ops we can't reason about are assumed to occupy all units.
+static int64_t estimateOccupancy(Operation *op, int64_t concurrency) {
+  int64_t occupancy = concurrency;
+  auto ceilDiv = [](int64_t lhs, int64_t rhs) { return (lhs + rhs - 1) / rhs; };
+  if (auto dispatchOp = dyn_cast<IREE::Stream::AsyncDispatchOp>(op)) {
+    int64_t workload = 1;
+    for (auto value : dispatchOp.getWorkload()) {
+      APInt dim;
+      if (!matchPattern(value, m_ConstantInt(&dim))) {
+        workload = -1;
+        break;
+      }
+      workload *= dim.getSExtValue();
+    }
+    if (workload >= 0) {
+      occupancy = ceilDiv(workload, kWorkloadPerExecutionUnit);
+    } else if (auto bytes = estimateResourceBytes(op)) {
+      occupancy = ceilDiv(*bytes, kBytesPerExecutionUnit);
+    }
+  } else if (auto bytes = estimateResourceBytes(op)) {
+    occupancy = ceilDiv(*bytes, kBytesPerExecutionUnit);
+  }
+  return std::max<int64_t>(1, std::min(occupancy, concurrency));
+}
+
 // This looks to extract a single level of concurrency; we should be recursively
 // dividing the block to identify both serial and concurrent regions.
+//
+// When the config specifies a concurrency each wave tracks the estimated
+// number of execution units its ops occupy and stops accepting ops once it is
+// saturated. Ops that would have joined a saturated wave are placed into
+// another candidate wave or a new one instead so that waves are sized to fill
+// the target (such as the number of CPU cores) without oversubscribing it.
 PartitionSet partitionRegionConcurrencyReference(
     IREE::Stream::PartitioningConfigAttr config, Block *block) {
   PartitionSet waveSet;
@@ -230,11 +302,14 @@ PartitionSet partitionRegionConcurrencyReference(
     // Disable partitioning when favoring debugability.
     return waveSet;
   }
+  int64_t concurrency = config.getConcurrency();
 
   struct PartitionBuilder {
     unsigned ordinal;
     // Ops present in the wave; ops may be present in multiple waves.
     SetVector<Operation *> ops;
+    // Estimated execution units occupied by the ops in the wave.
+    int64_t occupancy = 0;
   };
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
 
@@ -303,6 +378,19 @@ PartitionSet partitionRegionConcurrencyReference(
     opInfo.membership.reserve(builders.size() + 1);
     opInfo.membership.resize(builders.size(), /*t=*/false);
 
+    // Drop candidate waves that are already saturated.
+    int64_t occupancy = 0;
+    if (concurrency > 0) {
+      occupancy = estimateOccupancy(&op, concurrency);
+      for (auto candidateOrdinal : candidates.set_bits()) {
+        if (builders[candidateOrdinal]->occupancy >= concurrency) {
+          LLVM_DEBUG(llvm::dbgs() << "Wave " << candidateOrdinal
+                                  << " is saturated (skip)\n");
+          candidates.reset(candidateOrdinal);
+        }
+      }
+    }
+
     // No consumers - if there's any candidate then we'll go into that.
     int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
                                     ? candidates.find_first()
@@ -311,6 +399,7 @@ PartitionSet partitionRegionConcurrencyReference(
       LLVM_DEBUG(llvm::dbgs() << "Moving to last candidate wave "
                               << firstCandidateOrdinal << " (continue)\n");
       builders[firstCandidateOrdinal]->ops.insert(&op);
+      builders[firstCandidateOrdinal]->occupancy += occupancy;
       opInfo.membership.set(firstCandidateOrdinal);
       opInfo.hazards.set(0, firstCandidateOrdinal);
       opInfo.hazards.reset(firstCandidateOrdinal);
@@ -325,6 +414,7 @@ PartitionSet partitionRegionConcurrencyReference(
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->ops.insert(&op);
+    builder->occupancy = occupancy;
     LLVM_DEBUG(llvm::dbgs() << "Created wave " << builder->ordinal << "\n");
     builders.push_back(std::move(builder));
   }
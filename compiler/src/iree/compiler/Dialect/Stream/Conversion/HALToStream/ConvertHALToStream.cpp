@@ -10,6 +10,7 @@
 #include "iree/compiler/Dialect/Stream/Conversion/PatternUtils.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "mlir/Dialect/Arithmetic/IR/Arithmetic.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 
@@ -121,6 +122,34 @@ struct ConvertTensorImportOp
   }
 };
 
+// Returns the converted tensor imported from the buffer view that |storage|
+// is the backing buffer of, if any. This is the case for inputs donated to
+// outputs at the ABI boundary (`iree.abi.output` on tensor arguments).
+//
+// ConvertTensorImportOp replaces hal.tensor.import with a stream.tensor.import
+// of the buffer view followed by a stream.async.transfer to an unknown
+// lifetime and the transferred resource is the converted tensor. Only imports
+// that have already been converted and precede |exportOp| can be donated.
+static Optional<ConvertedTensor> findDonatedTensor(Value storage,
+                                                   Operation *exportOp) {
+  auto bufferOp = storage.getDefiningOp<IREE::HAL::BufferViewBufferOp>();
+  if (!bufferOp) return llvm::None;
+  for (auto *user : bufferOp.getBufferView().getUsers()) {
+    auto importOp = dyn_cast<IREE::Stream::TensorImportOp>(user);
+    if (!importOp) continue;
+    for (auto *importUser : importOp.getResult().getUsers()) {
+      auto transferOp = dyn_cast<IREE::Stream::AsyncTransferOp>(importUser);
+      if (!transferOp || transferOp->getBlock() != exportOp->getBlock() ||
+          !transferOp->isBeforeInBlock(exportOp)) {
+        continue;
+      }
+      return ConvertedTensor{transferOp.getResult(),
+                             transferOp.getResultSize()};
+    }
+  }
+  return llvm::None;
+}
+
 // %1 = hal.tensor.export %0 : tensor<4xf32> -> !hal.buffer_view
 // ->
 // %1 = stream.tensor.export %0 : tensor<4xf32> in !stream.resource<*> ->
@@ -144,7 +173,38 @@ struct ConvertTensorExportOp
         IREE::Stream::Lifetime::External);
     auto exportSource = adaptor.getSource();
     auto exportSize = source.resourceSize;
+    Optional<ConvertedTensor> donatedTensor;
     if (adaptor.getTargetStorage()) {
+      donatedTensor = findDonatedTensor(op.getTargetStorage(), op);
+    }
+    if (donatedTensor.has_value()) {
+      // The target storage is an input donated by the caller. Values computed
+      // in-place on the input are already stored in it. Otherwise we update the
+      // input value itself (instead of a second import of the same buffer) so
+      // that copy-on-write preserves the input contents if they are still used
+      // and the update happens in-place if not.
+      if (IREE::Util::TiedOpInterface::findTiedBaseValue(source.resource) !=
+          donatedTensor->resource) {
+        auto zeroOffset =
+            rewriter.create<arith::ConstantIndexOp>(op.getLoc(), 0);
+        auto updateOp = rewriter.create<IREE::Stream::AsyncUpdateOp>(
+            op.getLoc(), donatedTensor->resource.getType(),
+            donatedTensor->resource, donatedTensor->resourceSize, zeroOffset,
+            source.resourceSize, source.resource, source.resourceSize,
+            /*affinity=*/nullptr);
+        source.resource = updateOp.getResult();
+        source.resourceSize = updateOp.getTargetSize();
+      }
+      exportSource = source.resource;
+      exportSize = source.resourceSize;
+      if (source.resource.getType() != externalType) {
+        exportSource = rewriter.create<IREE::Stream::AsyncTransferOp>(
+            op.getLoc(), externalType, source.resource, source.resourceSize,
+            source.resourceSize,
+            /*source_affinity=*/nullptr,
+            /*result_affinity=*/nullptr);
+      }
+    } else if (adaptor.getTargetStorage()) {
       // Query the target storage buffer length; we will only populate up to
       // what is required for the output.
       auto storageSize =
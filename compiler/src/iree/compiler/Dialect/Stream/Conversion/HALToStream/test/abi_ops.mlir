@@ -65,3 +65,40 @@ func.func @exportBufferViewInPlace(%tensor: tensor<?x?x4xf32>, %dim0: index, %di
   // CHECK: return %[[STORAGE_RESULT]]
   return %0 : !hal.buffer_view
 }
+
+// -----
+
+// Tests that exporting into the storage of an imported buffer view (a donated
+// input) updates the imported value instead of importing the storage again.
+
+// CHECK-LABEL: @exportBufferViewDonated
+// CHECK-SAME: (%[[VIEW:.+]]: !hal.buffer_view, %[[UPDATE:.+]]: !stream.resource<*>, %[[UPDATE_SIZE:.+]]: index)
+func.func @exportBufferViewDonated(%view: !hal.buffer_view, %update: tensor<4xf32>) -> !hal.buffer_view {
+  //      CHECK: %[[INPUT:.+]] = stream.tensor.import %[[VIEW]]
+  %0 = hal.tensor.import %view : !hal.buffer_view -> tensor<4xf32>
+  %storage = hal.buffer_view.buffer<%view : !hal.buffer_view> : !hal.buffer
+  //  CHECK-NOT: hal.buffer.length
+  //  CHECK-NOT: stream.tensor.import
+  //      CHECK: stream.async.update %[[UPDATE]], %{{.+}}[%c0 to %[[UPDATE_SIZE]]]
+  //      CHECK: %[[RESULT:.+]] = stream.tensor.export
+  %1 = hal.tensor.export %update into %storage : tensor<4xf32> -> !hal.buffer_view
+  // CHECK: return %[[RESULT]]
+  return %1 : !hal.buffer_view
+}
+
+// -----
+
+// Tests that exporting a donated input into its own storage is a no-op.
+
+// CHECK-LABEL: @exportBufferViewDonatedInPlace
+// CHECK-SAME: (%[[VIEW:.+]]: !hal.buffer_view)
+func.func @exportBufferViewDonatedInPlace(%view: !hal.buffer_view) -> !hal.buffer_view {
+  //      CHECK: %[[INPUT:.+]] = stream.tensor.import %[[VIEW]]
+  %0 = hal.tensor.import %view : !hal.buffer_view -> tensor<4xf32>
+  %storage = hal.buffer_view.buffer<%view : !hal.buffer_view> : !hal.buffer
+  //  CHECK-NOT: stream.async.update
+  //      CHECK: %[[RESULT:.+]] = stream.tensor.export
+  %1 = hal.tensor.export %0 into %storage : tensor<4xf32> -> !hal.buffer_view
+  // CHECK: return %[[RESULT]]
+  return %1 : !hal.buffer_view
+}
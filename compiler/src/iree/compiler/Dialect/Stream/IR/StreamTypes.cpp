@@ -38,6 +38,11 @@ static llvm::cl::opt<Favor> clPartitioningFavor(
         clEnumValN(Favor::MaxConcurrency, "max-concurrency",
                    "Favor maximizing concurrency at the cost of additional "
                    "memory consumption.")));
+static llvm::cl::opt<int64_t> clPartitioningConcurrency(
+    "iree-stream-partitioning-concurrency",
+    llvm::cl::desc("Default number of execution units (such as CPU cores) that "
+                   "concurrently scheduled work should fill; 0 is unbounded."),
+    llvm::cl::init(0));
 
 // TODO(#8042): properly choose this value based on target devices. We don't
 // yet have the device information up in stream and thus for targets that have
@@ -239,6 +244,14 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
   } else if (failed(p.parseString(&favorStr))) {
     return {};
   }
+  int64_t concurrency = 0;
+  if (succeeded(p.parseOptionalComma())) {
+    if (failed(p.parseInteger(concurrency))) return {};
+    if (concurrency < 0) {
+      p.emitError(p.getNameLoc(), "concurrency must be >= 0");
+      return {};
+    }
+  }
   if (failed(p.parseGreater())) return {};
   auto favor = symbolizeFavor(favorStr);
   if (!favor.has_value()) {
@@ -246,13 +259,16 @@ Attribute PartitioningConfigAttr::parse(AsmParser &p, Type type) {
     return {};
   }
   return PartitioningConfigAttr::get(
-      FavorAttr::get(p.getContext(), favor.value()));
+      FavorAttr::get(p.getContext(), favor.value()), concurrency);
 }
 
 void PartitioningConfigAttr::print(AsmPrinter &p) const {
   p << "<";
   p << "favor-";
   p << stringifyFavor(getFavor().getValue());
+  if (getConcurrency() != 0) {
+    p << ", " << getConcurrency();
+  }
   p << ">";
 }
 
@@ -265,13 +281,13 @@ PartitioningConfigAttr PartitioningConfigAttr::lookup(Operation *op) {
   }
   // No config found; use defaults.
   auto favorAttr = FavorAttr::get(attrId.getContext(), clPartitioningFavor);
-  return PartitioningConfigAttr::get(favorAttr);
+  return PartitioningConfigAttr::get(favorAttr, clPartitioningConcurrency);
 }
 
 Attribute PartitioningConfigAttr::replaceImmediateSubElements(
     ArrayRef<Attribute> replAttrs, ArrayRef<Type> replTypes) const {
   return PartitioningConfigAttr::get(
-      replAttrs[0].cast<IREE::Stream::FavorAttr>());
+      replAttrs[0].cast<IREE::Stream::FavorAttr>(), getConcurrency());
 }
 
 //===----------------------------------------------------------------------===//
@@ -360,6 +376,7 @@ Value ResourceType::createSubrangeOp(Location loc, Value resource,
 void StreamDialect::registerAttributes() {
   // Register command line flags:
   (void)clPartitioningFavor;
+  (void)clPartitioningConcurrency;
   (void)clResourceMaxAllocationSize;
   (void)clResourceMinOffsetAlignment;
   (void)clResourceMaxRange;
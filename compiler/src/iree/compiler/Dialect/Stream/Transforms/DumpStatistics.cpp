@@ -13,6 +13,7 @@
 #include "iree/compiler/Dialect/Stream/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Format.h"
@@ -51,6 +52,9 @@ struct UsageInfo {
   // stream.cmd.execute ops containing all relevant device commands.
   SmallVector<IREE::Stream::CmdExecuteOp> executeOps;
   SmallVector<IREE::Stream::ResourceAllocaOp> allocaOps;
+  // stream.resource.alloca/dealloca ops in program order per function;
+  // each pair bounds the lifetime interval of a transient.
+  llvm::MapVector<Operation *, SmallVector<Operation *>> transientLifetimeOps;
 
   // stream.timepoint.await ops indicating host/device synchronization.
   SmallVector<IREE::Stream::TimepointAwaitOp> awaitOps;
@@ -68,8 +72,13 @@ struct UsageInfo {
     for (auto funcLikeOp : moduleOp.getOps<FunctionOpInterface>()) {
       funcLikeOp.walk([&](Operation *op) {
         TypeSwitch<Operation *>(op)
-            .Case<IREE::Stream::ResourceAllocaOp>(
-                [&](auto op) { allocaOps.push_back(op); })
+            .Case<IREE::Stream::ResourceAllocaOp>([&](auto op) {
+              allocaOps.push_back(op);
+              transientLifetimeOps[funcLikeOp.getOperation()].push_back(op);
+            })
+            .Case<IREE::Stream::ResourceDeallocaOp>([&](auto op) {
+              transientLifetimeOps[funcLikeOp.getOperation()].push_back(op);
+            })
             .Case<IREE::Stream::CmdExecuteOp>(
                 [&](auto op) { executeOps.push_back(op); })
             .Case<IREE::Stream::TimepointAwaitOp>(
@@ -106,6 +115,9 @@ struct Statistics {
   size_t submissionCount = 0;
   int64_t transientSize = 0;
   bool transientSizeDynamic = false;
+  size_t transientAllocationCount = 0;
+  // Largest transient size live at any point within a single function.
+  int64_t peakTransientSize = 0;
   // TODO(benvanik): add fill/copy sizes (when possible).
   size_t fillCount = 0;
   size_t copyCount = 0;
@@ -138,6 +150,7 @@ struct Statistics {
 
     // Execution:
     submissionCount = usageInfo.executeOps.size();
+    transientAllocationCount = usageInfo.allocaOps.size();
     for (auto allocaOp : usageInfo.allocaOps) {
       APInt allocaSize;
       if (matchPattern(allocaOp.getStorageSize(), m_ConstantInt(&allocaSize))) {
@@ -146,6 +159,7 @@ struct Statistics {
         transientSizeDynamic = true;
       }
     }
+    peakTransientSize = calculatePeakTransientSize(usageInfo);
     for (auto executeOp : usageInfo.executeOps) {
       executeOp.walk([&](Operation *op) {
         TypeSwitch<Operation *>(op)
@@ -159,6 +173,35 @@ struct Statistics {
     // Executables:
     executableCount = usageInfo.executableOps.size();
   }
+
+  // Returns the peak transient size by sweeping the alloca/dealloca lifetime
+  // intervals of each function in program order. Transients that are never
+  // deallocated remain live until the end of the function. Packed arenas are
+  // a single alloca already sized to the peak of the intervals packed into it.
+  static int64_t calculatePeakTransientSize(const UsageInfo &usageInfo) {
+    int64_t peakSize = 0;
+    for (auto &it : usageInfo.transientLifetimeOps) {
+      DenseMap<Value, int64_t> liveSizes;
+      int64_t liveSize = 0;
+      for (auto *op : it.second) {
+        if (auto allocaOp = dyn_cast<IREE::Stream::ResourceAllocaOp>(op)) {
+          APInt allocaSize;
+          if (!matchPattern(allocaOp.getStorageSize(),
+                            m_ConstantInt(&allocaSize))) {
+            continue;
+          }
+          liveSizes[allocaOp.getResult()] = allocaSize.getSExtValue();
+          liveSize += allocaSize.getSExtValue();
+          peakSize = std::max(peakSize, liveSize);
+        } else if (auto deallocaOp =
+                       dyn_cast<IREE::Stream::ResourceDeallocaOp>(op)) {
+          liveSize -= liveSizes.lookup(deallocaOp.getOperand());
+          liveSizes.erase(deallocaOp.getOperand());
+        }
+      }
+    }
+    return peakSize;
+  }
 };
 
 //===----------------------------------------------------------------------===//
@@ -223,6 +266,11 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv(
       "{0}{1} B ({2:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
       stats.transientSize, stats.transientSize / (1 * 1024 * 1024.0f));
+  os << llvm::formatv("//  Transients: {0}, peak ",
+                      stats.transientAllocationCount);
+  os << llvm::formatv(
+      "{0}{1} B ({2:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
+      stats.peakTransientSize, stats.peakTransientSize / (1 * 1024 * 1024.0f));
 
   os << llvm::formatv("//   DMA Fills: {0}\n", stats.fillCount);
   os << llvm::formatv("//  DMA Copies: {0}\n", stats.copyCount);
@@ -380,7 +428,7 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   Statistics stats;
   stats.analyze(usageInfo);
 
-  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Executables")";
+  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Allocations","Peak Transient Size","Fills","Copies","Dispatches","Executables")";
   os << "\n";
 
   // Globals:
@@ -392,8 +440,9 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   os << llvm::formatv("{0},", stats.awaitCount);
 
   // Execution:
-  os << llvm::formatv("{0},{1},{2},{3},{4},", stats.submissionCount,
-                      stats.transientSize, stats.fillCount, stats.copyCount,
+  os << llvm::formatv("{0},{1},{2},{3},{4},{5},{6},", stats.submissionCount,
+                      stats.transientSize, stats.transientAllocationCount,
+                      stats.peakTransientSize, stats.fillCount, stats.copyCount,
                       stats.dispatchCount);
 
   // Executables:
@@ -512,6 +561,10 @@ static void dumpAggregateJSONStructure(const UsageInfo &usageInfo,
   os << "  \"execution\": {\n";
   os << llvm::formatv(kvPair, "submission-count", stats.submissionCount);
   os << llvm::formatv(kvPair, "transient-memory-size", stats.transientSize);
+  os << llvm::formatv(kvPair, "transient-allocation-count",
+                      stats.transientAllocationCount);
+  os << llvm::formatv(kvPair, "peak-transient-memory-size",
+                      stats.peakTransientSize);
   os << llvm::formatv(kvPair, "fill-count", stats.fillCount);
   os << llvm::formatv(kvPair, "copy-count", stats.copyCount);
   os << llvm::formatv(kvPairNoComma, "dispatch-count", stats.dispatchCount);
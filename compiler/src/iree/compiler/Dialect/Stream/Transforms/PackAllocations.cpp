@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/IR/AsmState.h"
@@ -29,12 +30,220 @@ namespace IREE {
 namespace Stream {
 namespace {
 
+//===----------------------------------------------------------------------===//
+// Function-level transient arenas
+//===----------------------------------------------------------------------===//
+
+// A stream-ordered transient allocation released within the same block.
+struct TransientReservation {
+  IREE::Stream::ResourceAllocaOp allocaOp;
+  IREE::Stream::ResourceDeallocaOp deallocaOp;
+  // Ordinals of the alloca and dealloca ops in the block.
+  int64_t start = 0;
+  int64_t end = 0;
+};
+
+// Returns true if |value| is available before |insertionPt|. Pure ops in the
+// same block defining the value (such as the stream.resource.pack ops computing
+// transient slab sizes) are moved above |insertionPt| as needed.
+static bool makeAvailableBefore(Value value, Operation *insertionPt) {
+  auto *definingOp = value.getDefiningOp();
+  if (!definingOp || definingOp->getBlock() != insertionPt->getBlock() ||
+      definingOp->isBeforeInBlock(insertionPt)) {
+    return true;
+  }
+  if (definingOp->getNumRegions() != 0 ||
+      !MemoryEffectOpInterface::hasNoEffect(definingOp)) {
+    return false;
+  }
+  for (auto operand : definingOp->getOperands()) {
+    if (!makeAvailableBefore(operand, insertionPt)) return false;
+  }
+  definingOp->moveBefore(insertionPt);
+  return true;
+}
+
+// Gathers all transient allocas in |block| with a single dealloca in the same
+// block, grouped by their type and affinity.
+static SmallVector<SmallVector<TransientReservation>>
+findTransientReservations(Block &block) {
+  DenseMap<Operation *, int64_t> opOrdinals;
+  int64_t opOrdinal = 0;
+  for (auto &op : block) opOrdinals[&op] = opOrdinal++;
+
+  llvm::MapVector<std::pair<Type, Attribute>,
+                  SmallVector<TransientReservation>>
+      reservationGroups;
+  for (auto allocaOp : block.getOps<IREE::Stream::ResourceAllocaOp>()) {
+    IREE::Stream::ResourceDeallocaOp deallocaOp;
+    bool isLocal = true;
+    for (auto *user : allocaOp.getResult().getUsers()) {
+      if (user->getBlock() != &block) {
+        isLocal = false;
+        break;
+      }
+      if (auto userDeallocaOp =
+              dyn_cast<IREE::Stream::ResourceDeallocaOp>(user)) {
+        if (deallocaOp) {
+          isLocal = false;
+          break;
+        }
+        deallocaOp = userDeallocaOp;
+      }
+    }
+    if (!isLocal || !deallocaOp ||
+        deallocaOp.getAffinityAttr() != allocaOp.getAffinityAttr()) {
+      continue;
+    }
+    TransientReservation reservation;
+    reservation.allocaOp = allocaOp;
+    reservation.deallocaOp = deallocaOp;
+    reservation.start = opOrdinals[allocaOp];
+    reservation.end = opOrdinals[deallocaOp];
+    reservationGroups[std::make_pair(allocaOp.getResult().getType(),
+                                     allocaOp.getAffinityAttr())]
+        .push_back(reservation);
+  }
+
+  SmallVector<SmallVector<TransientReservation>> groups;
+  for (auto &it : reservationGroups) {
+    if (it.second.size() > 1) groups.push_back(std::move(it.second));
+  }
+  return groups;
+}
+
+// Replaces the transient allocas in |reservations| with subviews of a single
+// arena allocated at the first of them and released at the last. Slices are
+// packed by their lifetime intervals in the block such that transients of
+// execution regions that don't overlap can share memory. As the memory of a
+// transient may then be reused by any transient released before it was
+// allocated those must be released before it can be used.
+//
+// The packed offsets are only known after slice layout so we conservatively
+// assume that every earlier released slice aliases. This orders each region
+// after the completion of all prior regions using the arena and removes any
+// concurrency between them; the tradeoff for fewer allocations and a lower peak
+// is why packing is opt-in.
+static void packTransientArena(ArrayRef<TransientReservation> reservations) {
+  auto firstAllocaOp = reservations.front().allocaOp;
+  auto lastDeallocaOp =
+      llvm::max_element(reservations, [](auto &lhs, auto &rhs) {
+        return lhs.end < rhs.end;
+      })->deallocaOp;
+
+  // Slab sizes of each region are usually computed just before the region;
+  // they must be hoisted to where the arena is allocated.
+  SmallVector<TransientReservation> packedReservations;
+  for (auto &reservation : reservations) {
+    if (makeAvailableBefore(reservation.allocaOp.getStorageSize(),
+                            firstAllocaOp)) {
+      packedReservations.push_back(reservation);
+    }
+  }
+  if (packedReservations.size() < 2) return;
+
+  SmallVector<Location> locs;
+  SmallVector<int64_t> lifetimeIntervals;
+  SmallVector<Value> dynamicSliceSizes;
+  for (auto &reservation : packedReservations) {
+    locs.push_back(reservation.allocaOp.getLoc());
+    lifetimeIntervals.push_back(reservation.start);
+    lifetimeIntervals.push_back(reservation.end);
+    dynamicSliceSizes.push_back(reservation.allocaOp.getStorageSize());
+  }
+
+  OpBuilder builder(firstAllocaOp);
+  auto fusedLoc = builder.getFusedLoc(locs);
+  auto indexType = builder.getIndexType();
+  auto timepointType = builder.getType<IREE::Stream::TimepointType>();
+  SmallVector<Type> packedOffsetTypes(dynamicSliceSizes.size(), indexType);
+  auto packOp = builder.create<IREE::Stream::ResourcePackOp>(
+      fusedLoc, indexType, packedOffsetTypes, /*offset=*/nullptr,
+      builder.getIndexArrayAttr(lifetimeIntervals), dynamicSliceSizes,
+      firstAllocaOp.getAffinityAttr());
+  auto arenaOp = builder.create<IREE::Stream::ResourceAllocaOp>(
+      fusedLoc, firstAllocaOp.getResult().getType(), timepointType,
+      packOp.getTotalLength(), firstAllocaOp.getAwaitTimepoint(),
+      firstAllocaOp.getAffinityAttr());
+  auto arena = arenaOp.getResult();
+  auto arenaSize = packOp.getTotalLength();
+
+  // Replace each alloca with a subview of the arena that is ready once the
+  // arena is and all transients that may alias it have been released.
+  for (auto it : llvm::enumerate(packedReservations)) {
+    auto allocaOp = it.value().allocaOp;
+    builder.setInsertionPoint(allocaOp);
+    auto subviewOp = builder.create<IREE::Stream::ResourceSubviewOp>(
+        allocaOp.getLoc(), arena, arenaSize,
+        packOp.getPackedOffsets()[it.index()], allocaOp.getStorageSize());
+    SmallVector<Value> readyTimepoints;
+    readyTimepoints.push_back(arenaOp.getResultTimepoint());
+    if (it.index() > 0 && allocaOp.getAwaitTimepoint()) {
+      readyTimepoints.push_back(allocaOp.getAwaitTimepoint());
+    }
+    for (auto &reservation : packedReservations) {
+      if (reservation.end < it.value().start &&
+          reservation.deallocaOp.getAwaitTimepoint()) {
+        readyTimepoints.push_back(reservation.deallocaOp.getAwaitTimepoint());
+      }
+    }
+    Value readyTimepoint = readyTimepoints.front();
+    if (readyTimepoints.size() > 1) {
+      readyTimepoint = builder.create<IREE::Stream::TimepointJoinOp>(
+          allocaOp.getLoc(), timepointType, readyTimepoints);
+    }
+    allocaOp.getResult().replaceAllUsesWith(subviewOp.getResult());
+    allocaOp.getResultTimepoint().replaceAllUsesWith(readyTimepoint);
+    allocaOp.erase();
+  }
+
+  // Release the arena once all transients have been released. Releases of the
+  // individual transients now complete as soon as their uses do.
+  builder.setInsertionPoint(lastDeallocaOp);
+  SmallVector<Value> releaseTimepoints;
+  for (auto &reservation : packedReservations) {
+    if (auto awaitTimepoint = reservation.deallocaOp.getAwaitTimepoint()) {
+      releaseTimepoints.push_back(awaitTimepoint);
+    }
+  }
+  Value releaseTimepoint;
+  if (releaseTimepoints.size() == 1) {
+    releaseTimepoint = releaseTimepoints.front();
+  } else if (releaseTimepoints.size() > 1) {
+    releaseTimepoint = builder.create<IREE::Stream::TimepointJoinOp>(
+        lastDeallocaOp.getLoc(), timepointType, releaseTimepoints);
+  }
+  auto arenaDeallocaOp = builder.create<IREE::Stream::ResourceDeallocaOp>(
+      fusedLoc, arena, arenaSize, releaseTimepoint,
+      lastDeallocaOp.getAffinityAttr());
+  for (auto &reservation : packedReservations) {
+    auto deallocaOp = reservation.deallocaOp;
+    Value timepoint = arenaDeallocaOp.getResultTimepoint();
+    if (deallocaOp != lastDeallocaOp) {
+      timepoint = deallocaOp.getAwaitTimepoint();
+      if (!timepoint) {
+        timepoint = OpBuilder(deallocaOp)
+                        .create<IREE::Stream::TimepointImmediateOp>(
+                            deallocaOp.getLoc(), timepointType)
+                        .getResultTimepoint();
+      }
+    }
+    deallocaOp.getResultTimepoint().replaceAllUsesWith(timepoint);
+    deallocaOp.erase();
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // -iree-stream-pack-allocations
 //===----------------------------------------------------------------------===//
 
 class PackAllocationsPass : public PackAllocationsBase<PackAllocationsPass> {
  public:
+  PackAllocationsPass() = default;
+  PackAllocationsPass(bool packTransients) {
+    this->packTransients = packTransients;
+  }
+
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<mlir::func::FuncDialect>();
     registry.insert<IREE::Stream::StreamDialect>();
@@ -104,14 +313,25 @@ class PackAllocationsPass : public PackAllocationsBase<PackAllocationsPass> {
 
       allocOp.erase();
     });
+
+    // Transients of each execution region are allocated independently by
+    // stream.resource.alloca. Pack all of those within a block into a single
+    // arena so that regions that don't overlap reuse the same memory and each
+    // invocation performs a single allocation.
+    if (!packTransients) return;
+    parentOp.walk([&](Block *block) {
+      for (auto &reservations : findTransientReservations(*block)) {
+        packTransientArena(reservations);
+      }
+    });
   }
 };
 
 }  // namespace
 
 std::unique_ptr<InterfacePass<CallableOpInterface>>
-createPackAllocationsPass() {
-  return std::make_unique<PackAllocationsPass>();
+createPackAllocationsPass(bool packTransients) {
+  return std::make_unique<PackAllocationsPass>(packTransients);
 }
 
 }  // namespace Stream
@@ -176,7 +176,10 @@ void buildStreamCmdPassPipeline(OpPassManager &passManager,
       .addPass(IREE::Stream::createPackConstantsPass)
 
       // Pack fused allocations based on lifetime.
-      .addPass(IREE::Stream::createPackAllocationsPass)
+      .addPass([&]() {
+        return IREE::Stream::createPackAllocationsPass(
+            transformOptions.packTransients);
+      })
 
       // Layout packed slices to emit the arithmetic required for all resource
       // offsets. This enables us to propagate the subviews across the program
@@ -35,6 +35,16 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
       llvm::cl::init(true),
   };
 
+  Option<bool> packTransients{
+      *this,
+      "pack-transients",
+      llvm::cl::desc(
+          "Packs the stream-ordered transients of each block into a single "
+          "arena. Reduces allocations and peak memory but execution regions "
+          "then wait on the release of all transients released before them."),
+      llvm::cl::init(false),
+  };
+
   Option<DumpOutputFormat> dumpStatisticsFormat{
       *this,
       "dump-statistics-format",
@@ -134,7 +144,8 @@ std::unique_ptr<InterfacePass<CallableOpInterface>>
 createScheduleAllocationPass();
 
 std::unique_ptr<InterfacePass<CallableOpInterface>> createPackConstantsPass();
-std::unique_ptr<InterfacePass<CallableOpInterface>> createPackAllocationsPass();
+std::unique_ptr<InterfacePass<CallableOpInterface>> createPackAllocationsPass(
+    bool packTransients = false);
 std::unique_ptr<InterfacePass<CallableOpInterface>> createLayoutSlicesPass();
 
 //===----------------------------------------------------------------------===//
@@ -6,14 +6,15 @@
 // CHECK-PRETTY:   Variables: 0, 0 B
 // CHECK-PRETTY:  D->H Syncs: 2
 // CHECK-PRETTY: Submissions: 3, using cumulative 0 B
+// CHECK-PRETTY:  Transients: 0, peak 0 B
 // CHECK-PRETTY:   DMA Fills: 0
 // CHECK-PRETTY:  DMA Copies: 2
 // CHECK-PRETTY:  Dispatches: 3
 // CHECK-PRETTY: Executables: 2, 33% reuse
 
 // CHECK-CSV: ; Aggregate Statistics
-// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Executables"
-// CHECK-CSV: 1,0,0,0,2,3,0,0,2,3,2
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Allocations","Peak Transient Size","Fills","Copies","Dispatches","Executables"
+// CHECK-CSV: 1,0,0,0,2,3,0,0,0,0,2,3,2
 // CHECK-CSV: ; Execution
 // CHECK-CSV: "Depth","Command","Symbol","Length","Invocations","Workload","Operands","Resources"
 // CHECK-CSV: 0,"copy",,192,,,,
@@ -155,3 +156,29 @@ func.func public @func_a() -> (tensor<4xi32>, tensor<4xi32>) {
   %7 = stream.tensor.export %6 : tensor<4xi32> in !stream.resource<external>{%c16} -> tensor<4xi32>
   return %5, %7 : tensor<4xi32>, tensor<4xi32>
 }
+
+// -----
+
+// The peak only counts transients with overlapping lifetimes: %a is released
+// before %b and %c are allocated.
+
+// CHECK-PRETTY: Aggregate Statistics
+// CHECK-PRETTY: Submissions: 0, using cumulative 112 B
+// CHECK-PRETTY:  Transients: 3, peak 48 B
+
+// CHECK-CSV: ; Aggregate Statistics
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Allocations","Peak Transient Size","Fills","Copies","Dispatches","Executables"
+// CHECK-CSV: 0,0,0,0,0,0,112,3,48,0,0,0,0
+
+func.func @transient_lifetimes() {
+  %c16 = arith.constant 16 : index
+  %c32 = arith.constant 32 : index
+  %c64 = arith.constant 64 : index
+  %a, %a_ready = stream.resource.alloca uninitialized : !stream.resource<transient>{%c64} => !stream.timepoint
+  %a_freed = stream.resource.dealloca await(%a_ready) => %a : !stream.resource<transient>{%c64} => !stream.timepoint
+  %b, %b_ready = stream.resource.alloca uninitialized await(%a_freed) => !stream.resource<transient>{%c32} => !stream.timepoint
+  %c, %c_ready = stream.resource.alloca uninitialized await(%a_freed) => !stream.resource<transient>{%c16} => !stream.timepoint
+  %b_freed = stream.resource.dealloca await(%b_ready) => %b : !stream.resource<transient>{%c32} => !stream.timepoint
+  %c_freed = stream.resource.dealloca await(%c_ready) => %c : !stream.resource<transient>{%c16} => !stream.timepoint
+  return
+}
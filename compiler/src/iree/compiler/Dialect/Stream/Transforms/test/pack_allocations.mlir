@@ -1,4 +1,5 @@
-// RUN: iree-opt --split-input-file --pass-pipeline='func.func(iree-stream-pack-allocations)' %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline='func.func(iree-stream-pack-allocations)' %s | FileCheck %s --check-prefixes=CHECK,NOPACK
+// RUN: iree-opt --split-input-file --pass-pipeline='func.func(iree-stream-pack-allocations{pack-transients=true})' %s | FileCheck %s --check-prefixes=CHECK,PACK
 
 // CHECK-LABEL: @packAllocations
 // CHECK-SAME: (%[[SIZE_A:.+]]: index, %[[SIZE_B:.+]]: index)
@@ -36,3 +37,73 @@ func.func @packEmpty() {
   util.do_not_optimize(%0) : !stream.resource<transient>
   return
 }
+
+// -----
+
+// Tests that transient allocas within a block are packed into a single arena
+// when enabled. A is released before B and C are allocated and may share memory
+// with them; B and C must wait for A to be released before using their memory.
+// Without packing the allocas are left as-is and B and C do not wait on A.
+
+// CHECK-LABEL: @packTransients
+// CHECK-SAME: (%[[SIZE_A:[a-z0-9_]+]]: index, %[[SIZE_B:[a-z0-9_]+]]: index, %[[SIZE_C:[a-z0-9_]+]]: index,
+// CHECK-SAME:  %[[AWAIT_A:[a-z0-9_]+]]: !stream.timepoint, %[[AWAIT_B:[a-z0-9_]+]]: !stream.timepoint,
+// CHECK-SAME:  %[[DONE_A:[a-z0-9_]+]]: !stream.timepoint, %[[DONE_B:[a-z0-9_]+]]: !stream.timepoint, %[[DONE_C:[a-z0-9_]+]]: !stream.timepoint)
+func.func @packTransients(%size_a: index, %size_b: index, %size_c: index,
+                          %await_a: !stream.timepoint, %await_b: !stream.timepoint,
+                          %done_a: !stream.timepoint, %done_b: !stream.timepoint, %done_c: !stream.timepoint) -> !stream.timepoint {
+  // NOPACK-NOT: stream.resource.pack
+  // NOPACK: stream.resource.alloca uninitialized await(%[[AWAIT_A]])
+  // NOPACK: stream.resource.dealloca await(%[[DONE_A]])
+  // NOPACK: stream.resource.alloca uninitialized await(%[[AWAIT_B]])
+  // NOPACK-NOT: stream.timepoint.join
+  // NOPACK: stream.resource.alloca uninitialized :
+  // NOPACK-NOT: stream.timepoint.join
+  // NOPACK: stream.resource.dealloca await(%[[DONE_B]])
+  // NOPACK: stream.resource.dealloca await(%[[DONE_C]])
+
+  //      PACK: %[[SLICES:.+]]:4 = stream.resource.pack slices({
+  // PACK-NEXT:   [0, 3] = %[[SIZE_A]],
+  // PACK-NEXT:   [4, 10] = %[[SIZE_B]],
+  // PACK-NEXT:   [7, 11] = %[[SIZE_C]]
+  // PACK-NEXT: }) : index
+  // PACK-NEXT: %[[ARENA:.+]], %[[ARENA_READY:.+]] = stream.resource.alloca uninitialized await(%[[AWAIT_A]]) => !stream.resource<transient>{%[[SLICES]]#0} => !stream.timepoint
+  // PACK-NEXT: %[[A:.+]] = stream.resource.subview %[[ARENA]][%[[SLICES]]#1]
+  // PACK-SAME: !stream.resource<transient>{%[[SLICES]]#0} -> !stream.resource<transient>{%[[SIZE_A]]}
+  %a, %a_ready = stream.resource.alloca uninitialized await(%await_a) => !stream.resource<transient>{%size_a} => !stream.timepoint
+  // PACK-NEXT: util.do_not_optimize(%[[A]])
+  util.do_not_optimize(%a) : !stream.resource<transient>
+  // PACK-NEXT: util.do_not_optimize(%[[ARENA_READY]])
+  util.do_not_optimize(%a_ready) : !stream.timepoint
+  // PACK-NOT: stream.resource.dealloca
+  %a_freed = stream.resource.dealloca await(%done_a) => %a : !stream.resource<transient>{%size_a} => !stream.timepoint
+
+  // PACK: %[[B:.+]] = stream.resource.subview %[[ARENA]][%[[SLICES]]#2]
+  // PACK-SAME: !stream.resource<transient>{%[[SLICES]]#0} -> !stream.resource<transient>{%[[SIZE_B]]}
+  // PACK-NEXT: %[[B_READY:.+]] = stream.timepoint.join max(%[[ARENA_READY]], %[[AWAIT_B]], %[[DONE_A]])
+  %b, %b_ready = stream.resource.alloca uninitialized await(%await_b) => !stream.resource<transient>{%size_b} => !stream.timepoint
+  // PACK-NEXT: util.do_not_optimize(%[[B]])
+  util.do_not_optimize(%b) : !stream.resource<transient>
+  // PACK-NEXT: util.do_not_optimize(%[[B_READY]])
+  util.do_not_optimize(%b_ready) : !stream.timepoint
+
+  // PACK-NEXT: %[[C:.+]] = stream.resource.subview %[[ARENA]][%[[SLICES]]#3]
+  // PACK-SAME: !stream.resource<transient>{%[[SLICES]]#0} -> !stream.resource<transient>{%[[SIZE_C]]}
+  // PACK-NEXT: %[[C_READY:.+]] = stream.timepoint.join max(%[[ARENA_READY]], %[[DONE_A]])
+  %c, %c_ready = stream.resource.alloca uninitialized : !stream.resource<transient>{%size_c} => !stream.timepoint
+  // PACK-NEXT: util.do_not_optimize(%[[C]])
+  util.do_not_optimize(%c) : !stream.resource<transient>
+  // PACK-NEXT: util.do_not_optimize(%[[C_READY]])
+  util.do_not_optimize(%c_ready) : !stream.timepoint
+
+  // PACK-NOT: stream.resource.dealloca
+  %b_freed = stream.resource.dealloca await(%done_b) => %b : !stream.resource<transient>{%size_b} => !stream.timepoint
+  // PACK: %[[RELEASE:.+]] = stream.timepoint.join max(%[[DONE_A]], %[[DONE_B]], %[[DONE_C]])
+  // PACK-NEXT: %[[ARENA_FREED:.+]] = stream.resource.dealloca await(%[[RELEASE]]) => %[[ARENA]] : !stream.resource<transient>{%[[SLICES]]#0} => !stream.timepoint
+  %c_freed = stream.resource.dealloca await(%done_c) => %c : !stream.resource<transient>{%size_c} => !stream.timepoint
+
+  // PACK: %[[JOIN:.+]] = stream.timepoint.join max(%[[DONE_A]], %[[DONE_B]], %[[ARENA_FREED]])
+  %join = stream.timepoint.join max(%a_freed, %b_freed, %c_freed) => !stream.timepoint
+  // PACK: return %[[JOIN]]
+  return %join : !stream.timepoint
+}
@@ -98,3 +98,73 @@ func.func @partitioningForMaxConcurrency(%arg0: !stream.resource<external>, %arg
   %0 = stream.timepoint.await %result_timepoint => %results : !stream.resource<external>{%c20}
   return %0 : !stream.resource<external>
 }
+
+// -----
+
+// Tests that when a concurrency is specified waves stop accepting work once
+// their estimated occupancy reaches it. Each of the small dispatches occupies
+// one of the two execution units and they are split into two waves.
+
+// CHECK-LABEL: @partitioningWithConcurrency
+func.func @partitioningWithConcurrency(%arg0: !stream.resource<external>) -> (!stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>)
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency", 2>} {
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c80 = arith.constant 80 : index
+  // CHECK: stream.async.execute
+  %results:4, %result_timepoint = stream.async.execute
+      with(%arg0 as %arg1: !stream.resource<external>{%c80})
+      -> (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) {
+
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_0
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    // CHECK-NEXT: stream.yield
+
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_2
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_3
+    // CHECK-NEXT: stream.yield
+
+    %0 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    %1 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    %2 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    %3 = stream.async.dispatch @ex::@dispatch_3[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    stream.yield %0, %1, %2, %3 : !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}
+  } => !stream.timepoint
+  %4:4 = stream.timepoint.await %result_timepoint => %results#0, %results#1, %results#2, %results#3 : !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}
+  return %4#0, %4#1, %4#2, %4#3 : !stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>
+}
+
+// -----
+
+// Tests that a dispatch with a workload large enough to occupy all execution
+// units is not scheduled concurrently with other work.
+
+// CHECK-LABEL: @partitioningWithSaturatingDispatch
+func.func @partitioningWithSaturatingDispatch(%arg0: !stream.resource<external>) -> (!stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>)
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency", 2>} {
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c80 = arith.constant 80 : index
+  %c128 = arith.constant 128 : index
+  // CHECK: stream.async.execute
+  %results:3, %result_timepoint = stream.async.execute
+      with(%arg0 as %arg1: !stream.resource<external>{%c80})
+      -> (!stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}) {
+
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_2
+    // CHECK-NEXT: stream.yield
+    // CHECK-NOT: stream.async.concurrent
+    // CHECK: } => !stream.timepoint
+
+    %0 = stream.async.dispatch @ex::@dispatch_0[%c128, %c128, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    %1 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    %2 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%arg1) : (!stream.resource<external>{%c80}) -> !stream.resource<transient>{%c20}
+    stream.yield %0, %1, %2 : !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}
+  } => !stream.timepoint
+  %3:3 = stream.timepoint.await %result_timepoint => %results#0, %results#1, %results#2 : !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}, !stream.resource<transient>{%c20}
+  return %3#0, %3#1, %3#2 : !stream.resource<transient>, !stream.resource<transient>, !stream.resource<transient>
+}
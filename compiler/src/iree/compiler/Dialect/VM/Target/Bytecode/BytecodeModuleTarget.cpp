@@ -311,6 +311,63 @@ static iree_vm_FunctionSignatureDef_ref_t makeInternalFunctionSignatureDef(
                                     cconv.value(), /*attrsRef=*/0, fbb);
 }
 
+// Returns true if |value| is a read-only buffer or null. Rodata buffers cannot
+// be mutated by the VM (stores to them fail at runtime) and can be shared.
+static bool isImmutableRefValue(Value value) {
+  auto *definingOp = value.getDefiningOp();
+  return definingOp &&
+         isa<IREE::VM::ConstRefRodataOp, IREE::VM::RodataInlineOp,
+             IREE::VM::ConstRefZeroOp>(definingOp);
+}
+
+// Returns the ordinals of !vm.buffer globals that are only stored by the module
+// initializer with read-only rodata (or null). The buffers they reference can
+// be shared across module states forked from an initialized state.
+//
+// Other ref types are conservatively never shared as the VM cannot tell
+// whether the objects they reference are mutated (through vm.list.set,
+// vm.buffer.store, or imports) even if the globals themselves are not.
+static SmallVector<int32_t> findImmutableGlobalRefOrdinals(
+    IREE::VM::ModuleOp moduleOp) {
+  SmallVector<int32_t> ordinals;
+
+  // Indirect stores may target any global so we can't tell which are mutable.
+  bool hasIndirectStores = false;
+  moduleOp.walk([&](IREE::Util::GlobalStoreIndirectOpInterface op) {
+    hasIndirectStores = true;
+    return WalkResult::interrupt();
+  });
+  if (hasIndirectStores) return ordinals;
+
+  for (auto globalOp : moduleOp.getBlock().getOps<IREE::VM::GlobalRefOp>()) {
+    if (!globalOp.isPrivate()) continue;
+    auto refType = globalOp.getGlobalType().dyn_cast<IREE::VM::RefType>();
+    if (!refType || !refType.getObjectType().isa<IREE::VM::BufferType>()) {
+      continue;
+    }
+    auto uses = SymbolTable::getSymbolUses(globalOp, moduleOp);
+    if (!uses.has_value()) continue;
+    bool isImmutable = true;
+    for (auto use : uses.value()) {
+      auto *user = use.getUser();
+      if (isa<IREE::Util::GlobalLoadOpInterface>(user)) continue;
+      if (auto storeOp = dyn_cast<IREE::Util::GlobalStoreOpInterface>(user)) {
+        auto funcOp = user->getParentOfType<IREE::VM::FuncOp>();
+        if (funcOp && funcOp.getName() == "__init" &&
+            isImmutableRefValue(storeOp.getStoredGlobalValue())) {
+          continue;
+        }
+      }
+      isImmutable = false;
+      break;
+    }
+    if (isImmutable) {
+      ordinals.push_back(globalOp.getOrdinal()->getLimitedValue());
+    }
+  }
+  return ordinals;
+}
+
 // Builds a complete BytecodeModuleDef FlatBuffer object in |fbb|.
 // The order of the encoding is ordered to ensure that all metadata is at the
 // front of the resulting buffer. Large read-only data and bytecode blobs always
@@ -523,9 +580,18 @@ static LogicalResult buildFlatBufferModule(
 
   iree_vm_ModuleStateDef_ref_t moduleStateDef = 0;
   if (globalBytes || globalRefs) {
+    flatbuffers_int32_vec_ref_t immutableGlobalRefOrdinalsRef = 0;
+    auto immutableGlobalRefOrdinals = findImmutableGlobalRefOrdinals(moduleOp);
+    if (!immutableGlobalRefOrdinals.empty()) {
+      immutableGlobalRefOrdinalsRef = flatbuffers_int32_vec_create(
+          fbb, immutableGlobalRefOrdinals.data(),
+          immutableGlobalRefOrdinals.size());
+    }
     iree_vm_ModuleStateDef_start(fbb);
     iree_vm_ModuleStateDef_global_bytes_capacity_add(fbb, globalBytes);
     iree_vm_ModuleStateDef_global_ref_count_add(fbb, globalRefs);
+    iree_vm_ModuleStateDef_immutable_global_ref_ordinals_add(
+        fbb, immutableGlobalRefOrdinalsRef);
     moduleStateDef = iree_vm_ModuleStateDef_end(fbb);
   }
 
@@ -0,0 +1,52 @@
+// RUN: iree-compile --split-input-file --compile-mode=vm \
+// RUN:   --iree-vm-bytecode-module-output-format=flatbuffer-text %s | FileCheck %s
+
+// Tests that buffer globals only stored with rodata during initialization are
+// recorded as immutable so that forked module states can share them.
+
+// CHECK: "name": "global_mutability"
+vm.module @global_mutability {
+  // Only stored by the initializer; ordinal 0.
+  vm.global.ref private mutable @initialized : !vm.buffer
+  // Stored after initialization; ordinal 1.
+  vm.global.ref private mutable @updated : !vm.buffer
+  // Only stored by the initializer but with a mutable buffer; ordinal 2.
+  vm.global.ref private mutable @allocated : !vm.buffer
+  // Only stored by the initializer but lists can be mutated; ordinal 3.
+  vm.global.ref private mutable @list : !vm.list<i32>
+
+  vm.rodata private @buffer dense<[1, 2, 3]> : tensor<3xi8>
+
+  vm.initializer {
+    %buffer = vm.const.ref.rodata @buffer : !vm.buffer
+    vm.global.store.ref %buffer, @initialized : !vm.buffer
+    %c4 = vm.const.i64 4
+    %allocated = vm.buffer.alloc %c4 : !vm.buffer
+    vm.global.store.ref %allocated, @allocated : !vm.buffer
+    %c1 = vm.const.i32 1
+    %list = vm.list.alloc %c1 : (i32) -> !vm.list<i32>
+    vm.global.store.ref %list, @list : !vm.list<i32>
+    vm.return
+  }
+
+  vm.export @update
+  vm.func @update() -> !vm.buffer {
+    %initialized = vm.global.load.ref @initialized : !vm.buffer
+    vm.global.store.ref %initialized, @updated : !vm.buffer
+    %updated = vm.global.load.ref @updated : !vm.buffer
+    %c0 = vm.const.i64 0
+    %c1 = vm.const.i32 1
+    %allocated = vm.global.load.ref @allocated : !vm.buffer
+    vm.buffer.store.i8 %c1, %allocated[%c0] : i32 -> !vm.buffer
+    %list = vm.global.load.ref @list : !vm.list<i32>
+    vm.list.resize %list, %c1 : (!vm.list<i32>, i32)
+    vm.list.set.i32 %list, %c1, %c1 : (!vm.list<i32>, i32, i32)
+    vm.return %updated : !vm.buffer
+  }
+
+  //      CHECK: "module_state": {
+  //      CHECK:   "global_ref_count": 4,
+  // CHECK-NEXT:   "immutable_global_ref_ordinals": [
+  // CHECK-NEXT:     0
+  // CHECK-NEXT:   ]
+}
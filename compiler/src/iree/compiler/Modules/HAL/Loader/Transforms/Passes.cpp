@@ -67,7 +67,8 @@ void buildHALInlineDynamicTransformPassPipeline(
   // After this point the executables are opaque blobs and we cannot change
   // their interfaces.
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
-      IREE::HAL::createTranslateExecutablesPass());
+      IREE::HAL::createTranslateExecutablesPass(
+          /*executableCachePath=*/"", targetOptions.executableParallelism));
 
   //----------------------------------------------------------------------------
   // Conversion
@@ -91,7 +92,8 @@ void buildHALInlineDynamicTransformPassPipeline(
   passManager.addNestedPass<IREE::HAL::ExecutableOp>(
       IREE::HAL::createSerializeExecutablesPass(
           targetOptions.debugLevel, targetOptions.executableIntermediatesPath,
-          targetOptions.executableBinariesPath));
+          targetOptions.executableBinariesPath,
+          /*executableCachePath=*/"", targetOptions.executableParallelism));
 
   // NOTE: symbol DCE will destroy executable target contents.
   passManager.addPass(mlir::createSymbolDCEPass());
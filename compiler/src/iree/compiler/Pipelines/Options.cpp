@@ -74,6 +74,12 @@ void HighLevelOptimizationOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Reduces numeric precision to lower bit depths where possible."),
       llvm::cl::cat(category));
+  binder.opt<bool>(
+      "iree-opt-data-tiling", dataTiling,
+      llvm::cl::desc("Converts matmuls to mmt4d ops with tile shapes derived "
+                     "from the CPU features of the executable targets when no "
+                     "explicit --iree-flow-mmt4d-target-options are given."),
+      llvm::cl::cat(category));
   binder.opt<bool>("iree-opt-strip-assertions", stripAssertions,
                    llvm::cl::desc("Strips debug assertions after any useful "
                                   "information has been extracted."),
@@ -106,6 +112,13 @@ void SchedulingOptions::bindOptions(OptionsBinder &binder) {
                      "executables.")),
       llvm::cl::cat(category));
 
+  binder.opt<bool>(
+      "iree-scheduling-pack-transients", packTransients,
+      llvm::cl::desc("Packs the stream-ordered transients of each block into "
+                     "a single arena. Regions using the arena wait on the "
+                     "release of all transients released before them."),
+      llvm::cl::cat(category));
+
   binder.opt<DumpOutputFormat>(
       "iree-scheduling-dump-statistics-format", dumpStatisticsFormat,
       llvm::cl::desc("Dumps statistics in the specified output format."),
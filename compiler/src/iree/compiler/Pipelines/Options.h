@@ -68,6 +68,9 @@ struct HighLevelOptimizationOptions {
   // Optimizations to reduce numeric precision where it is safe to do so.
   bool numericPrecisionReduction = false;
 
+  // Converts matmuls to data tiled (mmt4d) layouts chosen for the CPU targets.
+  bool dataTiling = false;
+
   // Strips debug assertions after any useful information has been extracted.
   bool stripAssertions = false;
 
@@ -115,6 +118,11 @@ struct SchedulingOptions {
     // JSON format for better structure and data exchange.
     JSON = 4,
   };
+  // Packs the stream-ordered transients of each block into a single arena.
+  // This trades concurrency between execution regions for fewer allocations
+  // and a lower peak transient size.
+  bool packTransients = false;
+
   // Enables and specifies the the format for a stream statistics dump.
   DumpOutputFormat dumpStatisticsFormat = DumpOutputFormat::None;
   // File path to write statistics to; or `` for stderr or `-` for stdout.
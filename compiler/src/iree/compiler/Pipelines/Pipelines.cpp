@@ -83,6 +83,7 @@ void buildIREEVMTransformPassPipeline(
       highLevelOptimizationOptions.constExprHoisting;
   flowOptions.numericPrecisionReduction =
       highLevelOptimizationOptions.numericPrecisionReduction;
+  flowOptions.dataTiling = highLevelOptimizationOptions.dataTiling;
 
   // Enable const-eval via hook. For debug builds, we assert if enabled without
   // a hook. For release, we just silently skip enabling const-eval.
@@ -105,6 +106,7 @@ void buildIREEVMTransformPassPipeline(
 
   IREE::Stream::TransformOptions streamOptions;
   // TODO(benvanik): find a way to share the enums w/o circular deps.
+  streamOptions.packTransients = schedulingOptions.packTransients;
   streamOptions.dumpStatisticsFormat =
       (IREE::Stream::DumpOutputFormat)schedulingOptions.dumpStatisticsFormat;
   streamOptions.dumpStatisticsFile = schedulingOptions.dumpStatisticsFile;
@@ -114,6 +116,13 @@ void buildIREEVMTransformPassPipeline(
       // No flow/stream processing (implies no tensors).
       break;
     default:
+      // Data tiling picks its layouts based on the executable targets being
+      // compiled for and needs them assigned ahead of the HAL pipeline. The
+      // HAL pipeline keeps any targets already present on the module.
+      if (flowOptions.dataTiling && !executableOptions.targets.empty()) {
+        passManager.addPass(IREE::HAL::createAssignTargetDevicesPass(
+            executableOptions.targets));
+      }
       IREE::Flow::buildFlowTransformPassPipeline(passManager, flowOptions);
       IREE::Stream::buildStreamTransformPassPipeline(passManager,
                                                      streamOptions);
@@ -26,6 +26,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/AsmState.h"
@@ -217,7 +218,17 @@ int mlir::iree_compiler::runIreecMain(int argc, char **argv) {
   /// Processes the memory buffer with a new MLIRContext.
   auto processBuffer = [&](std::unique_ptr<llvm::MemoryBuffer> ownedBuffer,
                            llvm::raw_ostream &os) -> LogicalResult {
+    // Executables are translated and serialized in parallel on the context
+    // thread pool. The pool must outlive the context.
+    std::unique_ptr<llvm::ThreadPool> threadPool;
     mlir::MLIRContext context;
+    if (halTargetOptions.executableParallelism > 0 &&
+        context.isMultithreadingEnabled()) {
+      threadPool = std::make_unique<llvm::ThreadPool>(
+          llvm::hardware_concurrency(halTargetOptions.executableParallelism));
+      context.disableMultithreading();
+      context.setThreadPool(*threadPool);
+    }
     context.allowUnregisteredDialects();
     context.appendDialectRegistry(registry);
     llvm::SourceMgr sourceMgr;
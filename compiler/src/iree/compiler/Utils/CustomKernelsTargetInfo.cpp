@@ -15,7 +15,7 @@ namespace iree_compiler {
 
 LogicalResult ParseCustomKernelTargetFeaturesForAarch64(
     const llvm::SmallVector<llvm::StringRef> &features,
-    CustomKernelsTargetInfo &targetInfo) {
+    CustomKernelsTargetInfo &targetInfo, bool ignoreUnknownFeatures) {
   for (auto f : features) {
     if (f.empty()) {
       continue;
@@ -24,7 +24,7 @@ LogicalResult ParseCustomKernelTargetFeaturesForAarch64(
       targetInfo.add(CustomKernelTargetFeature::Aarch64Dotprod);
     } else if (f == "+i8mm") {
       targetInfo.add(CustomKernelTargetFeature::Aarch64I8mm);
-    } else {
+    } else if (!ignoreUnknownFeatures) {
       llvm::errs() << "Unhandled aarch64 CPU feature: " << f << "\n";
       return failure();
     }
@@ -32,9 +32,31 @@ LogicalResult ParseCustomKernelTargetFeaturesForAarch64(
   return success();
 }
 
-LogicalResult ParseCustomKernelsTargetInfo(
-    llvm::StringRef archStr, llvm::StringRef featuresStr,
-    CustomKernelsTargetInfo &targetInfo) {
+LogicalResult ParseCustomKernelTargetFeaturesForX86_64(
+    const llvm::SmallVector<llvm::StringRef> &features,
+    CustomKernelsTargetInfo &targetInfo, bool ignoreUnknownFeatures) {
+  for (auto f : features) {
+    if (f.empty()) {
+      continue;
+    }
+    if (f == "+fma") {
+      targetInfo.add(CustomKernelTargetFeature::X86_64Fma);
+    } else if (f == "+avx2") {
+      targetInfo.add(CustomKernelTargetFeature::X86_64Avx2);
+    } else if (f == "+avx512f") {
+      targetInfo.add(CustomKernelTargetFeature::X86_64Avx512f);
+    } else if (!ignoreUnknownFeatures) {
+      llvm::errs() << "Unhandled x86_64 CPU feature: " << f << "\n";
+      return failure();
+    }
+  }
+  return success();
+}
+
+LogicalResult ParseCustomKernelsTargetInfo(llvm::StringRef archStr,
+                                           llvm::StringRef featuresStr,
+                                           CustomKernelsTargetInfo &targetInfo,
+                                           bool ignoreUnknownFeatures) {
   // Set the out-value to defaults early so that early returns produce
   // consistent results and so that we can write simpler code below.
   targetInfo = CustomKernelsTargetInfo();
@@ -48,7 +70,13 @@ LogicalResult ParseCustomKernelsTargetInfo(
 
   if (archStr == "aarch64") {
     targetInfo.init(CustomKernelTargetArch::Aarch64);
-    return ParseCustomKernelTargetFeaturesForAarch64(features, targetInfo);
+    return ParseCustomKernelTargetFeaturesForAarch64(features, targetInfo,
+                                                     ignoreUnknownFeatures);
+  }
+  if (archStr == "x86_64") {
+    targetInfo.init(CustomKernelTargetArch::X86_64);
+    return ParseCustomKernelTargetFeaturesForX86_64(features, targetInfo,
+                                                    ignoreUnknownFeatures);
   }
 
   // Currently, on unknown arch, we return success as long as no features
@@ -57,7 +85,7 @@ LogicalResult ParseCustomKernelsTargetInfo(
   // on and don't want to create friction. Anyway, this leaves the `arch`
   // value with its default value None, so this will produce the intended
   // behaviour of not enabling arch-specific code paths.
-  return featuresStr.empty() ? success() : failure();
+  return featuresStr.empty() || ignoreUnknownFeatures ? success() : failure();
 }
 
 }  // namespace iree_compiler
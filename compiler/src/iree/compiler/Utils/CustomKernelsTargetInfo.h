@@ -18,7 +18,7 @@ namespace iree_compiler {
 
 // Enumerates target ISAs that we care about. 'int8_t' because we somewhat
 // care because this is used in struct MMTKernel, which is passed by value.
-enum class CustomKernelTargetArch : int8_t { None, Aarch64 };
+enum class CustomKernelTargetArch : int8_t { None, Aarch64, X86_64 };
 
 // Enumerates arch-specific target features that we care about.
 // We explicitly want to stick to the default enumeration values (0, 1, 2, ...,
@@ -34,6 +34,10 @@ enum class CustomKernelTargetFeature {
   // Aarch64 features.
   Aarch64Dotprod,
   Aarch64I8mm,
+  // X86_64 features.
+  X86_64Fma,
+  X86_64Avx2,
+  X86_64Avx512f,
 };
 
 inline bool isFeatureForArch(CustomKernelTargetFeature feature,
@@ -45,6 +49,10 @@ inline bool isFeatureForArch(CustomKernelTargetFeature feature,
       return arch == CustomKernelTargetArch::Aarch64;
     case CustomKernelTargetFeature::Aarch64I8mm:
       return arch == CustomKernelTargetArch::Aarch64;
+    case CustomKernelTargetFeature::X86_64Fma:
+    case CustomKernelTargetFeature::X86_64Avx2:
+    case CustomKernelTargetFeature::X86_64Avx512f:
+      return arch == CustomKernelTargetArch::X86_64;
   }
   assert(false && "Unhandled CustomKernelTargetFeature value");
   return false;
@@ -80,9 +88,14 @@ class CustomKernelsTargetInfo {
   uint64_t features = 0;
 };
 
+// Parses |archStr| and the comma-separated |featuresStr| into |targetInfo|.
+// Fails on features that are not enumerated in CustomKernelTargetFeature
+// unless |ignoreUnknownFeatures| is set, which allows passing the full CPU
+// feature string of a target.
 LogicalResult ParseCustomKernelsTargetInfo(llvm::StringRef archStr,
                                            llvm::StringRef featuresStr,
-                                           CustomKernelsTargetInfo &targetInfo);
+                                           CustomKernelsTargetInfo &targetInfo,
+                                           bool ignoreUnknownFeatures = false);
 
 }  // namespace iree_compiler
 }  // namespace mlir
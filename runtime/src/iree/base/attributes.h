@@ -162,6 +162,31 @@
 #define IREE_UNLIKELY(x) (x)
 #endif  // IREE_HAVE_ATTRIBUTE(likely)
 
+//===----------------------------------------------------------------------===//
+// IREE_PREFETCH_RO / IREE_PREFETCH_RW
+//===----------------------------------------------------------------------===//
+
+// Compiler hint that the cache line containing |address| will soon be read
+// (RO) or written (RW). |locality| is one of the IREE_PREFETCH_LOCALITY_*
+// values indicating how long the line should be kept in cache after it is
+// accessed. Prefetches never fault and are a no-op where unsupported.
+//
+// Example:
+//   IREE_PREFETCH_RO(next_row, IREE_PREFETCH_LOCALITY_NONE);
+#define IREE_PREFETCH_LOCALITY_NONE 0      // non-temporal; use once
+#define IREE_PREFETCH_LOCALITY_LOW 1       // outer cache levels
+#define IREE_PREFETCH_LOCALITY_MODERATE 2  // mid cache levels
+#define IREE_PREFETCH_LOCALITY_HIGH 3      // all cache levels
+#if defined(__GNUC__) || defined(__clang__)
+#define IREE_PREFETCH_RO(address, locality) \
+  __builtin_prefetch((address), 0, (locality))
+#define IREE_PREFETCH_RW(address, locality) \
+  __builtin_prefetch((address), 1, (locality))
+#else
+#define IREE_PREFETCH_RO(address, locality)
+#define IREE_PREFETCH_RW(address, locality)
+#endif  // __GNUC__ || __clang__
+
 //===----------------------------------------------------------------------===//
 // IREE_ATTRIBUTE_PACKED
 //===----------------------------------------------------------------------===//
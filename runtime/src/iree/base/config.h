@@ -234,6 +234,25 @@ typedef IREE_DEVICE_SIZE_T iree_device_size_t;
 #define IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE 0
 #endif  // !IREE_VM_EXECUTION_TRACING_SRC_LOC_ENABLE
 
+#if !defined(IREE_VM_EXECUTION_PROFILING_ENABLE)
+// Enables per-function call counts and timing of VM execution in contexts
+// created with IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION. Adds a few words to each
+// stack frame and a branch on function entry/exit even when not profiling and
+// as such is only enabled when explicitly requested.
+#define IREE_VM_EXECUTION_PROFILING_ENABLE 0
+#endif  // !IREE_VM_EXECUTION_PROFILING_ENABLE
+
+#if !defined(IREE_VM_EXECUTION_PROFILING_OPS_ENABLE)
+// Enables counting of executed bytecode ops when profiling VM execution.
+// Adds a branch to the dispatch of every op even when not profiling and as
+// such is only enabled when explicitly requested.
+#define IREE_VM_EXECUTION_PROFILING_OPS_ENABLE 0
+#endif  // !IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+#if IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+#undef IREE_VM_EXECUTION_PROFILING_ENABLE
+#define IREE_VM_EXECUTION_PROFILING_ENABLE 1
+#endif  // IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+
 #if !defined(IREE_VM_EXT_F32_ENABLE)
 // Enables the 32-bit floating-point instruction extension.
 // Targeted from the compiler with `-iree-vm-target-extension-f32`.
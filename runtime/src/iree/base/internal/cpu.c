@@ -69,6 +69,137 @@ static void iree_cpu_initialize_from_platform(iree_allocator_t temp_allocator,
 
 #endif  // IREE_PLATFORM_*
 
+//===----------------------------------------------------------------------===//
+// Architecture-specific processor data queries
+//===----------------------------------------------------------------------===//
+// Some architectures allow unprivileged queries of processor features that
+// work regardless of the platform. These are OR'ed into whatever the platform
+// queries produced.
+
+#if defined(IREE_ARCH_X86_64) && \
+    (defined(IREE_COMPILER_GCC_COMPAT) || defined(IREE_COMPILER_MSVC))
+
+#if defined(IREE_COMPILER_MSVC)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif  // IREE_COMPILER_MSVC
+
+// Executes CPUID with the given |leaf| and |subleaf| and returns
+// {eax, ebx, ecx, edx} in |out_regs|.
+static void iree_cpu_cpuid(uint32_t leaf, uint32_t subleaf,
+                           uint32_t out_regs[4]) {
+#if defined(IREE_COMPILER_MSVC)
+  int regs[4];
+  __cpuidex(regs, (int)leaf, (int)subleaf);
+  memcpy(out_regs, regs, sizeof(regs));
+#else
+  __cpuid_count(leaf, subleaf, out_regs[0], out_regs[1], out_regs[2],
+                out_regs[3]);
+#endif  // IREE_COMPILER_MSVC
+}
+
+// Returns XCR0 indicating which register state the OS saves/restores.
+// Must only be called if CPUID.01H:ECX.OSXSAVE is set.
+static uint64_t iree_cpu_xgetbv0(void) {
+#if defined(IREE_COMPILER_MSVC)
+  return _xgetbv(0);
+#else
+  // NOTE: inline asm avoids requiring -mxsave on the translation unit.
+  uint32_t eax = 0, edx = 0;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return ((uint64_t)edx << 32) | eax;
+#endif  // IREE_COMPILER_MSVC
+}
+
+// OR's |field_bit| into |field_value| if bit |reg_bit| is set in |reg_value|.
+#define IREE_SET_IF_CPUID(reg_value, reg_bit, field_value, field_bit) \
+  if ((reg_value) & (1u << (reg_bit))) (field_value) |= (field_bit)
+
+static void iree_cpu_initialize_from_arch(uint64_t* out_fields) {
+  uint32_t leaf0[4] = {0};
+  iree_cpu_cpuid(0, 0, leaf0);
+  const uint32_t max_leaf = leaf0[0];
+  uint32_t leaf1[4] = {0};
+  if (max_leaf >= 1) iree_cpu_cpuid(1, 0, leaf1);
+  uint32_t leaf7[4] = {0};
+  if (max_leaf >= 7) iree_cpu_cpuid(7, 0, leaf7);
+  uint32_t ext_leaf0[4] = {0};
+  iree_cpu_cpuid(0x80000000u, 0, ext_leaf0);
+  uint32_t ext_leaf1[4] = {0};
+  if (ext_leaf0[0] >= 0x80000001u) iree_cpu_cpuid(0x80000001u, 0, ext_leaf1);
+
+  // AVX and AVX-512 require the OS to save the extended register state on
+  // context switches: XCR0 bits 1-2 for SSE/AVX and 5-7 for opmask/ZMM.
+  bool os_avx = false;
+  bool os_avx512 = false;
+  if (leaf1[2] & (1u << 27)) {  // OSXSAVE
+    const uint64_t xcr0 = iree_cpu_xgetbv0();
+    os_avx = (xcr0 & 0x06) == 0x06;
+    os_avx512 = os_avx && (xcr0 & 0xE0) == 0xE0;
+  }
+
+  uint64_t* field0 = &out_fields[0];
+  IREE_SET_IF_CPUID(leaf1[2], 0, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE3);
+  IREE_SET_IF_CPUID(leaf1[2], 9, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSSE3);
+  IREE_SET_IF_CPUID(leaf1[2], 19, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE41);
+  IREE_SET_IF_CPUID(leaf1[2], 20, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE42);
+  IREE_SET_IF_CPUID(leaf1[2], 23, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_POPCNT);
+  IREE_SET_IF_CPUID(leaf1[2], 13, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_CX16);
+  IREE_SET_IF_CPUID(leaf1[2], 22, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_MOVBE);
+  IREE_SET_IF_CPUID(leaf1[2], 26, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_XSAVE);
+  IREE_SET_IF_CPUID(leaf7[1], 3, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI);
+  IREE_SET_IF_CPUID(leaf7[1], 8, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI2);
+  IREE_SET_IF_CPUID(ext_leaf1[2], 0, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SAHF);
+  IREE_SET_IF_CPUID(ext_leaf1[2], 5, *field0,
+                    IREE_CPU_DATA_FIELD_0_X86_64_HAVE_LZCNT);
+  if (os_avx) {
+    IREE_SET_IF_CPUID(leaf1[2], 28, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX);
+    IREE_SET_IF_CPUID(leaf1[2], 12, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_FMA);
+    IREE_SET_IF_CPUID(leaf1[2], 29, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_F16C);
+    IREE_SET_IF_CPUID(leaf7[1], 5, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2);
+  }
+  if (os_avx512) {
+    IREE_SET_IF_CPUID(leaf7[1], 16, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512F);
+    IREE_SET_IF_CPUID(leaf7[1], 28, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512CD);
+    IREE_SET_IF_CPUID(leaf7[1], 31, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VL);
+    IREE_SET_IF_CPUID(leaf7[1], 17, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512DQ);
+    IREE_SET_IF_CPUID(leaf7[1], 30, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BW);
+    IREE_SET_IF_CPUID(leaf7[2], 11, *field0,
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI);
+  }
+}
+
+#undef IREE_SET_IF_CPUID
+
+#else
+
+static void iree_cpu_initialize_from_arch(uint64_t* out_fields) {
+  // No architecture-level queries available; the platform queries are used.
+}
+
+#endif  // IREE_ARCH_*
+
 //===----------------------------------------------------------------------===//
 // Architecture-specific string lookup
 //===----------------------------------------------------------------------===//
@@ -91,6 +222,55 @@ static bool iree_cpu_lookup_data_by_key_for_arch(
   return false;
 }
 
+#elif defined(IREE_ARCH_X86_64)
+
+static bool iree_cpu_lookup_data_by_key_for_arch(
+    const uint64_t* fields, iree_string_view_t key,
+    int64_t* IREE_RESTRICT out_value) {
+  IREE_TEST_FIELD_BIT("sse3", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE3);
+  IREE_TEST_FIELD_BIT("ssse3", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSSE3);
+  IREE_TEST_FIELD_BIT("sse4.1", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE41);
+  IREE_TEST_FIELD_BIT("sse4.2", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE42);
+  IREE_TEST_FIELD_BIT("popcnt", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_POPCNT);
+  IREE_TEST_FIELD_BIT("cx16", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_CX16);
+  IREE_TEST_FIELD_BIT("sahf", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SAHF);
+  IREE_TEST_FIELD_BIT("avx", fields[0], IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX);
+  IREE_TEST_FIELD_BIT("avx2", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2);
+  IREE_TEST_FIELD_BIT("fma", fields[0], IREE_CPU_DATA_FIELD_0_X86_64_HAVE_FMA);
+  IREE_TEST_FIELD_BIT("f16c", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_F16C);
+  IREE_TEST_FIELD_BIT("bmi", fields[0], IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI);
+  IREE_TEST_FIELD_BIT("bmi2", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI2);
+  IREE_TEST_FIELD_BIT("lzcnt", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_LZCNT);
+  IREE_TEST_FIELD_BIT("movbe", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_MOVBE);
+  IREE_TEST_FIELD_BIT("xsave", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_XSAVE);
+  IREE_TEST_FIELD_BIT("avx512f", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512F);
+  IREE_TEST_FIELD_BIT("avx512cd", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512CD);
+  IREE_TEST_FIELD_BIT("avx512vl", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VL);
+  IREE_TEST_FIELD_BIT("avx512dq", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512DQ);
+  IREE_TEST_FIELD_BIT("avx512bw", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BW);
+  IREE_TEST_FIELD_BIT("avx512vnni", fields[0],
+                      IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI);
+  return false;
+}
+
 #else
 
 static bool iree_cpu_lookup_data_by_key_for_arch(
@@ -115,6 +295,7 @@ void iree_cpu_initialize(iree_allocator_t temp_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
   memset(iree_cpu_data_cache_, 0, sizeof(iree_cpu_data_cache_));
   iree_cpu_initialize_from_platform(temp_allocator, iree_cpu_data_cache_);
+  iree_cpu_initialize_from_arch(iree_cpu_data_cache_);
   IREE_TRACE_ZONE_END(z0);
 }
 
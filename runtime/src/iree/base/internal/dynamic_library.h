@@ -47,6 +47,14 @@ iree_status_t iree_dynamic_library_load_from_files(
 // Opens a dynamic library from a range of bytes in memory.
 // |identifier| will be used as the module name in debugging/profiling tools.
 // |buffer| must remain live for the lifetime of the library.
+//
+// Platforms that require a file to load from may extract the library. On Linux
+// and Android an in-memory file is used to avoid filesystem writes. If the
+// IREE_DYLIB_CACHE_DIR environment variable names a directory owned by and
+// only writable by the current user then libraries are persisted there keyed
+// by content so later loads reuse the same file. The total size of the cache
+// is bounded by IREE_DYLIB_CACHE_MAX_SIZE bytes (default 256MB) with the least
+// recently used libraries evicted first.
 iree_status_t iree_dynamic_library_load_from_memory(
     iree_string_view_t identifier, iree_const_byte_span_t buffer,
     iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
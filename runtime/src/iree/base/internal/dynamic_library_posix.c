@@ -20,10 +20,31 @@
 
 #include <dlfcn.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <dirent.h>
+#include <sys/syscall.h>
+// Open files can be loaded by path through /proc/self/fd/N. This lets us load
+// exactly the file we verified instead of whatever a path refers to by the
+// time the loader opens it.
+#define IREE_DYNAMIC_LIBRARY_HAVE_PROC_FD 1
+#if defined(SYS_memfd_create)
+// memfd_create is called via syscall as older libc/NDK versions lack the
+// wrapper even when the kernel supports it.
+#define IREE_DYNAMIC_LIBRARY_HAVE_MEMFD 1
+#if !defined(MFD_CLOEXEC)
+#define MFD_CLOEXEC 0x0001U
+#endif  // !MFD_CLOEXEC
+#endif  // SYS_memfd_create
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 struct iree_dynamic_library_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t allocator;
@@ -179,11 +200,31 @@ static iree_once_flag iree_dynamic_library_temp_dir_init_once_flag_ =
 static const char* iree_dynamic_library_temp_dir_path_;
 static bool iree_dynamic_library_temp_dir_valid_;
 static bool iree_dynamic_library_temp_dir_preserve_;
+static const char* iree_dynamic_library_cache_dir_path_;
+static bool iree_dynamic_library_cache_dir_valid_;
+static uint64_t iree_dynamic_library_cache_max_size_;
+
+// Default limit on the total size of the libraries in IREE_DYLIB_CACHE_DIR.
+#define IREE_DYNAMIC_LIBRARY_CACHE_DEFAULT_MAX_SIZE (256ull * 1024 * 1024)
 
 static bool iree_dynamic_library_path_is_null_or_empty(const char* path) {
   return path == NULL || path[0] == 0;
 }
 
+static bool iree_dynamic_library_path_is_directory(const char* path) {
+  struct stat s;
+  return stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR;
+}
+
+// Returns true if |path| is a directory owned by the current user that no
+// other user can write to. Libraries in the cache directory are loaded into
+// the process and must not be replaceable by anyone else.
+static bool iree_dynamic_library_path_is_private_directory(const char* path) {
+  struct stat s;
+  return stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR &&
+         s.st_uid == geteuid() && (s.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
 static void iree_dynamic_library_init_temp_dir(void) {
   // Semantics of IREE_PRESERVE_DYLIB_TEMP_FILES:
   // * If the environment variable is not set, temp files are not preserved.
@@ -216,26 +257,273 @@ static void iree_dynamic_library_init_temp_dir(void) {
   // Validate that temp_dir it is the path of a directory. Could fail if it was
   // user-provided, or on an Android device where /data/local/tmp hasn't been
   // created yet.
-  struct stat s;
   iree_dynamic_library_temp_dir_valid_ =
-      stat(path, &s) == 0 && (s.st_mode & S_IFMT) == S_IFDIR;
+      iree_dynamic_library_path_is_directory(path);
+
+  // IREE_DYLIB_CACHE_DIR names a directory where libraries are persisted by
+  // content hash so that subsequent loads (including from other processes)
+  // reuse the same file. The directory must be owned by the current user and
+  // not writable by others or it is ignored. IREE_DYLIB_CACHE_MAX_SIZE bounds
+  // the total bytes of cached libraries; the least recently used are evicted
+  // to make room for new ones. Example:
+  //   $ IREE_DYLIB_CACHE_DIR=~/.cache/iree iree-run-module ...
+  const char* cache_path = getenv("IREE_DYLIB_CACHE_DIR");
+  iree_dynamic_library_cache_dir_path_ = cache_path;
+  iree_dynamic_library_cache_dir_valid_ =
+      !iree_dynamic_library_path_is_null_or_empty(cache_path) &&
+      iree_dynamic_library_path_is_private_directory(cache_path);
+  iree_dynamic_library_cache_max_size_ =
+      IREE_DYNAMIC_LIBRARY_CACHE_DEFAULT_MAX_SIZE;
+  const char* max_size = getenv("IREE_DYLIB_CACHE_MAX_SIZE");
+  if (!iree_dynamic_library_path_is_null_or_empty(max_size)) {
+    char* max_size_end = NULL;
+    unsigned long long value = strtoull(max_size, &max_size_end, 10);
+    if (*max_size_end == 0) iree_dynamic_library_cache_max_size_ = value;
+  }
 }
 
-// TODO(#3845): use dlopen on an fd with either dlopen(/proc/self/fd/NN),
-// fdlopen, or android_dlopen_ext to avoid needing to write the file to disk.
-// Can fallback to memfd_create + dlopen where available, and fallback from
-// that to disk (maybe just windows/mac).
-iree_status_t iree_dynamic_library_load_from_memory(
+// Writes all of |data| to |fd|, handling partial writes.
+static iree_status_t iree_dynamic_library_write_fd(
+    int fd, iree_const_byte_span_t data) {
+  const uint8_t* ptr = data.data;
+  iree_host_size_t remaining = data.data_length;
+  while (remaining > 0) {
+    ssize_t written = write(fd, ptr, remaining);
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to write %zu bytes", remaining);
+    }
+    ptr += written;
+    remaining -= (iree_host_size_t)written;
+  }
+  return iree_ok_status();
+}
+
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_MEMFD)
+
+// Writes the library to an anonymous in-memory file without touching the
+// filesystem and returns the open file in |out_fd| along with a path the
+// loader can open in |fd_path|. Fails if memfd_create is unavailable (old
+// kernels, seccomp) or /proc is not mounted, in which case the caller should
+// fall back.
+static iree_status_t iree_dynamic_library_create_memfd(
     iree_string_view_t identifier, iree_const_byte_span_t buffer,
-    iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
-    iree_dynamic_library_t** out_library) {
+    iree_host_size_t fd_path_capacity, char* fd_path, int* out_fd) {
+  *out_fd = -1;
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(out_library);
-  *out_library = NULL;
 
-  iree_call_once(&iree_dynamic_library_temp_dir_init_once_flag_,
-                 iree_dynamic_library_init_temp_dir);
+  // The name is only used for debugging (it shows up in /proc/self/maps) and
+  // is limited to 249 characters by the kernel.
+  char name[64];
+  snprintf(name, sizeof(name), "iree_dylib_%.*s",
+           (int)iree_min(identifier.size, 40), identifier.data);
+  int fd = (int)syscall(SYS_memfd_create, name, MFD_CLOEXEC);
+  if (fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "memfd_create failed");
+  }
+
+  iree_status_t status = iree_dynamic_library_write_fd(fd, buffer);
+  if (iree_status_is_ok(status)) {
+    snprintf(fd_path, fd_path_capacity, "/proc/self/fd/%d", fd);
+    if (access(fd_path, R_OK) != 0) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "memfd not accessible at '%s'", fd_path);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_fd = fd;
+  } else {
+    close(fd);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_MEMFD
+
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_PROC_FD)
+
+// Prefix of the libraries in the cache directory. Files being written use a
+// leading '.' so that they are never evicted or reused by other processes.
+#define IREE_DYNAMIC_LIBRARY_CACHE_FILE_PREFIX "iree_dylib_"
+
+// Returns a 64-bit FNV-1a hash of |data|.
+static uint64_t iree_dynamic_library_hash(iree_const_byte_span_t data) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  for (iree_host_size_t i = 0; i < data.data_length; ++i) {
+    hash ^= data.data[i];
+    hash *= 0x100000001B3ull;
+  }
+  return hash;
+}
+
+// Opens the cached library at |file_path| and returns it in |out_fd| if it is
+// a regular file owned by the current user with exactly the contents of
+// |data|. The contents are verified through the returned fd and callers must
+// load from it so that replacing the file at |file_path| after verification
+// has no effect.
+static bool iree_dynamic_library_open_cached_file(const char* file_path,
+                                                  iree_const_byte_span_t data,
+                                                  int* out_fd) {
+  *out_fd = -1;
+  int fd = open(file_path, O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+  if (fd < 0) return false;
+  bool matches = false;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0 && (file_stat.st_mode & S_IFMT) == S_IFREG &&
+      file_stat.st_uid == geteuid() &&
+      (uint64_t)file_stat.st_size == (uint64_t)data.data_length) {
+    void* file_data =
+        mmap(NULL, data.data_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (file_data != MAP_FAILED) {
+      matches = memcmp(file_data, data.data, data.data_length) == 0;
+      munmap(file_data, data.data_length);
+    }
+  }
+  if (!matches) {
+    close(fd);
+    return false;
+  }
+  // Mark the library as recently used for eviction. Failure only makes it an
+  // earlier eviction candidate.
+  futimens(fd, NULL);
+  *out_fd = fd;
+  return true;
+}
+
+// Evicts the least recently used libraries from the cache directory until
+// |reserve_size| more bytes fit within IREE_DYLIB_CACHE_MAX_SIZE. Eviction is
+// best-effort: libraries already loaded by any process remain valid when
+// their files are removed.
+static void iree_dynamic_library_evict_from_cache(uint64_t reserve_size) {
+  for (;;) {
+    DIR* dir = opendir(iree_dynamic_library_cache_dir_path_);
+    if (!dir) return;
+    uint64_t total_size = 0;
+    char oldest_name[256] = {0};
+    time_t oldest_time = 0;
+    struct dirent* entry = NULL;
+    while ((entry = readdir(dir)) != NULL) {
+      if (strncmp(entry->d_name, IREE_DYNAMIC_LIBRARY_CACHE_FILE_PREFIX,
+                  strlen(IREE_DYNAMIC_LIBRARY_CACHE_FILE_PREFIX)) != 0) {
+        continue;
+      }
+      struct stat file_stat;
+      if (fstatat(dirfd(dir), entry->d_name, &file_stat,
+                  AT_SYMLINK_NOFOLLOW) != 0 ||
+          (file_stat.st_mode & S_IFMT) != S_IFREG) {
+        continue;
+      }
+      total_size += (uint64_t)file_stat.st_size;
+      if (!oldest_name[0] || file_stat.st_mtime < oldest_time) {
+        snprintf(oldest_name, sizeof(oldest_name), "%s", entry->d_name);
+        oldest_time = file_stat.st_mtime;
+      }
+    }
+    closedir(dir);
+    if (!oldest_name[0] ||
+        total_size + reserve_size <= iree_dynamic_library_cache_max_size_) {
+      return;
+    }
+    char oldest_path[512];
+    snprintf(oldest_path, sizeof(oldest_path), "%s/%s",
+             iree_dynamic_library_cache_dir_path_, oldest_name);
+    if (unlink(oldest_path) != 0) return;
+  }
+}
 
+// Extracts the library to the persistent cache directory and returns an open
+// file with its contents in |out_fd|. Extraction is skipped if a file with the
+// same contents already exists. Files are published with an atomic rename so
+// concurrent processes never observe partially written libraries.
+static iree_status_t iree_dynamic_library_extract_to_cache(
+    iree_const_byte_span_t buffer, int* out_fd) {
+  *out_fd = -1;
+  if ((uint64_t)buffer.data_length > iree_dynamic_library_cache_max_size_) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "library exceeds IREE_DYLIB_CACHE_MAX_SIZE");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Files are keyed by content hash and length. Contents are verified on reuse
+  // so that a hash collision only results in a cache miss.
+  char file_path[512];
+  if (snprintf(file_path, sizeof(file_path),
+               "%s/" IREE_DYNAMIC_LIBRARY_CACHE_FILE_PREFIX "%016" PRIx64
+               "_%zu.so",
+               iree_dynamic_library_cache_dir_path_,
+               iree_dynamic_library_hash(buffer),
+               buffer.data_length) >= sizeof(file_path)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "IREE_DYLIB_CACHE_DIR name too long");
+  }
+  if (iree_dynamic_library_open_cached_file(file_path, buffer, out_fd)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+
+  iree_dynamic_library_evict_from_cache(buffer.data_length);
+
+  // The file we write is the file we load: |fd| continues to refer to it even
+  // if the published path is replaced.
+  char temp_path[512];
+  snprintf(temp_path, sizeof(temp_path),
+           "%s/." IREE_DYNAMIC_LIBRARY_CACHE_FILE_PREFIX "XXXXXX",
+           iree_dynamic_library_cache_dir_path_);
+  int fd = mkstemp(temp_path);
+  if (fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "unable to mkstemp file in cache directory");
+  }
+  iree_status_t status = iree_dynamic_library_write_fd(fd, buffer);
+  if (iree_status_is_ok(status) && rename(temp_path, file_path) != 0) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "unable to rename '%s' to '%s'", temp_path,
+                              file_path);
+  }
+  if (iree_status_is_ok(status)) {
+    *out_fd = fd;
+  } else {
+    close(fd);
+    remove(temp_path);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Loads the library from the open file |fd| through /proc/self/fd so that the
+// loader maps exactly the file behind |fd|. The loader holds its own reference
+// to the file so |fd| can be closed once loaded.
+static iree_status_t iree_dynamic_library_load_from_fd(
+    int fd, iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
+    iree_dynamic_library_t** out_library) {
+  char fd_path[32];
+  snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+  if (access(fd_path, R_OK) != 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "fd not accessible at '%s'", fd_path);
+  }
+  return iree_dynamic_library_load_from_file(fd_path, flags, allocator,
+                                             out_library);
+}
+
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_PROC_FD
+
+// Extracts the library to a temp file and loads it from there. The file is
+// removed immediately after loading unless IREE_PRESERVE_DYLIB_TEMP_FILES is
+// set.
+static iree_status_t iree_dynamic_library_load_from_temp_file(
+    iree_const_byte_span_t buffer, iree_dynamic_library_flags_t flags,
+    iree_allocator_t allocator, iree_dynamic_library_t** out_library) {
   if (!iree_dynamic_library_temp_dir_valid_) {
     return iree_make_status(
         IREE_STATUS_INVALID_ARGUMENT,
@@ -245,10 +533,9 @@ iree_status_t iree_dynamic_library_load_from_memory(
 
   // Extract the library to a temp file.
   char* temp_path = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_dynamic_library_write_temp_file(
-              buffer, "mem_", "so", allocator,
-              iree_dynamic_library_temp_dir_path_, &temp_path));
+  IREE_RETURN_IF_ERROR(iree_dynamic_library_write_temp_file(
+      buffer, "mem_", "so", allocator, iree_dynamic_library_temp_dir_path_,
+      &temp_path));
 
   // Load using the normal load from file routine.
   iree_status_t status = iree_dynamic_library_load_from_file(
@@ -262,7 +549,67 @@ iree_status_t iree_dynamic_library_load_from_memory(
     remove(temp_path);
   }
   iree_allocator_free(allocator, temp_path);
+  return status;
+}
+
+// Libraries are loaded from the first of these that can be created:
+//  1. IREE_DYLIB_CACHE_DIR, if set, so repeated runs reuse extracted files.
+//     Only supported where files can be loaded through /proc/self/fd.
+//  2. An in-memory file (memfd_create) on Linux/Android to avoid any
+//     filesystem writes.
+//  3. A temp file under TMPDIR.
+// Only failures to create the file fall through to the next option; the
+// library is loaded once and load failures are returned to the caller.
+// IREE_PRESERVE_DYLIB_TEMP_FILES forces temp files so tools can access them.
+// TODO(#3845): use fdlopen or android_dlopen_ext where available.
+iree_status_t iree_dynamic_library_load_from_memory(
+    iree_string_view_t identifier, iree_const_byte_span_t buffer,
+    iree_dynamic_library_flags_t flags, iree_allocator_t allocator,
+    iree_dynamic_library_t** out_library) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(out_library);
+  *out_library = NULL;
+
+  iree_call_once(&iree_dynamic_library_temp_dir_init_once_flag_,
+                 iree_dynamic_library_init_temp_dir);
+
+  if (!iree_dynamic_library_temp_dir_preserve_) {
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_PROC_FD)
+    if (iree_dynamic_library_cache_dir_valid_) {
+      int cache_fd = -1;
+      iree_status_t status =
+          iree_dynamic_library_extract_to_cache(buffer, &cache_fd);
+      if (iree_status_is_ok(status)) {
+        status = iree_dynamic_library_load_from_fd(cache_fd, flags, allocator,
+                                                   out_library);
+        close(cache_fd);
+        IREE_TRACE_ZONE_END(z0);
+        return status;
+      }
+      // The cache directory may be read-only or full; fall back.
+      iree_status_ignore(status);
+    }
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_PROC_FD
+#if defined(IREE_DYNAMIC_LIBRARY_HAVE_MEMFD)
+    char fd_path[32];
+    int fd = -1;
+    iree_status_t status = iree_dynamic_library_create_memfd(
+        identifier, buffer, sizeof(fd_path), fd_path, &fd);
+    if (iree_status_is_ok(status)) {
+      // The loader maps the file from the fd path and holds its own reference
+      // so our fd can be closed once loaded.
+      status = iree_dynamic_library_load_from_file(fd_path, flags, allocator,
+                                                   out_library);
+      close(fd);
+      IREE_TRACE_ZONE_END(z0);
+      return status;
+    }
+    iree_status_ignore(status);
+#endif  // IREE_DYNAMIC_LIBRARY_HAVE_MEMFD
+  }
 
+  iree_status_t status = iree_dynamic_library_load_from_temp_file(
+      buffer, flags, allocator, out_library);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
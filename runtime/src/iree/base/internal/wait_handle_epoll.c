@@ -9,58 +9,411 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_EPOLL
 
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 #include "iree/base/tracing.h"
 
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// Maximum number of events we'll try to harvest from a single epoll_wait.
+// We only ever return a single wake handle from iree_wait_any so there's no
+// benefit to pulling more than one at a time today.
+#define IREE_WAIT_SET_EPOLL_MAX_EVENTS 1
+
+// epoll_wait may spuriously wake with an EINTR. We don't do anything with that
+// opportunity (no fancy signal stuff), but we do need to retry the wait and
+// ensure that we do so with an updated timeout based on the deadline.
+//
+// Documentation: https://man7.org/linux/man-pages/man2/epoll_wait.2.html
+static iree_status_t iree_syscall_epoll_wait(int epoll_fd,
+                                             struct epoll_event* events,
+                                             int max_events,
+                                             iree_time_t deadline_ns,
+                                             int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = epoll_wait(epoll_fd, events, max_events, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_wait failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Single-fd waits don't benefit from epoll and would require creating an epoll
+// fd just to perform the wait so we use ppoll instead.
+//
+// See the ppoll docs for more information as to what the expected value is:
+// http://man7.org/linux/man-pages/man2/poll.2.html
+static iree_status_t iree_syscall_poll_one(int fd, iree_time_t deadline_ns,
+                                           int* out_signaled_count) {
+  *out_signaled_count = 0;
+  struct pollfd poll_fd;
+  poll_fd.fd = fd;
+  poll_fd.events = POLLIN | POLLPRI;  // implicit POLLERR | POLLHUP | POLLNVAL
+  poll_fd.revents = 0;
+  int rv = -1;
+  do {
+    // Convert the deadline into a tmo_p struct for ppoll. Note that we must do
+    // this every iteration of the loop as a previous ppoll may have taken some
+    // of the time.
+    struct timespec timeout_ts;
+    struct timespec* tmo_p = &timeout_ts;
+    if (deadline_ns == IREE_TIME_INFINITE_PAST) {
+      // Block never.
+      memset(&timeout_ts, 0, sizeof(timeout_ts));
+    } else if (deadline_ns == IREE_TIME_INFINITE_FUTURE) {
+      // Block forever (NULL timeout to ppoll).
+      tmo_p = NULL;
+    } else {
+      // Wait only for as much time as we have before the deadline is exceeded.
+      iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+      if (timeout_ns < 0) {
+        // We've reached the deadline; we'll still perform the poll though as
+        // the caller is likely expecting that behavior (intentional context
+        // switch/thread yield/etc).
+        memset(&timeout_ts, 0, sizeof(timeout_ts));
+      } else {
+        timeout_ts.tv_sec = (time_t)(timeout_ns / 1000000000ull);
+        timeout_ts.tv_nsec = (long)(timeout_ns % 1000000000ull);
+      }
+    }
+    rv = ppoll(&poll_fd, 1, tmo_p, NULL);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    if (poll_fd.revents & POLLERR) {
+      return iree_make_status(IREE_STATUS_INTERNAL, "POLLERR on fd");
+    } else if (poll_fd.revents & POLLHUP) {
+      return iree_make_status(IREE_STATUS_CANCELLED, "POLLHUP on fd");
+    } else if (poll_fd.revents & POLLNVAL) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "POLLNVAL on fd");
+    }
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (rv < 0) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "ppoll failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using an epoll fd.
-// epoll lets us route the wait set operations right to kernel and not need our
-// own duplicate data structure. epoll is great, just not available on mac/ios
-// so we still need poll for that. linux/android/bsd all have epoll, though.
+// epoll lets us route the wait set operations right to the kernel: handles are
+// registered once on insertion and each wait only pays for the handles that
+// have actually signaled instead of needing to pass (and have the kernel scan)
+// the entire list as with poll. This makes the set suitable for waiting on
+// thousands of handles at a time such as when a loop has many outstanding
+// semaphore waits.
+//
+// epoll does not allow the same fd to be registered multiple times and as such
+// we track unique fds with a reference count. The index of each handle in the
+// |user_handles| list is stored as the epoll user data so that wakes can find
+// the handle without a scan.
 struct iree_wait_set_t {
-  // NOTE: we could in theory use the epoll handle directly (iree_wait_set_s
-  // then is just a pointer). Then allocate/free just go straight to the system.
-  int reserved;
+  iree_allocator_t allocator;
+
+  // epoll instance fd that all handles are registered with.
+  int epoll_fd;
+
+  // Total capacity of each handle list.
+  iree_host_size_t handle_capacity;
+
+  // Total number of valid unique user_handles/handle_refs.
+  iree_host_size_t handle_count;
+
+  // User-provided handles. Only unique handles are stored.
+  iree_wait_handle_t* user_handles;
+
+  // Number of times each handle in |user_handles| has been inserted.
+  uint32_t* handle_refs;
 };
 
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): epoll_create()
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Be reasonable; 64K objects is too high. The user data stored with each fd
+  // is the 16-bit set_internal.index.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait set capacity of %zu is unreasonably large",
+                            capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t user_handle_list_size =
+      capacity * iree_sizeof_struct(iree_wait_handle_t);
+  iree_host_size_t handle_ref_list_size = capacity * sizeof(uint32_t);
+  iree_host_size_t total_size = iree_sizeof_struct(iree_wait_set_t) +
+                                user_handle_list_size + handle_ref_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->handle_count = 0;
+
+  set->user_handles =
+      (iree_wait_handle_t*)((uint8_t*)set +
+                            iree_sizeof_struct(iree_wait_set_t));
+  set->handle_refs =
+      (uint32_t*)((uint8_t*)set->user_handles + user_handle_list_size);
+
+  // https://man7.org/linux/man-pages/man2/epoll_create.2.html
+  set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (IREE_UNLIKELY(set->epoll_fd < 0)) {
+    iree_status_t status = iree_make_status(
+        iree_status_code_from_errno(errno), "epoll_create1 failure %d", errno);
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  int rv;
+  IREE_SYSCALL(rv, close(set->epoll_fd));
+  (void)rv;
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count != 0;
+}
+
+// Registers the |user_handles| entry at |index| with epoll using |op|.
+static iree_status_t iree_wait_set_epoll_ctl(iree_wait_set_t* set, int op,
+                                             iree_host_size_t index) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLPRI;  // implicit EPOLLERR | EPOLLHUP
+  event.data.u64 = index;
+  int fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+  if (fd < 0) return iree_ok_status();  // immediate handles are never signaled
+  if (IREE_UNLIKELY(epoll_ctl(set->epoll_fd, op, fd, &event) < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_ctl failure on fd %d: %d", fd, errno);
+  }
+  return iree_ok_status();
+}
+
+// Returns the index of |handle| in the set or -1 if not found.
+// Uses the index hint stored on the handle by iree_wait_any when valid.
+static int iree_wait_set_find(iree_wait_set_t* set,
+                              const iree_wait_handle_t* handle) {
+  iree_host_size_t index = handle->set_internal.index;
+  if (IREE_LIKELY(index < set->handle_count) &&
+      IREE_LIKELY(iree_wait_primitive_compare_identical(
+          &set->user_handles[index], handle))) {
+    return (int)index;
+  }
+  // Fallback to a linear scan of (hopefully) a small list.
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    if (iree_wait_primitive_compare_identical(&set->user_handles[i], handle)) {
+      return (int)i;
+    }
+  }
+  return -1;
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_ADD)
+  if (set->handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+
+  // Optimistically try to register the handle as a new fd; the kernel will
+  // tell us if it's already present and only then do we need to go looking for
+  // the existing entry.
+  iree_host_size_t index = set->handle_count;
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  iree_wait_handle_wrap_primitive(handle.type, handle.value, user_handle);
+  iree_status_t status = iree_wait_set_epoll_ctl(set, EPOLL_CTL_ADD, index);
+  if (iree_status_is_already_exists(status)) {
+    iree_status_ignore(status);
+    int existing_index = iree_wait_set_find(set, &handle);
+    if (IREE_UNLIKELY(existing_index < 0)) {
+      // The fd is registered but not with an identical handle; this happens if
+      // two handle types share an fd which is not something we support.
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "fd registered with a different handle type");
+    }
+    ++set->handle_refs[existing_index];
+    return iree_ok_status();
+  } else if (!iree_status_is_ok(status)) {
+    return status;
+  }
+
+  set->handle_refs[index] = 1;
+  ++set->handle_count;
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_DEL)
+  // Find the user handle in the set. This either requires a linear scan to
+  // find the matching user handle or - if valid - we can use the native index
+  // set after an iree_wait_any wake to do a quick lookup.
+  int found_index = iree_wait_set_find(set, &handle);
+  if (IREE_UNLIKELY(found_index < 0)) return;
+  iree_host_size_t index = (iree_host_size_t)found_index;
+
+  // Only remove the handle once all references have been erased.
+  if (--set->handle_refs[index] > 0) return;
+
+  // Unregister from epoll. We ignore failures as the fd may have already been
+  // closed (which implicitly removes it from the epoll set).
+  int fd = iree_wait_primitive_get_read_fd(&set->user_handles[index]);
+  if (fd >= 0) epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+
+  // Since we make no guarantees about the order of the lists we can just swap
+  // with the last value. The moved handle needs its epoll user data updated so
+  // that it continues to point at its new index.
+  iree_host_size_t tail_index = set->handle_count - 1;
+  if (tail_index > index) {
+    memcpy(&set->user_handles[index], &set->user_handles[tail_index],
+           sizeof(*set->user_handles));
+    set->handle_refs[index] = set->handle_refs[tail_index];
+    iree_status_ignore(iree_wait_set_epoll_ctl(set, EPOLL_CTL_MOD, index));
+  }
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): close and reopen?
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd >= 0) epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+  }
+  set->handle_count = 0;
+}
+
+// Maps an epoll event bitfield result to a status (on failure) and an
+// indicator of whether the event was signaled.
+static iree_status_t iree_wait_set_resolve_epoll_events(uint32_t events,
+                                                        bool* out_signaled) {
+  if (events & EPOLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "EPOLLERR on fd");
+  } else if (events & EPOLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "EPOLLHUP on fd");
+  }
+  *out_signaled = (events & (EPOLLIN | EPOLLPRI)) != 0;
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // epoll is level-triggered and has no native wait-all; handles that have
+  // signaled would keep waking us while we wait for the remaining ones. Since
+  // signaled primitives stay signaled until reset we can instead wait on each
+  // handle in turn: any that have already signaled will return immediately and
+  // the total wait time is bounded by the slowest handle. Thankfully most waits
+  // are wait-any so this path is uncommon.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd < 0) continue;  // ignored like poll does with negative fds
+    int signaled_count = 0;
+    status = iree_syscall_poll_one(fd, deadline_ns, &signaled_count);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The kernel tracks readiness for us and only returns the signaled handles.
+  struct epoll_event events[IREE_WAIT_SET_EPOLL_MAX_EVENTS];
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_epoll_wait(set->epoll_fd, events,
+                                  IREE_ARRAYSIZE(events), deadline_ns,
+                                  &signaled_count));
+
+  // Route the wake back to the user handle using the index we stashed in the
+  // epoll user data at registration time.
+  memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  for (int i = 0; i < signaled_count; ++i) {
+    bool signaled = false;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_wait_set_resolve_epoll_events(events[i].events, &signaled));
+    iree_host_size_t index = (iree_host_size_t)events[i].data.u64;
+    if (signaled && index < set->handle_count) {
+      memcpy(out_wake_handle, &set->user_handles[index],
+             sizeof(*out_wake_handle));
+      out_wake_handle->set_internal.index = index;
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): just use poll?
+  int fd = iree_wait_primitive_get_read_fd(handle);
+  if (fd == -1) return iree_ok_status();  // immediate handle
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Just check for our single handle/event.
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_poll_one(fd, deadline_ns, &signaled_count));
+
+  IREE_TRACE_ZONE_END(z0);
+  return signaled_count ? iree_ok_status()
+                        : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_EPOLL
@@ -0,0 +1,208 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests loading libraries from memory through the IREE_DYLIB_CACHE_DIR cache.
+// The cache directory and size limit are read once per process and must be
+// set before the first load so these tests live in their own binary.
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/dynamic_library.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/testing/dynamic_library_test_library_embed.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+// The cache is only used where libraries can be loaded from an open file.
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+namespace iree {
+namespace {
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+
+class DynamicLibraryCacheTest : public ::testing::Test {
+ public:
+  static void SetUpTestCase() {
+    const char* test_tmpdir = getenv("TEST_TMPDIR");
+    if (!test_tmpdir) test_tmpdir = getenv("TMPDIR");
+    if (!test_tmpdir) test_tmpdir = "/tmp";
+    std::string cache_dir_template =
+        std::string(test_tmpdir) + "/iree_dylib_cache_XXXXXX";
+    std::vector<char> cache_dir(cache_dir_template.begin(),
+                                cache_dir_template.end());
+    cache_dir.push_back(0);
+    ASSERT_NE(nullptr, mkdtemp(cache_dir.data()));
+    cache_dir_ = cache_dir.data();
+    ASSERT_EQ(0, setenv("IREE_DYLIB_CACHE_DIR", cache_dir_.c_str(), 1));
+    // Room for two copies of the test library.
+    std::string max_size = std::to_string(2 * LibraryContents().data_length);
+    ASSERT_EQ(0, setenv("IREE_DYLIB_CACHE_MAX_SIZE", max_size.c_str(), 1));
+    unsetenv("IREE_PRESERVE_DYLIB_TEMP_FILES");
+  }
+
+  static void TearDownTestCase() {
+    ClearCache();
+    rmdir(cache_dir_.c_str());
+  }
+
+  void SetUp() override { ClearCache(); }
+
+  static void ClearCache() {
+    for (const auto& file_path : ListCacheFiles()) {
+      unlink(file_path.c_str());
+    }
+  }
+
+  // Returns the paths of all files in the cache directory.
+  static std::vector<std::string> ListCacheFiles() {
+    std::vector<std::string> file_paths;
+    DIR* dir = opendir(cache_dir_.c_str());
+    if (!dir) return file_paths;
+    while (struct dirent* entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name == "." || name == "..") continue;
+      file_paths.push_back(cache_dir_ + "/" + name);
+    }
+    closedir(dir);
+    return file_paths;
+  }
+
+  static iree_const_byte_span_t LibraryContents() {
+    const struct iree_file_toc_t* file_toc =
+        dynamic_library_test_library_create();
+    return iree_make_const_byte_span(file_toc->data, file_toc->size);
+  }
+
+  // Writes |size| bytes to |name| in the cache directory with a modification
+  // time |age_seconds| in the past.
+  static std::string WriteCacheFile(const char* name, size_t size,
+                                    int age_seconds) {
+    std::string file_path = cache_dir_ + "/" + name;
+    std::vector<uint8_t> contents(size, 0xCD);
+    IREE_CHECK_OK(iree_file_write_contents(
+        file_path.c_str(),
+        iree_make_const_byte_span(contents.data(), contents.size())));
+    struct timeval times[2];
+    gettimeofday(&times[0], NULL);
+    times[0].tv_sec -= age_seconds;
+    times[1] = times[0];
+    utimes(file_path.c_str(), times);
+    return file_path;
+  }
+
+  static void LoadAndCallLibrary() {
+    iree_dynamic_library_t* library = NULL;
+    IREE_ASSERT_OK(iree_dynamic_library_load_from_memory(
+        iree_make_cstring_view("cached"), LibraryContents(),
+        IREE_DYNAMIC_LIBRARY_FLAG_NONE, iree_allocator_system(), &library));
+    int (*fn_ptr)(int);
+    IREE_ASSERT_OK(iree_dynamic_library_lookup_symbol(library, "times_two",
+                                                      (void**)&fn_ptr));
+    ASSERT_NE(nullptr, fn_ptr);
+    EXPECT_EQ(246, fn_ptr(123));
+    iree_dynamic_library_release(library);
+  }
+
+  static std::string cache_dir_;
+};
+
+std::string DynamicLibraryCacheTest::cache_dir_;
+
+TEST_F(DynamicLibraryCacheTest, LoadExtractsOnceAndReuses) {
+  LoadAndCallLibrary();
+  auto file_paths = ListCacheFiles();
+  ASSERT_EQ(1, file_paths.size());
+  struct stat first_stat;
+  ASSERT_EQ(0, stat(file_paths[0].c_str(), &first_stat));
+  EXPECT_EQ(LibraryContents().data_length, first_stat.st_size);
+
+  // The second load reuses the extracted file instead of writing a new one.
+  LoadAndCallLibrary();
+  file_paths = ListCacheFiles();
+  ASSERT_EQ(1, file_paths.size());
+  struct stat second_stat;
+  ASSERT_EQ(0, stat(file_paths[0].c_str(), &second_stat));
+  EXPECT_EQ(first_stat.st_ino, second_stat.st_ino);
+}
+
+TEST_F(DynamicLibraryCacheTest, MismatchedContentsAreReplaced) {
+  LoadAndCallLibrary();
+  auto file_paths = ListCacheFiles();
+  ASSERT_EQ(1, file_paths.size());
+
+  // Corrupt the cached file while keeping its size: the contents check must
+  // reject it and extract the library again.
+  std::vector<uint8_t> garbage(LibraryContents().data_length, 0xCD);
+  IREE_ASSERT_OK(iree_file_write_contents(
+      file_paths[0].c_str(),
+      iree_make_const_byte_span(garbage.data(), garbage.size())));
+  LoadAndCallLibrary();
+  EXPECT_EQ(file_paths, ListCacheFiles());
+}
+
+TEST_F(DynamicLibraryCacheTest, SymlinksAreReplaced) {
+  LoadAndCallLibrary();
+  auto file_paths = ListCacheFiles();
+  ASSERT_EQ(1, file_paths.size());
+
+  // Replace the cached file with a symlink to a file with the same contents.
+  // The cache only loads regular files it opened itself and must extract the
+  // library again instead of following the link.
+  std::string target_path = cache_dir_ + ".target";
+  IREE_ASSERT_OK(
+      iree_file_write_contents(target_path.c_str(), LibraryContents()));
+  ASSERT_EQ(0, unlink(file_paths[0].c_str()));
+  ASSERT_EQ(0, symlink(target_path.c_str(), file_paths[0].c_str()));
+  LoadAndCallLibrary();
+  unlink(target_path.c_str());
+  struct stat file_stat;
+  ASSERT_EQ(0, lstat(file_paths[0].c_str(), &file_stat));
+  EXPECT_TRUE(S_ISREG(file_stat.st_mode));
+}
+
+TEST_F(DynamicLibraryCacheTest, LeastRecentlyUsedAreEvicted) {
+  // Fill the cache to its limit of two libraries. Extracting the library must
+  // evict the older file and leave the more recently used one.
+  size_t library_size = LibraryContents().data_length;
+  std::string old_path =
+      WriteCacheFile("iree_dylib_old.so", library_size, /*age_seconds=*/200);
+  std::string new_path =
+      WriteCacheFile("iree_dylib_new.so", library_size, /*age_seconds=*/100);
+  LoadAndCallLibrary();
+  auto file_paths = ListCacheFiles();
+  EXPECT_EQ(2, file_paths.size());
+  EXPECT_NE(0, access(old_path.c_str(), F_OK));
+  EXPECT_EQ(0, access(new_path.c_str(), F_OK));
+}
+
+TEST_F(DynamicLibraryCacheTest, LoadFailureIsReturned) {
+  // Invalid libraries can be extracted to the cache but fail to load; the
+  // failure must be returned instead of retrying with other file locations.
+  std::vector<uint8_t> garbage(128, 0xCD);
+  iree_dynamic_library_t* library = NULL;
+  iree_status_t status = iree_dynamic_library_load_from_memory(
+      iree_make_cstring_view("garbage"),
+      iree_make_const_byte_span(garbage.data(), garbage.size()),
+      IREE_DYNAMIC_LIBRARY_FLAG_NONE, iree_allocator_system(), &library);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, library);
+}
+
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+}  // namespace
+}  // namespace iree
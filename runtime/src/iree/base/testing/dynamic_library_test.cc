@@ -105,6 +105,24 @@ TEST_F(DynamicLibraryTest, LoadLibraryTwice) {
   iree_dynamic_library_release(library2);
 }
 
+TEST_F(DynamicLibraryTest, LoadLibraryFromMemory) {
+  const struct iree_file_toc_t* file_toc =
+      dynamic_library_test_library_create();
+  iree_dynamic_library_t* library = NULL;
+  IREE_ASSERT_OK(iree_dynamic_library_load_from_memory(
+      iree_make_cstring_view(file_toc->name),
+      iree_make_const_byte_span(file_toc->data, file_toc->size),
+      IREE_DYNAMIC_LIBRARY_FLAG_NONE, iree_allocator_system(), &library));
+
+  int (*fn_ptr)(int);
+  IREE_ASSERT_OK(iree_dynamic_library_lookup_symbol(library, "times_two",
+                                                    (void**)&fn_ptr));
+  ASSERT_NE(nullptr, fn_ptr);
+  EXPECT_EQ(246, fn_ptr(123));
+
+  iree_dynamic_library_release(library);
+}
+
 TEST_F(DynamicLibraryTest, GetSymbolSuccess) {
   iree_dynamic_library_t* library = NULL;
   IREE_ASSERT_OK(iree_dynamic_library_load_from_file(
@@ -0,0 +1,86 @@
+# Copyright 2022 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# Example command line:
+#   LLVM_AS=/usr/bin/llvm-as \
+#   LLVM_LINK=/usr/bin/llvm-link \
+#   CLANG=/usr/bin/clang-13 \
+#   ./runtime/src/iree/builtins/ukernel/bin/build.sh
+
+set -x
+set -e
+
+CLANG="${CLANG:-clang}"
+# TODO(benvanik): figure out how to get this path from clang itself.
+CLANG_INCLUDE="${CLANG_INCLUDE:-/usr/lib/llvm-13/lib/clang/13.0.0/include/}"
+IREE_SRC_DIR="$(git rev-parse --show-toplevel)"
+IREE_BUILD_DIR="${IREE_BUILD_DIR:-${IREE_SRC_DIR?}/../build}"
+LLVM_AS="${LLVM_AS:-${IREE_BUILD_DIR}/third_party/llvm-project/llvm/bin/llvm-as}"
+LLVM_LINK="${LLVM_LINK:-${IREE_BUILD_DIR}/third_party/llvm-project/llvm/bin/llvm-link}"
+
+SCRIPT_DIR="$(realpath `dirname $0`)"
+OUT="${SCRIPT_DIR?}/"
+SRC="${SCRIPT_DIR?}/.."
+RUNTIME_SRC="${IREE_SRC_DIR?}/runtime/src"
+
+function make_arch_bc {
+  local ARCH=$1
+  local FEATURES=$2
+  local SOURCE_FILES=$3
+  local FILE_BASENAME="${OUT}/libukernel_${ARCH}_${FEATURES}"
+
+  # Generate an LLVM IR assembly listing per source file and link them together
+  # so we can easily read the file. This is not checked in or used by the
+  # compiler.
+  local LL_FILES=()
+  for SOURCE_FILE in ${SOURCE_FILES}; do
+    local LL_FILE="${FILE_BASENAME}_${SOURCE_FILE%.c}.ll"
+    ${CLANG?} \
+        "${@:4}" \
+        -isystem "${CLANG_INCLUDE?}" \
+        -I "${RUNTIME_SRC?}" \
+        -std=c17 \
+        -O3 \
+        -fno-ident \
+        -fvisibility=hidden \
+        -ffreestanding \
+        -nostdinc \
+        -include stdint.h \
+        -S \
+        -emit-llvm \
+        -fdiscard-value-names \
+        -o "${LL_FILE}" \
+        -c \
+        "${SRC}/${SOURCE_FILE}"
+    LL_FILES+=("${LL_FILE}")
+  done
+  ${LLVM_LINK?} -S -o "${FILE_BASENAME}.ll" "${LL_FILES[@]}"
+  rm "${LL_FILES[@]}"
+
+  # Clang adds a bunch of bad attributes and host-specific information that we
+  # don't want (so we get at least somewhat deterministic builds).
+  sed -i 's/^;.*$//' "${FILE_BASENAME}.ll"
+  sed -i 's/^source_filename.*$//' "${FILE_BASENAME}.ll"
+  sed -i 's/^target datalayout.*$//' "${FILE_BASENAME}.ll"
+  sed -i 's/^target triple.*$//' "${FILE_BASENAME}.ll"
+  sed -i 's/^\(attributes #[0-9]* = {\).*$/\1 inlinehint }/' "${FILE_BASENAME}.ll"
+
+  # Generate a binary bitcode file embedded into the compiler binary.
+  # NOTE: we do this from stdin so that the filename on the user's system is not
+  # embedded in the bitcode file (making it non-deterministic).
+  cat "${FILE_BASENAME}.ll" | ${LLVM_AS} -opaque-pointers=0 -o="${FILE_BASENAME}.bc"
+}
+
+# Only the generic implementations are built today: they are target-agnostic
+# and LLVM vectorizes the loops for the target machine after linking.
+make_arch_bc "wasm32" "generic" "mmt4d.c mmt4d_generic.c" \
+    --target=wasm32 \
+    -DIREE_PLATFORM_GENERIC=1 \
+    -DIREE_UKERNEL_ARCH_GENERIC_32=1
+make_arch_bc "wasm64" "generic" "mmt4d.c mmt4d_generic.c" \
+    --target=wasm64 \
+    -DIREE_PLATFORM_GENERIC=1 \
+    -DIREE_UKERNEL_ARCH_GENERIC_64=1
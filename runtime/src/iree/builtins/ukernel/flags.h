@@ -0,0 +1,16 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_FLAGS_H_
+#define IREE_BUILTINS_UKERNEL_FLAGS_H_
+
+// Flags passed to the microkernels. These are shared with the compiler that
+// emits the microkernel calls and so this header must not include anything.
+
+// Accumulates into the existing contents of the output instead of overwriting.
+#define IREE_UKERNEL_FLAG_ACCUMULATE 1
+
+#endif  // IREE_BUILTINS_UKERNEL_FLAGS_H_
@@ -17,7 +17,7 @@
 
 IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_f32f32f32(
     const iree_ukernel_mmt4d_f32f32f32_params_t* params) {
-  if (params->flags & ~IREE_VMVX_MATMUL_FLAG_ACCUMULATE) {
+  if (params->flags & ~IREE_UKERNEL_FLAG_ACCUMULATE) {
     return IREE_UKERNEL_MMT4D_ERROR_BAD_FLAGS;
   }
 
@@ -35,7 +35,7 @@ IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_f32f32f32(
 
 IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32(
     const iree_ukernel_mmt4d_i8i8i32_params_t* params) {
-  if (params->flags & ~IREE_VMVX_MATMUL_FLAG_ACCUMULATE) {
+  if (params->flags & ~IREE_UKERNEL_FLAG_ACCUMULATE) {
     return IREE_UKERNEL_MMT4D_ERROR_BAD_FLAGS;
   }
 
@@ -51,6 +51,64 @@ IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32(
   return IREE_UKERNEL_MMT4D_ERROR_UNIMPLEMENTED;
 }
 
+IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_f32f32f32_memref(
+    const float* lhs_allocated, const float* lhs_aligned,
+    iree_ukernel_size_t lhs_base_offset, iree_ukernel_size_t lhs_offset,
+    iree_ukernel_size_t lhs_stride, const float* rhs_allocated,
+    const float* rhs_aligned, iree_ukernel_size_t rhs_base_offset,
+    iree_ukernel_size_t rhs_offset, iree_ukernel_size_t rhs_stride,
+    float* out_allocated, float* out_aligned,
+    iree_ukernel_size_t out_base_offset, iree_ukernel_size_t out_offset,
+    iree_ukernel_size_t out_stride, iree_ukernel_size_t M,
+    iree_ukernel_size_t N, iree_ukernel_size_t K, int32_t M0, int32_t N0,
+    int32_t K0, uint32_t flags) {
+  iree_ukernel_mmt4d_f32f32f32_params_t params = {
+      .lhs_buffer = lhs_aligned + lhs_base_offset + lhs_offset,
+      .rhs_buffer = rhs_aligned + rhs_base_offset + rhs_offset,
+      .out_buffer = out_aligned + out_base_offset + out_offset,
+      .lhs_stride = lhs_stride,
+      .rhs_stride = rhs_stride,
+      .out_stride = out_stride,
+      .M = M,
+      .N = N,
+      .K = K,
+      .M0 = M0,
+      .N0 = N0,
+      .K0 = K0,
+      .flags = flags,
+  };
+  return iree_ukernel_mmt4d_f32f32f32(&params);
+}
+
+IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32_memref(
+    const int8_t* lhs_allocated, const int8_t* lhs_aligned,
+    iree_ukernel_size_t lhs_base_offset, iree_ukernel_size_t lhs_offset,
+    iree_ukernel_size_t lhs_stride, const int8_t* rhs_allocated,
+    const int8_t* rhs_aligned, iree_ukernel_size_t rhs_base_offset,
+    iree_ukernel_size_t rhs_offset, iree_ukernel_size_t rhs_stride,
+    int32_t* out_allocated, int32_t* out_aligned,
+    iree_ukernel_size_t out_base_offset, iree_ukernel_size_t out_offset,
+    iree_ukernel_size_t out_stride, iree_ukernel_size_t M,
+    iree_ukernel_size_t N, iree_ukernel_size_t K, int32_t M0, int32_t N0,
+    int32_t K0, uint32_t flags) {
+  iree_ukernel_mmt4d_i8i8i32_params_t params = {
+      .lhs_buffer = lhs_aligned + lhs_base_offset + lhs_offset,
+      .rhs_buffer = rhs_aligned + rhs_base_offset + rhs_offset,
+      .out_buffer = out_aligned + out_base_offset + out_offset,
+      .lhs_stride = lhs_stride,
+      .rhs_stride = rhs_stride,
+      .out_stride = out_stride,
+      .M = M,
+      .N = N,
+      .K = K,
+      .M0 = M0,
+      .N0 = N0,
+      .K0 = K0,
+      .flags = flags,
+  };
+  return iree_ukernel_mmt4d_i8i8i32(&params);
+}
+
 const char* iree_ukernel_mmt4d_error_message(int retcode) {
   switch (retcode) {
     case IREE_UKERNEL_MMT4D_ERROR_UNIMPLEMENTED:
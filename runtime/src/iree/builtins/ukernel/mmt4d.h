@@ -8,6 +8,7 @@
 #define IREE_BUILTINS_UKERNEL_MMT4D_H_
 
 #include "iree/builtins/ukernel/common.h"
+#include "iree/builtins/ukernel/flags.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -53,9 +54,6 @@ typedef struct iree_ukernel_mmt4d_i8i8i32_params_t
 #define IREE_UKERNEL_MMT4D_ERROR_UNIMPLEMENTED 1
 #define IREE_UKERNEL_MMT4D_ERROR_BAD_FLAGS 2
 
-// TODO: move these flags to a header file shared with compiler/.
-#define IREE_VMVX_MATMUL_FLAG_ACCUMULATE 1
-
 IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_f32f32f32(
     const iree_ukernel_mmt4d_f32f32f32_params_t* params);
 IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32(
@@ -63,6 +61,34 @@ IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32(
 
 IREE_UKERNEL_EXPORT const char* iree_ukernel_mmt4d_error_message(int retcode);
 
+// Entry points called from code generated by the IREE compiler when this
+// library is linked in as bitcode. Each buffer is passed as the expanded fields
+// of the MLIR memref descriptor of its base allocation (allocated pointer,
+// aligned pointer, and offset) followed by the element offset and outer stride
+// of the accessed view. Other parameters match the params structs above.
+IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_f32f32f32_memref(
+    const float* lhs_allocated, const float* lhs_aligned,
+    iree_ukernel_size_t lhs_base_offset, iree_ukernel_size_t lhs_offset,
+    iree_ukernel_size_t lhs_stride, const float* rhs_allocated,
+    const float* rhs_aligned, iree_ukernel_size_t rhs_base_offset,
+    iree_ukernel_size_t rhs_offset, iree_ukernel_size_t rhs_stride,
+    float* out_allocated, float* out_aligned,
+    iree_ukernel_size_t out_base_offset, iree_ukernel_size_t out_offset,
+    iree_ukernel_size_t out_stride, iree_ukernel_size_t M,
+    iree_ukernel_size_t N, iree_ukernel_size_t K, int32_t M0, int32_t N0,
+    int32_t K0, uint32_t flags);
+IREE_UKERNEL_EXPORT int iree_ukernel_mmt4d_i8i8i32_memref(
+    const int8_t* lhs_allocated, const int8_t* lhs_aligned,
+    iree_ukernel_size_t lhs_base_offset, iree_ukernel_size_t lhs_offset,
+    iree_ukernel_size_t lhs_stride, const int8_t* rhs_allocated,
+    const int8_t* rhs_aligned, iree_ukernel_size_t rhs_base_offset,
+    iree_ukernel_size_t rhs_offset, iree_ukernel_size_t rhs_stride,
+    int32_t* out_allocated, int32_t* out_aligned,
+    iree_ukernel_size_t out_base_offset, iree_ukernel_size_t out_offset,
+    iree_ukernel_size_t out_stride, iree_ukernel_size_t M,
+    iree_ukernel_size_t N, iree_ukernel_size_t K, int32_t M0, int32_t N0,
+    int32_t K0, uint32_t flags);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -10,7 +10,7 @@
 
 int iree_ukernel_mmt4d_f32f32f32_generic(
     const iree_ukernel_mmt4d_f32f32f32_params_t* params) {
-  bool accumulate = params->flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+  bool accumulate = params->flags & IREE_UKERNEL_FLAG_ACCUMULATE;
   iree_ukernel_size_t lhs_tile_size = params->M0 * params->K0;
   iree_ukernel_size_t rhs_tile_size = params->N0 * params->K0;
   iree_ukernel_size_t out_tile_size = params->M0 * params->N0;
@@ -45,7 +45,7 @@ int iree_ukernel_mmt4d_f32f32f32_generic(
 
 int iree_ukernel_mmt4d_i8i8i32_generic(
     const iree_ukernel_mmt4d_i8i8i32_params_t* params) {
-  bool accumulate = params->flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+  bool accumulate = params->flags & IREE_UKERNEL_FLAG_ACCUMULATE;
   iree_ukernel_size_t lhs_tile_size = params->M0 * params->K0;
   iree_ukernel_size_t rhs_tile_size = params->N0 * params->K0;
   iree_ukernel_size_t out_tile_size = params->M0 * params->N0;
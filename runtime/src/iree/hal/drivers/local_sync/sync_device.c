@@ -38,6 +38,9 @@ typedef struct iree_hal_sync_device_t {
   // synchronization ourselves.
   iree_hal_sync_semaphore_state_t semaphore_state;
 
+  // Executable cache shared by all users of the device.
+  iree_hal_executable_cache_t* executable_cache;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_sync_device_t;
@@ -54,6 +57,7 @@ void iree_hal_sync_device_params_initialize(
     iree_hal_sync_device_params_t* out_params) {
   memset(out_params, 0, sizeof(*out_params));
   out_params->arena_block_size = 32 * 1024;
+  out_params->executable_cache_capacity = 256;
 }
 
 static iree_status_t iree_hal_sync_device_check_params(
@@ -107,6 +111,13 @@ iree_status_t iree_hal_sync_device_create(
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_cache_create(
+        device->identifier, /*worker_capacity=*/1,
+        params->executable_cache_capacity, device->loader_count,
+        device->loaders, host_allocator, &device->executable_cache);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -123,6 +134,7 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
+  iree_hal_executable_cache_release(device->executable_cache);
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -153,6 +165,7 @@ static iree_hal_allocator_t* iree_hal_sync_device_allocator(
 
 static iree_status_t iree_hal_sync_device_trim(iree_hal_device_t* base_device) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  iree_hal_local_executable_cache_trim(device->executable_cache);
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -228,9 +241,11 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
-  return iree_hal_local_executable_cache_create(
-      identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+  // All caches share the device cache such that executables are deduplicated
+  // across all users of the device.
+  iree_hal_executable_cache_retain(device->executable_cache);
+  *out_executable_cache = device->executable_cache;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_sync_device_create_pipeline_layout(
@@ -22,6 +22,12 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Maximum number of executables retained by the device executable cache.
+  // Executables prepared multiple times (such as by multiple contexts loading
+  // the same program) are loaded once and shared while cached. 0 disables
+  // caching and each preparation loads a new executable.
+  iree_host_size_t executable_cache_capacity;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -12,6 +12,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
@@ -41,6 +42,9 @@ typedef struct iree_hal_task_command_buffer_t {
 
   iree_task_scope_t* scope;
 
+  // Bytes of each streamed binding prefetched for the next workgroup.
+  iree_host_size_t dispatch_prefetch_budget;
+
   // Arena used for all allocations; references the shared device block pool.
   iree_arena_allocator_t arena;
 
@@ -111,6 +115,7 @@ iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_host_size_t dispatch_prefetch_budget,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
@@ -146,6 +151,7 @@ iree_status_t iree_hal_task_command_buffer_create(
         &iree_hal_task_command_buffer_vtable, &command_buffer->base);
     command_buffer->host_allocator = host_allocator;
     command_buffer->scope = scope;
+    command_buffer->dispatch_prefetch_budget = dispatch_prefetch_budget;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
     iree_task_list_initialize(&command_buffer->leaf_tasks);
@@ -799,12 +805,67 @@ typedef struct iree_hal_cmd_dispatch_t {
   // used (known at compile-time).
   uint16_t binding_count;
 
+  // Maximum number of bytes of each binding in |prefetch_bindings| to prefetch
+  // for the next workgroup prior to issuing the current one.
+  uint32_t prefetch_budget;
+
+  // Dense binding ordinals the executable declared as streamed and that will
+  // have the estimated range of the next workgroup prefetched. 0 if disabled.
+  uint64_t prefetch_bindings;
+
+  // Subset of |prefetch_bindings| that are writable and prefetched for write.
+  uint64_t prefetch_write_bindings;
+
   // Following this structure in memory there are 3 tables:
   // - const uint32_t push_constants[push_constant_count];
   // - void* binding_ptrs[binding_count];
   // - const size_t binding_lengths[binding_count];
 } iree_hal_cmd_dispatch_t;
 
+// Issues prefetches for the portion of each streamed binding we expect the
+// workgroup following the one in |tile_context| to access. Tiles are handed
+// out to workers in contiguous runs of linearized workgroup IDs and streamed
+// bindings are accessed roughly proportionally to that ID so by the time the
+// current workgroup finishes the next one's inputs are (hopefully) in cache.
+// The ranges are only estimates and this never affects correctness.
+static void iree_hal_cmd_dispatch_prefetch_next(
+    const iree_hal_cmd_dispatch_t* cmd,
+    const iree_task_tile_context_t* tile_context, void* const* binding_ptrs,
+    const size_t* binding_lengths) {
+  const uint64_t workgroup_total = (uint64_t)tile_context->workgroup_count[0] *
+                                   tile_context->workgroup_count[1] *
+                                   tile_context->workgroup_count[2];
+  const uint64_t next_workgroup_id =
+      ((uint64_t)tile_context->workgroup_xyz[2] *
+           tile_context->workgroup_count[1] +
+       tile_context->workgroup_xyz[1]) *
+          tile_context->workgroup_count[0] +
+      tile_context->workgroup_xyz[0] + 1;
+  if (next_workgroup_id >= workgroup_total) return;
+  uint64_t binding_mask = cmd->prefetch_bindings;
+  while (binding_mask) {
+    int i = iree_math_count_trailing_zeros_u64(binding_mask);
+    binding_mask &= binding_mask - 1;
+    iree_host_size_t range_offset = 0;
+    const iree_host_size_t range_length =
+        iree_hal_local_executable_streamed_range(
+            binding_lengths[i], workgroup_total, next_workgroup_id,
+            cmd->prefetch_budget, &range_offset);
+    const uint8_t* base = (const uint8_t*)binding_ptrs[i] + range_offset;
+    if (cmd->prefetch_write_bindings & (1ull << i)) {
+      for (iree_host_size_t offset = 0; offset < range_length;
+           offset += iree_hardware_destructive_interference_size) {
+        IREE_PREFETCH_RW(base + offset, IREE_PREFETCH_LOCALITY_NONE);
+      }
+    } else {
+      for (iree_host_size_t offset = 0; offset < range_length;
+           offset += iree_hardware_destructive_interference_size) {
+        IREE_PREFETCH_RO(base + offset, IREE_PREFETCH_LOCALITY_NONE);
+      }
+    }
+  }
+}
+
 static iree_status_t iree_hal_cmd_dispatch_tile(
     void* user_context, const iree_task_tile_context_t* tile_context,
     iree_task_submission_t* pending_submission) {
@@ -837,6 +898,14 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
   dispatch_state.binding_lengths = (size_t*)cmd_ptr;
   cmd_ptr += cmd->binding_count * sizeof(*dispatch_state.binding_lengths);
 
+  // Persistent scratch memory owned by this worker, if the entry point needs
+  // any. It is allocated on first use and reused by later tiles/dispatches.
+  iree_byte_span_t worker_scratch = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_local_executable_acquire_worker_scratch(
+              cmd->executable, cmd->ordinal, tile_context->worker_id,
+              &worker_scratch));
+
   const iree_alignas(64)
       iree_hal_executable_workgroup_state_v0_t workgroup_state = {
           .workgroup_id_x = tile_context->workgroup_xyz[0],
@@ -846,7 +915,14 @@ static iree_status_t iree_hal_cmd_dispatch_tile(
           .processor_id = tile_context->processor_id,
           .local_memory = tile_context->local_memory.data,
           .local_memory_size = (size_t)tile_context->local_memory.data_length,
+          .worker_scratch_size = (uint32_t)worker_scratch.data_length,
+          .worker_scratch = worker_scratch.data,
       };
+  if (cmd->prefetch_bindings) {
+    iree_hal_cmd_dispatch_prefetch_next(cmd, tile_context,
+                                        dispatch_state.binding_ptrs,
+                                        dispatch_state.binding_lengths);
+  }
   iree_status_t status = iree_hal_local_executable_issue_call(
       cmd->executable, cmd->ordinal, &dispatch_state, &workgroup_state,
       tile_context->worker_id);
@@ -899,6 +975,36 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd->push_constant_count = push_constant_count;
   cmd->binding_count = used_binding_count;
 
+  // Only streamed bindings are prefetched: reused bindings are expected to
+  // already be cache-resident and unknown ones may not be touched at all.
+  cmd->prefetch_budget = (uint32_t)iree_min(
+      command_buffer->dispatch_prefetch_budget, (iree_host_size_t)UINT32_MAX);
+  cmd->prefetch_bindings = 0;
+  if (cmd->prefetch_budget > 0) {
+    cmd->prefetch_bindings =
+        iree_hal_local_executable_dispatch_hints(local_executable, entry_point)
+            .streamed_bindings &
+        (used_binding_count >= 64 ? UINT64_MAX
+                                  : ((1ull << used_binding_count) - 1));
+  }
+
+  // Writable bindings are prefetched for write so that the lines arrive in an
+  // exclusive state and the stores don't need another coherence round trip.
+  // The layout tracks read-only bindings in the sparse set and we need them in
+  // the dense ordinal order.
+  cmd->prefetch_write_bindings = 0;
+  if (cmd->prefetch_bindings) {
+    iree_hal_local_binding_mask_t sparse_mask = local_layout->used_bindings;
+    for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
+      int sparse_ordinal = iree_math_count_trailing_zeros_u64(sparse_mask);
+      sparse_mask &= sparse_mask - 1;
+      if (!(local_layout->read_only_bindings & (1ull << sparse_ordinal))) {
+        cmd->prefetch_write_bindings |= 1ull << i;
+      }
+    }
+    cmd->prefetch_write_bindings &= cmd->prefetch_bindings;
+  }
+
   const uint32_t workgroup_count[3] = {workgroup_x, workgroup_y, workgroup_z};
   // TODO(benvanik): expose on API or keep fixed on executable.
   const uint32_t workgroup_size[3] = {1, 1, 1};
@@ -18,11 +18,15 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Creates a command buffer that records into task DAGs issued to |scope|.
+// Dispatches prefetch up to |dispatch_prefetch_budget| bytes of each streamed
+// binding for the next workgroup (see iree_hal_task_device_params_t).
 iree_status_t iree_hal_task_command_buffer_create(
     iree_hal_device_t* device, iree_task_scope_t* scope,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_host_size_t dispatch_prefetch_budget,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
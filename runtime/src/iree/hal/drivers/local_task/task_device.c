@@ -38,6 +38,12 @@ typedef struct iree_hal_task_device_t {
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t** loaders;
 
+  // Executable cache shared by all users of the device.
+  iree_hal_executable_cache_t* executable_cache;
+
+  // Bytes of each streamed binding prefetched ahead of each workgroup.
+  iree_host_size_t dispatch_prefetch_budget;
+
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
@@ -57,6 +63,8 @@ void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_count = 8;
+  out_params->executable_cache_capacity = 256;
+  out_params->dispatch_prefetch_budget = 0;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -123,6 +131,8 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_executable_loader_retain(device->loaders[i]);
     }
 
+    device->dispatch_prefetch_budget = params->dispatch_prefetch_budget;
+
     device->queue_count = params->queue_count;
     for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
@@ -132,6 +142,13 @@ iree_status_t iree_hal_task_device_create(
     }
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_cache_create(
+        device->identifier, iree_task_executor_worker_count(device->executor),
+        params->executable_cache_capacity, device->loader_count,
+        device->loaders, host_allocator, &device->executable_cache);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -149,6 +166,7 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
+  iree_hal_executable_cache_release(device->executable_cache);
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -184,6 +202,7 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   iree_arena_block_pool_trim(&device->small_block_pool);
   iree_arena_block_pool_trim(&device->large_block_pool);
   iree_task_executor_trim(device->executor);
+  iree_hal_local_executable_cache_trim(device->executable_cache);
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -244,8 +263,8 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
       device, command_categories, queue_affinity);
   return iree_hal_task_command_buffer_create(
       base_device, &device->queues[queue_index].scope, mode, command_categories,
-      queue_affinity, binding_capacity, &device->large_block_pool,
-      device->host_allocator, out_command_buffer);
+      queue_affinity, binding_capacity, device->dispatch_prefetch_budget,
+      &device->large_block_pool, device->host_allocator, out_command_buffer);
 }
 
 static iree_status_t iree_hal_task_device_create_descriptor_set_layout(
@@ -269,10 +288,11 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  return iree_hal_local_executable_cache_create(
-      identifier, iree_task_executor_worker_count(device->executor),
-      device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+  // All caches share the device cache such that executables are deduplicated
+  // across all users of the device.
+  iree_hal_executable_cache_retain(device->executable_cache);
+  *out_executable_cache = device->executable_cache;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_device_create_pipeline_layout(
@@ -28,6 +28,19 @@ typedef struct iree_hal_task_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Maximum number of executables retained by the device executable cache.
+  // Executables prepared multiple times (such as by multiple contexts loading
+  // the same program) are loaded once and shared while cached. 0 disables
+  // caching and each preparation loads a new executable.
+  iree_host_size_t executable_cache_capacity;
+
+  // Maximum number of bytes of each streamed binding that are prefetched for
+  // the next workgroup while the current one executes. Only bindings the
+  // executable declares as streamed in its dispatch hints are prefetched and
+  // the range is estimated by evenly dividing the binding across workgroups.
+  // 0 disables prefetching.
+  iree_host_size_t dispatch_prefetch_budget;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -31,8 +31,40 @@ typedef struct iree_elf_relocation_state_t {
   // PT_DYNAMIC table.
   iree_host_size_t dyn_table_count;
   const iree_elf_dyn_t* dyn_table;
+
+  // Host addresses of all dynamic symbols indexed by symbol ordinal.
+  // Imported symbols have been resolved and defined symbols are biased.
+  iree_host_size_t sym_count;
+  const iree_elf_addr_t* sym_addrs;
+
+  // .dynsym table with |sym_count| entries used to identify imported symbols.
+  const iree_elf_sym_t* syms;
 } iree_elf_relocation_state_t;
 
+// Returns the host address of the symbol with ordinal |sym_ordinal| as
+// referenced by a relocation entry.
+static inline iree_status_t iree_elf_relocation_state_resolve_symbol(
+    const iree_elf_relocation_state_t* state, iree_host_size_t sym_ordinal,
+    iree_elf_addr_t* out_sym_addr) {
+  if (IREE_UNLIKELY(sym_ordinal >= state->sym_count)) {
+    *out_sym_addr = 0;
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "relocation symbol ordinal %zu out of range (%zu)",
+                            sym_ordinal, state->sym_count);
+  }
+  *out_sym_addr = state->sym_addrs[sym_ordinal];
+  return iree_ok_status();
+}
+
+// Returns true if the symbol with ordinal |sym_ordinal| is imported from the
+// host instead of defined by the module. Imported symbols may be anywhere in the
+// host address space and not within range of narrow relocations.
+static inline bool iree_elf_relocation_state_is_import(
+    const iree_elf_relocation_state_t* state, iree_host_size_t sym_ordinal) {
+  return sym_ordinal > 0 && sym_ordinal < state->sym_count &&
+         state->syms[sym_ordinal].st_shndx == IREE_ELF_SHN_UNDEF;
+}
+
 // Applies architecture-specific relocations.
 iree_status_t iree_elf_arch_apply_relocations(
     iree_elf_relocation_state_t* state);
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -50,6 +51,28 @@ enum {
   IREE_ELF_R_X86_64_PC64 = 24,      // Place relative 64-bit signed
 };
 
+// Returns OUT_OF_RANGE if |value| does not fit in the 32-bit field of a
+// relocation of |type| applied to symbol |sym_ordinal|. This only happens when
+// the symbol is imported from the host and placed outside of the +/-2GB the
+// (non-PIC) code model assumes.
+static iree_status_t iree_elf_arch_x86_64_check_range32(
+    const iree_elf_relocation_state_t* state, uint32_t type,
+    iree_host_size_t sym_ordinal, int64_t value, int64_t min_value,
+    int64_t max_value) {
+  if (IREE_LIKELY(value >= min_value && value <= max_value)) {
+    return iree_ok_status();
+  }
+  return iree_make_status(
+      IREE_STATUS_OUT_OF_RANGE,
+      "x86_64 relocation type %u against %s symbol %zu out of range "
+      "(value %" PRId64 " not in [%" PRId64 ", %" PRId64
+      "]); imported symbols must be referenced through the GOT/PLT",
+      type,
+      iree_elf_relocation_state_is_import(state, sym_ordinal) ? "imported"
+                                                              : "defined",
+      sym_ordinal, value, min_value, max_value);
+}
+
 static iree_status_t iree_elf_arch_x86_64_apply_rela(
     iree_elf_relocation_state_t* state, iree_host_size_t rela_count,
     const iree_elf_rela_t* rela_table) {
@@ -58,12 +81,10 @@ static iree_status_t iree_elf_arch_x86_64_apply_rela(
     uint32_t type = IREE_ELF_R_TYPE(rela->r_info);
     if (type == IREE_ELF_R_X86_64_NONE) continue;
 
-    // TODO(benvanik): support imports by resolving from the import table.
+    iree_host_size_t sym_ordinal = IREE_ELF_R_SYM(rela->r_info);
     iree_elf_addr_t sym_addr = 0;
-    if (IREE_ELF_R_SYM(rela->r_info) != 0) {
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "symbol-relative relocations not implemented");
-    }
+    IREE_RETURN_IF_ERROR(
+        iree_elf_relocation_state_resolve_symbol(state, sym_ordinal, &sym_addr));
 
     iree_elf_addr_t instr_ptr =
         (iree_elf_addr_t)state->vaddr_bias + rela->r_offset;
@@ -79,21 +100,40 @@ static iree_status_t iree_elf_arch_x86_64_apply_rela(
         *(uint64_t*)instr_ptr = (uint64_t)sym_addr;
         break;
       case IREE_ELF_R_X86_64_COPY:
-        *(uint64_t*)instr_ptr = (uint64_t)sym_addr;
-        break;
+        // Copies the symbol contents into the module image. Only valid in
+        // executables and we never want module data aliasing host data.
+        return iree_make_status(
+            IREE_STATUS_UNIMPLEMENTED,
+            "x86_64 R_X86_64_COPY relocation against %s symbol %zu is not "
+            "supported; modules must be linked as shared objects",
+            iree_elf_relocation_state_is_import(state, sym_ordinal)
+                ? "imported"
+                : "defined",
+            sym_ordinal);
       case IREE_ELF_R_X86_64_64:
         *(uint64_t*)instr_ptr = (uint64_t)(sym_addr + rela->r_addend);
         break;
-      case IREE_ELF_R_X86_64_32:
-        *(uint32_t*)instr_ptr = (uint32_t)(sym_addr + rela->r_addend);
+      case IREE_ELF_R_X86_64_32: {
+        int64_t value = (int64_t)(sym_addr + rela->r_addend);
+        IREE_RETURN_IF_ERROR(iree_elf_arch_x86_64_check_range32(
+            state, type, sym_ordinal, value, 0, UINT32_MAX));
+        *(uint32_t*)instr_ptr = (uint32_t)value;
         break;
-      case IREE_ELF_R_X86_64_32S:
-        *(int32_t*)instr_ptr = (int32_t)(sym_addr + rela->r_addend);
+      }
+      case IREE_ELF_R_X86_64_32S: {
+        int64_t value = (int64_t)(sym_addr + rela->r_addend);
+        IREE_RETURN_IF_ERROR(iree_elf_arch_x86_64_check_range32(
+            state, type, sym_ordinal, value, INT32_MIN, INT32_MAX));
+        *(int32_t*)instr_ptr = (int32_t)value;
         break;
-      case IREE_ELF_R_X86_64_PC32:
-        *(uint32_t*)instr_ptr =
-            (uint32_t)(sym_addr + rela->r_addend - instr_ptr);
+      }
+      case IREE_ELF_R_X86_64_PC32: {
+        int64_t value = (int64_t)(sym_addr + rela->r_addend - instr_ptr);
+        IREE_RETURN_IF_ERROR(iree_elf_arch_x86_64_check_range32(
+            state, type, sym_ordinal, value, INT32_MIN, INT32_MAX));
+        *(uint32_t*)instr_ptr = (uint32_t)value;
         break;
+      }
       default:
         return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                 "unimplemented x86_64 relocation type %08X",
@@ -230,8 +230,117 @@ static iree_byte_range_t iree_elf_module_calculate_vaddr_range(
   return byte_range;
 }
 
+// Returns true if the raw ELF data may be mapped from a file such that pages
+// line up with the virtual address layout of the module. This is a cheap check
+// performed before querying the platform as file-backed ELFs are rare.
+static bool iree_elf_module_may_map_from_file(
+    iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state,
+    iree_byte_range_t vaddr_range) {
+  // File offsets and memory addresses are congruent modulo the page size so
+  // the data must be positioned in memory as it would be when loaded.
+  const iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD || phdr->p_filesz == 0) continue;
+    uintptr_t file_addr = (uintptr_t)raw_data.data + phdr->p_offset;
+    uintptr_t load_addr = phdr->p_vaddr - vaddr_range.offset;
+    if (((file_addr - load_addr) & (page_size - 1)) == 0) return true;
+  }
+  return false;
+}
+
+// Returns true if the PT_LOAD segment at |phdr_index| can be mapped directly
+// from |file| instead of being copied into committed memory.
+static bool iree_elf_module_can_map_segment(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    iree_elf_half_t phdr_index, const iree_memory_file_t* file) {
+  const iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  const iree_elf_phdr_t* phdr = &load_state->phdr_table[phdr_index];
+  if (phdr->p_filesz == 0) return false;
+
+  // Pages can only be mapped if the file and memory offsets within them match.
+  uintptr_t vaddr = (uintptr_t)module->vaddr_bias + phdr->p_vaddr;
+  uint64_t file_offset = file->offset + phdr->p_offset;
+  if ((vaddr & (page_size - 1)) != (file_offset & (page_size - 1))) {
+    return false;
+  }
+
+  // Pages are mapped whole and must not be shared with other segments that
+  // may need different file contents (or zeros) in them.
+  uintptr_t page_start = iree_page_align_start(vaddr, page_size);
+  uintptr_t page_end = iree_page_align_end(vaddr + phdr->p_memsz, page_size);
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* other_phdr = &load_state->phdr_table[i];
+    if (i == phdr_index || other_phdr->p_type != IREE_ELF_PT_LOAD) continue;
+    uintptr_t other_vaddr = (uintptr_t)module->vaddr_bias + other_phdr->p_vaddr;
+    uintptr_t other_page_start = iree_page_align_start(other_vaddr, page_size);
+    uintptr_t other_page_end =
+        iree_page_align_end(other_vaddr + other_phdr->p_memsz, page_size);
+    if (other_page_start < page_end && page_start < other_page_end) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Maps the PT_LOAD segment |phdr| from |file| into the module address space.
+// Pages are mapped privately such that they are shared with the page cache and
+// other processes until written (by relocation or as .data) at which point
+// they are copied.
+static iree_status_t iree_elf_module_map_segment(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_phdr_t* phdr, const iree_memory_file_t* file) {
+  const iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  iree_byte_range_t file_range = {
+      .offset = phdr->p_vaddr,
+      .length = phdr->p_filesz,
+  };
+  const uint64_t file_offset = file->offset + phdr->p_offset;
+
+  // Executable segments are first mapped as such to ensure the file allows it
+  // (it may be on a noexec mount) before we make the pages writeable.
+  if (phdr->p_flags & IREE_ELF_PF_X) {
+    IREE_RETURN_IF_ERROR(iree_memory_view_map_file_range(
+        module->vaddr_bias, file_range, file, file_offset,
+        IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_EXECUTE));
+    IREE_RETURN_IF_ERROR(iree_memory_view_protect_ranges(
+        module->vaddr_bias, 1, &file_range,
+        IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_memory_view_map_file_range(
+        module->vaddr_bias, file_range, file, file_offset,
+        IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+  }
+
+  // Bytes past p_filesz must be zeroed. Those in the last file page contain
+  // the neighboring file contents and the remainder need fresh zeroed pages.
+  if (phdr->p_memsz > phdr->p_filesz) {
+    uint8_t* zero_start = module->vaddr_bias + phdr->p_vaddr + phdr->p_filesz;
+    uint8_t* zero_end = module->vaddr_bias + phdr->p_vaddr + phdr->p_memsz;
+    uint8_t* page_end =
+        (uint8_t*)iree_page_align_end((uintptr_t)zero_start, page_size);
+    memset(zero_start, 0, iree_min(zero_end, page_end) - zero_start);
+    if (zero_end > page_end) {
+      iree_byte_range_t zero_range = {
+          .offset = (iree_host_size_t)(page_end - module->vaddr_bias),
+          .length = (iree_host_size_t)(zero_end - page_end),
+      };
+      IREE_RETURN_IF_ERROR(iree_memory_view_commit_ranges(
+          module->vaddr_bias, 1, &zero_range,
+          IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+    }
+  }
+
+  return iree_ok_status();
+}
+
 // Allocates space for and loads all DT_LOAD segments into the host virtual
 // address space.
+//
+// If |raw_data| is a page-aligned view of a mapped file (such as an ELF
+// embedded in a mapped module file) segments are mapped directly from the file
+// where possible instead of being copied. Only pages that are written during
+// loading are copied and the rest are shared with the page cache.
 static iree_status_t iree_elf_module_load_segments(
     iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state,
     iree_elf_module_t* module) {
@@ -248,29 +357,40 @@ static iree_status_t iree_elf_module_load_segments(
       module->host_allocator, (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
 
+  // Find the file backing the ELF data, if any.
+  iree_memory_file_t file;
+  bool has_file =
+      iree_elf_module_may_map_from_file(raw_data, load_state, vaddr_range) &&
+      iree_memory_file_query(raw_data.data, raw_data.data_length, &file);
+
   // Commit and load all of the segments.
+  iree_status_t status = iree_ok_status();
   for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
     const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
     if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
 
+    // Try to map the segment directly from the file.
+    if (has_file &&
+        iree_elf_module_can_map_segment(load_state, module, i, &file)) {
+      iree_status_t map_status =
+          iree_elf_module_map_segment(load_state, module, phdr, &file);
+      if (iree_status_is_ok(map_status)) continue;
+      // Fall back to copying; committing below replaces any partial mapping.
+      iree_status_ignore(map_status);
+    }
+
     // Commit the range of pages used by this segment, initially with write
     // access so that we can modify the pages.
     iree_byte_range_t byte_range = {
         .offset = phdr->p_vaddr,
         .length = phdr->p_memsz,
     };
-    IREE_RETURN_IF_ERROR(iree_memory_view_commit_ranges(
+    status = iree_memory_view_commit_ranges(
         module->vaddr_bias, 1, &byte_range,
-        IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+        IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE);
+    if (!iree_status_is_ok(status)) break;
 
     // Copy data present in the file.
-    // TODO(benvanik): infra for being able to detect if the source model is in
-    // a mapped file - if it is, we can remap the page and directly reference it
-    // here for read-only segments and setup copy-on-write for writeable ones.
-    // We'd need a way to pass in the underlying mapping and some guarantees on
-    // the lifetime of it. Today we are just always committing above and copying
-    // here because it keeps this all super simple (you know, as simple as an
-    // entire custom ELF loader can be :).
     if (phdr->p_filesz > 0) {
       memcpy(module->vaddr_bias + phdr->p_vaddr, raw_data.data + phdr->p_offset,
              phdr->p_filesz);
@@ -285,7 +405,8 @@ static iree_status_t iree_elf_module_load_segments(
     // pages in iree_elf_module_protect_segments.
   }
 
-  return iree_ok_status();
+  if (has_file) iree_memory_file_close(&file);
+  return status;
 }
 
 // Applies segment memory protection attributes.
@@ -466,24 +587,80 @@ static iree_status_t iree_elf_module_parse_dynamic_tables(
   return iree_ok_status();
 }
 
-// Verifies that there are no dynamic imports in the module as we don't support
-// them yet.
-static iree_status_t iree_elf_module_verify_no_imports(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+// Looks up |sym_name| in the |import_table|.
+static iree_status_t iree_elf_import_table_resolve(
+    const iree_elf_import_table_t* import_table, const char* sym_name,
+    void** out_ptr) {
+  *out_ptr = NULL;
+  if (import_table) {
+    for (iree_host_size_t i = 0; i < import_table->import_count; ++i) {
+      const iree_elf_import_t* import = &import_table->imports[i];
+      if (strcmp(import->sym_name, sym_name) == 0) {
+        *out_ptr = import->thunk_ptr;
+        return iree_ok_status();
+      }
+    }
+  }
+  return iree_make_status(IREE_STATUS_NOT_FOUND,
+                          "ELF import '%s' not found in the import table",
+                          sym_name);
+}
+
+// Resolves the host address of every symbol in the dynamic symbol table.
+// Symbols defined by the module are biased by the load address and undefined
+// symbols are resolved using |import_table|. Weak imports that cannot be
+// resolved are assigned 0 while strong imports fail the load.
+//
+// |out_sym_addrs| is indexed by symbol ordinal and must be freed by the caller
+// using the module host allocator.
+static iree_status_t iree_elf_module_resolve_symbols(
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_import_table_t* import_table,
+    iree_elf_addr_t** out_sym_addrs) {
+  *out_sym_addrs = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_elf_addr_t* sym_addrs = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(module->host_allocator,
+                                module->dynsym_count * sizeof(*sym_addrs),
+                                (void**)&sym_addrs));
+
   // NOTE: slot 0 is always the 0 placeholder.
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t import_count = 0;
+  sym_addrs[0] = 0;
   for (iree_host_size_t i = 1; i < module->dynsym_count; ++i) {
     const iree_elf_sym_t* sym = &module->dynsym[i];
-    if (sym->st_shndx == IREE_ELF_SHN_UNDEF) {
-      const char* symname IREE_ATTRIBUTE_UNUSED =
-          sym->st_name ? module->dynstr + sym->st_name : NULL;
-      return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                              "ELF imports one or more symbols (trying "
-                              "'%s'); imports are not supported in the "
-                              "platform-agnostic loader",
-                              symname);
+    if (sym->st_shndx != IREE_ELF_SHN_UNDEF) {
+      sym_addrs[i] = (iree_elf_addr_t)(module->vaddr_bias + sym->st_value);
+      continue;
     }
+    if (!sym->st_name) {
+      sym_addrs[i] = 0;
+      continue;
+    }
+    const char* sym_name = module->dynstr + sym->st_name;
+    void* sym_ptr = NULL;
+    status = iree_elf_import_table_resolve(import_table, sym_name, &sym_ptr);
+    if (!iree_status_is_ok(status) &&
+        IREE_ELF_ST_BIND(sym->st_info) == IREE_ELF_STB_WEAK) {
+      status = iree_status_ignore(status);
+      sym_ptr = NULL;
+    }
+    if (!iree_status_is_ok(status)) break;
+    sym_addrs[i] = (iree_elf_addr_t)sym_ptr;
+    ++import_count;
   }
-  return iree_ok_status();
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, import_count);
+
+  if (iree_status_is_ok(status)) {
+    *out_sym_addrs = sym_addrs;
+  } else {
+    iree_allocator_free(module->host_allocator, sym_addrs);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 //==============================================================================
@@ -492,13 +669,17 @@ static iree_status_t iree_elf_module_verify_no_imports(
 
 // Applies symbol and address base relocations to the loaded sections.
 static iree_status_t iree_elf_module_apply_relocations(
-    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module,
+    const iree_elf_addr_t* sym_addrs) {
   // Redirect to the architecture-specific handler.
   iree_elf_relocation_state_t reloc_state;
   memset(&reloc_state, 0, sizeof(reloc_state));
   reloc_state.vaddr_bias = module->vaddr_bias;
   reloc_state.dyn_table = load_state->dyn_table;
   reloc_state.dyn_table_count = load_state->dyn_table_count;
+  reloc_state.sym_count = module->dynsym_count;
+  reloc_state.sym_addrs = sym_addrs;
+  reloc_state.syms = module->dynsym;
   return iree_elf_arch_apply_relocations(&reloc_state);
 }
 
@@ -598,16 +779,20 @@ iree_status_t iree_elf_module_initialize_from_memory(
     status = iree_elf_module_parse_dynamic_tables(&load_state, out_module);
   }
 
-  // TODO(benvanik): imports would happen here. For now we just ensure there are
-  // no imports as otherwise things will fail with obscure messages later on.
+  // Resolve imports and the addresses of all symbols referenced by
+  // relocations.
+  iree_elf_addr_t* sym_addrs = NULL;
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_verify_no_imports(&load_state, out_module);
+    status = iree_elf_module_resolve_symbols(&load_state, out_module,
+                                             import_table, &sym_addrs);
   }
 
   // Apply relocations to the loaded pages.
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_apply_relocations(&load_state, out_module);
+    status =
+        iree_elf_module_apply_relocations(&load_state, out_module, sym_addrs);
   }
+  iree_allocator_free(host_allocator, sym_addrs);
 
   // Apply final protections to the loaded pages now that relocations have been
   // performed.
@@ -17,11 +17,17 @@
 // ELF symbol import table
 //==============================================================================
 
+// A symbol that can be imported by an ELF module.
+// |thunk_ptr| is called directly by the module code and must use the ELF
+// calling convention of the target architecture (System V on x86_64, which
+// differs from the host convention on Windows).
 typedef struct iree_elf_import_t {
   const char* sym_name;
   void* thunk_ptr;
 } iree_elf_import_t;
 
+// Symbols made available to ELF modules at load time.
+// Undefined dynamic symbols in the module are looked up by name in |imports|.
 typedef struct iree_elf_import_table_t {
   iree_host_size_t import_count;
   const iree_elf_import_t* imports;
@@ -7,12 +7,22 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/cpu.h"
 #include "iree/base/target_platform.h"
+#include "iree/hal/local/elf/arch.h"
 #include "iree/hal/local/elf/elf_module.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/executable_library.h"
 
 // ELF modules for various platforms embedded in the binary:
 #include "iree/hal/local/elf/testdata/elementwise_mul.h"
+#include "iree/hal/local/elf/testdata/unresolved_import.h"
+
+#if defined(IREE_PLATFORM_LINUX)
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_LINUX
 
 static iree_status_t query_arch_test_file_data(
     iree_const_byte_span_t* out_file_data) {
@@ -52,23 +62,16 @@ static iree_status_t query_arch_test_file_data(
                           "the application for the current target platform");
 }
 
-static iree_status_t run_test() {
-  iree_const_byte_span_t file_data;
-  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
-
-  iree_elf_import_table_t import_table;
-  memset(&import_table, 0, sizeof(import_table));
-  iree_elf_module_t module;
-  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
-      file_data, &import_table, iree_allocator_system(), &module));
-
+// Runs the elementwise_mul dispatch in the loaded |module| and verifies the
+// results.
+static iree_status_t run_module(iree_elf_module_t* module) {
   iree_hal_executable_environment_v0_t environment;
   iree_hal_executable_environment_initialize(iree_allocator_system(),
                                              &environment);
 
   void* query_fn_ptr = NULL;
   IREE_RETURN_IF_ERROR(iree_elf_module_lookup_export(
-      &module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
+      module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
 
   union {
     const iree_hal_executable_library_header_t** header;
@@ -141,21 +144,293 @@ static iree_status_t run_test() {
                             "dispatch function returned failure: %d", ret);
   }
 
-  iree_status_t status = iree_ok_status();
   for (int i = 0; i < IREE_ARRAYSIZE(expected); ++i) {
     if (ret0[i] != expected[i]) {
-      status =
-          iree_make_status(IREE_STATUS_INTERNAL,
-                           "output mismatch: ret[%d] = %.1f, expected %.1f", i,
-                           ret0[i], expected[i]);
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "output mismatch: ret[%d] = %.1f, expected %.1f",
+                              i, ret0[i], expected[i]);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Loads the ELF by copying its segments out of |file_data|.
+static iree_status_t run_test_from_memory(iree_const_byte_span_t file_data) {
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_t module;
+  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
+      file_data, &import_table, iree_allocator_system(), &module));
+  iree_status_t status = run_module(&module);
+  iree_elf_module_deinitialize(&module);
+  return status;
+}
+
+#if defined(IREE_PLATFORM_LINUX)
+
+// Returns true if the page at |address| is a mapping of the file at |path|.
+static bool is_address_mapped_from_file(const void* address,
+                                        const char* path) {
+  FILE* maps_file = fopen("/proc/self/maps", "r");
+  if (!maps_file) return false;
+  bool found = false;
+  char line[4096];
+  while (fgets(line, sizeof(line), maps_file)) {
+    unsigned long start = 0, end = 0;
+    int path_offset = 0;
+    if (sscanf(line, "%lx-%lx %*s %*s %*s %*s %n", &start, &end,
+               &path_offset) < 2 ||
+        path_offset == 0) {
+      continue;
+    }
+    if ((uintptr_t)address < start || (uintptr_t)address >= end) continue;
+    line[strcspn(line, "\n")] = 0;
+    found = strcmp(line + path_offset, path) == 0;
+    break;
+  }
+  fclose(maps_file);
+  return found;
+}
+
+// Writes |file_data| to a temporary file, maps it, and loads the ELF from the
+// mapping such that the segments are mapped from the file instead of copied.
+static iree_status_t run_test_from_file(iree_const_byte_span_t file_data) {
+  const char* tmp_dir = getenv("TEST_TMPDIR");
+  if (!tmp_dir) tmp_dir = getenv("TMPDIR");
+  if (!tmp_dir) tmp_dir = "/tmp";
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/elf_module_test_XXXXXX", tmp_dir);
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "unable to create temporary file in %s", tmp_dir);
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (write(fd, file_data.data, file_data.data_length) !=
+      (ssize_t)file_data.data_length) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "unable to write temporary file");
+  }
+  void* mapping = MAP_FAILED;
+  if (iree_status_is_ok(status)) {
+    mapping =
+        mmap(NULL, file_data.data_length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "unable to map temporary file");
+    }
+  }
+  close(fd);
+
+  if (iree_status_is_ok(status)) {
+    iree_elf_import_table_t import_table;
+    memset(&import_table, 0, sizeof(import_table));
+    iree_elf_module_t module;
+    status = iree_elf_module_initialize_from_memory(
+        iree_make_const_byte_span(mapping, file_data.data_length),
+        &import_table, iree_allocator_system(), &module);
+    if (iree_status_is_ok(status)) {
+      // The first page holds the ELF header and program headers and is never
+      // shared with another segment so it is always mapped from the file.
+      if (!is_address_mapped_from_file(module.vaddr_base, path)) {
+        status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                  "module segments were not mapped from %s",
+                                  path);
+      }
+      if (iree_status_is_ok(status)) status = run_module(&module);
+      iree_elf_module_deinitialize(&module);
+    }
+  }
+
+  if (mapping != MAP_FAILED) munmap(mapping, file_data.data_length);
+  unlink(path);
+  return status;
+}
+
+#endif  // IREE_PLATFORM_LINUX
+
+#if defined(IREE_ARCH_X86_64) && !defined(IREE_PLATFORM_WINDOWS)
+
+// Host function provided to the unresolved_import module. Called directly from
+// the module code and as such must use the ELF calling convention.
+static int iree_elf_test_import(void* arg) { return *(int*)arg + 1; }
+
+// Loads a module that imports `iree_elf_test_import` and verifies that the
+// import fails the load when it is not in the import table and is linked to
+// the provided function when it is.
+static iree_status_t run_import_test() {
+  const struct iree_file_toc_t* file_toc = NULL;
+  for (size_t i = 0; i < unresolved_import_size(); ++i) {
+    if (iree_string_view_match_pattern(
+            iree_make_cstring_view(unresolved_import_create()[i].name),
+            iree_make_cstring_view("*_x86_64.so"))) {
+      file_toc = &unresolved_import_create()[i];
       break;
     }
   }
+  if (!file_toc) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "no unresolved_import ELF binary embedded");
+  }
+  iree_const_byte_span_t file_data =
+      iree_make_const_byte_span(file_toc->data, file_toc->size);
+
+  // Strong imports missing from the table must fail the load.
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_t module;
+  iree_status_t status = iree_elf_module_initialize_from_memory(
+      file_data, &import_table, iree_allocator_system(), &module);
+  if (iree_status_is_ok(status)) {
+    iree_elf_module_deinitialize(&module);
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "module with an unresolved import loaded");
+  } else if (!iree_status_is_not_found(status)) {
+    return iree_status_annotate(status,
+                                IREE_SV("expected NOT_FOUND for an unresolved "
+                                        "import"));
+  }
+  iree_status_ignore(status);
 
+  // Imports present in the table are linked directly.
+  const iree_elf_import_t imports[] = {
+      {"iree_elf_test_import", (void*)iree_elf_test_import},
+  };
+  import_table.import_count = IREE_ARRAYSIZE(imports);
+  import_table.imports = imports;
+  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
+      file_data, &import_table, iree_allocator_system(), &module));
+  void* call_import_fn_ptr = NULL;
+  status = iree_elf_module_lookup_export(&module, "iree_elf_test_call_import",
+                                         &call_import_fn_ptr);
+  if (iree_status_is_ok(status)) {
+    int arg = 41;
+    int ret = iree_elf_call_i_p(call_import_fn_ptr, &arg);
+    if (ret != 42) {
+      status = iree_make_status(IREE_STATUS_INTERNAL,
+                                "import returned %d, expected 42", ret);
+    }
+  }
   iree_elf_module_deinitialize(&module);
   return status;
 }
 
+#endif  // IREE_ARCH_X86_64 && !IREE_PLATFORM_WINDOWS
+
+#if defined(IREE_ARCH_X86_64)
+
+// Synthetic module image with a single 32-bit relocation target.
+typedef struct iree_elf_test_reloc_image_t {
+  uint32_t field;
+  uint32_t padding;
+  iree_elf_rela_t rela;
+} iree_elf_test_reloc_image_t;
+
+// Applies a single relocation of |type| in |image| against a symbol imported
+// from |sym_addr|.
+static iree_status_t apply_test_relocation(iree_elf_test_reloc_image_t* image,
+                                           uint32_t type,
+                                           iree_elf_addr_t sym_addr) {
+  memset(image, 0, sizeof(*image));
+  image->rela.r_offset = offsetof(iree_elf_test_reloc_image_t, field);
+  image->rela.r_info = ((iree_elf_addr_t)1 << 32) | type;
+  const iree_elf_dyn_t dyn_table[] = {
+      {IREE_ELF_DT_RELA, {offsetof(iree_elf_test_reloc_image_t, rela)}},
+      {IREE_ELF_DT_RELASZ, {sizeof(image->rela)}},
+  };
+  // Symbol 1 is undefined (imported); symbol 0 is the null placeholder.
+  iree_elf_sym_t syms[2];
+  memset(syms, 0, sizeof(syms));
+  const iree_elf_addr_t sym_addrs[2] = {0, sym_addr};
+  iree_elf_relocation_state_t state;
+  memset(&state, 0, sizeof(state));
+  state.vaddr_bias = (uint8_t*)image;
+  state.dyn_table_count = IREE_ARRAYSIZE(dyn_table);
+  state.dyn_table = dyn_table;
+  state.sym_count = IREE_ARRAYSIZE(sym_addrs);
+  state.sym_addrs = sym_addrs;
+  state.syms = syms;
+  return iree_elf_arch_apply_relocations(&state);
+}
+
+// Verifies that narrow relocations against imported symbols placed beyond the
+// 32-bit range of the relocation fail instead of silently truncating and that
+// copy relocations are rejected.
+static iree_status_t run_relocation_range_test() {
+  enum {
+    R_X86_64_PC32 = 2,
+    R_X86_64_COPY = 5,
+    R_X86_64_32 = 10,
+    R_X86_64_32S = 11,
+  };
+  iree_elf_test_reloc_image_t image;
+  const iree_elf_addr_t image_addr = (iree_elf_addr_t)&image;
+
+  // In range: the displacement is written.
+  IREE_RETURN_IF_ERROR(
+      apply_test_relocation(&image, R_X86_64_PC32, image_addr + 0x1000));
+  if (image.field != 0x1000) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "PC32 relocation wrote %08X, expected 00001000",
+                            image.field);
+  }
+
+  // Out of range (>2GB away from the image or beyond 32 bits).
+  const struct {
+    uint32_t type;
+    iree_elf_addr_t sym_addr;
+  } out_of_range_cases[] = {
+      {R_X86_64_PC32, image_addr + 0x100000000ull},
+      {R_X86_64_PC32, image_addr - 0x100000000ull},
+      {R_X86_64_32, 0x100000000ull},
+      {R_X86_64_32S, 0x80000000ull},
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_of_range_cases); ++i) {
+    iree_status_t status = apply_test_relocation(
+        &image, out_of_range_cases[i].type, out_of_range_cases[i].sym_addr);
+    if (!iree_status_is_out_of_range(status)) {
+      return iree_status_join(
+          iree_make_status(IREE_STATUS_INTERNAL,
+                           "relocation type %u case %zu: expected OUT_OF_RANGE",
+                           out_of_range_cases[i].type, i),
+          status);
+    }
+    iree_status_ignore(status);
+    if (image.field != 0) {
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "out of range relocation modified the image");
+    }
+  }
+
+  iree_status_t status =
+      apply_test_relocation(&image, R_X86_64_COPY, image_addr + 0x1000);
+  if (iree_status_is_ok(status)) {
+    return iree_make_status(IREE_STATUS_INTERNAL,
+                            "COPY relocation against an import applied");
+  }
+  iree_status_ignore(status);
+  return iree_ok_status();
+}
+
+#endif  // IREE_ARCH_X86_64
+
+static iree_status_t run_test() {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+  IREE_RETURN_IF_ERROR(run_test_from_memory(file_data), "loading from memory");
+#if defined(IREE_PLATFORM_LINUX)
+  IREE_RETURN_IF_ERROR(run_test_from_file(file_data), "loading from file");
+#endif  // IREE_PLATFORM_LINUX
+#if defined(IREE_ARCH_X86_64) && !defined(IREE_PLATFORM_WINDOWS)
+  IREE_RETURN_IF_ERROR(run_import_test(), "resolving imports");
+#endif  // IREE_ARCH_X86_64 && !IREE_PLATFORM_WINDOWS
+#if defined(IREE_ARCH_X86_64)
+  IREE_RETURN_IF_ERROR(run_relocation_range_test(), "relocation ranges");
+#endif  // IREE_ARCH_X86_64
+  return iree_ok_status();
+}
+
 int main() {
   const iree_status_t result = run_test();
   int ret = (int)iree_status_code(result);
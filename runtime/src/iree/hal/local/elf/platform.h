@@ -174,4 +174,47 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
 // executing code from any pages that have been written during load.
 void iree_memory_view_flush_icache(void* base_address, iree_host_size_t length);
 
+//==============================================================================
+// File-backed memory
+//==============================================================================
+
+// A file backing a range of host memory that can be mapped into views.
+typedef struct iree_memory_file_t {
+  // Platform file handle (an fd on POSIX systems).
+  intptr_t handle;
+  // Offset in the file of the first byte of the queried memory range.
+  uint64_t offset;
+} iree_memory_file_t;
+
+// Returns true if |length| bytes at |address| are a mapping of a regular file
+// that can itself be mapped into memory views with
+// iree_memory_view_map_file_range. Returns false if the memory is not
+// file-backed (heap allocations, etc) or the platform does not support file
+// mappings.
+//
+// Upon success |out_file| contains a new handle to the file that must be closed
+// with iree_memory_file_close. Mappings created from the file remain valid
+// after it has been closed.
+bool iree_memory_file_query(const void* address, iree_host_size_t length,
+                            iree_memory_file_t* out_file);
+
+// Closes a |file| opened by iree_memory_file_query.
+void iree_memory_file_close(iree_memory_file_t* file);
+
+// Maps the pages overlapping |range| of the view to the contents of |file|
+// starting at |file_offset|, which corresponds to the byte at |range.offset|.
+// The mapping is private: pages are shared with the file (and other processes
+// mapping it) until written, at which point they are copied.
+//
+// The offset of |range| within its first page must match that of |file_offset|
+// as pages can only be mapped whole. Bytes in the pages outside of |range| will
+// contain the neighboring file contents.
+//
+// Implemented by mmap+MAP_FIXED|MAP_PRIVATE.
+iree_status_t iree_memory_view_map_file_range(void* base_address,
+                                              iree_byte_range_t range,
+                                              const iree_memory_file_t* file,
+                                              uint64_t file_offset,
+                                              iree_memory_access_t access);
+
 #endif  // IREE_HAL_LOCAL_ELF_PLATFORM_H_
@@ -11,7 +11,13 @@
 #if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
 
 #include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <unistd.h>
 
 //==============================================================================
@@ -161,4 +167,154 @@ void iree_memory_view_flush_icache(void* base_address,
   IREE_ELF_CLEAR_CACHE(base_address, base_address + length);
 }
 
+//==============================================================================
+// File-backed memory
+//==============================================================================
+
+// Finds the /proc/self/maps entry containing [address, address+length) and
+// returns the path of the mapped file along with the identity of the file at
+// the time it was mapped. Returns false if the range is not entirely within a
+// single file mapping.
+static bool iree_memory_file_find_mapping(const void* address,
+                                          iree_host_size_t length,
+                                          char* out_path,
+                                          iree_host_size_t path_capacity,
+                                          uint64_t* out_offset, dev_t* out_dev,
+                                          ino_t* out_ino) {
+  FILE* maps_file = fopen("/proc/self/maps", "re");
+  if (!maps_file) return false;
+  const uintptr_t range_start = (uintptr_t)address;
+  const uintptr_t range_end = range_start + length;
+  bool found = false;
+  char line[PATH_MAX + 128];
+  while (fgets(line, sizeof(line), maps_file)) {
+    // Lines longer than our buffer are continued in the next read; skip the
+    // remainder as the path could not be opened anyway.
+    iree_host_size_t line_length = strlen(line);
+    bool is_truncated = line_length > 0 && line[line_length - 1] != '\n';
+    if (is_truncated) {
+      int c = 0;
+      do {
+        c = fgetc(maps_file);
+      } while (c != '\n' && c != EOF);
+      continue;
+    }
+    line[line_length - 1] = 0;
+
+    // Format: start-end perms offset major:minor inode path
+    uintptr_t start = 0, end = 0;
+    char perms[5] = {0};
+    uint64_t offset = 0;
+    unsigned int dev_major = 0, dev_minor = 0;
+    uint64_t inode = 0;
+    int path_start = 0;
+    if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4s %" SCNx64 " %x:%x %" SCNu64
+                     " %n",
+               &start, &end, perms, &offset, &dev_major, &dev_minor, &inode,
+               &path_start) < 7) {
+      continue;
+    }
+    if (range_start < start || range_start >= end) continue;
+
+    // Found the mapping containing the start of the range; it must contain the
+    // entire range and be a readable regular file.
+    if (range_end <= end && perms[0] == 'r' && inode != 0 && path_start > 0 &&
+        line[path_start] == '/') {
+      iree_host_size_t path_length = strlen(line + path_start);
+      if (path_length < path_capacity) {
+        memcpy(out_path, line + path_start, path_length + 1);
+        *out_offset = offset + (range_start - start);
+        *out_dev = makedev(dev_major, dev_minor);
+        *out_ino = (ino_t)inode;
+        found = true;
+      }
+    }
+    break;
+  }
+  fclose(maps_file);
+  return found;
+}
+
+bool iree_memory_file_query(const void* address, iree_host_size_t length,
+                            iree_memory_file_t* out_file) {
+  memset(out_file, 0, sizeof(*out_file));
+  out_file->handle = -1;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  char path[PATH_MAX];
+  uint64_t offset = 0;
+  dev_t dev = 0;
+  ino_t ino = 0;
+  if (!iree_memory_file_find_mapping(address, length, path, sizeof(path),
+                                     &offset, &dev, &ino)) {
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+
+  // Reopen the file and ensure it is the same one that was mapped; the path
+  // may have been replaced or deleted since.
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) ||
+      file_stat.st_dev != dev || file_stat.st_ino != ino ||
+      offset + length > (uint64_t)file_stat.st_size) {
+    close(fd);
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+
+  out_file->handle = fd;
+  out_file->offset = offset;
+  IREE_TRACE_ZONE_END(z0);
+  return true;
+}
+
+void iree_memory_file_close(iree_memory_file_t* file) {
+  if (file->handle >= 0) close((int)file->handle);
+  file->handle = -1;
+}
+
+iree_status_t iree_memory_view_map_file_range(void* base_address,
+                                              iree_byte_range_t range,
+                                              const iree_memory_file_t* file,
+                                              uint64_t file_offset,
+                                              iree_memory_access_t access) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t page_size = getpagesize();
+  if ((((uintptr_t)base_address + range.offset) & (page_size - 1)) !=
+      (file_offset & (page_size - 1))) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file offset %" PRIu64
+                            " is not congruent with the view range offset",
+                            file_offset);
+  }
+
+  void* range_start = NULL;
+  iree_host_size_t aligned_length = 0;
+  iree_page_align_range(base_address, range, page_size, &range_start,
+                        &aligned_length);
+  uint64_t aligned_file_offset =
+      file_offset -
+      ((uintptr_t)base_address + range.offset - (uintptr_t)range_start);
+
+  iree_status_t status = iree_ok_status();
+  void* result = mmap(range_start, aligned_length,
+                      iree_memory_access_to_prot(access),
+                      MAP_PRIVATE | MAP_FIXED, (int)file->handle,
+                      (off_t)aligned_file_offset);
+  if (result == MAP_FAILED) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "mmap of file range failed");
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 #endif  // IREE_PLATFORM_*
@@ -149,4 +149,25 @@ void iree_memory_view_flush_icache(void* base_address,
   FlushInstructionCache(GetCurrentProcess(), base_address, length);
 }
 
+//==============================================================================
+// File-backed memory
+//==============================================================================
+
+bool iree_memory_file_query(const void* address, iree_host_size_t length,
+                            iree_memory_file_t* out_file) {
+  memset(out_file, 0, sizeof(*out_file));
+  return false;
+}
+
+void iree_memory_file_close(iree_memory_file_t* file) {}
+
+iree_status_t iree_memory_view_map_file_range(void* base_address,
+                                              iree_byte_range_t range,
+                                              const iree_memory_file_t* file,
+                                              uint64_t file_offset,
+                                              iree_memory_access_t access) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "file mappings not supported on this platform");
+}
+
 #endif  // IREE_PLATFORM_WINDOWS
@@ -82,3 +82,18 @@ X86_64=(
   --iree-llvm-target-triple=x86_64-pc-linux-elf
 )
 compile_and_extract_library "elementwise_mul_x86_64.so" ${X86_64[@]}
+
+# The unresolved import module is plain C built with the host toolchain and is
+# only provided for x86_64.
+# $1: file name ("foo_x86_64.so")
+function compile_unresolved_import_library() {
+  local so_name=$1
+  echo "Updating ${TESTDATA}/${so_name}"
+  ${CC:-cc} \
+      -O2 -fPIC -shared -nostdlib -fno-asynchronous-unwind-tables \
+      -Wl,--hash-style=sysv -Wl,-z,now -Wl,-z,noseparate-code \
+      -Wl,--build-id=none -s \
+      "${TESTDATA}/unresolved_import_lib.c" \
+      -o "${TESTDATA}/${so_name}"
+}
+compile_unresolved_import_library "unresolved_import_x86_64.so"
@@ -0,0 +1,12 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// ELF module importing a symbol that the module does not define. Used to test
+// dynamic import resolution in the ELF loader; see generate.sh.
+
+extern int iree_elf_test_import(void* arg);
+
+int iree_elf_test_call_import(void* arg) { return iree_elf_test_import(arg); }
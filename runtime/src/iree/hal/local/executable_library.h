@@ -40,6 +40,10 @@
 // Defines a bitfield of features that the library requires or supports.
 enum iree_hal_executable_library_feature_bits_t {
   IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE = 0u,
+  // The library declares the optional trailing
+  // iree_hal_executable_library_v0_t::export_hints table. Libraries without
+  // this bit must not have the field read as it may not be present.
+  IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_DISPATCH_HINTS = 1u << 0,
   // TODO(benvanik): declare features for debugging/coverage/printf/etc.
   // These will control which symbols are injected into the library at runtime.
 };
@@ -345,7 +349,18 @@ typedef struct iree_hal_executable_workgroup_state_v0_t {
   // the requested amount.
   uint32_t local_memory_size;
 
-  // +4 trailing bytes of free space
+  // Total number of bytes available in |worker_scratch|. This may be larger
+  // than the requested amount.
+  uint32_t worker_scratch_size;
+  // Persistent scratch memory exclusive to the worker executing the workgroup.
+  // Requires a non-zero value to be specified for |worker_scratch_pages|.
+  // Unlike |local_memory| the contents are retained across workgroups and
+  // dispatches of the same export executed by the same worker and can be used
+  // to cache derived data such as packed weights or im2col buffers. The memory
+  // starts zeroed and the runtime may provide fresh zeroed memory at any
+  // workgroup boundary: functions must validate any cached contents (such as
+  // by storing a key derived from the binding pointers and push constants).
+  void* worker_scratch;
 } iree_hal_executable_workgroup_state_v0_t;
 static_assert(
     sizeof(iree_hal_executable_workgroup_state_v0_t) <= 64,
@@ -379,12 +394,30 @@ typedef struct iree_hal_executable_dispatch_attrs_v0_t {
   // indicating how much workgroup local memory is required for the dispatch.
   // This is the size of the buffer referenced by the `local_memory` argument.
   uint16_t local_memory_pages;
-  // Must be 0. May be used in the future for flags controlling the dispatch
-  // behavior/synchronization requirements.
-  uint16_t reserved;
+  // Number of IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE byte pages (or 0)
+  // indicating how much persistent per-worker scratch memory is required.
+  // This is the size of the buffer referenced by the `worker_scratch` argument.
+  uint16_t worker_scratch_pages;
 } iree_hal_executable_dispatch_attrs_v0_t;
 static_assert(sizeof(iree_hal_executable_dispatch_attrs_v0_t) == 4, "uint32_t");
 
+// Hints describing how an exported function accesses its bindings.
+// Bits are indexed by binding ordinal in the dense `binding_ptrs` order and
+// bindings with neither bit set have unknown access patterns. Hints are only
+// used for scheduling and cache management (such as prefetching the ranges
+// the next workgroup will access) and never affect correctness.
+typedef struct iree_hal_executable_dispatch_hints_v0_t {
+  // Bindings that are streamed: each workgroup accesses a distinct range
+  // roughly proportional to its linearized workgroup ID and the contents are
+  // not reused by other workgroups.
+  uint64_t streamed_bindings;
+  // Bindings that are reused by all workgroups (such as weights or lookup
+  // tables) and benefit from remaining cache-resident.
+  uint64_t reused_bindings;
+} iree_hal_executable_dispatch_hints_v0_t;
+static_assert(sizeof(iree_hal_executable_dispatch_hints_v0_t) == 16,
+              "2 x uint64_t");
+
 // Source location information for a dispatch function indicating what code was
 // used to generate it. This only represents a single source snapshot, of which
 // there may be multiple valid possibilities (source program in Python, imported
@@ -459,6 +492,12 @@ typedef struct iree_hal_executable_library_v0_t {
 
   // Table of executable-level constants.
   iree_hal_executable_constant_table_v0_t constants;
+
+  // Optional table of dispatch hints 1:1 with exports.ptrs.
+  // Only present if the header declares
+  // IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_DISPATCH_HINTS; older libraries end
+  // before this field.
+  const iree_hal_executable_dispatch_hints_v0_t* export_hints;
 } iree_hal_executable_library_v0_t;
 
 #endif  // IREE_HAL_LOCAL_EXECUTABLE_LIBRARY_H_
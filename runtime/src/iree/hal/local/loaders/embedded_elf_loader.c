@@ -10,12 +10,79 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
+#include "iree/builtins/ukernel/elementwise.h"
+#include "iree/builtins/ukernel/mmt4d.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/elf/elf_module.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/local_executable.h"
 
+//===----------------------------------------------------------------------===//
+// Runtime ELF symbol table
+//===----------------------------------------------------------------------===//
+
+// Symbols that ELF executables may import dynamically instead of embedding
+// their own copy. This is a separate namespace from the HAL executable import
+// table resolved by the loader import provider: these are raw C symbols linked
+// directly into the module code and called with the ELF calling convention.
+//
+// On Windows x86_64 the host functions use the Microsoft x64 convention and
+// cannot be called directly from System V code so no symbols are provided.
+#if !(defined(IREE_PLATFORM_WINDOWS) && defined(IREE_ARCH_X86_64))
+
+#define IREE_HAL_ELF_SYMBOL(name) \
+  { #name, (void*)name }
+
+static const iree_elf_import_t iree_hal_embedded_elf_symbols[] = {
+    // builtins/ukernel/mmt4d.h
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_mmt4d_f32f32f32),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_mmt4d_f32f32f32_memref),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_mmt4d_i8i8i32),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_mmt4d_i8i8i32_memref),
+    // builtins/ukernel/elementwise.h
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_addf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_addi_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_andi_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_divf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_divsi_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_divui_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_mulf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_muli_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_ori_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_shli_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_shrsi_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_shrui_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_subf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_subi_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32b_xori_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_absf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_ceilf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_ctlz_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_expf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_floorf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_logf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_negf_2d),
+    IREE_HAL_ELF_SYMBOL(iree_ukernel_x32u_rsqrtf_2d),
+};
+
+#undef IREE_HAL_ELF_SYMBOL
+
+static const iree_elf_import_table_t iree_hal_embedded_elf_import_table = {
+    .import_count = IREE_ARRAYSIZE(iree_hal_embedded_elf_symbols),
+    .imports = iree_hal_embedded_elf_symbols,
+};
+
+#else
+
+static const iree_elf_import_table_t iree_hal_embedded_elf_import_table = {
+    .import_count = 0,
+    .imports = NULL,
+};
+
+#endif  // !(IREE_PLATFORM_WINDOWS && IREE_ARCH_X86_64)
+
 //===----------------------------------------------------------------------===//
 // iree_hal_elf_executable_t
 //===----------------------------------------------------------------------===//
@@ -80,8 +147,6 @@ static iree_status_t iree_hal_elf_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
 
-  executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-
   return iree_ok_status();
 }
 
@@ -127,7 +192,8 @@ static iree_status_t iree_hal_elf_executable_resolve_imports(
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_host_size_t worker_capacity, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -169,15 +235,21 @@ static iree_status_t iree_hal_elf_executable_create(
     }
   }
   if (iree_status_is_ok(status)) {
-    // Attempt to load the ELF module.
+    // Attempt to load the ELF module. Dynamic symbol imports are resolved
+    // against the runtime ELF symbol table and not the import provider.
     status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
+        executable_params->executable_data,
+        &iree_hal_embedded_elf_import_table, host_allocator,
+        &executable->module);
   }
   if (iree_status_is_ok(status)) {
     // Query metadata and get the entry point function pointers.
     status = iree_hal_elf_executable_query_library(executable);
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_initialize_library(
+        &executable->base, executable->library.v0, worker_capacity);
+  }
   if (iree_status_is_ok(status)) {
     // Resolve imports, if any.
     status =
@@ -378,7 +450,7 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
       executable_params, base_executable_loader->import_provider,
-      executable_loader->host_allocator, out_executable);
+      worker_capacity, executable_loader->host_allocator, out_executable);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
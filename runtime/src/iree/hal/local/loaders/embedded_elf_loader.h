@@ -21,6 +21,11 @@ extern "C" {
 // libraries on any platform. This allows us to use a single file format across
 // all operating systems at the cost of some missing debugging/profiling
 // features.
+//
+// |import_provider| resolves the executable library import table. Dynamic
+// symbols imported by the ELF itself are resolved against a fixed table of
+// runtime builtins (the iree/builtins/ukernel/ mmt4d and elementwise kernels)
+// and any other undefined strong symbol fails the load with NOT_FOUND.
 iree_status_t iree_hal_embedded_elf_loader_create(
     iree_hal_executable_import_provider_t import_provider,
     iree_allocator_t host_allocator,
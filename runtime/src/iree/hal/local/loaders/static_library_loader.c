@@ -9,8 +9,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 
+#include "iree/base/internal/atomics.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_environment.h"
@@ -41,7 +43,8 @@ static iree_status_t iree_hal_static_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_library_header_t** library_header,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_host_size_t worker_capacity, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(!executable_params->pipeline_layout_count ||
                        executable_params->pipeline_layouts);
@@ -67,7 +70,6 @@ static iree_status_t iree_hal_static_executable_create(
         host_allocator, &executable->base);
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
-    executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
 
     // Copy executable constants so we own them.
     if (executable_params->constant_count > 0) {
@@ -82,6 +84,11 @@ static iree_status_t iree_hal_static_executable_create(
     }
   }
 
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_initialize_library(
+        &executable->base, executable->library.v0, worker_capacity);
+  }
+
   if (iree_status_is_ok(status)) {
     if (executable->library.v0->imports.count > 0) {
       status =
@@ -186,16 +193,107 @@ static const iree_hal_local_executable_vtable_t
 // iree_hal_static_library_loader_t
 //===----------------------------------------------------------------------===//
 
+// A registered library and its lazily queried header.
+typedef struct iree_hal_static_library_slot_t {
+  iree_hal_static_library_registry_entry_t entry;
+  // Library header pointer as returned by the entry query function or 0 if
+  // the library has not yet been queried.
+  iree_atomic_intptr_t header;
+} iree_hal_static_library_slot_t;
+
 typedef struct iree_hal_static_library_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
   iree_host_size_t library_count;
-  const iree_hal_executable_library_header_t** const libraries[];
+  // Libraries sorted by name for binary search.
+  iree_hal_static_library_slot_t libraries[];
 } iree_hal_static_library_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_static_library_loader_vtable;
 
+// Allocates a loader with storage for |library_count| libraries.
+static iree_status_t iree_hal_static_library_loader_allocate(
+    iree_host_size_t library_count,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_static_library_loader_t** out_executable_loader) {
+  iree_hal_static_library_loader_t* executable_loader = NULL;
+  iree_host_size_t total_size =
+      sizeof(*executable_loader) +
+      sizeof(executable_loader->libraries[0]) * library_count;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(host_allocator, total_size,
+                                             (void**)&executable_loader));
+  iree_hal_executable_loader_initialize(&iree_hal_static_library_loader_vtable,
+                                        import_provider,
+                                        &executable_loader->base);
+  executable_loader->host_allocator = host_allocator;
+  executable_loader->library_count = library_count;
+  *out_executable_loader = executable_loader;
+  return iree_ok_status();
+}
+
+static int iree_hal_static_library_slot_compare(const void* lhs,
+                                                const void* rhs) {
+  return strcmp(((const iree_hal_static_library_slot_t*)lhs)->entry.name,
+                ((const iree_hal_static_library_slot_t*)rhs)->entry.name);
+}
+
+// Sorts the libraries of |executable_loader| by name and verifies there are no
+// duplicates. Must be called prior to the loader being published.
+static iree_status_t iree_hal_static_library_loader_sort_libraries(
+    iree_hal_static_library_loader_t* executable_loader) {
+  iree_hal_static_library_slot_t* libraries = executable_loader->libraries;
+  iree_host_size_t library_count = executable_loader->library_count;
+  qsort(libraries, library_count, sizeof(libraries[0]),
+        iree_hal_static_library_slot_compare);
+  for (iree_host_size_t i = 1; i < library_count; ++i) {
+    if (strcmp(libraries[i - 1].entry.name, libraries[i].entry.name) == 0) {
+      return iree_make_status(IREE_STATUS_ALREADY_EXISTS,
+                              "static library '%s' registered multiple times",
+                              libraries[i].entry.name);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Queries the library header using |query_fn| and verifies it is compatible
+// with the runtime.
+static iree_status_t iree_hal_static_library_query(
+    iree_hal_executable_library_query_fn_t query_fn,
+    iree_allocator_t host_allocator,
+    const iree_hal_executable_library_header_t*** out_header_ptr) {
+  *out_header_ptr = NULL;
+
+  // Default environment to enable initialization.
+  iree_hal_executable_environment_v0_t environment;
+  iree_hal_executable_environment_initialize(host_allocator, &environment);
+
+  // Query and verify the library matches our expected version.
+  // It's rare it won't, however static libraries generated with a newer
+  // version of the IREE compiler that are then linked with an older version
+  // of the runtime are difficult to spot otherwise.
+  const iree_hal_executable_library_header_t** header_ptr =
+      (const iree_hal_executable_library_header_t**)query_fn(
+          IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST, &environment);
+  if (!header_ptr) {
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "failed to query library header for runtime version %d",
+        IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+  }
+  const iree_hal_executable_library_header_t* header = *header_ptr;
+  if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "executable does not support this version of the "
+        "runtime (executable: %d, runtime: %d)",
+        header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
+  }
+  *out_header_ptr = header_ptr;
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_static_library_loader_create(
     iree_host_size_t library_count,
     const iree_hal_executable_library_query_fn_t* library_query_fns,
@@ -208,50 +306,28 @@ iree_status_t iree_hal_static_library_loader_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_static_library_loader_t* executable_loader = NULL;
-  iree_host_size_t total_size =
-      sizeof(*executable_loader) +
-      sizeof(executable_loader->libraries[0]) * library_count;
-  iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
-                                               (void**)&executable_loader);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_static_library_loader_allocate(
+              library_count, import_provider, host_allocator,
+              &executable_loader));
+
+  // Eagerly query all libraries as we need their names to perform lookups.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < library_count; ++i) {
+    const iree_hal_executable_library_header_t** header_ptr = NULL;
+    status = iree_hal_static_library_query(library_query_fns[i],
+                                           host_allocator, &header_ptr);
+    if (!iree_status_is_ok(status)) break;
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, (*header_ptr)->name);
+    iree_hal_static_library_slot_t* library = &executable_loader->libraries[i];
+    library->entry.name = (*header_ptr)->name;
+    library->entry.query_fn = library_query_fns[i];
+    iree_atomic_store_intptr(&library->header, (intptr_t)header_ptr,
+                             iree_memory_order_relaxed);
+  }
+
   if (iree_status_is_ok(status)) {
-    iree_hal_executable_loader_initialize(
-        &iree_hal_static_library_loader_vtable, import_provider,
-        &executable_loader->base);
-    executable_loader->host_allocator = host_allocator;
-    executable_loader->library_count = library_count;
-
-    // Default environment to enable initialization.
-    iree_hal_executable_environment_v0_t environment;
-    iree_hal_executable_environment_initialize(host_allocator, &environment);
-
-    // Query and verify the libraries provided all match our expected version.
-    // It's rare they won't, however static libraries generated with a newer
-    // version of the IREE compiler that are then linked with an older version
-    // of the runtime are difficult to spot otherwise.
-    for (iree_host_size_t i = 0; i < library_count; ++i) {
-      const iree_hal_executable_library_header_t* const* header_ptr =
-          library_query_fns[i](IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST,
-                               &environment);
-      if (!header_ptr) {
-        status = iree_make_status(
-            IREE_STATUS_UNAVAILABLE,
-            "failed to query library header for runtime version %d",
-            IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
-        break;
-      }
-      const iree_hal_executable_library_header_t* header = *header_ptr;
-      IREE_TRACE_ZONE_APPEND_TEXT(z0, header->name);
-      if (header->version > IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST) {
-        status = iree_make_status(
-            IREE_STATUS_FAILED_PRECONDITION,
-            "executable does not support this version of the "
-            "runtime (executable: %d, runtime: %d)",
-            header->version, IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST);
-        break;
-      }
-      memcpy((void*)&executable_loader->libraries[i], &header_ptr,
-             sizeof(header_ptr));
-    }
+    status = iree_hal_static_library_loader_sort_libraries(executable_loader);
   }
 
   if (iree_status_is_ok(status)) {
@@ -264,6 +340,43 @@ iree_status_t iree_hal_static_library_loader_create(
   return status;
 }
 
+iree_status_t iree_hal_static_library_loader_create_from_registry(
+    iree_host_size_t entry_count,
+    const iree_hal_static_library_registry_entry_t* entries,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
+  IREE_ASSERT_ARGUMENT(!entry_count || entries);
+  IREE_ASSERT_ARGUMENT(out_executable_loader);
+  *out_executable_loader = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, entry_count);
+
+  iree_hal_static_library_loader_t* executable_loader = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_static_library_loader_allocate(entry_count, import_provider,
+                                              host_allocator,
+                                              &executable_loader));
+  for (iree_host_size_t i = 0; i < entry_count; ++i) {
+    iree_hal_static_library_slot_t* library = &executable_loader->libraries[i];
+    library->entry = entries[i];
+    iree_atomic_store_intptr(&library->header, 0, iree_memory_order_relaxed);
+  }
+
+  iree_status_t status =
+      iree_hal_static_library_loader_sort_libraries(executable_loader);
+
+  if (iree_status_is_ok(status)) {
+    *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
+  } else {
+    iree_allocator_free(host_allocator, executable_loader);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static void iree_hal_static_library_loader_destroy(
     iree_hal_executable_loader_t* base_executable_loader) {
   iree_hal_static_library_loader_t* executable_loader =
@@ -284,6 +397,45 @@ static bool iree_hal_static_library_loader_query_support(
                                 iree_make_cstring_view("static"));
 }
 
+// Returns the library header for the entry at |index|, querying the library
+// if this is the first time it has been used. Concurrent first uses may both
+// query the library; queries are idempotent and return the same header.
+static iree_status_t iree_hal_static_library_loader_resolve(
+    iree_hal_static_library_loader_t* executable_loader, iree_host_size_t index,
+    const iree_hal_executable_library_header_t*** out_header_ptr) {
+  iree_hal_static_library_slot_t* library =
+      &executable_loader->libraries[index];
+  intptr_t cached_header =
+      iree_atomic_load_intptr(&library->header, iree_memory_order_acquire);
+  if (IREE_LIKELY(cached_header)) {
+    *out_header_ptr =
+        (const iree_hal_executable_library_header_t**)cached_header;
+    return iree_ok_status();
+  }
+
+  const iree_hal_static_library_registry_entry_t* entry = &library->entry;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, entry->name);
+
+  const iree_hal_executable_library_header_t** header_ptr = NULL;
+  iree_status_t status = iree_hal_static_library_query(
+      entry->query_fn, executable_loader->host_allocator, &header_ptr);
+  if (iree_status_is_ok(status) && strcmp((*header_ptr)->name, entry->name)) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "static library registered as '%s' declares "
+                              "the name '%s'",
+                              entry->name, (*header_ptr)->name);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_atomic_store_intptr(&library->header, (intptr_t)header_ptr,
+                             iree_memory_order_release);
+    *out_header_ptr = header_ptr;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_static_library_loader_try_load(
     iree_hal_executable_loader_t* base_executable_loader,
     const iree_hal_executable_params_t* executable_params,
@@ -296,20 +448,26 @@ static iree_status_t iree_hal_static_library_loader_try_load(
       (const char*)executable_params->executable_data.data,
       executable_params->executable_data.data_length);
 
-  // Linear scan of the registered libraries; there's usually only one per
-  // module (aka source model) and as such it's a small list and probably not
-  // worth optimizing. We could sort the libraries list by name on loader
-  // creation to perform a binary-search fairly easily, though, at the cost of
-  // the additional code size.
-  for (iree_host_size_t i = 0; i < executable_loader->library_count; ++i) {
-    const iree_hal_executable_library_header_t* header =
-        *executable_loader->libraries[i];
-    if (iree_string_view_equal(library_name,
-                               iree_make_cstring_view(header->name))) {
+  // Binary search of the registered libraries sorted by name.
+  iree_host_size_t low = 0;
+  iree_host_size_t high = executable_loader->library_count;
+  while (low < high) {
+    iree_host_size_t mid = low + (high - low) / 2;
+    int cmp = iree_string_view_compare(
+        library_name,
+        iree_make_cstring_view(executable_loader->libraries[mid].entry.name));
+    if (cmp == 0) {
+      const iree_hal_executable_library_header_t** header_ptr = NULL;
+      IREE_RETURN_IF_ERROR(iree_hal_static_library_loader_resolve(
+          executable_loader, mid, &header_ptr));
       return iree_hal_static_executable_create(
-          executable_params, executable_loader->libraries[i],
-          base_executable_loader->import_provider,
+          executable_params, header_ptr,
+          base_executable_loader->import_provider, worker_capacity,
           executable_loader->host_allocator, out_executable);
+    } else if (cmp < 0) {
+      high = mid;
+    } else {
+      low = mid + 1;
     }
   }
   return iree_make_status(IREE_STATUS_NOT_FOUND,
@@ -30,9 +30,11 @@ extern "C" {
 // iree_hal_executable_params_t used to reference the executables will contain
 // the library name and be used to lookup the library in the list.
 //
-// Multiple static library loaders can be registered in cases when several
-// independent sets of libraries are linked in however duplicate names both
-// within and across loaders will result in undefined behavior.
+// All libraries are queried during creation. Libraries declaring the same name
+// are rejected with IREE_STATUS_ALREADY_EXISTS. Multiple static library loaders
+// can be registered in cases when several independent sets of libraries are
+// linked in however duplicate names across loaders will result in undefined
+// behavior.
 iree_status_t iree_hal_static_library_loader_create(
     iree_host_size_t library_count,
     const iree_hal_executable_library_query_fn_t* library_query_fns,
@@ -40,6 +42,33 @@ iree_status_t iree_hal_static_library_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// A named static library that can be queried on demand.
+// The compiler emits a matching IREE_STATIC_LIBRARY_*_REGISTRY_ENTRY macro in
+// the header it generates for each static library.
+typedef struct iree_hal_static_library_registry_entry_t {
+  // Library name as embedded in the executable binary by the compiler. Must
+  // match the name declared in the library header exactly.
+  const char* name;
+  // Function used to query the library the first time it is loaded.
+  iree_hal_executable_library_query_fn_t query_fn;
+} iree_hal_static_library_registry_entry_t;
+
+// Creates a library loader that lazily exposes the provided named libraries to
+// the HAL for use as executables.
+//
+// Unlike iree_hal_static_library_loader_create no library is queried during
+// creation: each library is queried, initialized, and version checked the
+// first time an executable referencing it is loaded. Lookups are performed by
+// binary search over the names so programs statically linking many libraries
+// only pay for the ones they use. |entries| may be in any order and are copied
+// into the loader; duplicate names are rejected.
+iree_status_t iree_hal_static_library_loader_create_from_registry(
+    iree_host_size_t entry_count,
+    const iree_hal_static_library_registry_entry_t* entries,
+    iree_hal_executable_import_provider_t import_provider,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,176 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/loaders/static_library_loader.h"
+
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// A library without exports that counts how many times it was queried.
+struct TestLibrary {
+  iree_hal_executable_library_header_t header;
+  iree_hal_executable_library_v0_t library;
+  int query_count;
+};
+static TestLibrary test_libraries[3];
+static const char* kTestLibraryNames[3] = {"library_a", "library_b",
+                                           "library_c"};
+
+template <int kIndex>
+static const iree_hal_executable_library_header_t** QueryTestLibrary(
+    iree_hal_executable_library_version_t max_version,
+    const iree_hal_executable_environment_v0_t* environment) {
+  TestLibrary& library = test_libraries[kIndex];
+  ++library.query_count;
+  return (const iree_hal_executable_library_header_t**)&library.library;
+}
+
+class StaticLibraryLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(test_libraries); ++i) {
+      TestLibrary& library = test_libraries[i];
+      memset(&library, 0, sizeof(library));
+      library.header.version = IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST;
+      library.header.name = kTestLibraryNames[i];
+      library.header.features = IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE;
+      library.header.sanitizer = IREE_HAL_EXECUTABLE_LIBRARY_SANITIZER_NONE;
+      library.library.header = &library.header;
+    }
+  }
+
+  void TearDown() override { iree_hal_executable_loader_release(loader_); }
+
+  // Loads the static library |name| from |loader_| and releases it.
+  iree_status_t Load(const char* name) {
+    iree_hal_executable_params_t params;
+    iree_hal_executable_params_initialize(&params);
+    params.executable_format = iree_make_cstring_view("static");
+    params.executable_data =
+        iree_make_const_byte_span((const uint8_t*)name, strlen(name));
+    iree_hal_executable_t* executable = NULL;
+    IREE_RETURN_IF_ERROR(iree_hal_executable_loader_try_load(
+        loader_, &params, /*worker_capacity=*/0, &executable));
+    iree_hal_executable_release(executable);
+    return iree_ok_status();
+  }
+
+  iree_hal_executable_loader_t* loader_ = NULL;
+};
+
+TEST_F(StaticLibraryLoaderTest, EagerQueryByName) {
+  const iree_hal_executable_library_query_fn_t query_fns[] = {
+      QueryTestLibrary<2>,
+      QueryTestLibrary<0>,
+      QueryTestLibrary<1>,
+  };
+  IREE_ASSERT_OK(iree_hal_static_library_loader_create(
+      IREE_ARRAYSIZE(query_fns), query_fns,
+      iree_hal_executable_import_provider_null(), iree_allocator_system(),
+      &loader_));
+  for (auto& library : test_libraries) EXPECT_EQ(1, library.query_count);
+  for (const char* name : kTestLibraryNames) IREE_EXPECT_OK(Load(name));
+  for (auto& library : test_libraries) EXPECT_EQ(1, library.query_count);
+}
+
+TEST_F(StaticLibraryLoaderTest, EagerDuplicateNames) {
+  const iree_hal_executable_library_query_fn_t query_fns[] = {
+      QueryTestLibrary<0>,
+      QueryTestLibrary<1>,
+      QueryTestLibrary<0>,
+  };
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_ALREADY_EXISTS,
+                        iree_hal_static_library_loader_create(
+                            IREE_ARRAYSIZE(query_fns), query_fns,
+                            iree_hal_executable_import_provider_null(),
+                            iree_allocator_system(), &loader_));
+  EXPECT_EQ(NULL, loader_);
+}
+
+TEST_F(StaticLibraryLoaderTest, RegistryUnsortedEntries) {
+  // Entries are given out of order and must be sorted for the lookups.
+  const iree_hal_static_library_registry_entry_t entries[] = {
+      {"library_c", QueryTestLibrary<2>},
+      {"library_a", QueryTestLibrary<0>},
+      {"library_b", QueryTestLibrary<1>},
+  };
+  IREE_ASSERT_OK(iree_hal_static_library_loader_create_from_registry(
+      IREE_ARRAYSIZE(entries), entries,
+      iree_hal_executable_import_provider_null(), iree_allocator_system(),
+      &loader_));
+  for (const char* name : kTestLibraryNames) IREE_EXPECT_OK(Load(name));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, Load("library_0"));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, Load("library_bb"));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, Load("library_z"));
+}
+
+TEST_F(StaticLibraryLoaderTest, RegistryDuplicateNames) {
+  const iree_hal_static_library_registry_entry_t entries[] = {
+      {"library_b", QueryTestLibrary<1>},
+      {"library_a", QueryTestLibrary<0>},
+      {"library_b", QueryTestLibrary<1>},
+  };
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_ALREADY_EXISTS,
+                        iree_hal_static_library_loader_create_from_registry(
+                            IREE_ARRAYSIZE(entries), entries,
+                            iree_hal_executable_import_provider_null(),
+                            iree_allocator_system(), &loader_));
+  EXPECT_EQ(NULL, loader_);
+}
+
+TEST_F(StaticLibraryLoaderTest, RegistryLazyQuery) {
+  const iree_hal_static_library_registry_entry_t entries[] = {
+      {"library_a", QueryTestLibrary<0>},
+      {"library_b", QueryTestLibrary<1>},
+      {"library_c", QueryTestLibrary<2>},
+  };
+  IREE_ASSERT_OK(iree_hal_static_library_loader_create_from_registry(
+      IREE_ARRAYSIZE(entries), entries,
+      iree_hal_executable_import_provider_null(), iree_allocator_system(),
+      &loader_));
+  for (auto& library : test_libraries) EXPECT_EQ(0, library.query_count);
+
+  // Only the loaded library is queried and only the first time it is used.
+  IREE_ASSERT_OK(Load("library_b"));
+  EXPECT_EQ(0, test_libraries[0].query_count);
+  EXPECT_EQ(1, test_libraries[1].query_count);
+  EXPECT_EQ(0, test_libraries[2].query_count);
+  IREE_ASSERT_OK(Load("library_b"));
+  EXPECT_EQ(1, test_libraries[1].query_count);
+
+  // Unknown names never query anything.
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, Load("library_d"));
+  EXPECT_EQ(0, test_libraries[0].query_count);
+  EXPECT_EQ(0, test_libraries[2].query_count);
+}
+
+TEST_F(StaticLibraryLoaderTest, RegistryNameMismatch) {
+  // The entry name does not match the name declared by the library header.
+  const iree_hal_static_library_registry_entry_t entries[] = {
+      {"library_x", QueryTestLibrary<0>},
+  };
+  IREE_ASSERT_OK(iree_hal_static_library_loader_create_from_registry(
+      IREE_ARRAYSIZE(entries), entries,
+      iree_hal_executable_import_provider_null(), iree_allocator_system(),
+      &loader_));
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_FAILED_PRECONDITION, Load("library_x"));
+  // The failed query is not cached and the library is queried again.
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_FAILED_PRECONDITION, Load("library_x"));
+  EXPECT_EQ(2, test_libraries[0].query_count);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_NOT_FOUND, Load("library_a"));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -200,8 +200,6 @@ static iree_status_t iree_hal_system_executable_query_library(
 
   executable->identifier = iree_make_cstring_view(header->name);
 
-  executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
-
   return iree_ok_status();
 }
 
@@ -251,7 +249,8 @@ static iree_status_t iree_hal_system_executable_resolve_imports(
 static iree_status_t iree_hal_system_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_host_size_t worker_capacity, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -298,6 +297,10 @@ static iree_status_t iree_hal_system_executable_create(
     // Query metadata and get the entry point function pointers.
     status = iree_hal_system_executable_query_library(executable);
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_initialize_library(
+        &executable->base, executable->library.v0, worker_capacity);
+  }
   if (iree_status_is_ok(status)) {
     // Resolve imports, if any.
     status =
@@ -509,7 +512,8 @@ static iree_status_t iree_hal_system_library_loader_try_load(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_system_executable_create(
               executable_params, base_executable_loader->import_provider,
-              executable_loader->host_allocator, out_executable));
+              worker_capacity, executable_loader->host_allocator,
+              out_executable));
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
@@ -28,14 +28,93 @@ void iree_hal_local_executable_initialize(
 
   // Function attributes are optional and populated by the parent type.
   out_base_executable->dispatch_attrs = NULL;
+  out_base_executable->dispatch_hints = NULL;
+  out_base_executable->worker_capacity = 0;
+  out_base_executable->entry_point_count = 0;
+  out_base_executable->worker_scratch = NULL;
 
   // Default environment with no imports assigned.
   iree_hal_executable_environment_initialize(host_allocator,
                                              &out_base_executable->environment);
 }
 
+// Returns the number of bytes of worker scratch memory required by the entry
+// point |ordinal|.
+static iree_host_size_t iree_hal_local_executable_worker_scratch_size(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal) {
+  if (!executable->dispatch_attrs) return 0;
+  return (iree_host_size_t)executable->dispatch_attrs[ordinal]
+             .worker_scratch_pages *
+         IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE;
+}
+
+iree_status_t iree_hal_local_executable_initialize_library(
+    iree_hal_local_executable_t* executable,
+    const iree_hal_executable_library_v0_t* library,
+    iree_host_size_t worker_capacity) {
+  executable->dispatch_attrs = library->exports.attrs;
+  if (iree_all_bits_set(library->header->features,
+                        IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_DISPATCH_HINTS)) {
+    executable->dispatch_hints = library->export_hints;
+  }
+
+  // Only allocate the worker scratch table if any entry point needs it.
+  bool any_worker_scratch = false;
+  for (uint32_t i = 0; i < library->exports.count; ++i) {
+    if (iree_hal_local_executable_worker_scratch_size(executable, i) > 0) {
+      any_worker_scratch = true;
+      break;
+    }
+  }
+  if (!any_worker_scratch || !worker_capacity) return iree_ok_status();
+
+  void** worker_scratch = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      executable->host_allocator,
+      worker_capacity * library->exports.count * sizeof(*worker_scratch),
+      (void**)&worker_scratch));
+  executable->worker_capacity = worker_capacity;
+  executable->entry_point_count = library->exports.count;
+  executable->worker_scratch = worker_scratch;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_local_executable_acquire_worker_scratch(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    uint32_t worker_id, iree_byte_span_t* out_worker_scratch) {
+  *out_worker_scratch = iree_make_byte_span(NULL, 0);
+  iree_host_size_t size =
+      iree_hal_local_executable_worker_scratch_size(executable, ordinal);
+  if (!size) return iree_ok_status();
+  if (IREE_UNLIKELY(worker_id >= executable->worker_capacity)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "worker_id out of bounds (%u >= %zu)", worker_id,
+                            executable->worker_capacity);
+  }
+  void** slot =
+      &executable->worker_scratch[worker_id * executable->entry_point_count +
+                                  ordinal];
+  if (IREE_UNLIKELY(!*slot)) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc_aligned(
+        executable->host_allocator, size,
+        IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE, 0, slot));
+  }
+  *out_worker_scratch = iree_make_byte_span(*slot, size);
+  return iree_ok_status();
+}
+
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable) {
+  if (base_executable->worker_scratch) {
+    iree_host_size_t slot_count = base_executable->worker_capacity *
+                                  base_executable->entry_point_count;
+    for (iree_host_size_t i = 0; i < slot_count; ++i) {
+      iree_allocator_free_aligned(base_executable->host_allocator,
+                                  base_executable->worker_scratch[i]);
+    }
+    iree_allocator_free(base_executable->host_allocator,
+                        base_executable->worker_scratch);
+  }
   for (iree_host_size_t i = 0; i < base_executable->pipeline_layout_count;
        ++i) {
     iree_hal_pipeline_layout_release(base_executable->pipeline_layouts[i]);
@@ -80,6 +159,20 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
   IREE_TRACE_ZONE_APPEND_TEXT_STRING_VIEW(z0, xyz_string, xyz_string_length);
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
+  // Inline dispatches have no persistent workers (and may be issued from
+  // multiple threads concurrently) so any worker scratch memory only lives for
+  // the duration of the dispatch.
+  iree_byte_span_t worker_scratch = iree_make_byte_span(NULL, 0);
+  iree_host_size_t worker_scratch_size =
+      iree_hal_local_executable_worker_scratch_size(executable, ordinal);
+  if (worker_scratch_size > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(executable->host_allocator,
+                                  worker_scratch_size,
+                                  (void**)&worker_scratch.data));
+    worker_scratch.data_length = worker_scratch_size;
+  }
+
   iree_status_t status = iree_ok_status();
 
   iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
@@ -89,6 +182,8 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
       .processor_id = processor_id,
       .local_memory = local_memory.data,
       .local_memory_size = (size_t)local_memory.data_length,
+      .worker_scratch_size = (uint32_t)worker_scratch.data_length,
+      .worker_scratch = worker_scratch.data,
   };
   for (uint32_t z = 0; z < workgroup_count_z; ++z) {
     workgroup_state.workgroup_id_z = z;
@@ -104,6 +199,7 @@ iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     }
   }
 
+  iree_allocator_free(executable->host_allocator, worker_scratch.data);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -35,6 +35,18 @@ typedef struct iree_hal_local_executable_t {
   // of memory required by the function.
   const iree_hal_executable_dispatch_attrs_v0_t* dispatch_attrs;
 
+  // Optional per-entry point binding access hints. NULL if the library does
+  // not declare any in which case all access patterns are unknown.
+  const iree_hal_executable_dispatch_hints_v0_t* dispatch_hints;
+
+  // Persistent per-worker scratch memory for entry points declaring
+  // |worker_scratch_pages|. Indexed by [worker_id * entry_point_count +
+  // ordinal] and lazily allocated by the worker on first use. NULL if no entry
+  // point requires worker scratch memory.
+  iree_host_size_t worker_capacity;
+  iree_host_size_t entry_point_count;
+  void** worker_scratch;
+
   // Execution environment.
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
@@ -61,12 +73,59 @@ void iree_hal_local_executable_initialize(
     iree_allocator_t host_allocator,
     iree_hal_local_executable_t* out_base_executable);
 
+// Sets the dispatch attributes and hints from the given |library| and prepares
+// per-worker scratch storage for up to |worker_capacity| workers. Must be
+// called by the parent type before the executable is used.
+iree_status_t iree_hal_local_executable_initialize_library(
+    iree_hal_local_executable_t* executable,
+    const iree_hal_executable_library_v0_t* library,
+    iree_host_size_t worker_capacity);
+
 void iree_hal_local_executable_deinitialize(
     iree_hal_local_executable_t* base_executable);
 
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Returns the binding access hints for the entry point |ordinal|.
+// Returns all-zero (unknown) hints if the library declares none.
+static inline iree_hal_executable_dispatch_hints_v0_t
+iree_hal_local_executable_dispatch_hints(iree_hal_local_executable_t* executable,
+                                         iree_host_size_t ordinal) {
+  iree_hal_executable_dispatch_hints_v0_t hints = {0, 0};
+  if (executable->dispatch_hints) hints = executable->dispatch_hints[ordinal];
+  return hints;
+}
+
+// Estimates the range of a streamed binding of |binding_length| bytes that
+// workgroup |workgroup_id| of |workgroup_total| will access, limited to at most
+// |budget| bytes. Each workgroup is assumed to access an equal contiguous slice
+// (rounded up) and the range is clamped to the end of the binding.
+// Returns the length of the range starting at |out_offset| or 0 if the
+// workgroup is estimated to access nothing.
+static inline iree_host_size_t iree_hal_local_executable_streamed_range(
+    iree_host_size_t binding_length, uint64_t workgroup_total,
+    uint64_t workgroup_id, iree_host_size_t budget,
+    iree_host_size_t* out_offset) {
+  *out_offset = 0;
+  if (workgroup_id >= workgroup_total) return 0;
+  const uint64_t stride =
+      ((uint64_t)binding_length + workgroup_total - 1) / workgroup_total;
+  const uint64_t offset = workgroup_id * stride;
+  if (offset >= binding_length) return 0;
+  *out_offset = (iree_host_size_t)offset;
+  return (iree_host_size_t)iree_min(
+      iree_min(stride, (uint64_t)budget), (uint64_t)binding_length - offset);
+}
+
+// Returns the persistent scratch memory for |worker_id| when executing the
+// entry point |ordinal|, allocating it on first use. Only the worker itself
+// may call this with its own |worker_id|. Returns an empty span if the entry
+// point does not require worker scratch memory.
+iree_status_t iree_hal_local_executable_acquire_worker_scratch(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    uint32_t worker_id, iree_byte_span_t* out_worker_scratch);
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -8,14 +8,144 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <string.h>
 
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_pipeline_layout.h"
+
+//===----------------------------------------------------------------------===//
+// Executable keys
+//===----------------------------------------------------------------------===//
+
+// 128-bit content hash identifying an executable.
+// Collisions are treated as impossible and entries with matching keys are
+// shared without comparing their contents such that the cache need not retain
+// a copy of every executable it holds.
+typedef struct iree_hal_local_executable_cache_key_t {
+  uint64_t lo;
+  uint64_t hi;
+} iree_hal_local_executable_cache_key_t;
+
+static inline uint64_t iree_hal_local_executable_cache_rotl(uint64_t value,
+                                                            int shift) {
+  return (value << shift) | (value >> (64 - shift));
+}
+
+// Final avalanche so that small differences affect all bits.
+static inline uint64_t iree_hal_local_executable_cache_fmix(uint64_t value) {
+  value ^= value >> 33;
+  value *= 0xFF51AFD7ED558CCDull;
+  value ^= value >> 33;
+  value *= 0xC4CEB9FE1A85EC53ull;
+  value ^= value >> 33;
+  return value;
+}
+
+// Mixes |data_length| bytes of |data| into |key| 16 bytes at a time.
+// This is the MurmurHash3 x64 128-bit function seeded with the current |key|
+// such that segments can be chained.
+static void iree_hal_local_executable_cache_mix_bytes(
+    iree_hal_local_executable_cache_key_t* key, const void* data,
+    iree_host_size_t data_length) {
+  const uint64_t c1 = 0x87C37B91114253D5ull;
+  const uint64_t c2 = 0x4CF5AD432745937Full;
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint64_t h1 = key->lo;
+  uint64_t h2 = key->hi;
+  iree_host_size_t i = 0;
+  for (; i + 2 * sizeof(uint64_t) <= data_length; i += 2 * sizeof(uint64_t)) {
+    uint64_t k1 = 0;
+    uint64_t k2 = 0;
+    memcpy(&k1, bytes + i, sizeof(k1));
+    memcpy(&k2, bytes + i + sizeof(k1), sizeof(k2));
+    k1 = iree_hal_local_executable_cache_rotl(k1 * c1, 31) * c2;
+    h1 ^= k1;
+    h1 = (iree_hal_local_executable_cache_rotl(h1, 27) + h2) * 5 + 0x52DCE729;
+    k2 = iree_hal_local_executable_cache_rotl(k2 * c2, 33) * c1;
+    h2 ^= k2;
+    h2 = (iree_hal_local_executable_cache_rotl(h2, 31) + h1) * 5 + 0x38495AB5;
+  }
+  if (data_length > i) {
+    // |bytes| may be NULL when |data_length| is 0 so only touch it if there
+    // is a tail to read.
+    uint64_t tail[2] = {0, 0};
+    memcpy(tail, bytes + i, data_length - i);
+    h1 ^= iree_hal_local_executable_cache_rotl(tail[0] * c1, 31) * c2;
+    h2 ^= iree_hal_local_executable_cache_rotl(tail[1] * c2, 33) * c1;
+  }
+  h1 ^= (uint64_t)data_length;
+  h2 ^= (uint64_t)data_length;
+  h1 += h2;
+  h2 += h1;
+  h1 = iree_hal_local_executable_cache_fmix(h1);
+  h2 = iree_hal_local_executable_cache_fmix(h2);
+  h1 += h2;
+  h2 += h1;
+  key->lo = h1;
+  key->hi = h2;
+}
+
+// Returns the content hash used to identify the executable that would be
+// produced by preparing |executable_params|.
+// Pipeline layouts are compared separately as they are not content.
+static iree_hal_local_executable_cache_key_t
+iree_hal_local_executable_cache_make_key(
+    const iree_hal_executable_params_t* executable_params) {
+  iree_hal_local_executable_cache_key_t key = {
+      .lo = 0x9E3779B97F4A7C15ull,
+      .hi = (uint64_t)executable_params->caching_mode,
+  };
+  iree_hal_local_executable_cache_mix_bytes(
+      &key, executable_params->executable_format.data,
+      executable_params->executable_format.size);
+  iree_hal_local_executable_cache_mix_bytes(
+      &key, executable_params->executable_data.data,
+      executable_params->executable_data.data_length);
+  iree_hal_local_executable_cache_mix_bytes(
+      &key, executable_params->constants,
+      executable_params->constant_count * sizeof(uint32_t));
+  return key;
+}
+
+static inline bool iree_hal_local_executable_cache_key_equal(
+    iree_hal_local_executable_cache_key_t lhs,
+    iree_hal_local_executable_cache_key_t rhs) {
+  return lhs.lo == rhs.lo && lhs.hi == rhs.hi;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_executable_cache_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_local_executable_cache_entry_t {
+  // Content hash of the executable; see
+  // iree_hal_local_executable_cache_make_key.
+  iree_hal_local_executable_cache_key_t key;
+  // Value of the cache use clock when the entry was last used.
+  uint64_t last_use;
+  // Retained executable.
+  iree_hal_executable_t* executable;
+} iree_hal_local_executable_cache_entry_t;
 
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+
+  // Guards all cache entries and statistics.
+  iree_slim_mutex_t mutex;
+  // Monotonically increasing counter used to order entries by last use.
+  uint64_t use_clock IREE_GUARDED_BY(mutex);
+  iree_hal_local_executable_cache_statistics_t statistics
+      IREE_GUARDED_BY(mutex);
+  // Fixed-size table of cached executables; the first
+  // |statistics.entry_count| entries are valid.
+  iree_host_size_t entry_capacity;
+  iree_hal_local_executable_cache_entry_t* entries IREE_GUARDED_BY(mutex);
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -31,8 +161,8 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_host_size_t capacity, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
@@ -41,9 +171,13 @@ iree_status_t iree_hal_local_executable_cache_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_local_executable_cache_t* executable_cache = NULL;
-  iree_host_size_t total_size =
+  iree_host_size_t entries_offset = iree_host_align(
       sizeof(*executable_cache) +
-      loader_count * sizeof(*executable_cache->loaders) + identifier.size;
+          loader_count * sizeof(*executable_cache->loaders),
+      iree_max_align_t);
+  iree_host_size_t identifier_offset =
+      entries_offset + capacity * sizeof(*executable_cache->entries);
+  iree_host_size_t total_size = identifier_offset + identifier.size;
   iree_status_t status = iree_allocator_malloc(host_allocator, total_size,
                                                (void**)&executable_cache);
   if (iree_status_is_ok(status)) {
@@ -52,9 +186,15 @@ iree_status_t iree_hal_local_executable_cache_create(
     executable_cache->host_allocator = host_allocator;
     iree_string_view_append_to_buffer(
         identifier, &executable_cache->identifier,
-        (char*)executable_cache + total_size - identifier.size);
+        (char*)executable_cache + identifier_offset);
     executable_cache->worker_capacity = worker_capacity;
 
+    iree_slim_mutex_initialize(&executable_cache->mutex);
+    executable_cache->entry_capacity = capacity;
+    executable_cache->entries =
+        (iree_hal_local_executable_cache_entry_t*)((uint8_t*)executable_cache +
+                                                   entries_offset);
+
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
       executable_cache->loaders[i] = loaders[i];
@@ -75,6 +215,10 @@ static void iree_hal_local_executable_cache_destroy(
   iree_allocator_t host_allocator = executable_cache->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Executables must be released before the loaders that produced them.
+  iree_hal_local_executable_cache_trim(base_executable_cache);
+  iree_slim_mutex_deinitialize(&executable_cache->mutex);
+
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     iree_hal_executable_loader_release(executable_cache->loaders[i]);
   }
@@ -83,6 +227,35 @@ static void iree_hal_local_executable_cache_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_hal_local_executable_cache_trim(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Executables are released with the lock held as new entries cannot be added
+  // until we are done anyway.
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  for (iree_host_size_t i = 0; i < executable_cache->statistics.entry_count;
+       ++i) {
+    iree_hal_executable_release(executable_cache->entries[i].executable);
+  }
+  executable_cache->statistics.entry_count = 0;
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_local_executable_cache_query_statistics(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_local_executable_cache_statistics_t* out_statistics) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  *out_statistics = executable_cache->statistics;
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+}
+
 static bool iree_hal_local_executable_cache_can_prepare_format(
     iree_hal_executable_cache_t* base_executable_cache,
     iree_hal_executable_caching_mode_t caching_mode,
@@ -98,12 +271,11 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+// Loads a new executable with the first loader that supports it.
+static iree_status_t iree_hal_local_executable_cache_load(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (!iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_params->caching_mode,
@@ -133,6 +305,131 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
       executable_params->executable_format.data);
 }
 
+// Returns the cached entry matching |key| with pipeline layouts compatible with
+// |executable_params| or NULL if no compatible executable is cached. Must be
+// called with the mutex held.
+static iree_hal_local_executable_cache_entry_t*
+iree_hal_local_executable_cache_lookup(
+    iree_hal_local_executable_cache_t* executable_cache,
+    iree_hal_local_executable_cache_key_t key,
+    const iree_hal_executable_params_t* executable_params) {
+  for (iree_host_size_t i = 0; i < executable_cache->statistics.entry_count;
+       ++i) {
+    iree_hal_local_executable_cache_entry_t* entry =
+        &executable_cache->entries[i];
+    if (!iree_hal_local_executable_cache_key_equal(entry->key, key)) continue;
+    iree_hal_local_executable_t* local_executable =
+        iree_hal_local_executable_cast(entry->executable);
+    if (local_executable->pipeline_layout_count !=
+        executable_params->pipeline_layout_count) {
+      continue;
+    }
+    bool is_compatible = true;
+    for (iree_host_size_t j = 0; j < local_executable->pipeline_layout_count;
+         ++j) {
+      if (!iree_hal_local_pipeline_layout_is_compatible(
+              local_executable->pipeline_layouts[j],
+              executable_params->pipeline_layouts[j])) {
+        is_compatible = false;
+        break;
+      }
+    }
+    if (is_compatible) return entry;
+  }
+  return NULL;
+}
+
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  *out_executable = NULL;
+
+  // Fast path when caching is disabled.
+  if (executable_cache->entry_capacity == 0) {
+    iree_slim_mutex_lock(&executable_cache->mutex);
+    ++executable_cache->statistics.miss_count;
+    iree_slim_mutex_unlock(&executable_cache->mutex);
+    return iree_hal_local_executable_cache_load(
+        executable_cache, executable_params, out_executable);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The caching mode is part of the key so executables aliasing caller data are
+  // only shared with callers that made the same lifetime guarantee.
+  const iree_hal_local_executable_cache_key_t key =
+      iree_hal_local_executable_cache_make_key(executable_params);
+
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  iree_hal_local_executable_cache_entry_t* entry =
+      iree_hal_local_executable_cache_lookup(executable_cache, key,
+                                             executable_params);
+  if (entry) {
+    entry->last_use = ++executable_cache->use_clock;
+    ++executable_cache->statistics.hit_count;
+    iree_hal_executable_retain(entry->executable);
+    *out_executable = entry->executable;
+  } else {
+    ++executable_cache->statistics.miss_count;
+  }
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+  if (*out_executable) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Load without holding the lock so that other executables can be prepared
+  // concurrently.
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_local_executable_cache_load(
+              executable_cache, executable_params, &executable));
+
+  iree_hal_executable_t* evicted_executable = NULL;
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  entry = iree_hal_local_executable_cache_lookup(executable_cache, key,
+                                                 executable_params);
+  if (entry) {
+    // Raced with another thread loading the same executable; prefer the one
+    // already cached so that all users share it.
+    evicted_executable = executable;
+    executable = entry->executable;
+    iree_hal_executable_retain(executable);
+  } else {
+    if (executable_cache->statistics.entry_count <
+        executable_cache->entry_capacity) {
+      entry =
+          &executable_cache->entries[executable_cache->statistics.entry_count++];
+    } else {
+      // Evict the least recently used entry.
+      entry = &executable_cache->entries[0];
+      for (iree_host_size_t i = 1; i < executable_cache->entry_capacity; ++i) {
+        if (executable_cache->entries[i].last_use < entry->last_use) {
+          entry = &executable_cache->entries[i];
+        }
+      }
+      evicted_executable = entry->executable;
+      ++executable_cache->statistics.eviction_count;
+    }
+    entry->key = key;
+    entry->executable = executable;
+    iree_hal_executable_retain(executable);
+  }
+  entry->last_use = ++executable_cache->use_clock;
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+
+  // Destruction may be expensive (unmapping code/etc) so do it unlocked.
+  iree_hal_executable_release(evicted_executable);
+
+  *out_executable = executable;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static const iree_hal_executable_cache_vtable_t
     iree_hal_local_executable_cache_vtable = {
         .destroy = iree_hal_local_executable_cache_destroy,
@@ -15,20 +15,56 @@
 extern "C" {
 #endif  // __cplusplus
 
-// TODO(benvanik): when we refactor executable caches this can become something
-// more specialized; like nop_executable_cache (does nothing but pass through)
-// or inproc_lru_executable_cache (simple in-memory LRU of recent executables).
-//
-// We can also set this up so they share storage. Ideally a JIT'ed executable in
-// one device is the same JIT'ed executable in another, and in multi-tenant
-// situations we're likely to want that isolation _and_ sharing.
+// Statistics of an iree_hal_local_executable_cache_t.
+typedef struct iree_hal_local_executable_cache_statistics_t {
+  // Total number of executables prepared from a cached executable.
+  uint64_t hit_count;
+  // Total number of executables that had to be loaded.
+  uint64_t miss_count;
+  // Total number of cached executables evicted to make room for others.
+  uint64_t eviction_count;
+  // Number of executables currently held by the cache.
+  iree_host_size_t entry_count;
+} iree_hal_local_executable_cache_statistics_t;
 
+// Creates an in-memory executable cache that loads executables with |loaders|.
+//
+// Executables are content-addressed by a 128-bit hash of their data, format,
+// caching mode, and constants; the cache does not retain a copy of the data. Preparing an executable that matches one already held by
+// the cache returns a new reference to the same executable instead of loading
+// it again such that multiple contexts loading the same program (or multiple
+// programs sharing executables) share the loaded code. Pipeline layouts need
+// only be compatible (see iree_hal_local_pipeline_layout_is_compatible) and not
+// the same objects as those the executable was originally prepared with.
+//
+// Up to |capacity| executables are retained by the cache with the least
+// recently used evicted first. Evicted executables remain valid for as long as
+// references to them are held. A |capacity| of 0 disables caching and every
+// preparation loads a new executable.
+//
+// Cached executables are retained until evicted or trimmed and callers using
+// IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA must keep the data valid
+// for the lifetime of the cache as documented on the flag. Executables aliasing
+// caller data are only shared with callers that also request aliasing.
+//
+// Thread-safe: the cache may be shared across devices and contexts.
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_host_size_t capacity, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
+// Releases all executables held by |executable_cache|.
+// Executables still referenced by users remain valid but will no longer be
+// returned from the cache.
+void iree_hal_local_executable_cache_trim(
+    iree_hal_executable_cache_t* executable_cache);
+
+// Returns the current statistics of |executable_cache| in |out_statistics|.
+void iree_hal_local_executable_cache_query_statistics(
+    iree_hal_executable_cache_t* executable_cache,
+    iree_hal_local_executable_cache_statistics_t* out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,206 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_executable_cache.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_library_demo.h"
+#include "iree/hal/local/loaders/static_library_loader.h"
+#include "iree/hal/local/local_pipeline_layout.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+class LocalExecutableCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    const iree_hal_executable_library_query_fn_t libraries[] = {
+        demo_executable_library_query,
+    };
+    IREE_ASSERT_OK(iree_hal_static_library_loader_create(
+        IREE_ARRAYSIZE(libraries), libraries,
+        iree_hal_executable_import_provider_null(), iree_allocator_system(),
+        &loader_));
+  }
+
+  void TearDown() override {
+    iree_hal_executable_cache_release(executable_cache_);
+    iree_hal_executable_loader_release(loader_);
+  }
+
+  void CreateCache(iree_host_size_t capacity) {
+    IREE_ASSERT_OK(iree_hal_local_executable_cache_create(
+        IREE_SV("test"), /*worker_capacity=*/1, capacity,
+        /*loader_count=*/1, &loader_, iree_allocator_system(),
+        &executable_cache_));
+  }
+
+  // Creates a pipeline layout with |push_constants| and no bindings.
+  iree_hal_pipeline_layout_t* CreateLayout(iree_host_size_t push_constants) {
+    iree_hal_pipeline_layout_t* layout = NULL;
+    IREE_CHECK_OK(iree_hal_local_pipeline_layout_create(
+        push_constants, /*set_layout_count=*/0, /*set_layouts=*/NULL,
+        iree_allocator_system(), &layout));
+    return layout;
+  }
+
+  // Prepares the demo library with the given |constants| and |layout|.
+  // The library name is copied to new storage on each call to ensure the cache
+  // compares contents and not pointers.
+  iree_hal_executable_t* Prepare(
+      std::vector<uint32_t> constants = {},
+      iree_hal_pipeline_layout_t* layout = NULL,
+      iree_hal_executable_caching_mode_t caching_mode = 0) {
+    std::string library_name = "demo_library";
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode |= caching_mode;
+    executable_params.executable_format = IREE_SV("static");
+    executable_params.executable_data = iree_make_const_byte_span(
+        library_name.data(), library_name.size());
+    executable_params.pipeline_layout_count = layout ? 1 : 0;
+    executable_params.pipeline_layouts = &layout;
+    executable_params.constant_count = constants.size();
+    executable_params.constants = constants.data();
+    iree_hal_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache_, &executable_params, &executable));
+    return executable;
+  }
+
+  iree_hal_local_executable_cache_statistics_t QueryStatistics() {
+    iree_hal_local_executable_cache_statistics_t statistics;
+    iree_hal_local_executable_cache_query_statistics(executable_cache_,
+                                                     &statistics);
+    return statistics;
+  }
+
+  iree_hal_executable_loader_t* loader_ = NULL;
+  iree_hal_executable_cache_t* executable_cache_ = NULL;
+};
+
+TEST_F(LocalExecutableCacheTest, DeduplicatesIdenticalExecutables) {
+  CreateCache(/*capacity=*/4);
+  iree_hal_executable_t* executable_a = Prepare();
+  iree_hal_executable_t* executable_b = Prepare();
+  EXPECT_EQ(executable_a, executable_b);
+
+  auto statistics = QueryStatistics();
+  EXPECT_EQ(1, statistics.hit_count);
+  EXPECT_EQ(1, statistics.miss_count);
+  EXPECT_EQ(0, statistics.eviction_count);
+  EXPECT_EQ(1, statistics.entry_count);
+
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+}
+
+TEST_F(LocalExecutableCacheTest, DistinguishesConstants) {
+  CreateCache(/*capacity=*/4);
+  iree_hal_executable_t* executable_a = Prepare({1, 2});
+  iree_hal_executable_t* executable_b = Prepare({1, 3});
+  iree_hal_executable_t* executable_c = Prepare({1, 2});
+  EXPECT_NE(executable_a, executable_b);
+  EXPECT_EQ(executable_a, executable_c);
+  EXPECT_EQ(2, QueryStatistics().entry_count);
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+  iree_hal_executable_release(executable_c);
+}
+
+TEST_F(LocalExecutableCacheTest, DistinguishesCachingModes) {
+  CreateCache(/*capacity=*/4);
+  iree_hal_executable_t* executable_a = Prepare();
+  iree_hal_executable_t* executable_b =
+      Prepare({}, NULL, IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA);
+  EXPECT_NE(executable_a, executable_b);
+  EXPECT_EQ(2, QueryStatistics().entry_count);
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+}
+
+TEST_F(LocalExecutableCacheTest, SharesAcrossCompatibleLayouts) {
+  CreateCache(/*capacity=*/4);
+  iree_hal_pipeline_layout_t* layout_a = CreateLayout(/*push_constants=*/2);
+  iree_hal_pipeline_layout_t* layout_b = CreateLayout(/*push_constants=*/2);
+  iree_hal_pipeline_layout_t* layout_c = CreateLayout(/*push_constants=*/3);
+  iree_hal_executable_t* executable_a = Prepare({}, layout_a);
+  iree_hal_executable_t* executable_b = Prepare({}, layout_b);
+  iree_hal_executable_t* executable_c = Prepare({}, layout_c);
+  EXPECT_EQ(executable_a, executable_b);
+  EXPECT_NE(executable_a, executable_c);
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+  iree_hal_executable_release(executable_c);
+  iree_hal_pipeline_layout_release(layout_a);
+  iree_hal_pipeline_layout_release(layout_b);
+  iree_hal_pipeline_layout_release(layout_c);
+}
+
+TEST_F(LocalExecutableCacheTest, EvictsLeastRecentlyUsed) {
+  CreateCache(/*capacity=*/2);
+  iree_hal_executable_release(Prepare({1}));
+  iree_hal_executable_release(Prepare({2}));
+  iree_hal_executable_release(Prepare({1}));  // hit; {2} is now the LRU
+  iree_hal_executable_release(Prepare({3}));  // evicts {2}
+  iree_hal_executable_release(Prepare({1}));  // hit
+  iree_hal_executable_release(Prepare({2}));  // miss; evicts {3}
+
+  auto statistics = QueryStatistics();
+  EXPECT_EQ(2, statistics.hit_count);
+  EXPECT_EQ(4, statistics.miss_count);
+  EXPECT_EQ(2, statistics.eviction_count);
+  EXPECT_EQ(2, statistics.entry_count);
+}
+
+TEST_F(LocalExecutableCacheTest, EvictedExecutablesRemainValid) {
+  CreateCache(/*capacity=*/1);
+  iree_hal_executable_t* executable_a = Prepare({1});
+  iree_hal_executable_release(Prepare({2}));
+  EXPECT_EQ(1, QueryStatistics().eviction_count);
+  iree_hal_executable_t* executable_b = Prepare({1});
+  EXPECT_NE(executable_a, executable_b);
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+}
+
+TEST_F(LocalExecutableCacheTest, Trim) {
+  CreateCache(/*capacity=*/4);
+  iree_hal_executable_t* executable_a = Prepare();
+  iree_hal_local_executable_cache_trim(executable_cache_);
+  EXPECT_EQ(0, QueryStatistics().entry_count);
+  iree_hal_executable_t* executable_b = Prepare();
+  EXPECT_NE(executable_a, executable_b);
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+}
+
+TEST_F(LocalExecutableCacheTest, ZeroCapacityDisablesCaching) {
+  CreateCache(/*capacity=*/0);
+  iree_hal_executable_t* executable_a = Prepare();
+  iree_hal_executable_t* executable_b = Prepare();
+  EXPECT_NE(executable_a, executable_b);
+
+  auto statistics = QueryStatistics();
+  EXPECT_EQ(0, statistics.hit_count);
+  EXPECT_EQ(2, statistics.miss_count);
+  EXPECT_EQ(0, statistics.entry_count);
+
+  iree_hal_executable_release(executable_a);
+  iree_hal_executable_release(executable_b);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,238 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/local/local_executable.h"
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/local/executable_library.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+// Entry point 0 requests one page of worker scratch and declares binding hints.
+// Entry point 1 requests nothing.
+static const iree_hal_executable_dispatch_attrs_v0_t kDispatchAttrs[2] = {
+    {/*local_memory_pages=*/0, /*worker_scratch_pages=*/1},
+    {/*local_memory_pages=*/0, /*worker_scratch_pages=*/0},
+};
+static const iree_hal_executable_dispatch_hints_v0_t kDispatchHints[2] = {
+    {/*streamed_bindings=*/0x5, /*reused_bindings=*/0x2},
+    {/*streamed_bindings=*/0, /*reused_bindings=*/0},
+};
+
+// Workgroup state observed by the last call through the test vtable.
+struct IssuedCall {
+  void* worker_scratch = NULL;
+  uint32_t worker_scratch_size = 0;
+  bool worker_scratch_zeroed = false;
+};
+static IssuedCall last_issued_call;
+
+static iree_status_t test_executable_issue_call(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
+    uint32_t worker_id) {
+  last_issued_call.worker_scratch = workgroup_state->worker_scratch;
+  last_issued_call.worker_scratch_size = workgroup_state->worker_scratch_size;
+  const uint8_t* bytes = (const uint8_t*)workgroup_state->worker_scratch;
+  last_issued_call.worker_scratch_zeroed = true;
+  for (uint32_t i = 0; i < workgroup_state->worker_scratch_size; ++i) {
+    if (bytes[i] != 0) last_issued_call.worker_scratch_zeroed = false;
+  }
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t test_executable_vtable = {
+    /*.base=*/{/*.destroy=*/NULL},
+    /*.issue_call=*/test_executable_issue_call,
+};
+
+class LocalExecutableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_local_executable_initialize(
+        &test_executable_vtable, /*pipeline_layout_count=*/0,
+        /*source_pipeline_layouts=*/NULL, /*target_pipeline_layouts=*/NULL,
+        iree_allocator_system(), &executable_);
+  }
+
+  void TearDown() override {
+    iree_hal_local_executable_deinitialize(&executable_);
+  }
+
+  // Initializes |executable_| from a library with |features|.
+  void InitializeLibrary(iree_hal_executable_library_features_t features,
+                         iree_host_size_t worker_capacity) {
+    header_.version = IREE_HAL_EXECUTABLE_LIBRARY_VERSION_LATEST;
+    header_.name = "test_library";
+    header_.features = features;
+    header_.sanitizer = IREE_HAL_EXECUTABLE_LIBRARY_SANITIZER_NONE;
+    memset(&library_, 0, sizeof(library_));
+    library_.header = &header_;
+    library_.exports.count = IREE_ARRAYSIZE(kDispatchAttrs);
+    library_.exports.attrs = kDispatchAttrs;
+    library_.export_hints = kDispatchHints;
+    IREE_ASSERT_OK(iree_hal_local_executable_initialize_library(
+        &executable_, &library_, worker_capacity));
+  }
+
+  iree_hal_executable_library_header_t header_;
+  iree_hal_executable_library_v0_t library_;
+  iree_hal_local_executable_t executable_;
+};
+
+TEST_F(LocalExecutableTest, WorkerScratchIsPersistentPerWorker) {
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+                    /*worker_capacity=*/2);
+
+  iree_byte_span_t worker0_scratch;
+  IREE_ASSERT_OK(iree_hal_local_executable_acquire_worker_scratch(
+      &executable_, /*ordinal=*/0, /*worker_id=*/0, &worker0_scratch));
+  ASSERT_NE(nullptr, worker0_scratch.data);
+  ASSERT_EQ(IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE,
+            worker0_scratch.data_length);
+  EXPECT_TRUE(iree_host_size_has_alignment(
+      (iree_host_size_t)worker0_scratch.data,
+      IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE));
+  for (iree_host_size_t i = 0; i < worker0_scratch.data_length; ++i) {
+    ASSERT_EQ(0, worker0_scratch.data[i]);
+  }
+  memset(worker0_scratch.data, 0xCD, worker0_scratch.data_length);
+
+  // The same worker gets the same memory back with its contents retained.
+  iree_byte_span_t worker0_scratch_again;
+  IREE_ASSERT_OK(iree_hal_local_executable_acquire_worker_scratch(
+      &executable_, /*ordinal=*/0, /*worker_id=*/0, &worker0_scratch_again));
+  EXPECT_EQ(worker0_scratch.data, worker0_scratch_again.data);
+  EXPECT_EQ(0xCD, worker0_scratch_again.data[0]);
+
+  // Other workers get their own memory.
+  iree_byte_span_t worker1_scratch;
+  IREE_ASSERT_OK(iree_hal_local_executable_acquire_worker_scratch(
+      &executable_, /*ordinal=*/0, /*worker_id=*/1, &worker1_scratch));
+  ASSERT_NE(nullptr, worker1_scratch.data);
+  EXPECT_NE(worker0_scratch.data, worker1_scratch.data);
+  EXPECT_EQ(0, worker1_scratch.data[0]);
+}
+
+TEST_F(LocalExecutableTest, WorkerScratchOnlyForRequestingExports) {
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+                    /*worker_capacity=*/1);
+  iree_byte_span_t worker_scratch;
+  IREE_ASSERT_OK(iree_hal_local_executable_acquire_worker_scratch(
+      &executable_, /*ordinal=*/1, /*worker_id=*/0, &worker_scratch));
+  EXPECT_EQ(nullptr, worker_scratch.data);
+  EXPECT_EQ(0, worker_scratch.data_length);
+}
+
+TEST_F(LocalExecutableTest, WorkerScratchOutOfRangeWorker) {
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+                    /*worker_capacity=*/1);
+  iree_byte_span_t worker_scratch;
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_OUT_OF_RANGE,
+      iree_hal_local_executable_acquire_worker_scratch(
+          &executable_, /*ordinal=*/0, /*worker_id=*/1, &worker_scratch));
+}
+
+TEST_F(LocalExecutableTest, InlineDispatchUsesTransientWorkerScratch) {
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+                    /*worker_capacity=*/0);
+  iree_hal_executable_dispatch_state_v0_t dispatch_state;
+  memset(&dispatch_state, 0, sizeof(dispatch_state));
+  dispatch_state.workgroup_count_x = 1;
+  dispatch_state.workgroup_count_y = 1;
+  dispatch_state.workgroup_count_z = 1;
+
+  last_issued_call = IssuedCall();
+  IREE_ASSERT_OK(iree_hal_local_executable_issue_dispatch_inline(
+      &executable_, /*ordinal=*/0, &dispatch_state, /*processor_id=*/0,
+      iree_make_byte_span(NULL, 0)));
+  EXPECT_NE(nullptr, last_issued_call.worker_scratch);
+  EXPECT_EQ(IREE_HAL_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE,
+            last_issued_call.worker_scratch_size);
+  EXPECT_TRUE(last_issued_call.worker_scratch_zeroed);
+
+  last_issued_call = IssuedCall();
+  IREE_ASSERT_OK(iree_hal_local_executable_issue_dispatch_inline(
+      &executable_, /*ordinal=*/1, &dispatch_state, /*processor_id=*/0,
+      iree_make_byte_span(NULL, 0)));
+  EXPECT_EQ(nullptr, last_issued_call.worker_scratch);
+  EXPECT_EQ(0, last_issued_call.worker_scratch_size);
+}
+
+TEST_F(LocalExecutableTest, DispatchHintsRequireFeature) {
+  // Without the feature bit the trailing hints field must not be read.
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_NONE,
+                    /*worker_capacity=*/0);
+  iree_hal_executable_dispatch_hints_v0_t hints =
+      iree_hal_local_executable_dispatch_hints(&executable_, 0);
+  EXPECT_EQ(0, hints.streamed_bindings);
+  EXPECT_EQ(0, hints.reused_bindings);
+}
+
+TEST_F(LocalExecutableTest, DispatchHints) {
+  InitializeLibrary(IREE_HAL_EXECUTABLE_LIBRARY_FEATURE_DISPATCH_HINTS,
+                    /*worker_capacity=*/0);
+  iree_hal_executable_dispatch_hints_v0_t hints =
+      iree_hal_local_executable_dispatch_hints(&executable_, 0);
+  EXPECT_EQ(0x5, hints.streamed_bindings);
+  EXPECT_EQ(0x2, hints.reused_bindings);
+  hints = iree_hal_local_executable_dispatch_hints(&executable_, 1);
+  EXPECT_EQ(0, hints.streamed_bindings);
+  EXPECT_EQ(0, hints.reused_bindings);
+}
+
+TEST(StreamedRangeTest, EvenSlices) {
+  iree_host_size_t offset = 0;
+  EXPECT_EQ(256, iree_hal_local_executable_streamed_range(
+                     /*binding_length=*/1024, /*workgroup_total=*/4,
+                     /*workgroup_id=*/1, /*budget=*/4096, &offset));
+  EXPECT_EQ(256, offset);
+  EXPECT_EQ(64, iree_hal_local_executable_streamed_range(
+                    /*binding_length=*/1024, /*workgroup_total=*/4,
+                    /*workgroup_id=*/3, /*budget=*/64, &offset));
+  EXPECT_EQ(768, offset);
+}
+
+TEST(StreamedRangeTest, ClampedToBindingEnd) {
+  // Slices are rounded up to 3 bytes so the last one would cover [9, 12) of a
+  // 10 byte binding.
+  iree_host_size_t offset = 0;
+  EXPECT_EQ(1, iree_hal_local_executable_streamed_range(
+                   /*binding_length=*/10, /*workgroup_total=*/4,
+                   /*workgroup_id=*/3, /*budget=*/4096, &offset));
+  EXPECT_EQ(9, offset);
+  // Slices are rounded up to 2 bytes so the last one would start at 6, past the
+  // end of a 5 byte binding.
+  offset = 1;
+  EXPECT_EQ(0, iree_hal_local_executable_streamed_range(
+                   /*binding_length=*/5, /*workgroup_total=*/4,
+                   /*workgroup_id=*/3, /*budget=*/4096, &offset));
+  EXPECT_EQ(0, offset);
+}
+
+TEST(StreamedRangeTest, OutOfRangeWorkgroup) {
+  iree_host_size_t offset = 1;
+  EXPECT_EQ(0, iree_hal_local_executable_streamed_range(
+                   /*binding_length=*/1024, /*workgroup_total=*/4,
+                   /*workgroup_id=*/4, /*budget=*/4096, &offset));
+  EXPECT_EQ(0, offset);
+  EXPECT_EQ(0, iree_hal_local_executable_streamed_range(
+                   /*binding_length=*/0, /*workgroup_total=*/4,
+                   /*workgroup_id=*/0, /*budget=*/4096, &offset));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -160,6 +160,18 @@ iree_status_t iree_hal_local_pipeline_layout_create(
   return status;
 }
 
+bool iree_hal_local_pipeline_layout_is_compatible(
+    iree_hal_pipeline_layout_t* lhs, iree_hal_pipeline_layout_t* rhs) {
+  if (lhs == rhs) return true;
+  iree_hal_local_pipeline_layout_t* local_lhs =
+      iree_hal_local_pipeline_layout_cast(lhs);
+  iree_hal_local_pipeline_layout_t* local_rhs =
+      iree_hal_local_pipeline_layout_cast(rhs);
+  return local_lhs->push_constants == local_rhs->push_constants &&
+         local_lhs->used_bindings == local_rhs->used_bindings &&
+         local_lhs->read_only_bindings == local_rhs->read_only_bindings;
+}
+
 static void iree_hal_local_pipeline_layout_destroy(
     iree_hal_pipeline_layout_t* base_layout) {
   iree_hal_local_pipeline_layout_t* layout =
@@ -7,6 +7,7 @@
 #ifndef IREE_HAL_LOCAL_LOCAL_PIPELINE_LAYOUT_H_
 #define IREE_HAL_LOCAL_LOCAL_PIPELINE_LAYOUT_H_
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "iree/base/api.h"
@@ -72,6 +73,12 @@ iree_status_t iree_hal_local_pipeline_layout_create(
 iree_hal_local_pipeline_layout_t* iree_hal_local_pipeline_layout_cast(
     iree_hal_pipeline_layout_t* base_value);
 
+// Returns true if |lhs| and |rhs| are interchangeable for dispatch; that is,
+// they declare the same push constants and the same set of (read-only) bindings.
+// Executables created with one may be dispatched as if created with the other.
+bool iree_hal_local_pipeline_layout_is_compatible(
+    iree_hal_pipeline_layout_t* lhs, iree_hal_pipeline_layout_t* rhs);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -1384,8 +1384,7 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
 
   iree_hal_module_t* module = IREE_HAL_MODULE_CAST(base_module);
   module->host_allocator = host_allocator;
-  // TODO(benvanik): fix vm yield with result storage.
-  module->flags = flags | IREE_HAL_MODULE_FLAG_SYNCHRONOUS;
+  module->flags = flags;
   module->shared_device = device;
   iree_hal_device_retain(module->shared_device);
 
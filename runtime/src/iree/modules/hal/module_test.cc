@@ -0,0 +1,185 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Tests covering the asynchronous behavior of the HAL module.
+//
+// iree/modules/hal/module_test.mlir contains the functions used here for
+// testing.
+
+#include "iree/modules/hal/module.h"
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_sync/sync_device.h"
+#include "iree/modules/hal/module_test_module_c.h"
+#include "iree/modules/hal/types.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+
+namespace iree {
+namespace {
+
+using iree::testing::status::StatusIs;
+
+class HALModuleTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(
+        iree_vm_instance_create(iree_allocator_system(), &instance_));
+    IREE_ASSERT_OK(iree_hal_module_register_all_types(instance_));
+
+    iree_hal_allocator_t* device_allocator = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("local"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator));
+    iree_hal_sync_device_params_t params;
+    iree_hal_sync_device_params_initialize(&params);
+    iree_status_t status = iree_hal_sync_device_create(
+        iree_make_cstring_view("local-sync"), &params, /*loader_count=*/0,
+        /*loaders=*/NULL, device_allocator, iree_allocator_system(), &device_);
+    iree_hal_allocator_release(device_allocator);
+    IREE_ASSERT_OK(status);
+
+    // Fence waits yield to the scheduler instead of blocking.
+    IREE_ASSERT_OK(iree_hal_module_create(instance_, device_,
+                                          IREE_HAL_MODULE_FLAG_NONE,
+                                          iree_allocator_system(), &hal_module_));
+
+    const iree_file_toc_t* module_file =
+        iree_modules_hal_module_test_module_create();
+    IREE_ASSERT_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_make_const_byte_span(module_file->data, module_file->size),
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    iree_vm_module_t* modules[2] = {hal_module_, bytecode_module_};
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules),
+        modules, iree_allocator_system(), &context_));
+
+    IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+        bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_make_cstring_view("await_fence"), &await_fence_));
+  }
+
+  void TearDown() override {
+    iree_vm_context_release(context_);
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_module_release(hal_module_);
+    iree_hal_device_release(device_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Returns a fence that is reached when |semaphore| reaches |value|.
+  static iree_hal_fence_t* CreateFence(iree_hal_semaphore_t* semaphore,
+                                       uint64_t value) {
+    iree_hal_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_hal_fence_create(1, iree_allocator_system(), &fence));
+    IREE_CHECK_OK(iree_hal_fence_insert(fence, semaphore, value));
+    return fence;
+  }
+
+  // Begins an invocation of @await_fence with |fence| in |state|.
+  iree_status_t BeginAwaitFence(iree_vm_invoke_state_t* state,
+                                iree_hal_fence_t* fence) {
+    iree_vm_list_t* inputs = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_create(/*element_type=*/NULL, 1, iree_allocator_system(),
+                            &inputs));
+    iree_vm_ref_t fence_ref = iree_hal_fence_retain_ref(fence);
+    iree_status_t status = iree_vm_list_push_ref_move(inputs, &fence_ref);
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_begin_invoke(state, context_, await_fence_,
+                                    IREE_VM_INVOCATION_FLAG_NONE,
+                                    /*policy=*/NULL, inputs,
+                                    iree_allocator_system());
+    }
+    iree_vm_list_release(inputs);
+    return status;
+  }
+
+  // Ends the invocation in |state| and returns the i32 status returned by
+  // @await_fence in |out_wait_status|.
+  static iree_status_t EndAwaitFence(iree_vm_invoke_state_t* state,
+                                     int32_t* out_wait_status) {
+    iree_vm_list_t* outputs = NULL;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_create(/*element_type=*/NULL, 1, iree_allocator_system(),
+                            &outputs));
+    iree_status_t invoke_status = iree_ok_status();
+    iree_status_t status = iree_vm_end_invoke(state, outputs, &invoke_status);
+    if (iree_status_is_ok(status)) status = invoke_status;
+    iree_vm_value_t value;
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_list_get_value(outputs, 0, &value);
+    }
+    if (iree_status_is_ok(status)) *out_wait_status = value.i32;
+    iree_vm_list_release(outputs);
+    return status;
+  }
+
+  iree_vm_instance_t* instance_ = NULL;
+  iree_hal_device_t* device_ = NULL;
+  iree_vm_module_t* hal_module_ = NULL;
+  iree_vm_module_t* bytecode_module_ = NULL;
+  iree_vm_context_t* context_ = NULL;
+  iree_vm_function_t await_fence_;
+};
+
+// Tests that awaiting a reached fence completes without yielding.
+TEST_F(HALModuleTest, FenceAwaitReached) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 1ull, &semaphore));
+  iree_hal_fence_t* fence = CreateFence(semaphore, 1ull);
+
+  iree_vm_invoke_state_t state;
+  IREE_ASSERT_OK(BeginAwaitFence(&state, fence));
+  int32_t wait_status = -1;
+  IREE_ASSERT_OK(EndAwaitFence(&state, &wait_status));
+  EXPECT_EQ(0, wait_status);
+
+  iree_hal_fence_release(fence);
+  iree_hal_semaphore_release(semaphore);
+}
+
+// Tests that awaiting an unreached fence yields from the bytecode caller with a
+// wait frame on top of the HAL native frame and that resuming after the wait
+// resumes hal.fence.await (and not whatever frame is on top of the stack) and
+// marshals its result into the caller.
+TEST_F(HALModuleTest, FenceAwaitYields) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+  iree_hal_fence_t* fence = CreateFence(semaphore, 1ull);
+
+  iree_vm_invoke_state_t state;
+  ASSERT_THAT(BeginAwaitFence(&state, fence), StatusIs(StatusCode::kDeferred));
+  iree_vm_stack_frame_t* wait_frame = iree_vm_stack_current_frame(state.stack);
+  ASSERT_NE(nullptr, wait_frame);
+  ASSERT_EQ(IREE_VM_STACK_FRAME_WAIT, wait_frame->type);
+  iree_vm_stack_frame_t* native_frame = iree_vm_stack_frame_parent(wait_frame);
+  ASSERT_NE(nullptr, native_frame);
+  EXPECT_EQ(IREE_VM_STACK_FRAME_NATIVE, native_frame->type);
+  EXPECT_EQ(hal_module_, native_frame->function.module);
+
+  // Reach the fence and let the scheduler perform the wait before resuming.
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphore, 1ull));
+  IREE_ASSERT_OK(iree_vm_wait_invoke(
+      &state, (iree_vm_wait_frame_t*)iree_vm_stack_frame_storage(wait_frame),
+      IREE_TIME_INFINITE_FUTURE));
+  IREE_ASSERT_OK(iree_vm_resume_invoke(&state));
+
+  int32_t wait_status = -1;
+  IREE_ASSERT_OK(EndAwaitFence(&state, &wait_status));
+  EXPECT_EQ(0, wait_status);
+
+  iree_hal_fence_release(fence);
+  iree_hal_semaphore_release(semaphore);
+}
+
+}  // namespace
+}  // namespace iree
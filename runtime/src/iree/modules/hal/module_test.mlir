@@ -0,0 +1,21 @@
+// Tested by iree/modules/hal/module_test.cc.
+
+vm.module @module_test {
+
+  vm.import @hal.fence.await(
+    %timeout_millis : i32,
+    %fences : !vm.ref<!hal.fence> ...
+  ) -> i32
+  attributes {vm.yield}
+
+  // Waits on %fence with an infinite timeout and returns the wait status.
+  // The call yields to the scheduler when the fence has not been reached and
+  // the wait status is marshaled into the result register on resume.
+  vm.export @await_fence
+  vm.func @await_fence(%fence : !vm.ref<!hal.fence>) -> i32 {
+    %timeout = vm.const.i32 -1
+    %status = vm.call.variadic @hal.fence.await(%timeout, [%fence]) : (i32, !vm.ref<!hal.fence> ...) -> i32
+    vm.return %status : i32
+  }
+
+}
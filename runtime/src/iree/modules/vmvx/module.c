@@ -536,7 +536,7 @@ IREE_VMVX_ABI_EXPORT(iree_vmvx_matmul_f32f32f32, matmul, v) {
   iree_host_size_t K = (iree_host_size_t)args->k;
 
   // TODO: define flags more robustly
-  unsigned accumulate_flag = args->flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+  unsigned accumulate_flag = args->flags & IREE_UKERNEL_FLAG_ACCUMULATE;
   unsigned unhandled_flags = args->flags ^ accumulate_flag;
   if (unhandled_flags) {
     IREE_TRACE_ZONE_END(z0);
@@ -587,7 +587,7 @@ IREE_VMVX_ABI_EXPORT(iree_vmvx_matmul_i8i8i32, matmul, v) {
   iree_host_size_t K = (iree_host_size_t)args->k;
 
   // TODO: define flags more robustly
-  unsigned accumulate_flag = args->flags & IREE_VMVX_MATMUL_FLAG_ACCUMULATE;
+  unsigned accumulate_flag = args->flags & IREE_UKERNEL_FLAG_ACCUMULATE;
   unsigned unhandled_flags = args->flags ^ accumulate_flag;
   if (unhandled_flags) {
     IREE_TRACE_ZONE_END(z0);
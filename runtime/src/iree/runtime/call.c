@@ -111,6 +111,16 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer_view(
   return iree_vm_list_push_ref_retain(call->inputs, &value);
 }
 
+IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer(
+    iree_runtime_call_t* call, iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(call);
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_vm_ref_t value = {0};
+  IREE_RETURN_IF_ERROR(
+      iree_vm_ref_wrap_assign(buffer, iree_hal_buffer_type_id(), &value));
+  return iree_vm_list_push_ref_retain(call->inputs, &value);
+}
+
 // Pops a buffer view from the front of the call outputs list.
 // Ownership of the buffer view transfers to the caller.
 IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
@@ -106,6 +106,13 @@ IREE_API_EXPORT iree_status_t iree_runtime_call_invoke(
 IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer_view(
     iree_runtime_call_t* call, iree_hal_buffer_view_t* buffer_view);
 
+// Pushes |buffer| to the call inputs list.
+// This is used to provide preallocated storage for function results that were
+// compiled with a `!hal.buffer` argument annotated with `iree.abi.output`.
+// The value will be retained by the list.
+IREE_API_EXPORT iree_status_t iree_runtime_call_inputs_push_back_buffer(
+    iree_runtime_call_t* call, iree_hal_buffer_t* buffer);
+
 // Pops a buffer view from the front of the call outputs list.
 // Ownership of the buffer view transfers to the caller.
 IREE_API_EXPORT iree_status_t iree_runtime_call_outputs_pop_front_buffer_view(
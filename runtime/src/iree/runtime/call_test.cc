@@ -0,0 +1,152 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <array>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/runtime/api.h"
+#include "iree/runtime/testdata/output_storage_module_c.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace runtime {
+namespace {
+
+using ::testing::ElementsAre;
+
+class CallTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_runtime_instance_options_t instance_options;
+    iree_runtime_instance_options_initialize(IREE_API_VERSION_LATEST,
+                                             &instance_options);
+    iree_runtime_instance_options_use_all_available_drivers(&instance_options);
+    IREE_ASSERT_OK(iree_runtime_instance_create(
+        &instance_options, iree_allocator_system(), &instance_));
+
+    iree_hal_device_t* device = NULL;
+    IREE_ASSERT_OK(iree_runtime_instance_try_create_default_device(
+        instance_, iree_make_cstring_view("local-task"), &device));
+    iree_runtime_session_options_t session_options;
+    iree_runtime_session_options_initialize(&session_options);
+    iree_status_t status = iree_runtime_session_create_with_device(
+        instance_, &session_options, device,
+        iree_runtime_instance_host_allocator(instance_), &session_);
+    iree_hal_device_release(device);
+    IREE_ASSERT_OK(status);
+
+    const iree_file_toc_t* module_file =
+        iree_runtime_testdata_output_storage_module_create();
+    IREE_ASSERT_OK(iree_runtime_session_append_bytecode_module_from_memory(
+        session_,
+        iree_make_const_byte_span(module_file->data, module_file->size),
+        iree_allocator_null()));
+  }
+
+  void TearDown() override {
+    iree_runtime_session_release(session_);
+    iree_runtime_instance_release(instance_);
+  }
+
+  // Allocates a tensor<4xf32> buffer view holding |data|.
+  iree_hal_buffer_view_t* AllocateBufferView(
+      const std::array<float, 4>& data) {
+    static const iree_hal_dim_t shape[1] = {4};
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+    params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_DEFAULT | IREE_HAL_BUFFER_USAGE_MAPPING;
+    iree_hal_buffer_view_t* buffer_view = NULL;
+    IREE_CHECK_OK(iree_hal_buffer_view_allocate_buffer(
+        iree_runtime_session_device_allocator(session_), IREE_ARRAYSIZE(shape),
+        shape, IREE_HAL_ELEMENT_TYPE_FLOAT_32,
+        IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR, params,
+        iree_make_const_byte_span(data.data(), sizeof(data)), &buffer_view));
+    return buffer_view;
+  }
+
+  // Returns the allocation backing |buffer_view|, which may be a subspan.
+  static iree_hal_buffer_t* GetAllocatedBuffer(
+      iree_hal_buffer_view_t* buffer_view) {
+    return iree_hal_buffer_allocated_buffer(
+        iree_hal_buffer_view_buffer(buffer_view));
+  }
+
+  // Reads the 4 floats stored in |buffer|.
+  static std::array<float, 4> ReadBuffer(iree_hal_buffer_t* buffer) {
+    std::array<float, 4> data = {0};
+    IREE_CHECK_OK(
+        iree_hal_buffer_map_read(buffer, 0, data.data(), sizeof(data)));
+    return data;
+  }
+
+  iree_runtime_instance_t* instance_ = NULL;
+  iree_runtime_session_t* session_ = NULL;
+};
+
+TEST_F(CallTest, PushBackBufferAsOutputStorage) {
+  iree_runtime_call_t call;
+  IREE_ASSERT_OK(iree_runtime_call_initialize_by_name(
+      session_, iree_make_cstring_view("module.mul_into"), &call));
+
+  iree_hal_buffer_view_t* lhs = AllocateBufferView({1.0f, 2.0f, 3.0f, 4.0f});
+  iree_hal_buffer_view_t* rhs = AllocateBufferView({2.0f, 2.0f, 2.0f, 2.0f});
+  iree_hal_buffer_view_t* storage =
+      AllocateBufferView({0.0f, 0.0f, 0.0f, 0.0f});
+  IREE_ASSERT_OK(iree_runtime_call_inputs_push_back_buffer_view(&call, lhs));
+  IREE_ASSERT_OK(iree_runtime_call_inputs_push_back_buffer_view(&call, rhs));
+  IREE_ASSERT_OK(iree_runtime_call_inputs_push_back_buffer(
+      &call, iree_hal_buffer_view_buffer(storage)));
+  iree_hal_buffer_view_release(lhs);
+  iree_hal_buffer_view_release(rhs);
+
+  IREE_ASSERT_OK(iree_runtime_call_invoke(&call, /*flags=*/0));
+
+  // The result is returned in the storage provided.
+  iree_hal_buffer_view_t* result = NULL;
+  IREE_ASSERT_OK(
+      iree_runtime_call_outputs_pop_front_buffer_view(&call, &result));
+  EXPECT_EQ(GetAllocatedBuffer(storage), GetAllocatedBuffer(result));
+  EXPECT_THAT(ReadBuffer(iree_hal_buffer_view_buffer(storage)),
+              ElementsAre(2.0f, 4.0f, 6.0f, 8.0f));
+  iree_hal_buffer_view_release(result);
+  iree_hal_buffer_view_release(storage);
+
+  iree_runtime_call_deinitialize(&call);
+}
+
+TEST_F(CallTest, DonatedInputAsOutputStorage) {
+  iree_runtime_call_t call;
+  IREE_ASSERT_OK(iree_runtime_call_initialize_by_name(
+      session_, iree_make_cstring_view("module.mul_donated"), &call));
+
+  iree_hal_buffer_view_t* lhs = AllocateBufferView({1.0f, 2.0f, 3.0f, 4.0f});
+  iree_hal_buffer_view_t* rhs = AllocateBufferView({3.0f, 3.0f, 3.0f, 3.0f});
+  IREE_ASSERT_OK(iree_runtime_call_inputs_push_back_buffer_view(&call, lhs));
+  IREE_ASSERT_OK(iree_runtime_call_inputs_push_back_buffer_view(&call, rhs));
+  iree_hal_buffer_view_release(rhs);
+
+  IREE_ASSERT_OK(iree_runtime_call_invoke(&call, /*flags=*/0));
+
+  // The result is returned in the storage of the donated input.
+  iree_hal_buffer_view_t* result = NULL;
+  IREE_ASSERT_OK(
+      iree_runtime_call_outputs_pop_front_buffer_view(&call, &result));
+  EXPECT_EQ(GetAllocatedBuffer(lhs), GetAllocatedBuffer(result));
+  EXPECT_THAT(ReadBuffer(iree_hal_buffer_view_buffer(lhs)),
+              ElementsAre(3.0f, 6.0f, 9.0f, 12.0f));
+  iree_hal_buffer_view_release(result);
+  iree_hal_buffer_view_release(lhs);
+
+  iree_runtime_call_deinitialize(&call);
+}
+
+}  // namespace
+}  // namespace runtime
+}  // namespace iree
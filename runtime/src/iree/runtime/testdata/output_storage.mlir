@@ -0,0 +1,11 @@
+// Results written into storage provided by the caller as a !hal.buffer.
+func.func @mul_into(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>, %storage: !hal.buffer {iree.abi.output = 0 : index}) -> tensor<4xf32> {
+  %0 = arith.mulf %arg0, %arg1 : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
+
+// Results written into the storage of an input donated by the caller.
+func.func @mul_donated(%arg0: tensor<4xf32> {iree.abi.output = 0 : index}, %arg1: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = arith.mulf %arg0, %arg1 : tensor<4xf32>
+  return %0 : tensor<4xf32>
+}
@@ -73,6 +73,146 @@ enum iree_cpu_data_field_0_e {
   // Canonical key: "i8mm"
   IREE_CPU_DATA_FIELD_0_AARCH64_HAVE_I8MM = 1ull << 1,
 
+  //===--------------------------------------------------------------------===//
+  // IREE_ARCH_X86_64 / x86-64
+  //===--------------------------------------------------------------------===//
+  // The canonical keys match the LLVM target feature names so that the
+  // compiler can map a target feature set to runtime queries directly. Bits
+  // requiring OS support for extended register state (AVX/AVX-512) are only
+  // set if the OS has enabled that state.
+
+  // SSE3 instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.SSE3[bit 0]
+  // Canonical key: "sse3"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE3 = 1ull << 0,
+
+  // SSSE3 instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.SSSE3[bit 9]
+  // Canonical key: "ssse3"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSSE3 = 1ull << 1,
+
+  // SSE4.1 instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.SSE4_1[bit 19]
+  // Canonical key: "sse4.1"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE41 = 1ull << 2,
+
+  // SSE4.2 instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.SSE4_2[bit 20]
+  // Canonical key: "sse4.2"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SSE42 = 1ull << 3,
+
+  // POPCNT instruction is implemented.
+  //
+  // Source: CPUID.01H:ECX.POPCNT[bit 23]
+  // Canonical key: "popcnt"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_POPCNT = 1ull << 4,
+
+  // CMPXCHG16B instruction is implemented.
+  //
+  // Source: CPUID.01H:ECX.CMPXCHG16B[bit 13]
+  // Canonical key: "cx16"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_CX16 = 1ull << 5,
+
+  // LAHF/SAHF instructions are implemented in 64-bit mode.
+  //
+  // Source: CPUID.80000001H:ECX.LAHF-SAHF[bit 0]
+  // Canonical key: "sahf"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_SAHF = 1ull << 6,
+
+  // AVX instructions are implemented and enabled by the OS.
+  //
+  // Source: CPUID.01H:ECX.AVX[bit 28] + XCR0[2:1]
+  // Canonical key: "avx"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX = 1ull << 7,
+
+  // AVX2 instructions are implemented and enabled by the OS.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX2[bit 5]
+  // Canonical key: "avx2"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX2 = 1ull << 8,
+
+  // FMA3 instructions are implemented and enabled by the OS.
+  //
+  // Source: CPUID.01H:ECX.FMA[bit 12]
+  // Canonical key: "fma"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_FMA = 1ull << 9,
+
+  // F16C half-precision conversion instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.F16C[bit 29]
+  // Canonical key: "f16c"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_F16C = 1ull << 10,
+
+  // BMI1 instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.BMI1[bit 3]
+  // Canonical key: "bmi"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI = 1ull << 11,
+
+  // BMI2 instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.BMI2[bit 8]
+  // Canonical key: "bmi2"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_BMI2 = 1ull << 12,
+
+  // LZCNT instruction is implemented.
+  //
+  // Source: CPUID.80000001H:ECX.LZCNT[bit 5]
+  // Canonical key: "lzcnt"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_LZCNT = 1ull << 13,
+
+  // MOVBE instruction is implemented.
+  //
+  // Source: CPUID.01H:ECX.MOVBE[bit 22]
+  // Canonical key: "movbe"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_MOVBE = 1ull << 14,
+
+  // XSAVE/XRSTOR instructions are implemented.
+  //
+  // Source: CPUID.01H:ECX.XSAVE[bit 26]
+  // Canonical key: "xsave"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_XSAVE = 1ull << 15,
+
+  // AVX-512 Foundation instructions are implemented and enabled by the OS.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX512F[bit 16] + XCR0[7:5]
+  // Canonical key: "avx512f"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512F = 1ull << 16,
+
+  // AVX-512 Conflict Detection instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX512CD[bit 28]
+  // Canonical key: "avx512cd"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512CD = 1ull << 17,
+
+  // AVX-512 Vector Length extensions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX512VL[bit 31]
+  // Canonical key: "avx512vl"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VL = 1ull << 18,
+
+  // AVX-512 Doubleword and Quadword instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX512DQ[bit 17]
+  // Canonical key: "avx512dq"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512DQ = 1ull << 19,
+
+  // AVX-512 Byte and Word instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):EBX.AVX512BW[bit 30]
+  // Canonical key: "avx512bw"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512BW = 1ull << 20,
+
+  // AVX-512 Vector Neural Network instructions are implemented.
+  //
+  // Source: CPUID.(EAX=07H, ECX=0H):ECX.AVX512_VNNI[bit 11]
+  // Canonical key: "avx512vnni"
+  IREE_CPU_DATA_FIELD_0_X86_64_HAVE_AVX512VNNI = 1ull << 21,
+
 };
 
 #endif  // IREE_SCHEMAS_CPU_DATA_H_
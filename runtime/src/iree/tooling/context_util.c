@@ -413,6 +413,10 @@ iree_status_t iree_tooling_resolve_modules(
 //===----------------------------------------------------------------------===//
 
 IREE_FLAG(bool, trace_execution, false, "Traces VM execution to stderr.");
+IREE_FLAG(bool, profile_execution, false,
+          "Profiles VM execution and prints per-function call counts and "
+          "timings to stderr. Requires a runtime built with "
+          "-DIREE_VM_EXECUTION_PROFILING_ENABLE=1.");
 
 iree_status_t iree_tooling_create_instance(iree_allocator_t host_allocator,
                                            iree_vm_instance_t** out_instance) {
@@ -468,6 +472,9 @@ iree_status_t iree_tooling_create_context_from_flags(
     // invocation can have the flag specified to trace.
     flags |= IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION;
   }
+  if (FLAG_profile_execution) {
+    flags |= IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION;
+  }
 
   // Create the context with the full list of resolved modules.
   // The context retains the modules and we can release them afterward.
@@ -506,3 +513,11 @@ iree_status_t iree_tooling_create_context_from_flags(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+iree_status_t iree_tooling_print_context_profile(iree_vm_context_t* context,
+                                                 FILE* file) {
+  IREE_ASSERT_ARGUMENT(context);
+  iree_vm_profile_t* profile = iree_vm_context_profile(context);
+  if (!profile) return iree_ok_status();
+  return iree_vm_profile_fprint(file, profile);
+}
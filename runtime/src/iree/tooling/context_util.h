@@ -7,6 +7,8 @@
 #ifndef IREE_TOOLING_CONTEXT_UTIL_H_
 #define IREE_TOOLING_CONTEXT_UTIL_H_
 
+#include <stdio.h>
+
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
 #include "iree/vm/api.h"
@@ -87,6 +89,11 @@ iree_status_t iree_tooling_create_context_from_flags(
     iree_hal_device_t** out_device,
     iree_hal_allocator_t** out_device_allocator);
 
+// Prints the VM execution profile of |context| to |file| if profiling was
+// requested with --profile_execution. No-op otherwise.
+iree_status_t iree_tooling_print_context_profile(iree_vm_context_t* context,
+                                                 FILE* file);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -476,39 +476,23 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   }
 }
 
-// Issues a populated import call and marshals the results into |dst_reg_list|.
-static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+// Marshals import call |results| from the ABI results buffer into the
+// |dst_reg_list| registers of the caller frame now at the top of the stack.
+static void iree_vm_bytecode_marshal_import_results(
+    iree_vm_stack_t* stack, iree_string_view_t cconv_results,
+    iree_byte_span_t results,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t** out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
-  // Call external function.
-  iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
-  if (iree_status_is_deferred(call_status)) {
-    if (!iree_byte_span_is_empty(call.results)) {
-      iree_status_ignore(call_status);
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "yield in imports with results not supported");
-    }
-    return call_status;  // deferred for future resume
-  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
-    // TODO(benvanik): set execution result to failure/capture stack.
-    return iree_status_annotate(call_status,
-                                iree_make_cstring_view("while calling import"));
-  }
-
-  // NOTE: we don't support yielding within imported functions right now so it's
-  // safe to assume the stack is still valid here. If the called function can
-  // yield then we'll need to requery all pointers here.
+  // The import may have grown the stack (or yielded and been resumed) so we
+  // need to requery all pointers here.
   *out_caller_frame = iree_vm_stack_current_frame(stack);
   *out_caller_registers =
       iree_vm_bytecode_get_register_storage(*out_caller_frame);
 
   // Marshal outputs from the ABI results buffer to registers.
   iree_vm_registers_t caller_registers = *out_caller_registers;
-  uint8_t* IREE_RESTRICT p = call.results.data;
+  uint8_t* IREE_RESTRICT p = results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
        ++i) {
     uint16_t dst_reg = dst_reg_list->registers[i];
@@ -536,7 +520,31 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
         break;
     }
   }
+}
+
+// Issues a populated import call and marshals the results into |dst_reg_list|.
+// If the import yields the results will be marshaled when the caller frame is
+// resumed by iree_vm_bytecode_resume_import_call.
+static iree_status_t iree_vm_bytecode_issue_import_call(
+    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
+    iree_string_view_t cconv_results,
+    const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
+    iree_vm_stack_frame_t** out_caller_frame,
+    iree_vm_registers_t* out_caller_registers) {
+  // Call external function.
+  iree_status_t call_status =
+      call.function.module->begin_call(call.function.module->self, stack, call);
+  if (iree_status_is_deferred(call_status)) {
+    return call_status;  // deferred for future resume
+  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
+    // TODO(benvanik): set execution result to failure/capture stack.
+    return iree_status_annotate(call_status,
+                                iree_make_cstring_view("while calling import"));
+  }
 
+  iree_vm_bytecode_marshal_import_results(stack, cconv_results, call.results,
+                                          dst_reg_list, out_caller_frame,
+                                          out_caller_registers);
   return iree_ok_status();
 }
 
@@ -572,21 +580,17 @@ static iree_status_t iree_vm_bytecode_verify_import(
   return iree_ok_status();
 }
 
-// Calls an imported function from another module.
+// Calls an imported function from another module (or the native
+// implementation of an internal function).
 // Marshals the |src_reg_list| registers into ABI storage and results into
 // |dst_reg_list|.
 static iree_status_t iree_vm_bytecode_call_import(
-    iree_vm_stack_t* stack, const iree_vm_bytecode_module_state_t* module_state,
-    uint32_t import_ordinal, const iree_vm_registers_t caller_registers,
+    iree_vm_stack_t* stack, const iree_vm_bytecode_import_t* import,
+    const iree_vm_registers_t caller_registers,
     const iree_vm_register_list_t* IREE_RESTRICT src_reg_list,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
     iree_vm_stack_frame_t** out_caller_frame,
     iree_vm_registers_t* out_caller_registers) {
-  // Prepare |call| by looking up the import information.
-  const iree_vm_bytecode_import_t* import = NULL;
-  IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(stack, module_state,
-                                                      import_ordinal, &import));
-
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
   call.function = import->function;
@@ -649,6 +653,72 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
                                             out_caller_registers);
 }
 
+// Resumes an import call that previously yielded from |caller_frame|.
+// The caller frame pc is expected to point at the call op that issued the
+// import so that the result registers can be decoded again. On completion the
+// results are marshaled into the caller registers and the caller frame pc is
+// advanced past the call op.
+static iree_status_t iree_vm_bytecode_resume_import_call(
+    iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
+    iree_vm_stack_frame_t* caller_frame, iree_vm_stack_frame_t* callee_frame,
+    iree_vm_stack_frame_t** out_caller_frame,
+    iree_vm_registers_t* out_caller_registers) {
+  const iree_vm_bytecode_module_state_t* module_state =
+      (iree_vm_bytecode_module_state_t*)caller_frame->module_state;
+  const uint8_t* IREE_RESTRICT bytecode_data =
+      module->bytecode_data.data +
+      module->function_descriptor_table[caller_frame->function.ordinal]
+          .bytecode_offset;
+  iree_vm_source_offset_t pc = caller_frame->pc;
+
+  // Decode the call op the same way as the dispatch loop.
+  uint8_t opcode = bytecode_data[pc++];
+  if (IREE_UNLIKELY(opcode != IREE_VM_OP_CORE_Call &&
+                    opcode != IREE_VM_OP_CORE_CallVariadic)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "resumed frame is not suspended in an import call");
+  }
+  int32_t function_ordinal = VM_DecFuncAttr("callee");
+  if (opcode == IREE_VM_OP_CORE_CallVariadic) {
+    VM_DecVariadicOperands("segment_sizes");
+  }
+  VM_DecVariadicOperands("operands");
+  const iree_vm_register_list_t* dst_reg_list =
+      VM_DecVariadicResults("results");
+  const iree_vm_bytecode_import_t* import = NULL;
+  if (function_ordinal & 0x80000000u) {
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(
+        stack, module_state, function_ordinal, &import));
+  } else if (module->native_functions &&
+             module->native_functions[function_ordinal].function.module) {
+    import = &module->native_functions[function_ordinal];
+  } else {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "resumed frame is not suspended in an import call");
+  }
+
+  // Resume the callee with fresh result storage. The storage only needs to
+  // survive until the callee completes and we marshal the results out.
+  iree_byte_span_t results;
+  results.data_length = import->result_buffer_size;
+  results.data = iree_alloca(results.data_length);
+  memset(results.data, 0, results.data_length);
+  iree_status_t call_status = callee_frame->function.module->resume_call(
+      callee_frame->function.module->self, stack, results);
+  if (iree_status_is_deferred(call_status)) {
+    return call_status;  // deferred for future resume
+  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
+    return iree_status_annotate(
+        call_status, iree_make_cstring_view("while resuming import"));
+  }
+
+  iree_vm_bytecode_marshal_import_results(stack, import->results, results,
+                                          dst_reg_list, out_caller_frame,
+                                          out_caller_registers);
+  (*out_caller_frame)->pc = pc;
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // Main interpreter dispatch routine
 //===----------------------------------------------------------------------===//
@@ -678,15 +748,27 @@ iree_status_t iree_vm_bytecode_dispatch_begin(
 iree_status_t iree_vm_bytecode_dispatch_resume(
     iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
     iree_byte_span_t call_results) {
+  // Find the topmost frame belonging to this module. Modules may only import
+  // from modules registered before them in a context and as such all frames of
+  // a module are contiguous on the stack. Any frame above ours is an import
+  // call that yielded and must complete before we can continue.
+  iree_vm_stack_frame_t* callee_frame = NULL;
   iree_vm_stack_frame_t* current_frame = iree_vm_stack_top(stack);
+  while (current_frame &&
+         current_frame->function.module != &module->interface) {
+    callee_frame = current_frame;
+    current_frame = iree_vm_stack_frame_parent(current_frame);
+  }
   if (IREE_UNLIKELY(!current_frame)) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "no frame at top of stack to resume");
   }
   iree_vm_registers_t regs =
       iree_vm_bytecode_get_register_storage(current_frame);
-  // TODO(benvanik): assert the module is at the top of the frame? We should
-  // only be coming in from a call based on the current frame.
+  if (callee_frame) {
+    IREE_RETURN_IF_ERROR(iree_vm_bytecode_resume_import_call(
+        stack, module, current_frame, callee_frame, &current_frame, &regs));
+  }
   return iree_vm_bytecode_dispatch(stack, module, current_frame, regs,
                                    call_results);
 }
@@ -713,6 +795,10 @@ static iree_status_t iree_vm_bytecode_dispatch(
       module->function_descriptor_table[current_frame->function.ordinal]
           .bytecode_offset;
   iree_vm_source_offset_t pc = current_frame->pc;
+#if IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+  iree_atomic_int64_t* profile_op_counts =
+      iree_vm_profile_op_counters(iree_vm_stack_profile(stack));
+#endif  // IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
 
   BEGIN_DISPATCH_CORE() {
     //===------------------------------------------------------------------===//
@@ -1689,6 +1775,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
     });
 
     DISPATCH_OP(CORE, Call, {
+      const iree_vm_source_offset_t call_pc = pc - VM_PC_OFFSET_CORE;
       int32_t function_ordinal = VM_DecFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
           VM_DecVariadicOperands("operands");
@@ -1700,10 +1787,23 @@ static iree_status_t iree_vm_bytecode_dispatch(
       // TODO(benvanik): something more clever than just a high bit?
       int is_import = (function_ordinal & 0x80000000u) != 0;
       if (is_import) {
-        // Call import (and possible yield).
+        // Call import (and possible yield). The frame pc is left at the call op
+        // so that a resume can decode where the results are to be stored.
+        const iree_vm_bytecode_import_t* import = NULL;
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_verify_import(
+            stack, module_state, function_ordinal, &import));
+        current_frame->pc = call_pc;
+        IREE_RETURN_IF_ERROR(iree_vm_bytecode_call_import(
+            stack, import, regs, src_reg_list, dst_reg_list, &current_frame,
+            &regs));
+      } else if (module->native_functions &&
+                 module->native_functions[function_ordinal].function.module) {
+        // Call the native implementation of the function as if it were an
+        // import. See iree_vm_bytecode_module_attach_native_module.
+        current_frame->pc = call_pc;
         IREE_RETURN_IF_ERROR(iree_vm_bytecode_call_import(
-            stack, module_state, function_ordinal, regs, src_reg_list,
-            dst_reg_list, &current_frame, &regs));
+            stack, &module->native_functions[function_ordinal], regs,
+            src_reg_list, dst_reg_list, &current_frame, &regs));
       } else {
         // Switch execution to the target function and continue running in the
         // bytecode dispatcher.
@@ -1720,6 +1820,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP(CORE, CallVariadic, {
       // TODO(benvanik): dedupe with above or merge and always have the seg size
       // list be present (but empty) for non-variadic calls.
+      const iree_vm_source_offset_t call_pc = pc - VM_PC_OFFSET_CORE;
       int32_t function_ordinal = VM_DecFuncAttr("callee");
       const iree_vm_register_list_t* segment_size_list =
           VM_DecVariadicOperands("segment_sizes");
@@ -1727,7 +1828,7 @@ static iree_status_t iree_vm_bytecode_dispatch(
           VM_DecVariadicOperands("operands");
       const iree_vm_register_list_t* dst_reg_list =
           VM_DecVariadicResults("results");
-      current_frame->pc = pc;
+      current_frame->pc = call_pc;
 
       // NOTE: we assume validation has ensured these functions exist.
       // TODO(benvanik): something more clever than just a high bit?
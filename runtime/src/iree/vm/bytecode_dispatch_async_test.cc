@@ -15,6 +15,7 @@
 #include "iree/testing/status_matchers.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module.h"
+#include "iree/vm/native_module.h"
 
 // Compiled module embedded here to avoid file IO:
 #include "iree/vm/test/async_bytecode_modules.h"
@@ -24,6 +25,115 @@ namespace {
 
 using iree::testing::status::StatusIs;
 
+//===----------------------------------------------------------------------===//
+// yieldable_test module
+//===----------------------------------------------------------------------===//
+// Native module providing imports that yield before returning results.
+
+// vm.import @yieldable_test.yield_n(%arg0 : i32, %arg1 : i32) -> i32
+// Yields %arg1 times and then returns %arg0 + %arg1. The native frame has no
+// storage so the in-progress value and remaining yield count are stashed in the
+// frame pc.
+static iree_status_t yieldable_test_yield_n(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_top(stack);
+  uint32_t value = 0;
+  uint32_t remaining = 0;
+  if (flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) {
+    value = (uint32_t)(current_frame->pc & 0xFFFFFFFFu) + 1;
+    remaining = (uint32_t)(current_frame->pc >> 32) - 1;
+  } else {
+    const uint32_t* args = (const uint32_t*)args_storage.data;
+    value = args[0];
+    remaining = args[1];
+  }
+  if (remaining > 0) {
+    current_frame->pc = ((int64_t)remaining << 32) | value;
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  memcpy(rets_storage.data, &value, sizeof(value));
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t yieldable_test_exports_[] = {
+    {iree_make_cstring_view("yield_n"), iree_make_cstring_view("0ii_i"), 0,
+     NULL},
+};
+static const iree_vm_native_function_ptr_t yieldable_test_funcs_[] = {
+    {yieldable_test_yield_n, NULL},
+};
+static_assert(IREE_ARRAYSIZE(yieldable_test_funcs_) ==
+                  IREE_ARRAYSIZE(yieldable_test_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t yieldable_test_descriptor_ = {
+    /*name=*/iree_make_cstring_view("yieldable_test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(yieldable_test_exports_),
+    /*exports=*/yieldable_test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(yieldable_test_funcs_),
+    /*functions=*/yieldable_test_funcs_,
+};
+
+static iree_status_t yieldable_test_module_create(
+    iree_vm_instance_t* instance, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &yieldable_test_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+//===----------------------------------------------------------------------===//
+// native_async_ops module
+//===----------------------------------------------------------------------===//
+// Native module attached to the async_ops bytecode module that implements some
+// of its functions. See iree_vm_bytecode_module_attach_native_module.
+
+// vm.func @async_ops.yield_internal(%arg0 : i32, %arg1 : i32) -> i32
+// Yields %arg1 times and then returns %arg0 + %arg1 like yield_n.
+static const iree_vm_native_export_descriptor_t native_async_ops_exports_[] = {
+    {iree_make_cstring_view("yield_internal"), iree_make_cstring_view("0ii_i"),
+     0, NULL},
+};
+static const iree_vm_native_function_ptr_t native_async_ops_funcs_[] = {
+    {yieldable_test_yield_n, NULL},
+};
+static_assert(IREE_ARRAYSIZE(native_async_ops_funcs_) ==
+                  IREE_ARRAYSIZE(native_async_ops_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t native_async_ops_descriptor_ = {
+    /*name=*/iree_make_cstring_view("native_async_ops"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(native_async_ops_exports_),
+    /*exports=*/native_async_ops_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(native_async_ops_funcs_),
+    /*functions=*/native_async_ops_funcs_,
+};
+
+static iree_status_t native_async_ops_module_create(
+    iree_vm_instance_t* instance, iree_allocator_t allocator,
+    iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &native_async_ops_descriptor_,
+                                      instance, allocator, out_module);
+}
+
 class VMBytecodeDispatchAsyncTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -38,7 +148,16 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
                                file->size},
         iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
 
-    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    IREE_CHECK_OK(yieldable_test_module_create(
+        instance_, iree_allocator_system(), &native_module_));
+
+    IREE_CHECK_OK(native_async_ops_module_create(
+        instance_, iree_allocator_system(), &attached_module_));
+    IREE_CHECK_OK(iree_vm_bytecode_module_attach_native_module(
+        bytecode_module_, attached_module_));
+
+    std::vector<iree_vm_module_t*> modules = {native_module_, attached_module_,
+                                              bytecode_module_};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
         instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
         iree_allocator_system(), &context_));
@@ -47,6 +166,8 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
   void TearDown() override {
     IREE_TRACE_SCOPE();
     iree_vm_module_release(bytecode_module_);
+    iree_vm_module_release(attached_module_);
+    iree_vm_module_release(native_module_);
     iree_vm_context_release(context_);
     iree_vm_instance_release(instance_);
   }
@@ -54,6 +175,9 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
   iree_vm_module_t* bytecode_module_ = nullptr;
+  iree_vm_module_t* native_module_ = nullptr;
+  // Attached to |bytecode_module_| and implements @yield_internal.
+  iree_vm_module_t* attached_module_ = nullptr;
 };
 
 // Tests a simple straight-line yield sequence that requires 3 resumes.
@@ -152,5 +276,101 @@ TEST_F(VMBytecodeDispatchAsyncTest, YieldDivergent) {
   iree_vm_stack_deinitialize(stack);
 }
 
+// Tests calling an import that yields and returns results.
+// See iree/vm/test/async_ops.mlir > @call_yield_import
+TEST_F(VMBytecodeDispatchAsyncTest, CallYieldImport) {
+  IREE_TRACE_SCOPE();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("call_yield_import"), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  uint32_t arg_value = 97;
+  uint32_t ret_value = 0;
+
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(&arg_value, sizeof(arg_value));
+  call.results = iree_make_byte_span(&ret_value, sizeof(ret_value));
+
+  // 0/3
+  ASSERT_THAT(function.module->begin_call(function.module->self, stack, call),
+              StatusIs(StatusCode::kDeferred));
+
+  // 1/3
+  ASSERT_THAT(
+      function.module->resume_call(function.module->self, stack, call.results),
+      StatusIs(StatusCode::kDeferred));
+
+  // 2/3
+  ASSERT_THAT(
+      function.module->resume_call(function.module->self, stack, call.results),
+      StatusIs(StatusCode::kDeferred));
+
+  // 3/3
+  IREE_ASSERT_OK(
+      function.module->resume_call(function.module->self, stack, call.results));
+
+  ASSERT_EQ(ret_value, arg_value + 3 + 1);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests calling an internal function that dispatches to its attached native
+// implementation which yields and returns results. The bytecode version would
+// complete without yielding.
+// See iree/vm/test/async_ops.mlir > @call_yield_internal
+TEST_F(VMBytecodeDispatchAsyncTest, CallYieldNativeInternal) {
+  IREE_TRACE_SCOPE();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("call_yield_internal"), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  uint32_t arg_value = 97;
+  uint32_t ret_value = 0;
+
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(&arg_value, sizeof(arg_value));
+  call.results = iree_make_byte_span(&ret_value, sizeof(ret_value));
+
+  // 0/3
+  ASSERT_THAT(function.module->begin_call(function.module->self, stack, call),
+              StatusIs(StatusCode::kDeferred));
+  iree_vm_stack_frame_t* native_frame = iree_vm_stack_current_frame(stack);
+  ASSERT_NE(nullptr, native_frame);
+  EXPECT_EQ(IREE_VM_STACK_FRAME_NATIVE, native_frame->type);
+  EXPECT_EQ(attached_module_, native_frame->function.module);
+
+  // 1/3
+  ASSERT_THAT(
+      function.module->resume_call(function.module->self, stack, call.results),
+      StatusIs(StatusCode::kDeferred));
+
+  // 2/3
+  ASSERT_THAT(
+      function.module->resume_call(function.module->self, stack, call.results),
+      StatusIs(StatusCode::kDeferred));
+
+  // 3/3
+  IREE_ASSERT_OK(
+      function.module->resume_call(function.module->self, stack, call.results));
+
+  ASSERT_EQ(ret_value, arg_value + 3 + 1);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
 }  // namespace
 }  // namespace iree
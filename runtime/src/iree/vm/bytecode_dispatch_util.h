@@ -140,6 +140,18 @@ static inline const iree_vm_type_def_t* iree_vm_map_type(
 #define IREE_DISPATCH_TRACE_INSTRUCTION(...)
 #endif  // IREE_VM_EXECUTION_TRACING_ENABLE
 
+#if IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+#define IREE_DISPATCH_PROFILE_INSTRUCTION(ext, op_name)           \
+  if (profile_op_counts) {                                        \
+    iree_atomic_fetch_add_int64(                                  \
+        &profile_op_counts[IREE_VM_PROFILE_OP_TABLE_##ext * 256 + \
+                           IREE_VM_OP_##ext##_##op_name],         \
+        1, iree_memory_order_relaxed);                            \
+  }
+#else
+#define IREE_DISPATCH_PROFILE_INSTRUCTION(...)
+#endif  // IREE_VM_EXECUTION_PROFILING_OPS_ENABLE
+
 #if defined(IREE_COMPILER_MSVC) && !defined(IREE_COMPILER_CLANG)
 #define IREE_DISPATCH_MODE_SWITCH 1
 #else
@@ -346,6 +358,7 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
 #define DISPATCH_OP(ext, op_name, body)                          \
   _dispatch_##ext##_##op_name:;                                  \
   IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name); \
+  IREE_DISPATCH_PROFILE_INSTRUCTION(ext, op_name);               \
   body;                                                          \
   goto* kDispatchTable_CORE[bytecode_data[pc++]];
 
@@ -382,6 +395,7 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
 #define DISPATCH_OP(ext, op_name, body)                            \
   case IREE_VM_OP_##ext##_##op_name: {                             \
     IREE_DISPATCH_TRACE_INSTRUCTION(VM_PC_OFFSET_##ext, #op_name); \
+    IREE_DISPATCH_PROFILE_INSTRUCTION(ext, op_name);               \
     body;                                                          \
   } break;
 
@@ -299,6 +299,25 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
     }
   }
 
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module_def);
+  if (module_state_def) {
+    int32_t global_ref_count =
+        iree_vm_ModuleStateDef_global_ref_count(module_state_def);
+    flatbuffers_int32_vec_t immutable_ordinals =
+        iree_vm_ModuleStateDef_immutable_global_ref_ordinals(module_state_def);
+    for (size_t i = 0; i < flatbuffers_int32_vec_len(immutable_ordinals);
+         ++i) {
+      int32_t ordinal = flatbuffers_int32_vec_at(immutable_ordinals, i);
+      if (ordinal < 0 || ordinal >= global_ref_count) {
+        return iree_make_status(
+            IREE_STATUS_INVALID_ARGUMENT,
+            "immutable_global_ref_ordinals[%zu] out of bounds (0 < %d < %d)",
+            i, ordinal, global_ref_count);
+      }
+    }
+  }
+
   iree_vm_ModuleDependencyDef_vec_t dependencies =
       iree_vm_BytecodeModuleDef_dependencies(module_def);
   for (size_t i = 0; i < iree_vm_ModuleDependencyDef_vec_len(dependencies);
@@ -452,6 +471,11 @@ static void iree_vm_bytecode_module_destroy(void* self) {
   iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_allocator_free(module->allocator, module->native_functions);
+  module->native_functions = NULL;
+  iree_vm_module_release(module->native_module);
+  module->native_module = NULL;
+
   module->def = NULL;
   iree_allocator_free(module->archive_allocator,
                       (void*)module->archive_contents.data);
@@ -992,6 +1016,75 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   return iree_ok_status();
 }
 
+static iree_status_t iree_vm_bytecode_module_fork_state(
+    void* self, iree_vm_module_state_t* source_module_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  IREE_ASSERT_ARGUMENT(source_module_state);
+  IREE_ASSERT_ARGUMENT(out_module_state);
+  *out_module_state = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
+  iree_vm_bytecode_module_state_t* source_state =
+      (iree_vm_bytecode_module_state_t*)source_module_state;
+
+  // Mutable ref globals may reference objects the program modifies in place
+  // (lists, buffers, etc) and there's no generic way to clone them. If any are
+  // set the program must be initialized again to get its own; unset ones are
+  // left unset in the fork.
+  iree_vm_ModuleStateDef_table_t module_state_def =
+      iree_vm_BytecodeModuleDef_module_state(module->def);
+  flatbuffers_int32_vec_t immutable_ordinals =
+      module_state_def
+          ? iree_vm_ModuleStateDef_immutable_global_ref_ordinals(
+                module_state_def)
+          : NULL;
+  iree_host_size_t immutable_count =
+      flatbuffers_int32_vec_len(immutable_ordinals);
+  iree_host_size_t set_mutable_count = 0;
+  for (iree_host_size_t i = 0; i < source_state->global_ref_count; ++i) {
+    if (source_state->global_ref_table[i].ptr) ++set_mutable_count;
+  }
+  for (iree_host_size_t i = 0; i < immutable_count; ++i) {
+    int32_t ordinal = flatbuffers_int32_vec_at(immutable_ordinals, i);
+    if (source_state->global_ref_table[ordinal].ptr) --set_mutable_count;
+  }
+  if (set_mutable_count > 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "%" PRIhsz " mutable ref globals are set and cannot be shared",
+        set_mutable_count);
+  }
+
+  // Allocate a fresh state with the same layout; rodata references point
+  // directly at the module FlatBuffer and are shared by construction.
+  iree_vm_module_state_t* module_state = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_bytecode_module_alloc_state(self, allocator, &module_state));
+  iree_vm_bytecode_module_state_t* state =
+      (iree_vm_bytecode_module_state_t*)module_state;
+
+  // Primitive globals are copied such that each context can mutate its own.
+  memcpy(state->rwdata_storage.data, source_state->rwdata_storage.data,
+         state->rwdata_storage.data_length);
+
+  // Immutable ref globals are retained such that the objects they reference
+  // (executables, constant buffers, etc) are shared across all contexts.
+  for (iree_host_size_t i = 0; i < immutable_count; ++i) {
+    int32_t ordinal = flatbuffers_int32_vec_at(immutable_ordinals, i);
+    iree_vm_ref_retain(&source_state->global_ref_table[ordinal],
+                       &state->global_ref_table[ordinal]);
+  }
+
+  // NOTE: imports are not copied as they are resolved against the module
+  // states of the new context.
+
+  *out_module_state = module_state;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static void iree_vm_bytecode_module_free_state(
     void* self, iree_vm_module_state_t* module_state) {
   if (!module_state) return;
@@ -1016,6 +1109,11 @@ static void iree_vm_bytecode_module_free_state(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t iree_vm_bytecode_import_initialize(
+    const iree_vm_function_t* function,
+    const iree_vm_function_signature_t* signature,
+    iree_vm_bytecode_import_t* import);
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -1029,7 +1127,14 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
                             ordinal, state->import_count);
   }
 
-  iree_vm_bytecode_import_t* import = &state->import_table[ordinal];
+  return iree_vm_bytecode_import_initialize(
+      function, signature, &state->import_table[ordinal]);
+}
+
+static iree_status_t iree_vm_bytecode_import_initialize(
+    const iree_vm_function_t* function,
+    const iree_vm_function_signature_t* signature,
+    iree_vm_bytecode_import_t* import) {
   import->function = *function;
 
   // Split up arguments/results into fragments so that we can avoid scanning
@@ -1050,9 +1155,10 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
       import->results, /*segment_size_list=*/NULL, &result_buffer_size));
   if (argument_buffer_size > 16 * 1024 || result_buffer_size > 16 * 1024) {
+    iree_string_view_t name = iree_vm_function_name(function);
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "ABI marshaling buffer overflow on import %zu",
-                            ordinal);
+                            "ABI marshaling buffer overflow on import `%.*s`",
+                            (int)name.size, name.data);
   }
   import->argument_buffer_size = (uint16_t)argument_buffer_size;
   import->result_buffer_size = (uint16_t)result_buffer_size;
@@ -1079,6 +1185,15 @@ static iree_status_t iree_vm_bytecode_module_begin_call(
   IREE_RETURN_IF_ERROR(iree_vm_bytecode_map_internal_ordinal(
       module, call.function, &internal_ordinal, &signature_def));
 
+  // Route to the native implementation of the function, if any. The native
+  // module will push its own frame and handle any resumes.
+  if (module->native_functions &&
+      module->native_functions[internal_ordinal].function.module) {
+    call.function = module->native_functions[internal_ordinal].function;
+    return call.function.module->begin_call(call.function.module->self, stack,
+                                            call);  // tail
+  }
+
   call.function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
   call.function.ordinal = internal_ordinal;
 
@@ -1118,6 +1233,88 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_attach_native_module(
+    iree_vm_module_t* base_module, iree_vm_module_t* native_module) {
+  IREE_ASSERT_ARGUMENT(base_module);
+  IREE_ASSERT_ARGUMENT(native_module);
+  if (base_module->begin_call != iree_vm_bytecode_module_begin_call) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "native modules can only be attached to bytecode "
+                            "modules");
+  }
+  iree_vm_bytecode_module_t* module =
+      (iree_vm_bytecode_module_t*)base_module->self;
+  if (module->native_module) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "a native module has already been attached");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_bytecode_import_t* native_functions = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(
+              module->allocator,
+              module->function_descriptor_count * sizeof(*native_functions),
+              (void**)&native_functions));
+
+  // Match each export by name and calling convention. Exports that don't match
+  // are left to execute as bytecode.
+  iree_host_size_t native_function_count = 0;
+  iree_status_t status = iree_ok_status();
+  iree_vm_ExportFunctionDef_vec_t exported_functions =
+      iree_vm_BytecodeModuleDef_exported_functions(module->def);
+  for (iree_host_size_t i = 0;
+       i < iree_vm_ExportFunctionDef_vec_len(exported_functions); ++i) {
+    iree_vm_function_t export_function;
+    iree_string_view_t export_name = iree_string_view_empty();
+    iree_vm_function_signature_t export_signature;
+    status = iree_vm_bytecode_module_get_function(
+        module, IREE_VM_FUNCTION_LINKAGE_EXPORT, i, &export_function,
+        &export_name, &export_signature);
+    uint16_t internal_ordinal = 0;
+    if (iree_status_is_ok(status)) {
+      status = iree_vm_bytecode_map_internal_ordinal(module, export_function,
+                                                     &internal_ordinal, NULL);
+    }
+    if (!iree_status_is_ok(status)) break;
+
+    iree_vm_function_t native_function;
+    iree_status_t lookup_status = iree_vm_module_lookup_function_by_name(
+        native_module, IREE_VM_FUNCTION_LINKAGE_EXPORT, export_name,
+        &native_function);
+    if (iree_status_is_not_found(lookup_status)) {
+      iree_status_ignore(lookup_status);
+      continue;
+    } else if (!iree_status_is_ok(lookup_status)) {
+      status = lookup_status;
+      break;
+    }
+    iree_vm_function_signature_t native_signature =
+        iree_vm_function_signature(&native_function);
+    if (!iree_string_view_equal(export_signature.calling_convention,
+                                native_signature.calling_convention)) {
+      continue;
+    }
+
+    status = iree_vm_bytecode_import_initialize(
+        &native_function, &native_signature,
+        &native_functions[internal_ordinal]);
+    if (!iree_status_is_ok(status)) break;
+    ++native_function_count;
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (int64_t)native_function_count);
+
+  if (iree_status_is_ok(status) && native_function_count > 0) {
+    module->native_module = native_module;
+    iree_vm_module_retain(native_module);
+    module->native_functions = native_functions;
+  } else {
+    iree_allocator_free(module->allocator, native_functions);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
@@ -1205,6 +1402,7 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
 #endif  // IREE_VM_BACKTRACE_ENABLE
   module->interface.alloc_state = iree_vm_bytecode_module_alloc_state;
   module->interface.free_state = iree_vm_bytecode_module_free_state;
+  module->interface.fork_state = iree_vm_bytecode_module_fork_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.notify = iree_vm_bytecode_module_notify;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
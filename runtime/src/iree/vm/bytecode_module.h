@@ -25,6 +25,22 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Attaches |native_module| as the native implementation of |module| exports.
+// Each export of |module| that |native_module| also exports with the same name
+// and calling convention will be dispatched natively when called externally and
+// when called from bytecode within |module|. All other functions continue to
+// execute as bytecode.
+//
+// |native_module| is expected to have been generated from the same source (for
+// example with the C module target) restricted to the hot functions and must be
+// registered in every context that |module| is registered in. Module state is
+// not shared between the two and native functions must not rely on mutable
+// globals also used by bytecode functions.
+//
+// Must be called prior to |module| being registered in any context.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_attach_native_module(
+    iree_vm_module_t* module, iree_vm_module_t* native_module);
+
 // Parses the module archive header in |archive_contents|.
 // The subrange containing the FlatBuffer data is returned as well as the
 // offset where external rodata begins. Note that archives may have
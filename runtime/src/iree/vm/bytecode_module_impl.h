@@ -83,6 +83,15 @@ typedef struct iree_vm_bytecode_module_t {
   // Loaded FlatBuffer module pointing into the archive contents.
   iree_vm_BytecodeModuleDef_table_t def;
 
+  // Optional native module providing implementations of exported functions.
+  // See iree_vm_bytecode_module_attach_native_module.
+  iree_vm_module_t* native_module;
+
+  // Native function table mapped 1:1 with internal functions or NULL if no
+  // native module is attached. Entries with a NULL function module have no
+  // native implementation and are executed as bytecode.
+  struct iree_vm_bytecode_import_t* native_functions;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
@@ -10,10 +10,378 @@
 
 #include "iree/vm/bytecode_module.h"
 
+#include "iree/base/status_cc.h"
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/native_module.h"
+#include "iree/vm/ref_cc.h"
 
+// Compiled module embedded here to avoid file IO:
+#include "iree/vm/test/async_bytecode_modules.h"
+#include "iree/vm/test/fork_bytecode_modules.h"
+
+namespace iree {
 namespace {
 
+using iree::testing::status::StatusIs;
+
 // TODO(benvanik): bytecode_module_test.cc for FlatBuffer/module implementation.
 
+//===----------------------------------------------------------------------===//
+// Attached native modules
+//===----------------------------------------------------------------------===//
+
+// Native implementation of async_ops.yield_sequence(i32) -> i32 that completes
+// synchronously and returns a distinct value so tests can tell it ran.
+static iree_status_t native_yield_sequence(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  uint32_t value = 0;
+  memcpy(&value, args_storage.data, sizeof(value));
+  value += 1000;
+  memcpy(rets_storage.data, &value, sizeof(value));
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t native_async_ops_exports_[] = {
+    // Matches the bytecode export and will be dispatched natively.
+    {iree_make_cstring_view("yield_sequence"), iree_make_cstring_view("0i_i"),
+     0, NULL},
+    // Calling convention mismatch with the bytecode export; ignored.
+    {iree_make_cstring_view("yield_divergent"), iree_make_cstring_view("0i_i"),
+     0, NULL},
+};
+static const iree_vm_native_function_ptr_t native_async_ops_funcs_[] = {
+    {native_yield_sequence, NULL},
+    {native_yield_sequence, NULL},
+};
+static_assert(IREE_ARRAYSIZE(native_async_ops_funcs_) ==
+                  IREE_ARRAYSIZE(native_async_ops_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t native_async_ops_descriptor_ = {
+    /*name=*/iree_make_cstring_view("native_async_ops"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(native_async_ops_exports_),
+    /*exports=*/native_async_ops_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(native_async_ops_funcs_),
+    /*functions=*/native_async_ops_funcs_,
+};
+
+// Native implementation of the yieldable_test.yield_n(i32, i32) -> i32 import
+// required by the async test module. Results match the yielding version used
+// in bytecode_dispatch_async_test.cc but are produced without suspending.
+static iree_status_t native_yield_n(iree_vm_stack_t* stack,
+                                    iree_vm_native_function_flags_t flags,
+                                    iree_byte_span_t args_storage,
+                                    iree_byte_span_t rets_storage,
+                                    iree_vm_native_function_target_t target_fn,
+                                    void* module, void* module_state) {
+  uint32_t args[2] = {0, 0};
+  memcpy(args, args_storage.data, sizeof(args));
+  uint32_t value = args[0] + args[1];
+  memcpy(rets_storage.data, &value, sizeof(value));
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t yieldable_test_exports_[] = {
+    {iree_make_cstring_view("yield_n"), iree_make_cstring_view("0ii_i"), 0,
+     NULL},
+};
+static const iree_vm_native_function_ptr_t yieldable_test_funcs_[] = {
+    {native_yield_n, NULL},
+};
+static_assert(IREE_ARRAYSIZE(yieldable_test_funcs_) ==
+                  IREE_ARRAYSIZE(yieldable_test_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t yieldable_test_descriptor_ = {
+    /*name=*/iree_make_cstring_view("yieldable_test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(yieldable_test_exports_),
+    /*exports=*/yieldable_test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(yieldable_test_funcs_),
+    /*functions=*/yieldable_test_funcs_,
+};
+
+class VMBytecodeModuleNativeTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_TRACE_SCOPE();
+    const iree_file_toc_t* file = async_bytecode_modules_c_create();
+
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
+                               file->size},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
+
+    iree_vm_module_t interface;
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    IREE_CHECK_OK(iree_vm_native_module_create(
+        &interface, &native_async_ops_descriptor_, instance_,
+        iree_allocator_system(), &native_module_));
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    IREE_CHECK_OK(iree_vm_native_module_create(
+        &interface, &yieldable_test_descriptor_, instance_,
+        iree_allocator_system(), &import_module_));
+  }
+
+  void TearDown() override {
+    IREE_TRACE_SCOPE();
+    iree_vm_context_release(context_);
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_module_release(native_module_);
+    iree_vm_module_release(import_module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  void CreateContext() {
+    std::vector<iree_vm_module_t*> modules = {import_module_, native_module_,
+                                              bytecode_module_};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_));
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+  iree_vm_module_t* native_module_ = nullptr;
+  // Provides the yieldable_test imports required by the bytecode module.
+  iree_vm_module_t* import_module_ = nullptr;
+};
+
+// Tests that matching exports dispatch to the attached native module.
+TEST_F(VMBytecodeModuleNativeTest, AttachedExportRunsNatively) {
+  IREE_TRACE_SCOPE();
+  IREE_ASSERT_OK(iree_vm_bytecode_module_attach_native_module(bytecode_module_,
+                                                              native_module_));
+  CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("yield_sequence"), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  uint32_t arg_value = 97;
+  uint32_t ret_value = 0;
+
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(&arg_value, sizeof(arg_value));
+  call.results = iree_make_byte_span(&ret_value, sizeof(ret_value));
+
+  // The bytecode version yields 3 times; the native one completes immediately.
+  IREE_ASSERT_OK(
+      function.module->begin_call(function.module->self, stack, call));
+  ASSERT_EQ(ret_value, arg_value + 1000);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that exports with mismatched signatures continue to run as bytecode.
+TEST_F(VMBytecodeModuleNativeTest, MismatchedExportRunsBytecode) {
+  IREE_TRACE_SCOPE();
+  IREE_ASSERT_OK(iree_vm_bytecode_module_attach_native_module(bytecode_module_,
+                                                              native_module_));
+  CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("yield_divergent"), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  uint32_t arg_values[3] = {1, 100, 200};
+  uint32_t ret_value = 0;
+
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(arg_values, sizeof(arg_values));
+  call.results = iree_make_byte_span(&ret_value, sizeof(ret_value));
+
+  ASSERT_THAT(function.module->begin_call(function.module->self, stack, call),
+              StatusIs(StatusCode::kDeferred));
+  IREE_ASSERT_OK(
+      function.module->resume_call(function.module->self, stack, call.results));
+  ASSERT_EQ(ret_value, arg_values[1]);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that exports without a native match still resolve and call imports.
+TEST_F(VMBytecodeModuleNativeTest, UnmatchedExportCallsImport) {
+  IREE_TRACE_SCOPE();
+  IREE_ASSERT_OK(iree_vm_bytecode_module_attach_native_module(bytecode_module_,
+                                                              native_module_));
+  CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("call_yield_import"), &function));
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_CONTEXT_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context_),
+                                  iree_allocator_system());
+
+  uint32_t arg_value = 97;
+  uint32_t ret_value = 0;
+
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = iree_make_byte_span(&arg_value, sizeof(arg_value));
+  call.results = iree_make_byte_span(&ret_value, sizeof(ret_value));
+
+  // The test import completes synchronously so no resumes are required.
+  IREE_ASSERT_OK(
+      function.module->begin_call(function.module->self, stack, call));
+  ASSERT_EQ(ret_value, arg_value + 3 + 1);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that only bytecode modules accept attached native modules.
+TEST_F(VMBytecodeModuleNativeTest, AttachToNativeModuleFails) {
+  IREE_TRACE_SCOPE();
+  EXPECT_THAT(iree_vm_bytecode_module_attach_native_module(native_module_,
+                                                           native_module_),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+//===----------------------------------------------------------------------===//
+// Forked module state
+//===----------------------------------------------------------------------===//
+
+class VMBytecodeModuleForkTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_TRACE_SCOPE();
+    const iree_file_toc_t* file = fork_bytecode_modules_c_create();
+
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    iree_vm_module_t* bytecode_module = nullptr;
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        instance_,
+        iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
+                               file->size},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module));
+
+    std::vector<iree_vm_module_t*> modules = {bytecode_module};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        iree_allocator_system(), &context_));
+    iree_vm_module_release(bytecode_module);
+  }
+
+  void TearDown() override {
+    IREE_TRACE_SCOPE();
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  StatusOr<int32_t> RunFunction(iree_vm_context_t* context,
+                                const char* function_name) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(iree_vm_context_resolve_function(
+        context, iree_make_cstring_view(function_name), &function));
+    vm::ref<iree_vm_list_t> output_list;
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(
+        /*element_type=*/nullptr, 1, iree_allocator_system(), &output_list));
+    IREE_RETURN_IF_ERROR(iree_vm_invoke(
+        context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        /*inputs=*/nullptr, output_list.get(), iree_allocator_system()));
+    iree_vm_value_t ret0_value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value(output_list.get(), 0, &ret0_value));
+    return ret0_value.i32;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+};
+
+// Tests that forks share initialized immutable globals and copy primitives.
+TEST_F(VMBytecodeModuleForkTest, SharesImmutableState) {
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0,
+                            RunFunction(context_, "fork_ops.increment"));
+  ASSERT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+
+  // Initializers are not run again but the fork observes their results.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t has_shared,
+                            RunFunction(forked_context, "fork_ops.has_shared"));
+  EXPECT_EQ(has_shared, 1);
+
+  // Primitive globals start from the source value and then diverge.
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v1,
+                            RunFunction(forked_context, "fork_ops.increment"));
+  EXPECT_EQ(v1, 2);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v2,
+                            RunFunction(forked_context, "fork_ops.increment"));
+  EXPECT_EQ(v2, 3);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v3,
+                            RunFunction(context_, "fork_ops.increment"));
+  EXPECT_EQ(v3, 2);
+
+  // Mutable ref globals set in the fork are not visible to the source.
+  IREE_ASSERT_OK(RunFunction(forked_context, "fork_ops.set_scratch").status());
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t has_scratch,
+                            RunFunction(context_, "fork_ops.has_scratch"));
+  EXPECT_EQ(has_scratch, 0);
+
+  iree_vm_context_release(forked_context);
+}
+
+// Tests that a source state holding mutable refs is not shared and the fork is
+// initialized from scratch instead.
+TEST_F(VMBytecodeModuleForkTest, ReinitializesMutableState) {
+  IREE_ASSERT_OK(RunFunction(context_, "fork_ops.increment").status());
+  IREE_ASSERT_OK(RunFunction(context_, "fork_ops.set_scratch").status());
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t has_scratch, RunFunction(forked_context, "fork_ops.has_scratch"));
+  EXPECT_EQ(has_scratch, 0);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t has_shared,
+                            RunFunction(forked_context, "fork_ops.has_shared"));
+  EXPECT_EQ(has_shared, 1);
+  IREE_ASSERT_OK_AND_ASSIGN(int32_t v0,
+                            RunFunction(forked_context, "fork_ops.increment"));
+  EXPECT_EQ(v0, 1);
+
+  iree_vm_context_release(forked_context);
+}
+
 }  // namespace
+}  // namespace iree
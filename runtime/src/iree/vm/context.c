@@ -32,6 +32,12 @@ struct iree_vm_context_t {
   // Configuration flags.
   iree_vm_context_flags_t flags;
 
+  // Execution profile, if IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION is set.
+  iree_vm_profile_t* profile;
+
+  // Largest stack high-water mark of any invocation made on the context.
+  iree_atomic_intptr_t stack_high_water_mark;
+
   struct {
     iree_host_size_t count;
     iree_host_size_t capacity;
@@ -41,6 +47,9 @@ struct iree_vm_context_t {
 };
 
 static void iree_vm_context_destroy(iree_vm_context_t* context);
+static iree_status_t iree_vm_context_register_modules_with_states(
+    iree_vm_context_t* context, iree_host_size_t module_count,
+    iree_vm_module_t** modules, iree_vm_module_state_t** source_states);
 
 // Allocates a process-unique ID for a context to use.
 static iree_vm_context_id_t iree_vm_context_allocate_id(void) {
@@ -295,14 +304,25 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create(
       out_context);
 }
 
-IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+// Allocates a context with static storage for |module_count| modules.
+// No modules are registered.
+static iree_status_t iree_vm_context_allocate(
     iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
-    iree_host_size_t module_count, iree_vm_module_t** modules,
-    iree_allocator_t allocator, iree_vm_context_t** out_context) {
+    iree_host_size_t module_count, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_ASSERT_ARGUMENT(out_context);
   *out_context = NULL;
 
+#if !IREE_VM_EXECUTION_PROFILING_ENABLE
+  if (flags & IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_UNAVAILABLE,
+        "execution profiling requested but not compiled into this build; "
+        "define IREE_VM_EXECUTION_PROFILING_ENABLE=1 to enable");
+  }
+#endif  // !IREE_VM_EXECUTION_PROFILING_ENABLE
+
   iree_host_size_t context_size =
       sizeof(iree_vm_context_t) + sizeof(iree_vm_module_t*) * module_count +
       sizeof(iree_vm_module_state_t*) * module_count;
@@ -321,6 +341,8 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->is_frozen = module_count > 0;
   context->is_static = module_count > 0;
   context->flags = flags;
+  iree_atomic_store_intptr(&context->stack_high_water_mark, 0,
+                           iree_memory_order_relaxed);
 
   uint8_t* p = (uint8_t*)context + sizeof(iree_vm_context_t);
   context->list.modules = (iree_vm_module_t**)p;
@@ -330,6 +352,34 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   context->list.count = 0;
   context->list.capacity = module_count;
 
+  if (flags & IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION) {
+    iree_status_t profile_status =
+        iree_vm_profile_allocate(allocator, &context->profile);
+    if (!iree_status_is_ok(profile_status)) {
+      iree_vm_context_destroy(context);
+      IREE_TRACE_ZONE_END(z0);
+      return profile_status;
+    }
+  }
+
+  *out_context = context;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
+    iree_vm_instance_t* instance, iree_vm_context_flags_t flags,
+    iree_host_size_t module_count, iree_vm_module_t** modules,
+    iree_allocator_t allocator, iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(instance, flags, module_count, allocator,
+                                   &context));
+
   iree_status_t register_status =
       iree_vm_context_register_modules(context, module_count, modules);
   if (!iree_status_is_ok(register_status)) {
@@ -343,6 +393,37 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    const iree_vm_context_t* source_context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(source_context);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_context_t* context = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_context_allocate(source_context->instance,
+                                   source_context->flags,
+                                   source_context->list.count, allocator,
+                                   &context));
+
+  // Modules are registered in the same order as the source such that imports
+  // resolve identically.
+  iree_status_t register_status = iree_vm_context_register_modules_with_states(
+      context, source_context->list.count, source_context->list.modules,
+      source_context->list.module_states);
+  if (!iree_status_is_ok(register_status)) {
+    iree_vm_context_destroy(context);
+    IREE_TRACE_ZONE_END(z0);
+    return register_status;
+  }
+
+  *out_context = context;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static void iree_vm_context_destroy(iree_vm_context_t* context) {
   if (!context) return;
 
@@ -361,6 +442,9 @@ static void iree_vm_context_destroy(iree_vm_context_t* context) {
     context->list.module_states = NULL;
   }
 
+  iree_vm_profile_free(context->profile);
+  context->profile = NULL;
+
   iree_vm_instance_release(context->instance);
   context->instance = NULL;
 
@@ -395,9 +479,49 @@ iree_vm_context_flags(const iree_vm_context_t* context) {
   return context->flags;
 }
 
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_context_profile(
+    const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return context->profile;
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_context_stack_high_water_mark(const iree_vm_context_t* context) {
+  IREE_ASSERT_ARGUMENT(context);
+  return (iree_host_size_t)iree_atomic_load_intptr(
+      (iree_atomic_intptr_t*)&context->stack_high_water_mark,
+      iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT void iree_vm_context_record_stack_high_water_mark(
+    iree_vm_context_t* context, iree_host_size_t high_water_mark) {
+  IREE_ASSERT_ARGUMENT(context);
+  // relaxed because we only care about the maximum value, not ordering w.r.t.
+  // other memory accesses.
+  intptr_t current = iree_atomic_load_intptr(&context->stack_high_water_mark,
+                                             iree_memory_order_relaxed);
+  while ((intptr_t)high_water_mark > current &&
+         !iree_atomic_compare_exchange_weak_intptr(
+             &context->stack_high_water_mark, &current,
+             (intptr_t)high_water_mark, iree_memory_order_relaxed,
+             iree_memory_order_relaxed)) {
+    // current was reloaded by the failed exchange; retry if still smaller.
+  }
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
     iree_vm_context_t* context, iree_host_size_t module_count,
     iree_vm_module_t** modules) {
+  return iree_vm_context_register_modules_with_states(
+      context, module_count, modules, /*source_states=*/NULL);
+}
+
+// Registers |modules| with |context|. If |source_states| is provided then each
+// module that supports forking has its state forked from the corresponding
+// source state and its initializer is not run again.
+static iree_status_t iree_vm_context_register_modules_with_states(
+    iree_vm_context_t* context, iree_host_size_t module_count,
+    iree_vm_module_t** modules, iree_vm_module_state_t** source_states) {
   IREE_ASSERT_ARGUMENT(context);
   if (!modules && module_count > 1) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
@@ -472,10 +596,23 @@ IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
 
     iree_vm_module_retain(module);
 
-    // Allocate module state.
+    // Allocate module state, forking it from the source when possible.
     iree_vm_module_state_t* module_state = NULL;
-    status =
-        module->alloc_state(module->self, context->allocator, &module_state);
+    bool is_forked = source_states && module->fork_state;
+    if (is_forked) {
+      status = module->fork_state(module->self, source_states[i],
+                                  context->allocator, &module_state);
+      if (iree_status_is_unavailable(status)) {
+        // Module state cannot be shared; allocate and initialize a new one.
+        iree_status_ignore(status);
+        status = iree_ok_status();
+        is_forked = false;
+      }
+    }
+    if (!is_forked && iree_status_is_ok(status)) {
+      status =
+          module->alloc_state(module->self, context->allocator, &module_state);
+    }
     if (!iree_status_is_ok(status)) {
       // Cleanup handled below.
       break;
@@ -496,6 +633,18 @@ IREE_API_EXPORT iree_status_t iree_vm_context_register_modules(
 
     ++context->list.count;
 
+    // Track the module functions in the profile, if enabled.
+    if (context->profile) {
+      status = iree_vm_profile_register_module(context->profile, module);
+      if (!iree_status_is_ok(status)) {
+        // Cleanup handled below.
+        break;
+      }
+    }
+
+    // Forked state has already been initialized by the source context.
+    if (is_forked) continue;
+
     // Run module __init functions, if present.
     // As initialization functions may reference imports we need to perform
     // all of these after we have resolved the imports above.
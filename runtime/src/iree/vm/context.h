@@ -47,6 +47,16 @@ enum iree_vm_context_flag_bits_t {
   // is not performed by the context and callers must ensure the executing
   // programs support concurrency.
   IREE_VM_CONTEXT_FLAG_CONCURRENT = 1u << 1,
+
+  // Enables profiling of execution.
+  // See iree/base/config.h for the flags that control whether this
+  // functionality is available; specifically:
+  //   -DIREE_VM_EXECUTION_PROFILING_ENABLE=1
+  //   -DIREE_VM_EXECUTION_PROFILING_OPS_ENABLE=1 (for op histograms)
+  // Context creation fails with IREE_STATUS_UNAVAILABLE if requested when not
+  // available. All invocations made to this context will be recorded into a
+  // profile that can be queried with iree_vm_context_profile.
+  IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION = 1u << 2,
 };
 typedef uint32_t iree_vm_context_flags_t;
 
@@ -68,6 +78,26 @@ IREE_API_EXPORT iree_status_t iree_vm_context_create_with_modules(
     iree_host_size_t module_count, iree_vm_module_t** modules,
     iree_allocator_t allocator, iree_vm_context_t** out_context);
 
+// Creates a new context with the same instance, flags, and modules as
+// |source_context| that shares the source's initialized module state.
+// Modules that support forking (see iree_vm_module_t::fork_state) share the
+// objects referenced by their immutable globals, such as executables and
+// constant buffers created by initializers, and copy their primitive globals;
+// initializers are not run again. Modules with mutable state that cannot be
+// copied and modules that do not support forking have fresh state allocated
+// and are initialized as with iree_vm_context_create_with_modules. This allows
+// many contexts to be created for the same program at a fraction of the memory
+// and startup cost.
+//
+// The source context must not be executing while it is being forked. Programs
+// that mutate the contents of objects referenced by immutable globals in place
+// will observe each other's changes and should use independently created
+// contexts instead.
+// |out_context| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_vm_context_fork(
+    const iree_vm_context_t* source_context, iree_allocator_t allocator,
+    iree_vm_context_t** out_context);
+
 // Retains the given |context| for the caller.
 IREE_API_EXPORT void iree_vm_context_retain(iree_vm_context_t* context);
 
@@ -82,6 +112,24 @@ iree_vm_context_id(const iree_vm_context_t* context);
 IREE_API_EXPORT iree_vm_context_flags_t
 iree_vm_context_flags(const iree_vm_context_t* context);
 
+// Returns the execution profile of |context| or NULL if the context was not
+// created with IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION. The profile is owned by
+// the context and accumulates statistics from all invocations.
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_context_profile(
+    const iree_vm_context_t* context);
+
+// Returns the maximum number of bytes of stack frame storage used by any
+// invocation made on |context|. Hosts can use this to size the stacks they
+// provide for their programs such that no dynamic growth is required.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_context_stack_high_water_mark(const iree_vm_context_t* context);
+
+// Records the high-water mark of a stack used to invoke functions on |context|.
+// Called by the invocation utilities when their stack is torn down; hosts
+// managing their own stacks can call it to contribute to the context total.
+IREE_API_EXPORT void iree_vm_context_record_stack_high_water_mark(
+    iree_vm_context_t* context, iree_host_size_t high_water_mark);
+
 // Registers a list of modules with the context and resolves imports in the
 // order provided.
 // The modules will be retained by the context until destruction.
@@ -433,6 +433,7 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
                   sizeof(state->stack_storage) - result_storage_size),
               flags, iree_vm_context_state_resolver(context), host_allocator,
               &stack));
+  iree_vm_stack_set_profile(stack, iree_vm_context_profile(context));
 
   // NOTE: at this point the stack must be properly deinitialized if we bail.
 
@@ -493,8 +494,11 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
       return iree_ok_status();
     }
 
-    // Get the top execution frame of the stack where we will resume execution.
-    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_top(state->stack);
+    // Get the bottom (entry) frame of the stack. Each module is responsible
+    // for resuming the frames above its own (if any) so that results returned
+    // from callees that yielded can be marshaled into the caller's storage;
+    // only the entry module knows that |state->results| is its result storage.
+    iree_vm_stack_frame_t* resume_frame = iree_vm_stack_bottom(state->stack);
     if (IREE_UNLIKELY(!resume_frame)) {
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "resume called with no parent frame");
@@ -553,13 +557,22 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
   } else if (wait_frame->count == 1) {
     wait_frame->wait_status = iree_wait_source_wait_one(
         wait_frame->wait_sources[0], iree_make_deadline(min_deadline_ns));
+  } else if (wait_frame->wait_type == IREE_VM_WAIT_ALL) {
+    // Wait on each source in turn; the total wait time is bounded by the
+    // slowest source and any that have already resolved return immediately.
+    wait_frame->wait_status = iree_ok_status();
+    for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+      wait_frame->wait_status = iree_wait_source_wait_one(
+          wait_frame->wait_sources[i], iree_make_deadline(min_deadline_ns));
+      if (!iree_status_is_ok(wait_frame->wait_status)) break;
+    }
   } else {
-    // TODO(benvanik): multi-wait when running synchronously. This is already
-    // supported by iree_loop_inline_t and maybe we can just reuse that. These
-    // are not currently emitted by the compiler.
+    // TODO(benvanik): multi-wait-any when running synchronously. This is
+    // already supported by iree_loop_inline_t and maybe we can just reuse
+    // that. These are not currently emitted by the compiler.
     return iree_make_status(
         IREE_STATUS_UNIMPLEMENTED,
-        "multi-wait in synchronous invocations not yet implemented");
+        "multi-wait-any in synchronous invocations not yet implemented");
   }
 
   // Reset status to OK - the next resume will pick back up in the waiter.
@@ -625,6 +638,16 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   if (state->stack) {
+    // Report how much stack the invocation used so that hosts can tune their
+    // stack sizes to avoid growth.
+    iree_host_size_t high_water_mark =
+        iree_vm_stack_high_water_mark(state->stack);
+    IREE_TRACE_PLOT_VALUE_I64("iree_vm_stack_high_water_mark",
+                              high_water_mark);
+    if (state->context) {
+      iree_vm_context_record_stack_high_water_mark(state->context,
+                                                   high_water_mark);
+    }
     iree_vm_stack_deinitialize(state->stack);
     state->stack = NULL;
   }
@@ -440,6 +440,10 @@ typedef struct iree_vm_module_t {
 
   // Resumes execution of a previously-yielded call.
   //
+  // If the module yielded while within a call to another module (such as an
+  // import that waits) it must first resume that callee with storage for its
+  // results and then continue execution with the results once it completes.
+  //
   // Returns OK if execution completes immediately. If the call completes
   // immediately the results will be written to |call|->results.
   //
@@ -448,6 +452,18 @@ typedef struct iree_vm_module_t {
   // without first completing prior ones.
   iree_status_t(IREE_API_PTR* resume_call)(void* self, iree_vm_stack_t* stack,
                                            iree_byte_span_t call_results);
+
+  // Allocates module state data for a new context as a fork of |source_state|
+  // from an existing context. Immutable objects referenced by the source state
+  // (such as executables and constant buffers created by initializers) are
+  // shared by reference and primitive storage is copied such that initializers
+  // need not be run again. Mutable objects must not be shared; modules that
+  // cannot give the fork its own copies return IREE_STATUS_UNAVAILABLE and the
+  // state is allocated and initialized as if newly created. Optional; modules
+  // without it always get freshly allocated state.
+  iree_status_t(IREE_API_PTR* fork_state)(
+      void* self, iree_vm_module_state_t* source_state,
+      iree_allocator_t allocator, iree_vm_module_state_t** out_module_state);
 } iree_vm_module_t;
 
 // Initializes the interface of a module handle.
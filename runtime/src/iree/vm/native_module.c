@@ -288,6 +288,15 @@ static void IREE_API_PTR iree_vm_native_module_free_state(
   IREE_ASSERT_EQ(module_state, NULL);
 }
 
+static iree_status_t IREE_API_PTR iree_vm_native_module_fork_state(
+    void* self, iree_vm_module_state_t* source_state,
+    iree_allocator_t allocator, iree_vm_module_state_t** out_module_state) {
+  iree_vm_native_module_t* module = (iree_vm_native_module_t*)self;
+  *out_module_state = NULL;
+  return module->user_interface.fork_state(module->self, source_state,
+                                           allocator, out_module_state);
+}
+
 static iree_status_t IREE_API_PTR iree_vm_native_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -388,11 +397,22 @@ static iree_status_t IREE_API_PTR iree_vm_native_module_resume_call(
                                               call_results);
   }
 
-  // Resume call using existing top frame.
-  iree_vm_stack_frame_t* callee_frame = iree_vm_stack_top(stack);
+  // Resume call using the native frame at the top of the stack. If the
+  // function yielded to wait then its wait frame is above the native frame and
+  // is left for the function to pop with iree_vm_stack_wait_leave.
+  iree_vm_stack_frame_t* callee_frame = iree_vm_stack_current_frame(stack);
+  if (callee_frame && callee_frame->type == IREE_VM_STACK_FRAME_WAIT) {
+    callee_frame = iree_vm_stack_frame_parent(callee_frame);
+  }
   if (IREE_UNLIKELY(!callee_frame)) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "no frame at top of stack to resume");
+  } else if (IREE_UNLIKELY(callee_frame->type != IREE_VM_STACK_FRAME_NATIVE ||
+                           callee_frame->function.module !=
+                               &module->base_interface)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "frame at top of stack is not a native frame of "
+                            "the resumed module");
   }
   return iree_vm_native_module_issue_call(
       module, stack, callee_frame, IREE_VM_NATIVE_FUNCTION_CALL_RESUME,
@@ -503,6 +523,11 @@ IREE_API_EXPORT iree_status_t iree_vm_native_module_initialize(
       iree_vm_native_module_get_function_attr;
   module->base_interface.alloc_state = iree_vm_native_module_alloc_state;
   module->base_interface.free_state = iree_vm_native_module_free_state;
+  // Only forkable if the user module supports it; otherwise contexts will
+  // allocate fresh state.
+  module->base_interface.fork_state = module->user_interface.fork_state
+                                          ? iree_vm_native_module_fork_state
+                                          : NULL;
   module->base_interface.resolve_import = iree_vm_native_module_resolve_import;
   module->base_interface.notify = iree_vm_native_module_notify;
   module->base_interface.begin_call = iree_vm_native_module_begin_call;
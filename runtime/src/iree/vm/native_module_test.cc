@@ -21,6 +21,8 @@
 namespace iree {
 namespace {
 
+using iree::testing::status::StatusIs;
+
 // Test suite that uses module_a and module_b defined in native_module_test.h.
 // Both modules are put in a context and the module_b.entry function can be
 // executed with RunFunction.
@@ -43,7 +45,7 @@ class VMNativeModuleTest : public ::testing::Test {
     // will be allocated.
     std::vector<iree_vm_module_t*> modules = {module_a, module_b};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
-        instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
+        instance_, context_flags(), modules.size(), modules.data(),
         iree_allocator_system(), &context_));
 
     // No longer need the modules as the context retains them.
@@ -56,14 +58,24 @@ class VMNativeModuleTest : public ::testing::Test {
     iree_vm_instance_release(instance_);
   }
 
+  virtual iree_vm_context_flags_t context_flags() const {
+    return IREE_VM_CONTEXT_FLAG_NONE;
+  }
+
   StatusOr<int32_t> RunFunction(iree_string_view_t function_name,
                                 int32_t arg0) {
+    return RunFunction(context_, function_name, arg0);
+  }
+
+  StatusOr<int32_t> RunFunction(iree_vm_context_t* context,
+                                iree_string_view_t function_name,
+                                int32_t arg0) {
     // Lookup the entry function. This can be cached in an application if
     // multiple calls will be made.
     iree_vm_function_t function;
     IREE_RETURN_IF_ERROR(
         iree_vm_context_resolve_function(
-            context_, iree_make_cstring_view("module_b.entry"), &function),
+            context, iree_make_cstring_view("module_b.entry"), &function),
         "unable to resolve entry point");
 
     // Setup I/O lists and pass in the argument. The result list will be
@@ -80,7 +92,7 @@ class VMNativeModuleTest : public ::testing::Test {
 
     // Invoke the entry function to do our work. Runs synchronously.
     IREE_RETURN_IF_ERROR(
-        iree_vm_invoke(context_, function, IREE_VM_INVOCATION_FLAG_NONE,
+        iree_vm_invoke(context, function, IREE_VM_INVOCATION_FLAG_NONE,
                        /*policy=*/nullptr, input_list.get(), output_list.get(),
                        iree_allocator_system()));
 
@@ -91,7 +103,7 @@ class VMNativeModuleTest : public ::testing::Test {
     return ret0_value.i32;
   }
 
- private:
+ protected:
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
 };
@@ -108,5 +120,125 @@ TEST_F(VMNativeModuleTest, Example) {
   ASSERT_EQ(v2, 8);
 }
 
+// Tests that forked contexts start with a copy of the source module state and
+// then diverge independently.
+TEST_F(VMNativeModuleTest, Fork) {
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v0, RunFunction(iree_make_cstring_view("module_b.entry"), 1));
+  ASSERT_EQ(v0, 1);
+
+  iree_vm_context_t* forked_context = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_context_fork(context_, iree_allocator_system(), &forked_context));
+  EXPECT_NE(iree_vm_context_id(context_), iree_vm_context_id(forked_context));
+  EXPECT_EQ(iree_vm_context_flags(context_),
+            iree_vm_context_flags(forked_context));
+
+  // Both contexts continue from the state at the time of the fork.
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v1, RunFunction(forked_context,
+                              iree_make_cstring_view("module_b.entry"), 2));
+  ASSERT_EQ(v1, 4);
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v2, RunFunction(iree_make_cstring_view("module_b.entry"), 2));
+  ASSERT_EQ(v2, 4);
+
+  // The fork remains valid after the source context is released.
+  iree_vm_context_release(context_);
+  context_ = forked_context;
+  IREE_ASSERT_OK_AND_ASSIGN(
+      int32_t v3, RunFunction(iree_make_cstring_view("module_b.entry"), 3));
+  ASSERT_EQ(v3, 8);
+}
+
+// Tests that invocations report their stack usage to the context.
+TEST_F(VMNativeModuleTest, StackHighWaterMark) {
+  EXPECT_EQ(0, iree_vm_context_stack_high_water_mark(context_));
+  IREE_ASSERT_OK(
+      RunFunction(iree_make_cstring_view("module_b.entry"), 1).status());
+  iree_host_size_t high_water_mark =
+      iree_vm_context_stack_high_water_mark(context_);
+  EXPECT_GT(high_water_mark, 0);
+
+  // The same call depth does not change the mark.
+  IREE_ASSERT_OK(
+      RunFunction(iree_make_cstring_view("module_b.entry"), 2).status());
+  EXPECT_EQ(high_water_mark, iree_vm_context_stack_high_water_mark(context_));
+
+  // Smaller marks recorded by other stacks do not lower it.
+  iree_vm_context_record_stack_high_water_mark(context_, 1);
+  EXPECT_EQ(high_water_mark, iree_vm_context_stack_high_water_mark(context_));
+  iree_vm_context_record_stack_high_water_mark(context_, high_water_mark + 1);
+  EXPECT_EQ(high_water_mark + 1,
+            iree_vm_context_stack_high_water_mark(context_));
+}
+
+// Same as VMNativeModuleTest but with execution profiling enabled.
+// build_tools/cmake/build_and_test_runtime_profiling.sh runs these tests in a
+// build with profiling compiled in.
+class VMNativeModuleProfileTest : public VMNativeModuleTest {
+ protected:
+  void SetUp() override {
+#if !IREE_VM_EXECUTION_PROFILING_ENABLE
+    GTEST_SKIP() << "execution profiling not enabled in this build";
+#endif  // !IREE_VM_EXECUTION_PROFILING_ENABLE
+    VMNativeModuleTest::SetUp();
+  }
+
+  iree_vm_context_flags_t context_flags() const override {
+    return IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION;
+  }
+};
+
+TEST_F(VMNativeModuleTest, NoProfileByDefault) {
+  EXPECT_EQ(nullptr, iree_vm_context_profile(context_));
+}
+
+// Tests that requesting profiling fails when it is not compiled in instead of
+// silently producing no profile.
+TEST_F(VMNativeModuleTest, ProfileUnavailable) {
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  GTEST_SKIP() << "execution profiling enabled in this build";
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+  iree_vm_context_t* context = nullptr;
+  EXPECT_THAT(Status(iree_vm_context_create(
+                  instance_, IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION,
+                  iree_allocator_system(), &context)),
+              StatusIs(StatusCode::kUnavailable));
+  EXPECT_EQ(nullptr, context);
+}
+
+TEST_F(VMNativeModuleProfileTest, CountsCalls) {
+  iree_vm_profile_t* profile = iree_vm_context_profile(context_);
+  ASSERT_NE(nullptr, profile);
+  for (int i = 0; i < 3; ++i) {
+    IREE_ASSERT_OK(
+        RunFunction(iree_make_cstring_view("module_b.entry"), 1).status());
+  }
+
+  // Functions are tracked in module registration order: module_a.add_1,
+  // module_a.sub_1, module_b.entry.
+  ASSERT_EQ(3, iree_vm_profile_function_count(profile));
+  iree_vm_profile_function_stats_t add_1_stats;
+  IREE_ASSERT_OK(iree_vm_profile_function_stats(profile, 0, &add_1_stats));
+  iree_vm_profile_function_stats_t entry_stats;
+  IREE_ASSERT_OK(iree_vm_profile_function_stats(profile, 2, &entry_stats));
+  EXPECT_EQ(IREE_VM_FUNCTION_LINKAGE_EXPORT, entry_stats.function.linkage);
+  EXPECT_EQ(0, entry_stats.function.ordinal);
+  EXPECT_EQ(3, add_1_stats.call_count);
+  EXPECT_EQ(3, entry_stats.call_count);
+  EXPECT_LE(entry_stats.exclusive_time_ns, entry_stats.inclusive_time_ns);
+  EXPECT_GE(entry_stats.inclusive_time_ns, add_1_stats.inclusive_time_ns);
+
+  iree_vm_profile_function_stats_t out_of_range_stats;
+  EXPECT_THAT(
+      Status(iree_vm_profile_function_stats(profile, 3, &out_of_range_stats)),
+      StatusIs(StatusCode::kOutOfRange));
+
+  iree_vm_profile_reset(profile);
+  IREE_ASSERT_OK(iree_vm_profile_function_stats(profile, 2, &entry_stats));
+  EXPECT_EQ(0, entry_stats.call_count);
+}
+
 }  // namespace
 }  // namespace iree
@@ -0,0 +1,432 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/vm/profile.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/tracing.h"
+#include "iree/vm/generated/bytecode_op_table.h"
+
+struct iree_vm_profile_entry_t {
+  iree_atomic_int64_t call_count;
+  iree_atomic_int64_t inclusive_time_ns;
+  iree_atomic_int64_t exclusive_time_ns;
+};
+
+// Statistics for all functions within a single module.
+// Entries are indexed by export ordinal followed by internal ordinal.
+typedef struct iree_vm_profile_module_t {
+  iree_vm_module_t* module;
+  iree_host_size_t export_count;
+  iree_host_size_t internal_count;
+  iree_vm_profile_entry_t* entries;
+} iree_vm_profile_module_t;
+
+struct iree_vm_profile_t {
+  iree_allocator_t allocator;
+
+  // Registered modules. Only modified during registration and as such readers
+  // do not need to synchronize.
+  iree_host_size_t module_count;
+  iree_host_size_t module_capacity;
+  iree_vm_profile_module_t* modules;
+
+  // Total time spent in wait frames.
+  iree_atomic_int64_t wait_time_ns;
+
+  // Executed op counts indexed by `table * 256 + opcode`.
+  iree_atomic_int64_t op_counts[IREE_VM_PROFILE_OP_TABLE_COUNT * 256];
+};
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_allocate(
+    iree_allocator_t allocator, iree_vm_profile_t** out_profile) {
+  IREE_ASSERT_ARGUMENT(out_profile);
+  *out_profile = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_vm_profile_t* profile = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, sizeof(*profile), (void**)&profile));
+  profile->allocator = allocator;
+
+  *out_profile = profile;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_profile_free(iree_vm_profile_t* profile) {
+  if (!profile) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_allocator_t allocator = profile->allocator;
+  for (iree_host_size_t i = 0; i < profile->module_count; ++i) {
+    iree_allocator_free(allocator, profile->modules[i].entries);
+    iree_vm_module_release(profile->modules[i].module);
+  }
+  iree_allocator_free(allocator, profile->modules);
+  iree_allocator_free(allocator, profile);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_register_module(
+    iree_vm_profile_t* profile, iree_vm_module_t* module) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(module);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (profile->module_count == profile->module_capacity) {
+    iree_host_size_t new_capacity = iree_max(4, profile->module_capacity * 2);
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_realloc(
+                profile->allocator,
+                new_capacity * sizeof(iree_vm_profile_module_t),
+                (void**)&profile->modules));
+    profile->module_capacity = new_capacity;
+  }
+
+  iree_vm_module_signature_t signature = iree_vm_module_signature(module);
+  iree_host_size_t entry_count =
+      signature.export_function_count + signature.internal_function_count;
+  iree_vm_profile_entry_t* entries = NULL;
+  if (entry_count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(profile->allocator,
+                                  entry_count * sizeof(*entries),
+                                  (void**)&entries));
+  }
+
+  iree_vm_profile_module_t* profile_module =
+      &profile->modules[profile->module_count++];
+  profile_module->module = module;
+  iree_vm_module_retain(module);
+  profile_module->export_count = signature.export_function_count;
+  profile_module->internal_count = signature.internal_function_count;
+  profile_module->entries = entries;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_vm_profile_reset(iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  for (iree_host_size_t i = 0; i < profile->module_count; ++i) {
+    iree_vm_profile_module_t* profile_module = &profile->modules[i];
+    iree_host_size_t entry_count =
+        profile_module->export_count + profile_module->internal_count;
+    for (iree_host_size_t j = 0; j < entry_count; ++j) {
+      iree_vm_profile_entry_t* entry = &profile_module->entries[j];
+      iree_atomic_store_int64(&entry->call_count, 0, iree_memory_order_relaxed);
+      iree_atomic_store_int64(&entry->inclusive_time_ns, 0,
+                              iree_memory_order_relaxed);
+      iree_atomic_store_int64(&entry->exclusive_time_ns, 0,
+                              iree_memory_order_relaxed);
+    }
+  }
+  iree_atomic_store_int64(&profile->wait_time_ns, 0, iree_memory_order_relaxed);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(profile->op_counts); ++i) {
+    iree_atomic_store_int64(&profile->op_counts[i], 0,
+                            iree_memory_order_relaxed);
+  }
+}
+
+IREE_API_EXPORT iree_host_size_t
+iree_vm_profile_function_count(const iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  iree_host_size_t count = 0;
+  for (iree_host_size_t i = 0; i < profile->module_count; ++i) {
+    count += profile->modules[i].export_count +
+             profile->modules[i].internal_count;
+  }
+  return count;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_function_stats(
+    const iree_vm_profile_t* profile, iree_host_size_t index,
+    iree_vm_profile_function_stats_t* out_stats) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(out_stats);
+  memset(out_stats, 0, sizeof(*out_stats));
+  for (iree_host_size_t i = 0; i < profile->module_count; ++i) {
+    const iree_vm_profile_module_t* profile_module = &profile->modules[i];
+    iree_host_size_t entry_count =
+        profile_module->export_count + profile_module->internal_count;
+    if (index >= entry_count) {
+      index -= entry_count;
+      continue;
+    }
+    out_stats->function.module = profile_module->module;
+    if (index < profile_module->export_count) {
+      out_stats->function.linkage = IREE_VM_FUNCTION_LINKAGE_EXPORT;
+      out_stats->function.ordinal = (uint16_t)index;
+    } else {
+      out_stats->function.linkage = IREE_VM_FUNCTION_LINKAGE_INTERNAL;
+      out_stats->function.ordinal =
+          (uint16_t)(index - profile_module->export_count);
+    }
+    iree_vm_profile_entry_t* entry = &profile_module->entries[index];
+    out_stats->call_count = (uint64_t)iree_atomic_load_int64(
+        &entry->call_count, iree_memory_order_relaxed);
+    out_stats->inclusive_time_ns = iree_atomic_load_int64(
+        &entry->inclusive_time_ns, iree_memory_order_relaxed);
+    out_stats->exclusive_time_ns = iree_atomic_load_int64(
+        &entry->exclusive_time_ns, iree_memory_order_relaxed);
+    return iree_ok_status();
+  }
+  return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                          "function index out of range");
+}
+
+IREE_API_EXPORT iree_duration_t
+iree_vm_profile_wait_time(const iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(profile);
+  return iree_atomic_load_int64((iree_atomic_int64_t*)&profile->wait_time_ns,
+                                iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT uint64_t iree_vm_profile_op_count(
+    const iree_vm_profile_t* profile, iree_vm_profile_op_table_t table,
+    uint8_t opcode) {
+  IREE_ASSERT_ARGUMENT(profile);
+  if (table >= IREE_VM_PROFILE_OP_TABLE_COUNT) return 0;
+  return (uint64_t)iree_atomic_load_int64(
+      (iree_atomic_int64_t*)&profile->op_counts[table * 256 + opcode],
+      iree_memory_order_relaxed);
+}
+
+//===----------------------------------------------------------------------===//
+// Formatting
+//===----------------------------------------------------------------------===//
+
+#define IREE_VM_PROFILE_OP_NAME(ordinal, name) #name,
+#define IREE_VM_PROFILE_OP_RSV(ordinal) NULL,
+static const char* const iree_vm_profile_op_names
+    [IREE_VM_PROFILE_OP_TABLE_COUNT][256] = {
+        {IREE_VM_OP_CORE_TABLE(IREE_VM_PROFILE_OP_NAME,
+                               IREE_VM_PROFILE_OP_RSV)},
+        {IREE_VM_OP_EXT_F32_TABLE(IREE_VM_PROFILE_OP_NAME,
+                                  IREE_VM_PROFILE_OP_RSV)},
+        {IREE_VM_OP_EXT_F64_TABLE(IREE_VM_PROFILE_OP_NAME,
+                                  IREE_VM_PROFILE_OP_RSV)},
+};
+#undef IREE_VM_PROFILE_OP_NAME
+#undef IREE_VM_PROFILE_OP_RSV
+
+static const char* const iree_vm_profile_op_table_names[] = {
+    "core",
+    "f32",
+    "f64",
+};
+
+typedef struct iree_vm_profile_op_stats_t {
+  uint16_t key;  // table * 256 + opcode
+  uint64_t count;
+} iree_vm_profile_op_stats_t;
+
+static int iree_vm_profile_compare_function_stats(const void* lhs_ptr,
+                                                  const void* rhs_ptr) {
+  const iree_vm_profile_function_stats_t* lhs =
+      (const iree_vm_profile_function_stats_t*)lhs_ptr;
+  const iree_vm_profile_function_stats_t* rhs =
+      (const iree_vm_profile_function_stats_t*)rhs_ptr;
+  if (lhs->exclusive_time_ns != rhs->exclusive_time_ns) {
+    return lhs->exclusive_time_ns > rhs->exclusive_time_ns ? -1 : 1;
+  }
+  if (lhs->call_count != rhs->call_count) {
+    return lhs->call_count > rhs->call_count ? -1 : 1;
+  }
+  return 0;
+}
+
+static int iree_vm_profile_compare_op_stats(const void* lhs_ptr,
+                                            const void* rhs_ptr) {
+  const iree_vm_profile_op_stats_t* lhs =
+      (const iree_vm_profile_op_stats_t*)lhs_ptr;
+  const iree_vm_profile_op_stats_t* rhs =
+      (const iree_vm_profile_op_stats_t*)rhs_ptr;
+  if (lhs->count != rhs->count) return lhs->count > rhs->count ? -1 : 1;
+  return (int)lhs->key - (int)rhs->key;
+}
+
+static iree_status_t iree_vm_profile_format_function_name(
+    const iree_vm_function_t* function, iree_string_builder_t* builder) {
+  iree_string_view_t module_name = iree_vm_module_name(function->module);
+  iree_string_view_t function_name = iree_vm_function_name(function);
+  if (iree_string_view_is_empty(function_name)) {
+    return iree_string_builder_append_format(
+        builder, "%.*s@%d", (int)module_name.size, module_name.data,
+        (int)function->ordinal);
+  }
+  return iree_string_builder_append_format(
+      builder, "%.*s.%.*s", (int)module_name.size, module_name.data,
+      (int)function_name.size, function_name.data);
+}
+
+static iree_status_t iree_vm_profile_format_functions(
+    const iree_vm_profile_t* profile, iree_string_builder_t* builder) {
+  // Gather all called functions so we can sort them.
+  iree_host_size_t function_count = iree_vm_profile_function_count(profile);
+  if (!function_count) return iree_ok_status();
+  iree_vm_profile_function_stats_t* stats = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(profile->allocator,
+                                             function_count * sizeof(*stats),
+                                             (void**)&stats));
+  iree_host_size_t called_count = 0;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < function_count; ++i) {
+    status = iree_vm_profile_function_stats(profile, i, &stats[called_count]);
+    if (!iree_status_is_ok(status)) break;
+    if (stats[called_count].call_count > 0) ++called_count;
+  }
+  qsort(stats, called_count, sizeof(*stats),
+        iree_vm_profile_compare_function_stats);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_string_builder_append_format(
+        builder, "%12s %16s %16s  %s\n", "calls", "inclusive (ms)",
+        "exclusive (ms)", "function");
+  }
+  for (iree_host_size_t i = 0; i < called_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_string_builder_append_format(
+        builder, "%12" PRIu64 " %16.3f %16.3f  ", stats[i].call_count,
+        stats[i].inclusive_time_ns / 1000000.0,
+        stats[i].exclusive_time_ns / 1000000.0);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_vm_profile_format_function_name(&stats[i].function, builder);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_string_builder_append_cstring(builder, "\n");
+    }
+  }
+
+  iree_allocator_free(profile->allocator, stats);
+  return status;
+}
+
+static iree_status_t iree_vm_profile_format_ops(
+    const iree_vm_profile_t* profile, iree_string_builder_t* builder) {
+  iree_vm_profile_op_stats_t ops[IREE_VM_PROFILE_OP_TABLE_COUNT * 256];
+  iree_host_size_t op_count = 0;
+  uint64_t total_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(ops); ++i) {
+    uint64_t count = iree_vm_profile_op_count(
+        profile, (iree_vm_profile_op_table_t)(i / 256), (uint8_t)(i % 256));
+    if (!count) continue;
+    ops[op_count].key = (uint16_t)i;
+    ops[op_count].count = count;
+    total_count += count;
+    ++op_count;
+  }
+  if (!op_count) return iree_ok_status();
+  qsort(ops, op_count, sizeof(*ops), iree_vm_profile_compare_op_stats);
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, "\n%12s %8s  %s\n", "ops", "%", "op"));
+  for (iree_host_size_t i = 0; i < op_count; ++i) {
+    const char* name = iree_vm_profile_op_names[ops[i].key / 256]
+                                               [ops[i].key % 256];
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder, "%12" PRIu64 " %8.2f  %s.%s\n", ops[i].count,
+        100.0 * ops[i].count / total_count,
+        iree_vm_profile_op_table_names[ops[i].key / 256],
+        name ? name : "??"));
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_profile_format(
+    const iree_vm_profile_t* profile, iree_string_builder_t* builder) {
+  IREE_ASSERT_ARGUMENT(profile);
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_string_builder_append_format(
+              builder, "wait time: %.3f ms\n\n",
+              iree_vm_profile_wait_time(profile) / 1000000.0));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_profile_format_functions(profile, builder));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
+                                    iree_vm_profile_format_ops(profile, builder));
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_profile_fprint(FILE* file, const iree_vm_profile_t* profile) {
+  IREE_ASSERT_ARGUMENT(file);
+  IREE_ASSERT_ARGUMENT(profile);
+
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(profile->allocator, &builder);
+
+  iree_status_t status = iree_string_builder_append_cstring(
+      &builder, "[[ iree_vm_profile_t execution profile ]]\n");
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_profile_format(profile, &builder);
+  }
+
+  if (iree_status_is_ok(status)) {
+    fprintf(file, "%.*s", (int)iree_string_builder_size(&builder),
+            iree_string_builder_buffer(&builder));
+  }
+
+  iree_string_builder_deinitialize(&builder);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Recording
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT iree_vm_profile_entry_t* iree_vm_profile_lookup_entry(
+    iree_vm_profile_t* profile, const iree_vm_function_t* function) {
+  if (!profile || !function->module) return NULL;
+  for (iree_host_size_t i = 0; i < profile->module_count; ++i) {
+    iree_vm_profile_module_t* profile_module = &profile->modules[i];
+    if (profile_module->module != function->module) continue;
+    switch (function->linkage) {
+      case IREE_VM_FUNCTION_LINKAGE_EXPORT:
+        return function->ordinal < profile_module->export_count
+                   ? &profile_module->entries[function->ordinal]
+                   : NULL;
+      case IREE_VM_FUNCTION_LINKAGE_INTERNAL:
+        return function->ordinal < profile_module->internal_count
+                   ? &profile_module->entries[profile_module->export_count +
+                                              function->ordinal]
+                   : NULL;
+      default:
+        return NULL;
+    }
+  }
+  return NULL;
+}
+
+IREE_API_EXPORT void iree_vm_profile_record_call(
+    iree_vm_profile_entry_t* entry, iree_duration_t inclusive_time_ns,
+    iree_duration_t exclusive_time_ns) {
+  iree_atomic_fetch_add_int64(&entry->call_count, 1, iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&entry->inclusive_time_ns, inclusive_time_ns,
+                              iree_memory_order_relaxed);
+  iree_atomic_fetch_add_int64(&entry->exclusive_time_ns, exclusive_time_ns,
+                              iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT void iree_vm_profile_record_wait(iree_vm_profile_t* profile,
+                                                 iree_duration_t duration_ns) {
+  iree_atomic_fetch_add_int64(&profile->wait_time_ns, duration_ns,
+                              iree_memory_order_relaxed);
+}
+
+IREE_API_EXPORT iree_atomic_int64_t* iree_vm_profile_op_counters(
+    iree_vm_profile_t* profile) {
+  return profile ? profile->op_counts : NULL;
+}
@@ -0,0 +1,137 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_VM_PROFILE_H_
+#define IREE_VM_PROFILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/vm/module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Low-overhead execution profile of VM invocations.
+// Profiles are owned by contexts created with
+// IREE_VM_CONTEXT_FLAG_PROFILE_EXECUTION and accumulate statistics across all
+// invocations made against the context:
+//  - per-function call counts and inclusive/exclusive time for both bytecode
+//    and native functions (including imports such as
+//    `hal.command_buffer.dispatch`, which show up as native functions)
+//  - total time spent in wait frames (such as waiting on device fences)
+//  - optionally a histogram of executed bytecode ops (see
+//    IREE_VM_EXECUTION_PROFILING_OPS_ENABLE in iree/base/config.h)
+//
+// Inclusive time is the wall time from function entry to exit and includes
+// time spent in callees, in waits, and while the invocation was suspended.
+// Exclusive time excludes callees and waits and approximates the host-side VM
+// overhead of the function itself.
+//
+// Thread-safe: concurrent invocations may record into the same profile.
+typedef struct iree_vm_profile_t iree_vm_profile_t;
+
+// Execution statistics for a single function.
+typedef struct iree_vm_profile_function_stats_t {
+  // Function the statistics were gathered for.
+  iree_vm_function_t function;
+  // Total number of times the function was entered.
+  uint64_t call_count;
+  // Total time spent between function entry and exit.
+  iree_duration_t inclusive_time_ns;
+  // Total time spent in the function excluding callees and waits.
+  iree_duration_t exclusive_time_ns;
+} iree_vm_profile_function_stats_t;
+
+// Identifies one of the bytecode op tables (core or extension).
+// Matches the `ext` names used by the bytecode dispatcher.
+typedef enum iree_vm_profile_op_table_e {
+  IREE_VM_PROFILE_OP_TABLE_CORE = 0,
+  IREE_VM_PROFILE_OP_TABLE_EXT_F32 = 1,
+  IREE_VM_PROFILE_OP_TABLE_EXT_F64 = 2,
+  IREE_VM_PROFILE_OP_TABLE_COUNT,
+} iree_vm_profile_op_table_t;
+
+// Allocates an empty profile.
+IREE_API_EXPORT iree_status_t iree_vm_profile_allocate(
+    iree_allocator_t allocator, iree_vm_profile_t** out_profile);
+
+// Frees a |profile| allocated with iree_vm_profile_allocate.
+IREE_API_EXPORT void iree_vm_profile_free(iree_vm_profile_t* profile);
+
+// Registers |module| with the profile so that its functions can be recorded.
+// Functions from modules not registered are ignored. The module is retained
+// until the profile is freed. Not thread-safe with respect to recording.
+IREE_API_EXPORT iree_status_t iree_vm_profile_register_module(
+    iree_vm_profile_t* profile, iree_vm_module_t* module);
+
+// Resets all statistics in |profile| to zero.
+// Recordings made concurrently with the reset may be partially retained.
+IREE_API_EXPORT void iree_vm_profile_reset(iree_vm_profile_t* profile);
+
+// Returns the total number of functions tracked by |profile|.
+// Functions that have never been called are included.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_profile_function_count(const iree_vm_profile_t* profile);
+
+// Returns the statistics of the function at |index| in |out_stats|.
+IREE_API_EXPORT iree_status_t iree_vm_profile_function_stats(
+    const iree_vm_profile_t* profile, iree_host_size_t index,
+    iree_vm_profile_function_stats_t* out_stats);
+
+// Returns the total time spent in wait frames.
+IREE_API_EXPORT iree_duration_t
+iree_vm_profile_wait_time(const iree_vm_profile_t* profile);
+
+// Returns the number of times the bytecode op |opcode| in |table| has been
+// executed. Always 0 unless IREE_VM_EXECUTION_PROFILING_OPS_ENABLE is set.
+IREE_API_EXPORT uint64_t iree_vm_profile_op_count(
+    const iree_vm_profile_t* profile, iree_vm_profile_op_table_t table,
+    uint8_t opcode);
+
+// Appends a human-readable report of |profile| to |builder|.
+// Functions are listed in order of decreasing exclusive time and those never
+// called are omitted.
+IREE_API_EXPORT iree_status_t iree_vm_profile_format(
+    const iree_vm_profile_t* profile, iree_string_builder_t* builder);
+
+// Writes a human-readable report of |profile| to |file|.
+IREE_API_EXPORT iree_status_t
+iree_vm_profile_fprint(FILE* file, const iree_vm_profile_t* profile);
+
+//===----------------------------------------------------------------------===//
+// Recording (used by the VM implementation)
+//===----------------------------------------------------------------------===//
+
+// Opaque per-function statistics record.
+typedef struct iree_vm_profile_entry_t iree_vm_profile_entry_t;
+
+// Returns the statistics record for |function| or NULL if it is not tracked.
+IREE_API_EXPORT iree_vm_profile_entry_t* iree_vm_profile_lookup_entry(
+    iree_vm_profile_t* profile, const iree_vm_function_t* function);
+
+// Records one call to the function of |entry|.
+IREE_API_EXPORT void iree_vm_profile_record_call(
+    iree_vm_profile_entry_t* entry, iree_duration_t inclusive_time_ns,
+    iree_duration_t exclusive_time_ns);
+
+// Records |duration_ns| spent in a wait frame.
+IREE_API_EXPORT void iree_vm_profile_record_wait(iree_vm_profile_t* profile,
+                                                 iree_duration_t duration_ns);
+
+// Returns the op counters indexed by
+// `table * 256 + opcode` or NULL if |profile| is NULL.
+IREE_API_EXPORT iree_atomic_int64_t* iree_vm_profile_op_counters(
+    iree_vm_profile_t* profile);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_VM_PROFILE_H_
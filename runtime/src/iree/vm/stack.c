@@ -9,6 +9,7 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "iree/base/alignment.h"
@@ -71,13 +72,26 @@
 // expand the required register count for a function from 30 to 3000.
 //
 // To support these cases the stack can optionally be provided an allocator to
-// enable it to grow the stack when the initial storage is exhausted. As we
-// store pointers to the stack storage within the storage itself (such as the
-// iree_vm_registers_t pointers) this means we need to perform a fixup step
-// during reallocation to ensure they are all updated. This also means that the
-// pointers to the stack frames are possibly invalidated on every function
-// entry and that users of the stack cannot rely on pointer stability during
-// execution.
+// enable it to grow the stack when the initial storage is exhausted. Instead of
+// reallocating the storage (and fixing up all of the pointers stored within
+// it) the stack is split into segments: the initial storage provided by the
+// user is the first segment and when a frame does not fit in the current
+// segment a new one is chained after it. Frames never span segments and never
+// move once pushed so frame pointers remain stable for the lifetime of the
+// frame and growth is O(1) regardless of stack depth.
+//
+// [initial segment] -> [segment 1 (2x)] -> [segment 2 (4x)] -> NULL
+//  frames 0..N          frames N+1..M       (cached, empty)
+//
+// Segments are retained when the stack unwinds out of them so that a program
+// bouncing across a segment boundary (such as a loop calling a function) does
+// not hit the allocator on every call. All segments are released when the
+// stack is deinitialized. Users wanting to avoid the system allocator entirely
+// can provide a pooling allocator that hands out fixed-size blocks.
+//
+// The stack tracks the total bytes of frame storage used and the high-water
+// mark of that value such that hosts can size the initial storage of their
+// stacks to avoid growth entirely.
 //
 // Calling convention
 // ------------------
@@ -115,12 +129,31 @@
 // code paths which are likely still in instruction cache the bulk of the work
 // amounts to some small memcpys.
 
-// Multiplier on the capacity of the stack frame storage when growing.
-// Since we never shrink stacks it's nice to keep this relative low. If we
-// measure a lot of growth happening in normal models we should increase this
-// but otherwise leave as small as we can to avoid overallocation.
+// Multiplier on the capacity of each new segment relative to the previous one.
+// Since we never release segments until the stack is deinitialized it's nice
+// to keep this relatively low. If we measure a lot of growth happening in
+// normal models we should increase this but otherwise leave as small as we can
+// to avoid overallocation.
 #define IREE_VM_STACK_GROWTH_FACTOR 2
 
+// A contiguous segment of frame storage. The initial segment lives within the
+// iree_vm_stack_t and references the storage provided by the user while all
+// others are allocated from the stack allocator with their storage immediately
+// following the segment header.
+typedef struct iree_vm_stack_segment_t {
+  // Previous segment in the stack or NULL if this is the initial segment.
+  struct iree_vm_stack_segment_t* parent;
+  // Next segment in the stack, retained for reuse after the stack unwinds out
+  // of it. NULL if no segment has yet been allocated.
+  struct iree_vm_stack_segment_t* next;
+  // Total capacity of |storage| in bytes.
+  iree_host_size_t capacity;
+  // Bytes of |storage| used by frames.
+  iree_host_size_t size;
+  // Frame storage aligned to 16 bytes.
+  uint8_t* storage;
+} iree_vm_stack_segment_t;
+
 // A private stack frame header that allows us to walk the linked list of
 // frames without exposing their exact structure through the API. This makes it
 // easier for us to add/version additional information or hide implementation
@@ -128,12 +161,12 @@
 typedef struct iree_vm_stack_frame_header_t {
   // Size, in bytes, of the frame header and frame payload including registers.
   // Adding this value to the base header pointer will yield the next available
-  // memory location. Ensure that it does not exceed the total
-  // frame_storage_capacity.
+  // memory location. Ensure that it does not exceed the capacity of the segment
+  // containing the frame.
   iree_host_size_t frame_size;
 
   // Pointer to the parent stack frame, usually immediately preceding this one
-  // in the frame storage. May be NULL.
+  // in the frame storage (or at the end of the previous segment). May be NULL.
   struct iree_vm_stack_frame_header_t* parent;
 
   // Size, in bytes, of the additional stack frame data that follows the frame.
@@ -145,42 +178,47 @@ typedef struct iree_vm_stack_frame_header_t {
   // Function called when the stack frame is left.
   iree_vm_stack_frame_cleanup_fn_t frame_cleanup_fn;
 
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+  // Profile record of the frame function or NULL if not being profiled.
+  iree_vm_profile_entry_t* profile_entry;
+  // Time the frame was entered, if profiling.
+  iree_time_t profile_start_ns;
+  // Total time spent in callee frames (including waits), if profiling.
+  iree_duration_t profile_callee_ns;
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
+
   // Actual stack frame as visible through the API.
   // The registers within the frame will (likely) point to addresses immediately
   // following this header in memory.
   iree_vm_stack_frame_t frame;
 } iree_vm_stack_frame_header_t;
 
-// Core stack storage. This will be mapped either into dynamic memory allocated
-// by the member allocator or static memory allocated externally. Static stacks
-// cannot grow when storage runs out while dynamic ones will resize their stack.
+// Core stack storage. The initial segment is mapped into static memory
+// allocated externally and additional segments are allocated from the member
+// allocator. Stacks without an allocator cannot grow when storage runs out
+// while dynamic ones will chain new segments.
 struct iree_vm_stack_t {
   // NOTE: to get better cache hit rates we put the most frequently accessed
   // members first.
 
   // Pointer to the current top of the stack.
   // This can be used to walk the stack from top to bottom by following the
-  // |parent| pointers. Note that these pointers are invalidated each time the
-  // stack grows (if dynamic growth is enabled) and all of the frames will need
-  // updating.
+  // |parent| pointers. Frames never move once pushed so these pointers remain
+  // valid until the frame is left.
   iree_vm_stack_frame_header_t* top;
 
-  // Base pointer to stack storage.
-  // For statically-allocated stacks this will (likely) point to immediately
-  // after the iree_vm_stack_t in memory. For dynamically-allocated stacks this
-  // will (likely) point to heap memory.
-  iree_host_size_t frame_storage_capacity;
+  // Segment frames are currently being pushed into.
+  iree_vm_stack_segment_t* segment;
+
+  // Total bytes of frame storage used across all segments.
   iree_host_size_t frame_storage_size;
-  void* frame_storage;
+
+  // Maximum value of |frame_storage_size| since the stack was initialized.
+  iree_host_size_t frame_storage_high_water_mark;
 
   // Flags controlling the behavior of the invocation owning this stack.
   iree_vm_invocation_flags_t flags;
 
-  // True if the stack owns the frame_storage and should free it when it is no
-  // longer required. Host stack-allocated stacks don't own their storage but
-  // may transition to owning it on dynamic growth.
-  bool owns_frame_storage;
-
   // Resolves a module to a module state within a context.
   // This will be called on function entry whenever module transitions occur.
   iree_vm_state_resolver_t state_resolver;
@@ -188,6 +226,14 @@ struct iree_vm_stack_t {
   // Allocator used for dynamic stack allocations. May be the null allocator
   // if growth is prohibited.
   iree_allocator_t allocator;
+
+  // Profile that frames are recorded into or NULL if not profiling.
+  iree_vm_profile_t* profile;
+
+  // Initial segment referencing the storage provided by the user.
+  // For statically-allocated stacks this will (likely) point to immediately
+  // after the iree_vm_stack_t in memory.
+  iree_vm_stack_segment_t base_segment;
 };
 
 //===----------------------------------------------------------------------===//
@@ -211,16 +257,20 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_initialize(
 
   iree_vm_stack_t* stack = (iree_vm_stack_t*)storage.data;
   memset(stack, 0, sizeof(iree_vm_stack_t));
-  stack->owns_frame_storage = false;
   stack->flags = flags;
   stack->state_resolver = state_resolver;
   stack->allocator = allocator;
 
   iree_host_size_t storage_offset =
       iree_host_align(sizeof(iree_vm_stack_t), 16);
-  stack->frame_storage_capacity = storage.data_length - storage_offset;
+  stack->base_segment.parent = NULL;
+  stack->base_segment.next = NULL;
+  stack->base_segment.capacity = storage.data_length - storage_offset;
+  stack->base_segment.size = 0;
+  stack->base_segment.storage = storage.data + storage_offset;
+  stack->segment = &stack->base_segment;
   stack->frame_storage_size = 0;
-  stack->frame_storage = storage.data + storage_offset;
+  stack->frame_storage_high_water_mark = 0;
 
   stack->top = NULL;
 
@@ -247,10 +297,15 @@ IREE_API_EXPORT void iree_vm_stack_deinitialize(iree_vm_stack_t* stack) {
   // Release stack frame resources.
   iree_vm_stack_reset(stack);
 
-  // Drop allocated frame storage.
-  if (stack->owns_frame_storage) {
-    iree_allocator_free(stack->allocator, stack->frame_storage);
+  // Drop all allocated segments. The initial segment is owned by the user.
+  iree_vm_stack_segment_t* segment = stack->base_segment.next;
+  while (segment) {
+    iree_vm_stack_segment_t* next = segment->next;
+    iree_allocator_free(stack->allocator, segment);
+    segment = next;
   }
+  stack->base_segment.next = NULL;
+  stack->segment = &stack->base_segment;
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -294,6 +349,22 @@ iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack) {
   return stack->flags;
 }
 
+IREE_API_EXPORT iree_host_size_t
+iree_vm_stack_high_water_mark(const iree_vm_stack_t* stack) {
+  return stack->frame_storage_high_water_mark;
+}
+
+IREE_API_EXPORT void iree_vm_stack_set_profile(iree_vm_stack_t* stack,
+                                               iree_vm_profile_t* profile) {
+  VMCHECK(!stack->top);
+  stack->profile = profile;
+}
+
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_stack_profile(
+    const iree_vm_stack_t* stack) {
+  return stack->profile;
+}
+
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack) {
   if (!stack->top) {
@@ -323,6 +394,24 @@ IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_parent_frame(
   return parent_header ? &parent_header->frame : NULL;
 }
 
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_bottom(
+    iree_vm_stack_t* stack) {
+  iree_vm_stack_frame_header_t* header = stack->top;
+  if (!header) return NULL;
+  while (header->parent) header = header->parent;
+  return &header->frame;
+}
+
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_frame_parent(
+    iree_vm_stack_frame_t* frame) {
+  if (!frame) return NULL;
+  iree_vm_stack_frame_header_t* header =
+      (iree_vm_stack_frame_header_t*)((uint8_t*)frame -
+                                      offsetof(iree_vm_stack_frame_header_t,
+                                               frame));
+  return header->parent ? &header->parent->frame : NULL;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
     iree_vm_stack_t* stack, iree_vm_module_t* module,
     iree_vm_module_state_t** out_module_state) {
@@ -330,78 +419,137 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
                                                   module, out_module_state);
 }
 
-// Attempts to grow the stack store to hold at least |minimum_capacity|.
-// Pointers to existing stack frames will be invalidated and any pointers
-// embedded in the stack frame data structures will be updated.
+// Moves the stack to a segment after the current one with at least
+// |minimum_capacity| bytes of storage, reusing a previously allocated segment
+// if possible. Existing frames are never moved.
 // Fails if dynamic stack growth is disabled or the allocator is OOM.
 static iree_status_t iree_vm_stack_grow(iree_vm_stack_t* stack,
                                         iree_host_size_t minimum_capacity) {
+  iree_vm_stack_segment_t* parent = stack->segment;
+  iree_vm_stack_segment_t* segment = parent->next;
+  if (IREE_LIKELY(segment && segment->capacity >= minimum_capacity)) {
+    // Reuse the segment from a previous growth operation.
+    segment->size = 0;
+    stack->segment = segment;
+    return iree_ok_status();
+  }
+
   if (IREE_UNLIKELY(stack->allocator.ctl == NULL)) {
     return iree_make_status(
         IREE_STATUS_RESOURCE_EXHAUSTED,
         "stack initialized on the host stack and cannot grow");
   }
 
-  // Ensure we grow at least as much as required.
-  iree_host_size_t new_capacity = stack->frame_storage_capacity;
-  do {
-    new_capacity *= IREE_VM_STACK_GROWTH_FACTOR;
-  } while (new_capacity < minimum_capacity);
-  if (new_capacity > IREE_VM_STACK_MAX_SIZE) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The cached segment (if any) is too small for the requested frame; drop it
+  // and everything after it as we'll be allocating larger segments anyway.
+  while (segment) {
+    iree_vm_stack_segment_t* next = segment->next;
+    iree_allocator_free(stack->allocator, segment);
+    segment = next;
+  }
+  parent->next = NULL;
+
+  iree_host_size_t new_capacity = iree_max(
+      parent->capacity * IREE_VM_STACK_GROWTH_FACTOR, minimum_capacity);
+  new_capacity = iree_max(iree_min(new_capacity, IREE_VM_STACK_MAX_SIZE),
+                          minimum_capacity);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, (uint64_t)new_capacity);
+
+  iree_host_size_t header_size =
+      iree_host_align(sizeof(iree_vm_stack_segment_t), 16);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(stack->allocator, header_size + new_capacity,
+                                (void**)&segment));
+  segment->parent = parent;
+  segment->next = NULL;
+  segment->capacity = new_capacity;
+  segment->size = 0;
+  segment->storage = (uint8_t*)segment + header_size;
+  parent->next = segment;
+  stack->segment = segment;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Reserves |size| bytes of frame storage at the top of the stack, growing the
+// stack into a new segment if required.
+static iree_status_t iree_vm_stack_push_storage(iree_vm_stack_t* stack,
+                                                iree_host_size_t size,
+                                                void** out_ptr) {
+  iree_host_size_t new_storage_size = stack->frame_storage_size + size;
+  if (IREE_UNLIKELY(new_storage_size > IREE_VM_STACK_MAX_SIZE)) {
     return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
                             "new stack size would exceed maximum size: %" PRIhsz
                             " > %d",
-                            new_capacity, IREE_VM_STACK_MAX_SIZE);
+                            new_storage_size, IREE_VM_STACK_MAX_SIZE);
   }
-
-  IREE_TRACE_ZONE_BEGIN(z0);
-
-  // Reallocate the frame storage. 99.9999% chance the new storage pointer will
-  // differ and we'll need to fix up pointers so we just always do that.
-  void* old_storage = stack->frame_storage;
-  void* new_storage = stack->frame_storage;
-  iree_status_t status;
-  if (stack->owns_frame_storage) {
-    // We own the storage already likely from a previous growth operation.
-    status =
-        iree_allocator_realloc(stack->allocator, new_capacity, &new_storage);
-  } else {
-    // We don't own the original storage so we are going to switch to our own
-    // newly-allocated storage instead. We need to make sure we copy over the
-    // existing stack contents.
-    status =
-        iree_allocator_malloc(stack->allocator, new_capacity, &new_storage);
-    if (iree_status_is_ok(status)) {
-      memcpy(new_storage, old_storage, stack->frame_storage_capacity);
-    }
+  if (IREE_UNLIKELY(stack->segment->size + size > stack->segment->capacity)) {
+    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, size));
   }
-  if (!iree_status_is_ok(status)) {
-    IREE_TRACE_ZONE_END(z0);
-    return status;
+
+  iree_vm_stack_segment_t* segment = stack->segment;
+  *out_ptr = segment->storage + segment->size;
+  segment->size += size;
+  stack->frame_storage_size = new_storage_size;
+  if (new_storage_size > stack->frame_storage_high_water_mark) {
+    stack->frame_storage_high_water_mark = new_storage_size;
   }
-  stack->frame_storage = new_storage;
-  stack->frame_storage_capacity = new_capacity;
-  stack->owns_frame_storage = true;
-
-#define REBASE_POINTER(type, ptr, old_base, new_base)           \
-  if (ptr) {                                                    \
-    (ptr) = (type)(((uintptr_t)(ptr) - (uintptr_t)(old_base)) + \
-                   (uintptr_t)(new_base));                      \
+  return iree_ok_status();
+}
+
+// Releases |size| bytes of frame storage from the top of the stack, moving
+// back to the previous segment(s) when the current one is emptied.
+static void iree_vm_stack_pop_storage(iree_vm_stack_t* stack,
+                                      iree_host_size_t size) {
+  iree_vm_stack_segment_t* segment = stack->segment;
+  VMCHECK(segment->size >= size);
+  segment->size -= size;
+  stack->frame_storage_size -= size;
+  // Segments may be empty if a frame did not fit in them; skip over those so
+  // that the current segment always contains the top frame (if any).
+  while (segment->size == 0 && segment->parent) {
+    segment = segment->parent;
   }
+  stack->segment = segment;
+}
 
-  // Fixup embedded stack frame pointers.
-  REBASE_POINTER(iree_vm_stack_frame_header_t*, stack->top, old_storage,
-                 new_storage);
-  iree_vm_stack_frame_header_t* frame_header = stack->top;
-  while (frame_header != NULL) {
-    REBASE_POINTER(iree_vm_stack_frame_header_t*, frame_header->parent,
-                   old_storage, new_storage);
-    frame_header = frame_header->parent;
+#if IREE_VM_EXECUTION_PROFILING_ENABLE
+// Begins profiling |frame_header| as it is entered, if profiling.
+static void iree_vm_stack_profile_enter(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_header_t* frame_header) {
+  if (IREE_LIKELY(!stack->profile)) return;
+  if (frame_header->frame.type != IREE_VM_STACK_FRAME_WAIT) {
+    frame_header->profile_entry = iree_vm_profile_lookup_entry(
+        stack->profile, &frame_header->frame.function);
   }
+  frame_header->profile_start_ns = iree_time_now();
+}
 
-  IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+// Records the time spent in |frame_header| as it is left, if profiling.
+// The time is attributed to the parent frame as callee time such that the
+// exclusive time of the parent does not include it.
+static void iree_vm_stack_profile_leave(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_header_t* frame_header) {
+  if (IREE_LIKELY(!stack->profile)) return;
+  iree_duration_t duration_ns =
+      iree_time_now() - frame_header->profile_start_ns;
+  if (frame_header->frame.type == IREE_VM_STACK_FRAME_WAIT) {
+    iree_vm_profile_record_wait(stack->profile, duration_ns);
+  } else if (frame_header->profile_entry) {
+    iree_vm_profile_record_call(frame_header->profile_entry, duration_ns,
+                                duration_ns - frame_header->profile_callee_ns);
+  }
+  if (frame_header->parent) {
+    frame_header->parent->profile_callee_ns += duration_ns;
+  }
 }
+#else
+#define iree_vm_stack_profile_enter(stack, frame_header)
+#define iree_vm_stack_profile_leave(stack, frame_header)
+#endif  // IREE_VM_EXECUTION_PROFILING_ENABLE
 
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 static iree_zone_id_t iree_vm_stack_trace_wait_zone_begin(
@@ -439,24 +587,15 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_enter(
 
   // Allocate stack space and grow stack, if required.
   iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
-  iree_host_size_t new_top =
-      stack->frame_storage_size + header_size + frame_size;
-  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
-    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
-  }
+  iree_vm_stack_frame_header_t* frame_header = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_push_storage(
+      stack, header_size + frame_size, (void**)&frame_header));
+  memset(frame_header, 0, header_size + frame_size);
 
-  // Try to reuse the same module state if the caller and callee are from the
-  // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
   iree_vm_stack_frame_t* caller_frame =
       caller_frame_header ? &caller_frame_header->frame : NULL;
 
-  // Bump pointer and get real stack pointer offsets.
-  iree_vm_stack_frame_header_t* frame_header =
-      (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
-                                      stack->frame_storage_size);
-  memset(frame_header, 0, header_size + frame_size);
-
   frame_header->frame_size = header_size + frame_size;
   frame_header->parent = stack->top;
   frame_header->data_size = frame_size;
@@ -469,8 +608,8 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_enter(
   callee_frame->type = IREE_VM_STACK_FRAME_WAIT;
   callee_frame->depth = caller_frame ? caller_frame->depth + 1 : 0;
 
-  stack->frame_storage_size = new_top;
   stack->top = frame_header;
+  iree_vm_stack_profile_enter(stack, frame_header);
 
   IREE_TRACE({
     frame_header->trace_zone =
@@ -517,9 +656,12 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_leave(
     out_wait_result->trace_zone = wait_frame->trace_zone;
   });
 
+  iree_vm_stack_profile_leave(stack, stack->top);
+
   // Restore the frame pointer to the caller.
-  stack->frame_storage_size -= stack->top->frame_size;
+  iree_host_size_t frame_size = stack->top->frame_size;
   stack->top = stack->top->parent;
+  iree_vm_stack_pop_storage(stack, frame_size);
 
   return iree_ok_status();
 }
@@ -546,14 +688,6 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     iree_vm_stack_frame_t** out_callee_frame) {
   if (out_callee_frame) *out_callee_frame = NULL;
 
-  // Allocate stack space and grow stack, if required.
-  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
-  iree_host_size_t new_top =
-      stack->frame_storage_size + header_size + frame_size;
-  if (IREE_UNLIKELY(new_top > stack->frame_storage_capacity)) {
-    IREE_RETURN_IF_ERROR(iree_vm_stack_grow(stack, new_top));
-  }
-
   // Try to reuse the same module state if the caller and callee are from the
   // same module. Otherwise, query the state from the registered handler.
   iree_vm_stack_frame_header_t* caller_frame_header = stack->top;
@@ -567,10 +701,11 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
         stack->state_resolver.self, function->module, &module_state));
   }
 
-  // Bump pointer and get real stack pointer offsets.
-  iree_vm_stack_frame_header_t* frame_header =
-      (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
-                                      stack->frame_storage_size);
+  // Allocate stack space and grow stack, if required.
+  iree_host_size_t header_size = sizeof(iree_vm_stack_frame_header_t);
+  iree_vm_stack_frame_header_t* frame_header = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_push_storage(
+      stack, header_size + frame_size, (void**)&frame_header));
   memset(frame_header, 0, header_size + frame_size);
 
   frame_header->frame_size = header_size + frame_size;
@@ -585,8 +720,8 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
   callee_frame->pc = 0;
   callee_frame->depth = caller_frame ? caller_frame->depth + 1 : 0;
 
-  stack->frame_storage_size = new_top;
   stack->top = frame_header;
+  iree_vm_stack_profile_enter(stack, frame_header);
 
   IREE_TRACE({
     frame_header->trace_zone =
@@ -618,9 +753,12 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
     }
   });
 
+  iree_vm_stack_profile_leave(stack, stack->top);
+
   // Restore the frame pointer to the caller.
-  stack->frame_storage_size -= stack->top->frame_size;
+  iree_host_size_t frame_size = stack->top->frame_size;
   stack->top = stack->top->parent;
+  iree_vm_stack_pop_storage(stack, frame_size);
 
   return iree_ok_status();
 }
@@ -16,6 +16,7 @@
 #include "iree/base/string_builder.h"
 #include "iree/base/tracing.h"
 #include "iree/vm/module.h"
+#include "iree/vm/profile.h"
 #include "iree/vm/ref.h"
 
 #ifdef __cplusplus
@@ -247,6 +248,21 @@ IREE_API_EXPORT void iree_vm_stack_free(iree_vm_stack_t* stack);
 IREE_API_EXPORT iree_vm_invocation_flags_t
 iree_vm_stack_invocation_flags(const iree_vm_stack_t* stack);
 
+// Returns the maximum number of bytes of frame storage used by |stack| since it
+// was initialized. Hosts can use this to size the initial stack storage for
+// their programs such that no dynamic growth is required.
+IREE_API_EXPORT iree_host_size_t
+iree_vm_stack_high_water_mark(const iree_vm_stack_t* stack);
+
+// Sets the |profile| that frames entered on |stack| will be recorded into.
+// Must be set while the stack is empty. May be NULL to disable profiling.
+IREE_API_EXPORT void iree_vm_stack_set_profile(iree_vm_stack_t* stack,
+                                               iree_vm_profile_t* profile);
+
+// Returns the profile frames entered on |stack| are recorded into, if any.
+IREE_API_EXPORT iree_vm_profile_t* iree_vm_stack_profile(
+    const iree_vm_stack_t* stack);
+
 // Returns the top stack execution frame, ignore wait frames.
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_top(
     iree_vm_stack_t* stack);
@@ -259,6 +275,19 @@ IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_current_frame(
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_parent_frame(
     iree_vm_stack_t* stack);
 
+// Returns the bottom (entry) stack frame or nullptr if the stack is empty.
+// Asynchronous invocations resume from here so that each module on the stack
+// can resume its callees and marshal their results.
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_bottom(
+    iree_vm_stack_t* stack);
+
+// Returns the parent of |frame| or nullptr if |frame| is the bottom frame.
+// Frames never move once pushed and the returned pointer remains valid until
+// the parent frame is left. Wait frames are only ever at the top of the stack
+// and as such the parent of a wait frame is the frame that entered the wait.
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_frame_parent(
+    iree_vm_stack_frame_t* frame);
+
 // Queries the context-specific module state for the given module.
 IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
     iree_vm_stack_t* stack, iree_vm_module_t* module,
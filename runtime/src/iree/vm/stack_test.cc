@@ -120,6 +120,106 @@ TEST(VMStackTest, StackOverflow) {
   iree_vm_stack_deinitialize(stack);
 }
 
+// Tests that frames do not move when the stack grows beyond its initial
+// storage and that the grown storage is reused after unwinding.
+TEST(VMStackTest, GrowthPreservesFrames) {
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  state_resolver, iree_allocator_system());
+
+  // Push enough frames to spill the inline storage several times over.
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  static constexpr int kFrameCount = 64;
+  static constexpr iree_host_size_t kFrameSize = 1024;
+  iree_vm_stack_frame_t* frames[kFrameCount] = {nullptr};
+  for (int i = 0; i < kFrameCount; ++i) {
+    IREE_ASSERT_OK(iree_vm_stack_function_enter(
+        stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, kFrameSize, NULL,
+        &frames[i]));
+    frames[i]->pc = i;
+    memset(iree_vm_stack_frame_storage(frames[i]), i, kFrameSize);
+  }
+
+  // All frames must still be at their original addresses and intact.
+  EXPECT_EQ(frames[kFrameCount - 1], iree_vm_stack_current_frame(stack));
+  EXPECT_EQ(frames[0], iree_vm_stack_bottom(stack));
+  for (int i = kFrameCount - 1; i > 0; --i) {
+    EXPECT_EQ(frames[i - 1], iree_vm_stack_frame_parent(frames[i]));
+    EXPECT_EQ(i, frames[i]->pc);
+    const uint8_t* storage =
+        (const uint8_t*)iree_vm_stack_frame_storage(frames[i]);
+    EXPECT_EQ((uint8_t)i, storage[0]);
+    EXPECT_EQ((uint8_t)i, storage[kFrameSize - 1]);
+  }
+
+  // Unwind halfway and push again; frames should land in the same places.
+  for (int i = kFrameCount - 1; i >= kFrameCount / 2; --i) {
+    IREE_ASSERT_OK(iree_vm_stack_function_leave(stack));
+  }
+  EXPECT_EQ(frames[kFrameCount / 2 - 1], iree_vm_stack_current_frame(stack));
+  for (int i = kFrameCount / 2; i < kFrameCount; ++i) {
+    iree_vm_stack_frame_t* frame = nullptr;
+    IREE_ASSERT_OK(iree_vm_stack_function_enter(
+        stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, kFrameSize, NULL,
+        &frame));
+    EXPECT_EQ(frames[i], frame);
+  }
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that stacks without an allocator cannot grow.
+TEST(VMStackTest, NoGrowthWithoutAllocator) {
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  state_resolver, iree_allocator_null());
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  iree_vm_stack_frame_t* frame_a = nullptr;
+  iree_status_t status = iree_vm_stack_function_enter(
+      stack, &function_a, IREE_VM_STACK_FRAME_NATIVE,
+      IREE_VM_STACK_DEFAULT_SIZE, NULL, &frame_a);
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_RESOURCE_EXHAUSTED, status);
+  iree_status_free(status);
+  EXPECT_EQ(nullptr, iree_vm_stack_current_frame(stack));
+
+  iree_vm_stack_deinitialize(stack);
+}
+
+// Tests that the high-water mark tracks the deepest stack usage.
+TEST(VMStackTest, HighWaterMark) {
+  iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  state_resolver, iree_allocator_system());
+  EXPECT_EQ(0, iree_vm_stack_high_water_mark(stack));
+
+  iree_vm_function_t function_a = {MODULE_A_SENTINEL,
+                                   IREE_VM_FUNCTION_LINKAGE_INTERNAL, 0};
+  IREE_ASSERT_OK(iree_vm_stack_function_enter(
+      stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, 64, NULL, NULL));
+  iree_host_size_t one_frame = iree_vm_stack_high_water_mark(stack);
+  EXPECT_GT(one_frame, 64);
+  IREE_ASSERT_OK(iree_vm_stack_function_enter(
+      stack, &function_a, IREE_VM_STACK_FRAME_NATIVE, 64, NULL, NULL));
+  EXPECT_EQ(2 * one_frame, iree_vm_stack_high_water_mark(stack));
+
+  // Leaving frames does not lower the high-water mark.
+  IREE_ASSERT_OK(iree_vm_stack_function_leave(stack));
+  IREE_ASSERT_OK(iree_vm_stack_function_leave(stack));
+  EXPECT_EQ(2 * one_frame, iree_vm_stack_high_water_mark(stack));
+
+  // Usage beyond the initial storage is included.
+  IREE_ASSERT_OK(iree_vm_stack_function_enter(
+      stack, &function_a, IREE_VM_STACK_FRAME_NATIVE,
+      IREE_VM_STACK_DEFAULT_SIZE * 2, NULL, NULL));
+  EXPECT_GT(iree_vm_stack_high_water_mark(stack),
+            IREE_VM_STACK_DEFAULT_SIZE * 2);
+
+  iree_vm_stack_deinitialize(stack);
+}
+
 // Tests unbalanced stack popping.
 TEST(VMStackTest, UnbalancedPop) {
   iree_vm_state_resolver_t state_resolver = {nullptr, SentinelStateResolver};
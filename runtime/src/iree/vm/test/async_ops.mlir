@@ -50,4 +50,54 @@ vm.module @async_ops {
     vm.return %result : i32
   }
 
+  //===--------------------------------------------------------------------===//
+  // Yieldable imports
+  //===--------------------------------------------------------------------===//
+
+  // Native import provided by the test that yields %arg1 times before
+  // returning %arg0 + %arg1.
+  vm.import @yieldable_test.yield_n(%arg0 : i32, %arg1 : i32) -> i32
+
+  // Tests calling an import that yields and returns results, ensuring the
+  // results are marshaled back into the caller registers on resume.
+  //
+  // Expects a result of %arg0 + 3 after 3 resumes + 1.
+  vm.export @call_yield_import
+  vm.func @call_yield_import(%arg0: i32) -> i32 {
+    %c1 = vm.const.i32 1
+    %c3 = vm.const.i32 3
+    %y0 = vm.call @yieldable_test.yield_n(%arg0, %c3) : (i32, i32) -> i32
+    %y0_dno = util.do_not_optimize(%y0) : i32
+    %y1 = vm.add.i32 %y0_dno, %c1 : i32
+    vm.return %y1 : i32
+  }
+
+  //===--------------------------------------------------------------------===//
+  // Yieldable native internal functions
+  //===--------------------------------------------------------------------===//
+
+  // Replaced by a native implementation attached by the test that yields %arg1
+  // times before returning %arg0 + %arg1. This bytecode version returns the
+  // same result without yielding.
+  vm.export @yield_internal
+  vm.func @yield_internal(%arg0 : i32, %arg1 : i32) -> i32 attributes {noinline} {
+    %0 = vm.add.i32 %arg0, %arg1 : i32
+    vm.return %0 : i32
+  }
+
+  // Tests calling an internal function that is dispatched to its native
+  // implementation and yields, ensuring that resumes continue the native
+  // function and marshal its results back into the caller registers.
+  //
+  // Expects a result of %arg0 + 3 after 3 resumes + 1.
+  vm.export @call_yield_internal
+  vm.func @call_yield_internal(%arg0: i32) -> i32 {
+    %c1 = vm.const.i32 1
+    %c3 = vm.const.i32 3
+    %y0 = vm.call @yield_internal(%arg0, %c3) : (i32, i32) -> i32
+    %y0_dno = util.do_not_optimize(%y0) : i32
+    %y1 = vm.add.i32 %y0_dno, %c1 : i32
+    vm.return %y1 : i32
+  }
+
 }
@@ -0,0 +1,54 @@
+vm.module @fork_ops {
+
+  vm.rodata private @buffer dense<[1, 2, 3]> : tensor<3xi8>
+
+  // Only stored by the initializer; shared by forked states.
+  vm.global.ref private mutable @shared : !vm.buffer
+  // Stored after initialization; never shared by forked states.
+  vm.global.ref private mutable @scratch : !vm.buffer
+  // Primitive state copied into forked states.
+  vm.global.i32 private mutable @counter : i32
+
+  vm.initializer {
+    %buffer = vm.const.ref.rodata @buffer : !vm.buffer
+    vm.global.store.ref %buffer, @shared : !vm.buffer
+    vm.return
+  }
+
+  // Increments the counter and returns the new value.
+  vm.export @increment
+  vm.func @increment() -> i32 {
+    %c1 = vm.const.i32 1
+    %counter = vm.global.load.i32 @counter : i32
+    %new_counter = vm.add.i32 %counter, %c1 : i32
+    vm.global.store.i32 %new_counter, @counter : i32
+    vm.return %new_counter : i32
+  }
+
+  // Returns 1 if the shared global has been initialized.
+  vm.export @has_shared
+  vm.func @has_shared() -> i32 {
+    %shared = vm.global.load.ref @shared : !vm.buffer
+    %is_set = vm.cmp.nz.ref %shared : !vm.buffer
+    vm.return %is_set : i32
+  }
+
+  // Allocates a new buffer into the scratch global and returns 1.
+  vm.export @set_scratch
+  vm.func @set_scratch() -> i32 {
+    %c4 = vm.const.i64 4
+    %scratch = vm.buffer.alloc %c4 : !vm.buffer
+    vm.global.store.ref %scratch, @scratch : !vm.buffer
+    %is_set = vm.cmp.nz.ref %scratch : !vm.buffer
+    vm.return %is_set : i32
+  }
+
+  // Returns 1 if the scratch global has been set.
+  vm.export @has_scratch
+  vm.func @has_scratch() -> i32 {
+    %scratch = vm.global.load.ref @scratch : !vm.buffer
+    %is_set = vm.cmp.nz.ref %scratch : !vm.buffer
+    vm.return %is_set : i32
+  }
+
+}
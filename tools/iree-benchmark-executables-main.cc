@@ -0,0 +1,433 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===----------------------------------------------------------------------===//
+// iree-benchmark-executables: benchmarks every dispatch in a module on CPU
+//===----------------------------------------------------------------------===//
+//
+// Runs each dispatch benchmark function in a module produced by the compiler
+// with --iree-hal-dump-executable-benchmarks-to=<dir> and
+// --iree-hal-dump-executable-benchmarks-combined across a sweep of task system
+// worker counts. Each function dispatches one executable export with the
+// workload and binding sizes recorded from the original program using
+// zero-initialized buffers. The intent is to be able to find performance
+// regressions kernel by kernel:
+//
+//   iree-compile --iree-hal-target-backends=llvm-cpu \
+//       --iree-hal-dump-executable-benchmarks-to=/tmp/bench/ \
+//       --iree-hal-dump-executable-benchmarks-combined \
+//       model.mlir -o /dev/null
+//   iree-compile --iree-hal-target-backends=llvm-cpu \
+//       /tmp/bench/module_benchmarks.mlir -o /tmp/bench/benchmarks.vmfb
+//   iree-benchmark-executables --module_file=/tmp/bench/benchmarks.vmfb \
+//       --worker_counts=1,2,4,8
+//
+// Each benchmark reports the following counters when the information was
+// available at compile time:
+//   FLOP/s:     estimated arithmetic throughput of the dispatch.
+//   bytes/s:    total binding bytes accessed by the dispatch per second. This
+//               assumes each byte is touched once and is a lower bound on the
+//               actual memory traffic.
+//   efficiency: parallel scaling efficiency of runs with N > 1 workers
+//               relative to the 1 worker run (t1 / (N * tN)). Only reported
+//               when 1 is part of the sweep. Worker counts are swept in
+//               increasing order so the 1 worker run of each dispatch is
+//               measured first.
+//
+// Passing --dispatch_prefetch_budget=N prefetches up to N bytes of each binding
+// the compiler marked as streamed for the next workgroup while the current one
+// runs. Comparing the bytes/s of runs with and without it shows which
+// memory-bound dispatches benefit from prefetching.
+//
+// Timings include the cost of recording and submitting a command buffer with
+// --batch_size dispatches and waiting for it to complete. Increase the batch
+// size to amortize that overhead for very small dispatches. As with
+// iree-benchmark-module these numbers are only a guide: use tracy or
+// platform tooling for precise per-dispatch timings.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
+#include "iree/base/status_cc.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/local_task/task_device.h"
+#include "iree/hal/local/loaders/registration/init.h"
+#include "iree/modules/hal/module.h"
+#include "iree/task/api.h"
+#include "iree/tooling/context_util.h"
+#include "iree/vm/api.h"
+#include "iree/vm/ref_cc.h"
+
+IREE_FLAG(int32_t, batch_size, 16,
+          "Number of dispatches recorded into each submitted command buffer.");
+
+IREE_FLAG(string, worker_counts, "",
+          "Comma-separated list of task system worker counts to benchmark\n"
+          "each dispatch with (such as `1,2,4,8`). Defaults to powers of two\n"
+          "up to the number of physical cores in the machine.");
+
+IREE_FLAG(int64_t, dispatch_prefetch_budget, 0,
+          "Maximum number of bytes of each streamed binding prefetched for the\n"
+          "next workgroup during dispatch. 0 disables prefetching.");
+
+namespace iree {
+namespace {
+
+// Dispatch information recorded by the compiler in function reflection data.
+struct DispatchInfo {
+  std::string function_name;
+  iree_vm_function_t function;
+  // Estimated arithmetic operations per dispatch or 0 if unknown.
+  uint64_t flops = 0;
+  // Total binding bytes per dispatch or 0 if unknown.
+  uint64_t bytes = 0;
+};
+
+// A device and context using a task system with a fixed worker count.
+struct WorkerContext {
+  int64_t worker_count = 0;
+  iree_hal_device_t* device = nullptr;
+  iree_vm_context_t* context = nullptr;
+};
+
+// Returns the decimal value of the reflection attribute |key| or 0 if the
+// attribute is not present or invalid.
+static uint64_t LookupUint64Attr(iree_vm_function_t* function,
+                                 iree_string_view_t key) {
+  iree_string_view_t value =
+      iree_vm_function_lookup_attr_by_name(function, key);
+  uint64_t result = 0;
+  if (iree_string_view_is_empty(value) ||
+      !iree_string_view_atoi_uint64(value, &result)) {
+    return 0;
+  }
+  return result;
+}
+
+// Parses --worker_counts= into |out_worker_counts|.
+static iree_status_t ParseWorkerCounts(
+    std::vector<int64_t>* out_worker_counts) {
+  out_worker_counts->clear();
+  iree_string_view_t remaining = iree_make_cstring_view(FLAG_worker_counts);
+  if (iree_string_view_is_empty(remaining)) {
+    // Default to powers of two up to the physical core count.
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_physical_cores(
+        IREE_TASK_EXECUTOR_MAX_WORKER_COUNT, &topology);
+    int64_t max_count = (int64_t)iree_task_topology_group_count(&topology);
+    iree_task_topology_deinitialize(&topology);
+    for (int64_t count = 1; count < max_count; count *= 2) {
+      out_worker_counts->push_back(count);
+    }
+    out_worker_counts->push_back(max_count > 0 ? max_count : 1);
+    return iree_ok_status();
+  }
+  while (!iree_string_view_is_empty(remaining)) {
+    iree_string_view_t count_str;
+    iree_string_view_split(remaining, ',', &count_str, &remaining);
+    count_str = iree_string_view_trim(count_str);
+    uint32_t count = 0;
+    if (!iree_string_view_atoi_uint32(count_str, &count) || count == 0 ||
+        count > IREE_TASK_EXECUTOR_MAX_WORKER_COUNT) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid worker count '%.*s'; expected a value "
+                              "in [1, %d]",
+                              (int)count_str.size, count_str.data,
+                              IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
+    }
+    out_worker_counts->push_back(count);
+  }
+  // Sweep in increasing order so that the 1 worker baseline used for the
+  // efficiency counter is measured before the runs that reference it.
+  std::sort(out_worker_counts->begin(), out_worker_counts->end());
+  out_worker_counts->erase(
+      std::unique(out_worker_counts->begin(), out_worker_counts->end()),
+      out_worker_counts->end());
+  return iree_ok_status();
+}
+
+// Runs |dispatch| on |worker_context|. |baseline_time| holds the wall time per
+// iteration of the last 1 worker run of the dispatch or 0 if it has not run.
+static void BenchmarkDispatch(const std::string& benchmark_name,
+                              const DispatchInfo& dispatch,
+                              const WorkerContext& worker_context,
+                              double* baseline_time, benchmark::State& state) {
+  IREE_TRACE_SCOPE_DYNAMIC(benchmark_name.c_str());
+  IREE_TRACE_FRAME_MARK();
+
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                    iree_allocator_system(), &inputs));
+  iree_vm_value_t batch_size = iree_vm_value_make_i32(FLAG_batch_size);
+  IREE_CHECK_OK(iree_vm_list_push_value(inputs.get(), &batch_size));
+
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                    iree_allocator_system(), &outputs));
+
+  // Benchmarking loop.
+  iree_time_t start_time = iree_time_now();
+  while (state.KeepRunningBatch(FLAG_batch_size)) {
+    IREE_TRACE_SCOPE0("BenchmarkIteration");
+    IREE_TRACE_FRAME_MARK_NAMED("Iteration");
+    IREE_CHECK_OK(iree_vm_invoke(worker_context.context, dispatch.function,
+                                 IREE_VM_INVOCATION_FLAG_NONE,
+                                 /*policy=*/nullptr, inputs.get(),
+                                 outputs.get(), iree_allocator_system()));
+    IREE_CHECK_OK(iree_vm_list_resize(outputs.get(), 0));
+  }
+  iree_time_t end_time = iree_time_now();
+  state.SetItemsProcessed(state.iterations());
+
+  // Each iteration is a single dispatch so rates are computed per iteration.
+  if (dispatch.flops) {
+    state.counters["FLOP/s"] = benchmark::Counter(
+        (double)dispatch.flops, benchmark::Counter::kIsIterationInvariantRate,
+        benchmark::Counter::kIs1000);
+  }
+  if (dispatch.bytes) {
+    state.counters["bytes/s"] = benchmark::Counter(
+        (double)dispatch.bytes, benchmark::Counter::kIsIterationInvariantRate,
+        benchmark::Counter::kIs1000);
+  }
+
+  // Scaling efficiency is reported as a counter so that it is emitted by
+  // whichever reporter --benchmark_format= selects.
+  if (state.iterations() > 0 && end_time > start_time) {
+    double time = (double)(end_time - start_time) / state.iterations();
+    if (worker_context.worker_count == 1) {
+      *baseline_time = time;
+    } else if (*baseline_time > 0.0) {
+      state.counters["efficiency"] = benchmark::Counter(
+          *baseline_time / (worker_context.worker_count * time));
+    }
+  }
+}
+
+// The lifetime of ExecutableBenchmarks should be as long as
+// ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
+// benchmarking.
+class ExecutableBenchmarks {
+ public:
+  ExecutableBenchmarks() = default;
+
+  ~ExecutableBenchmarks() {
+    IREE_TRACE_SCOPE0("ExecutableBenchmarks::dtor");
+    for (auto& worker_context : worker_contexts_) {
+      iree_vm_context_release(worker_context->context);
+      iree_hal_device_release(worker_context->device);
+    }
+    worker_contexts_.clear();
+    iree_vm_module_release(main_module_);
+    for (iree_host_size_t i = 0; i < loader_count_; ++i) {
+      iree_hal_executable_loader_release(loaders_[i]);
+    }
+    iree_vm_instance_release(instance_);
+  }
+
+  iree_status_t Register() {
+    IREE_TRACE_SCOPE0("ExecutableBenchmarks::Register");
+    IREE_RETURN_IF_ERROR(Init());
+
+    std::vector<DispatchInfo> dispatches;
+    IREE_RETURN_IF_ERROR(EnumerateDispatches(&dispatches));
+    if (dispatches.empty()) {
+      return iree_make_status(
+          IREE_STATUS_NOT_FOUND,
+          "module contains no dispatch benchmark functions; compile it from "
+          "the output of --iree-hal-dump-executable-benchmarks-to=");
+    }
+
+    for (auto& dispatch : dispatches) {
+      RegisterDispatchBenchmark(dispatch);
+    }
+    return iree_ok_status();
+  }
+
+ private:
+  iree_status_t Init() {
+    IREE_TRACE_SCOPE0("ExecutableBenchmarks::Init");
+    IREE_TRACE_FRAME_MARK_BEGIN_NAMED("init");
+
+    if (FLAG_dispatch_prefetch_budget < 0) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid dispatch prefetch budget %" PRId64
+                              "; expected a value >= 0",
+                              FLAG_dispatch_prefetch_budget);
+    }
+
+    iree_allocator_t host_allocator = iree_allocator_system();
+    IREE_RETURN_IF_ERROR(
+        iree_tooling_create_instance(host_allocator, &instance_));
+    IREE_RETURN_IF_ERROR(iree_tooling_load_module_from_flags(
+        instance_, host_allocator, &main_module_));
+    IREE_RETURN_IF_ERROR(iree_hal_create_all_available_executable_loaders(
+        IREE_ARRAYSIZE(loaders_), &loader_count_, loaders_, host_allocator));
+
+    std::vector<int64_t> worker_counts;
+    IREE_RETURN_IF_ERROR(ParseWorkerCounts(&worker_counts));
+    for (int64_t worker_count : worker_counts) {
+      auto worker_context = std::make_unique<WorkerContext>();
+      worker_context->worker_count = worker_count;
+      IREE_RETURN_IF_ERROR(CreateWorkerContext(worker_context.get()));
+      worker_contexts_.push_back(std::move(worker_context));
+    }
+
+    IREE_TRACE_FRAME_MARK_END_NAMED("init");
+    return iree_ok_status();
+  }
+
+  // Creates a local-task device with |worker_context|.worker_count workers and
+  // a context containing the HAL module for it and the main module.
+  iree_status_t CreateWorkerContext(WorkerContext* worker_context) {
+    IREE_TRACE_SCOPE0("ExecutableBenchmarks::CreateWorkerContext");
+    iree_allocator_t host_allocator = iree_allocator_system();
+
+    iree_task_executor_options_t options;
+    IREE_RETURN_IF_ERROR(
+        iree_task_executor_options_initialize_from_flags(&options));
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(
+        (iree_host_size_t)worker_context->worker_count, &topology);
+    iree_task_executor_t* executor = nullptr;
+    iree_status_t status = iree_task_executor_create(
+        options, &topology, host_allocator, &executor);
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_allocator_t* device_allocator = nullptr;
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_allocator_create_heap(IREE_SV("local"), host_allocator,
+                                              host_allocator,
+                                              &device_allocator);
+    }
+
+    if (iree_status_is_ok(status)) {
+      iree_hal_task_device_params_t params;
+      iree_hal_task_device_params_initialize(&params);
+      params.dispatch_prefetch_budget =
+          (iree_host_size_t)FLAG_dispatch_prefetch_budget;
+      status = iree_hal_task_device_create(
+          IREE_SV("local-task"), &params, executor, loader_count_, loaders_,
+          device_allocator, host_allocator, &worker_context->device);
+    }
+    iree_hal_allocator_release(device_allocator);
+    iree_task_executor_release(executor);
+
+    iree_vm_module_t* hal_module = nullptr;
+    if (iree_status_is_ok(status)) {
+      // The benchmark loop invokes synchronously and cannot resume yields.
+      status = iree_hal_module_create(instance_, worker_context->device,
+                                      IREE_HAL_MODULE_FLAG_SYNCHRONOUS,
+                                      host_allocator, &hal_module);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_vm_module_t* modules[2] = {hal_module, main_module_};
+      status = iree_vm_context_create_with_modules(
+          instance_, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules),
+          modules, host_allocator, &worker_context->context);
+    }
+    iree_vm_module_release(hal_module);
+    return status;
+  }
+
+  // Gathers all functions marked as dispatch benchmarks by the compiler.
+  iree_status_t EnumerateDispatches(std::vector<DispatchInfo>* out_dispatches) {
+    IREE_TRACE_SCOPE0("ExecutableBenchmarks::EnumerateDispatches");
+    iree_vm_module_signature_t signature =
+        iree_vm_module_signature(main_module_);
+    for (iree_host_size_t i = 0; i < signature.export_function_count; ++i) {
+      DispatchInfo dispatch;
+      IREE_RETURN_IF_ERROR(iree_vm_module_lookup_function_by_ordinal(
+          main_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT, i,
+          &dispatch.function));
+      iree_string_view_t benchmark_type = iree_vm_function_lookup_attr_by_name(
+          &dispatch.function, IREE_SV("iree.benchmark"));
+      if (!iree_string_view_equal(benchmark_type, IREE_SV("dispatch"))) {
+        continue;
+      }
+      iree_string_view_t function_name =
+          iree_vm_function_name(&dispatch.function);
+      dispatch.function_name =
+          std::string(function_name.data, function_name.size);
+      dispatch.flops = LookupUint64Attr(&dispatch.function,
+                                        IREE_SV("iree.benchmark.flops"));
+      dispatch.bytes = LookupUint64Attr(&dispatch.function,
+                                        IREE_SV("iree.benchmark.bytes"));
+      out_dispatches->push_back(std::move(dispatch));
+    }
+    return iree_ok_status();
+  }
+
+  void RegisterDispatchBenchmark(const DispatchInfo& dispatch) {
+    auto benchmark_name = "BM_" + dispatch.function_name;
+    const auto* worker_contexts = &worker_contexts_;
+    // Shared by the runs of all worker counts of the dispatch.
+    auto baseline_time = std::make_shared<double>(0.0);
+    auto* benchmark = benchmark::RegisterBenchmark(
+        benchmark_name.c_str(),
+        [benchmark_name, dispatch, worker_contexts,
+         baseline_time](benchmark::State& state) -> void {
+          for (auto& worker_context : *worker_contexts) {
+            if (worker_context->worker_count == state.range(0)) {
+              BenchmarkDispatch(benchmark_name, dispatch, *worker_context,
+                                baseline_time.get(), state);
+              return;
+            }
+          }
+          state.SkipWithError("no context for worker count");
+        });
+    benchmark->ArgName("workers");
+    for (auto& worker_context : worker_contexts_) {
+      benchmark->Arg(worker_context->worker_count);
+    }
+    // By default only the main thread is included in CPU time. Include all
+    // the threads instead.
+    benchmark->MeasureProcessCPUTime()
+        // Workers run on their own threads so wall time is what matters. See
+        // https://github.com/google/benchmark#cpu-timers.
+        ->UseRealTime()
+        ->Unit(benchmark::kMicrosecond);
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_module_t* main_module_ = nullptr;
+  iree_hal_executable_loader_t* loaders_[8] = {nullptr};
+  iree_host_size_t loader_count_ = 0;
+  std::vector<std::unique_ptr<WorkerContext>> worker_contexts_;
+};
+
+}  // namespace
+}  // namespace iree
+
+int main(int argc, char** argv) {
+  IREE_TRACE_SCOPE0("main");
+
+  // Pass through flags to benchmark (allowing --help to fall through).
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK |
+                               IREE_FLAGS_PARSE_MODE_CONTINUE_AFTER_HELP,
+                           &argc, &argv);
+  ::benchmark::Initialize(&argc, argv);
+
+  iree::ExecutableBenchmarks executable_benchmarks;
+  iree_status_t status = executable_benchmarks.Register();
+  if (!iree_status_is_ok(status)) {
+    int ret = static_cast<int>(iree_status_code(status));
+    std::cout << iree::Status(std::move(status)) << std::endl;
+    return ret;
+  }
+  ::benchmark::RunSpecifiedBenchmarks();
+  return 0;
+}
@@ -287,6 +287,9 @@ class IREEBenchmark {
 
     // Order matters. Tear down modules first to release resources.
     inputs_.reset();
+    if (context_) {
+      IREE_IGNORE_ERROR(iree_tooling_print_context_profile(context_, stderr));
+    }
     iree_vm_context_release(context_);
     iree_vm_module_release(main_module_);
     iree_vm_instance_release(instance_);
@@ -133,6 +133,9 @@ iree_status_t Run() {
       PrintVariantList(outputs.get(), (size_t)FLAG_print_max_element_count),
       "printing results");
 
+  IREE_RETURN_IF_ERROR(iree_tooling_print_context_profile(context, stderr),
+                       "printing profile");
+
   // Release resources before gathering statistics.
   inputs.reset();
   outputs.reset();
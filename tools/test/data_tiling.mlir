@@ -0,0 +1,25 @@
+// RUN: (iree-compile %s --iree-hal-target-backends=vmvx \
+// RUN:     --iree-opt-data-tiling | \
+// RUN:  iree-run-module --device=local-task --entry_function=matmul \
+// RUN:     --function_input="2x3xf32=[1 2 3][4 5 6]" \
+// RUN:     --function_input="3x2xf32=[7 8][9 10][11 12]") | FileCheck %s
+// RUN: (iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-opt-data-tiling | \
+// RUN:  iree-run-module --device=local-task --entry_function=matmul \
+// RUN:     --function_input="2x3xf32=[1 2 3][4 5 6]" \
+// RUN:     --function_input="3x2xf32=[7 8][9 10][11 12]") | FileCheck %s
+
+// Data tiling assigns the executable targets ahead of the flow pipeline.
+// Targets without a known data tiled layout (non-CPU targets or CPUs without
+// the required features) must compile and run unchanged.
+
+// CHECK-LABEL: EXEC @matmul
+func.func @matmul(%lhs : tensor<2x3xf32>, %rhs : tensor<3x2xf32>) -> tensor<2x2xf32> {
+  %zero = arith.constant 0.0 : f32
+  %init = linalg.init_tensor [2, 2] : tensor<2x2xf32>
+  %acc = linalg.fill ins(%zero : f32) outs(%init : tensor<2x2xf32>) -> tensor<2x2xf32>
+  %result = linalg.matmul ins(%lhs, %rhs : tensor<2x3xf32>, tensor<3x2xf32>)
+                          outs(%acc : tensor<2x2xf32>) -> tensor<2x2xf32>
+  return %result : tensor<2x2xf32>
+}
+// CHECK: 2x2xf32=[58 64][139 154]
@@ -0,0 +1,68 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/cold.vmfb \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/warm.vmfb \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=WARM
+// RUN: cmp %t/cold.vmfb %t/warm.vmfb
+// RUN: iree-run-module --module_file=%t/warm.vmfb --entry_function=abs \
+// RUN:     --function_input=f32=-2 | FileCheck %s
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-codegen-llvm-number-of-threads=2 \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-llvmcpu-enable-microkernels \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-llvmcpu-enable-triple-tiling-pipeline \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+// RUN: touch %t/tuning.jsonl
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-codegen-llvmcpu-tuning-database=%t/tuning.jsonl \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-codegen-llvmcpu-tuning-database=%t/tuning.jsonl \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=WARM
+// RUN: echo '{"fingerprint": "0", "compilation_info": ""}' > %t/tuning.jsonl
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-cache-dir=%t/cache -o %t/flag.vmfb \
+// RUN:     --iree-codegen-llvmcpu-tuning-database=%t/tuning.jsonl \
+// RUN:     --mlir-pass-statistics --mlir-pass-statistics-display=list 2>&1 | \
+// RUN: FileCheck %s --check-prefix=COLD
+
+// The first compilation populates the cache and the second one reuses both
+// the translated dispatch and the serialized binary, producing an identical
+// module.
+//
+// Changing any codegen option, or the contents of the tuning database, misses
+// the cache.
+
+// COLD: TranslateTargetExecutableVariantsPass
+// COLD:   (S) 1 cache miss(es)
+// COLD: SerializeTargetExecutablesPass
+// COLD:   (S) 1 cache miss(es)
+
+// WARM: TranslateTargetExecutableVariantsPass
+// WARM:   (S) 1 cache hit(s)
+// WARM: SerializeTargetExecutablesPass
+// WARM:   (S) 1 cache hit(s)
+
+// CHECK-LABEL: EXEC @abs
+func.func @abs(%input : tensor<f32>) -> (tensor<f32>) {
+  %result = math.absf %input : tensor<f32>
+  return %result : tensor<f32>
+}
+// CHECK: f32=2
@@ -0,0 +1,26 @@
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-parallelism=1 -o %t.serial.vmfb
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-executable-parallelism=4 -o %t.parallel.vmfb
+// RUN: cmp %t.serial.vmfb %t.parallel.vmfb
+// RUN: iree-run-module --module_file=%t.parallel.vmfb --entry_function=abs \
+// RUN:     --function_input="4xf32=-1 2 -3 4" | FileCheck %s --check-prefix=ABS
+// RUN: iree-run-module --module_file=%t.parallel.vmfb --entry_function=neg \
+// RUN:     --function_input="4xf32=-1 2 -3 4" | FileCheck %s --check-prefix=NEG
+
+// The dispatches are linked into a single executable that is code generated
+// in multiple partitions. The output must not depend on the thread count.
+
+// ABS-LABEL: EXEC @abs
+func.func @abs(%input : tensor<4xf32>) -> (tensor<4xf32>) {
+  %result = math.absf %input : tensor<4xf32>
+  return %result : tensor<4xf32>
+}
+// ABS: 4xf32=1 2 3 4
+
+// NEG-LABEL: EXEC @neg
+func.func @neg(%input : tensor<4xf32>) -> (tensor<4xf32>) {
+  %result = arith.negf %input : tensor<4xf32>
+  return %result : tensor<4xf32>
+}
+// NEG: 4xf32=1 -2 3 -4
@@ -0,0 +1,23 @@
+// RUN: iree-compile %s -o ignored.mlir \
+// RUN:     --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-dump-executable-benchmarks-to=- \
+// RUN:     --iree-hal-dump-executable-benchmarks-combined | \
+// RUN: iree-compile - -o %t.vmfb
+// RUN: iree-benchmark-executables --module_file=%t.vmfb --worker_counts=1,2 \
+// RUN:     --dispatch_prefetch_budget=4096 | FileCheck %s
+// RUN: not iree-benchmark-executables --module_file=%t.vmfb \
+// RUN:     --dispatch_prefetch_budget=-1 | FileCheck %s --check-prefix=NEGATIVE
+
+// The elementwise dispatch streams both inputs and the output across its
+// workgroups so the compiler marks them in the dispatch hints and each tile
+// prefetches the range of the next workgroup. Prefetching must not change the
+// results or fail the dispatch.
+
+// CHECK: BM_{{.+}}/workers:1
+// CHECK: BM_{{.+}}/workers:2
+func.func @add(%lhs : tensor<65536xf32>, %rhs : tensor<65536xf32>) -> (tensor<65536xf32>) {
+  %result = arith.addf %lhs, %rhs : tensor<65536xf32>
+  return %result : tensor<65536xf32>
+}
+
+// NEGATIVE: invalid dispatch prefetch budget -1
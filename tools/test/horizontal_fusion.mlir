@@ -0,0 +1,57 @@
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-dump-executable-sources-to=- \
+// RUN:     -o %t.unfused.vmfb | FileCheck %s --check-prefix=UNFUSED
+// RUN: iree-compile %s --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-flow-enable-horizontal-fusion \
+// RUN:     --iree-hal-dump-executable-sources-to=- \
+// RUN:     -o %t.fused.vmfb | FileCheck %s --check-prefix=FUSED
+// RUN: iree-run-module --module_file=%t.unfused.vmfb --entry_function=sum_max \
+// RUN:     --function_input="4x8xf32=[1 2 3 4 5 6 7 8][-1 -2 -3 -4 -5 -6 -7 -8][0 0 0 0 0 0 0 1][2 2 2 2 2 2 2 2]" | \
+// RUN:   FileCheck %s
+// RUN: iree-run-module --module_file=%t.fused.vmfb --entry_function=sum_max \
+// RUN:     --function_input="4x8xf32=[1 2 3 4 5 6 7 8][-1 -2 -3 -4 -5 -6 -7 -8][0 0 0 0 0 0 0 1][2 2 2 2 2 2 2 2]" | \
+// RUN:   FileCheck %s
+
+// The two row reductions over the same input each form their own dispatch by
+// default. Horizontal fusion merges them into a single multi-result reduction
+// that LLVMCPU code generates as one dispatch writing both results. The
+// results must be the same either way.
+
+// UNFUSED: hal.executable.export
+// UNFUSED: hal.executable.export
+// UNFUSED-NOT: hal.executable.export
+
+// FUSED: hal.executable.export
+// FUSED-NOT: hal.executable.export
+// FUSED: linalg.generic
+// FUSED-SAME: iterator_types = ["parallel", "reduction"]
+// FUSED: arith.addf
+// FUSED: arith.maxf
+// FUSED-COUNT-2: flow.dispatch.tensor.store
+// FUSED-NOT: hal.executable.export
+
+// CHECK-LABEL: EXEC @sum_max
+#map0 = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+func.func @sum_max(%input : tensor<4x8xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %zero = arith.constant 0.0 : f32
+  %ninf = arith.constant 0xFF800000 : f32
+  %init = linalg.init_tensor [4] : tensor<4xf32>
+  %sum_init = linalg.fill ins(%zero : f32) outs(%init : tensor<4xf32>) -> tensor<4xf32>
+  %max_init = linalg.fill ins(%ninf : f32) outs(%init : tensor<4xf32>) -> tensor<4xf32>
+  %sum = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%input : tensor<4x8xf32>) outs(%sum_init : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.addf %in, %out : f32
+    linalg.yield %0 : f32
+  } -> tensor<4xf32>
+  %max = linalg.generic {indexing_maps = [#map0, #map1], iterator_types = ["parallel", "reduction"]}
+      ins(%input : tensor<4x8xf32>) outs(%max_init : tensor<4xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %0 = arith.maxf %in, %out : f32
+    linalg.yield %0 : f32
+  } -> tensor<4xf32>
+  return %sum, %max : tensor<4xf32>, tensor<4xf32>
+}
+// CHECK: 4xf32=36 -36 1 16
+// CHECK: 4xf32=8 -1 1 2
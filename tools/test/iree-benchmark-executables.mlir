@@ -0,0 +1,34 @@
+// RUN: iree-compile %s -o ignored.mlir \
+// RUN:     --iree-hal-target-backends=llvm-cpu \
+// RUN:     --iree-hal-dump-executable-benchmarks-to=- \
+// RUN:     --iree-hal-dump-executable-benchmarks-combined | \
+// RUN: iree-compile - -o %t.vmfb
+// RUN: iree-benchmark-executables --module_file=%t.vmfb --worker_counts=4,2,1 \
+// RUN:     --benchmark_min_time=0 | FileCheck %s
+// RUN: iree-benchmark-executables --module_file=%t.vmfb --worker_counts=4,2,1 \
+// RUN:     --benchmark_min_time=0 --benchmark_format=json | \
+// RUN: FileCheck %s --check-prefix=JSON
+
+// Worker counts are swept in increasing order and the scaling efficiency of
+// each multi-worker run is reported as a counter relative to the 1 worker run.
+// The 1 worker run is the baseline and reports no efficiency. Counters are
+// emitted by whichever reporter --benchmark_format= selects.
+
+//      CHECK: BM_abs_dispatch_0{{.+}}/workers:1
+//  CHECK-NOT:   efficiency=
+//      CHECK: BM_abs_dispatch_0{{.+}}/workers:2
+// CHECK-SAME:   efficiency=
+//      CHECK: BM_abs_dispatch_0{{.+}}/workers:4
+// CHECK-SAME:   efficiency=
+
+//      JSON: "benchmarks": [
+//      JSON:   "name": "BM_abs_dispatch_0{{.+}}/workers:1
+//  JSON-NOT:   "efficiency"
+//      JSON:   "name": "BM_abs_dispatch_0{{.+}}/workers:2
+//      JSON:   "efficiency": {{[0-9]}}
+//      JSON:   "name": "BM_abs_dispatch_0{{.+}}/workers:4
+//      JSON:   "efficiency": {{[0-9]}}
+func.func @abs(%input : tensor<1024xf32>) -> (tensor<1024xf32>) {
+  %result = math.absf %input : tensor<1024xf32>
+  return %result : tensor<1024xf32>
+}